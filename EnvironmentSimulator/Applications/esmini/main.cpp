@@ -99,9 +99,9 @@ static int execute_scenario(int argc, char* argv[])
         retval = player->Frame(dt);
 
 #ifdef _USE_IMPLOT
-        if (plot != nullptr && plot->IsModeSynchronuous())
+        if (plot != nullptr && plot->IsModeSynchronuous() && player->scheduler.ShouldRun(FrameScheduler::Stage::PLOT))
         {
-            plot->Frame();
+            player->scheduler.Run(FrameScheduler::Stage::PLOT, [&plot]() { plot->Frame(); });
         }
 #endif  // _USE_IMPLOT
     }
@@ -18,6 +18,9 @@
 #include "osi_object.pb.h"
 #include "osi_sensorview.pb.h"
 #include "osi_version.pb.h"
+#include "SharedMemory.hpp"
+#include "ChunkedTrace.hpp"
+#include "UDP.hpp"
 #include <signal.h>
 
 #ifndef _WINDOWS
@@ -27,25 +30,11 @@
 
 static bool quit;
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <Ws2tcpip.h>
-typedef SOCKET SE_SOCKET;
-#define SE_INVALID_SOCKET INVALID_SOCKET
-#else
-/* Assume that any non-Windows platform uses POSIX-style sockets instead. */
-#include <sys/socket.h>
-#include <arpa/inet.h>
-#include <netdb.h>  /* Needed for getaddrinfo() and freeaddrinfo() */
-#include <unistd.h> /* Needed for close() */
-typedef int SE_SOCKET;
-#define SE_INVALID_SOCKET -1
-#endif
-
 #define OSI_OUT_PORT          48198
 #define ES_SERV_TIMEOUT       500
 #define MAX_MSG_SIZE          1024000
-#define OSI_MAX_UDP_DATA_SIZE 8200
+#define OSI_MAX_UDP_DATA_SIZE 65536  // large enough for any package size configured on sender side
+#define OSI_SHM_DEFAULT_NAME  "esmini_osi"
 
 void CloseGracefully(SE_SOCKET socket)
 {
@@ -63,6 +52,30 @@ void CloseGracefully(SE_SOCKET socket)
 #endif
 }
 
+static void PrintGroundTruth(osi3::GroundTruth& gt)
+{
+    // Print timestamp
+    printf("timestamp: %.2f\n",
+           static_cast<double>(gt.mutable_timestamp()->seconds()) + 1E-9 * static_cast<double>(gt.mutable_timestamp()->nanos()));
+
+    // Print object id, position, orientation and velocity
+    for (int i = 0; i < gt.mutable_moving_object()->size(); i++)
+    {
+        printf(" obj id %d pos (%.2f, %.2f, %.2f) orientation (%.2f, %.2f, %.2f) velocity (%.2f, %.2f, %.2f) assigned lane: %d\n",
+               static_cast<int>(gt.moving_object(i).id().value()),
+               gt.moving_object(i).base().position().x(),
+               gt.moving_object(i).base().position().y(),
+               gt.moving_object(i).base().position().z(),
+               gt.moving_object(i).base().orientation().yaw(),
+               gt.moving_object(i).base().orientation().pitch(),
+               gt.moving_object(i).base().orientation().roll(),
+               gt.moving_object(i).base().velocity().x(),
+               gt.moving_object(i).base().velocity().y(),
+               gt.moving_object(i).base().velocity().z(),
+               gt.moving_object(i).assigned_lane_id_size() > 0 ? static_cast<int>(gt.moving_object(i).assigned_lane_id(0).value()) : -1);
+    }
+}
+
 static void signal_handler(int s)
 {
     printf("Caught signal %d - quit\n", s);
@@ -70,30 +83,141 @@ static void signal_handler(int s)
     quit = true;
 }
 
+static int ReceiveSharedMemory(const char* name)
+{
+#ifdef _WIN32
+    printf("Shared memory not supported on this platform\n");
+    return -1;
+#else
+    osi3::GroundTruth gt;
+    bool              waiting = false;
+
+    while (!quit)
+    {
+        SharedMemoryReader reader(name);
+        if (reader.GetStatus() != 0)
+        {
+            if (!waiting)
+            {
+                printf("Waiting for shared memory %s to be created. Press Ctrl-C to quit.\n", name);
+                waiting = true;
+            }
+            Sleep(ES_SERV_TIMEOUT);
+            continue;
+        }
+        waiting = false;
+
+        printf("Shared memory %s open. Waiting for OSI messages. Press Ctrl-C to quit.\n", name);
+
+        while (!quit && !reader.IsWriterClosed())
+        {
+            // parse directly from shared memory, discard if overwritten meanwhile
+            size_t      size = 0;
+            const char* data = reader.Acquire(size, ES_SERV_TIMEOUT);
+            if (data != nullptr)
+            {
+                bool parsed = gt.ParseFromArray(data, static_cast<int>(size));
+                if (reader.Release() && parsed)
+                {
+                    PrintGroundTruth(gt);
+                }
+            }
+        }
+
+        if (!quit)
+        {
+            printf("Shared memory %s closed by sender (%llu messages skipped)\n", name, static_cast<unsigned long long>(reader.GetNumberOfSkippedMessages()));
+        }
+    }
+
+    return 0;
+#endif
+}
+
+static int ReadTraceFile(const char* filename, double start_time)
+{
+    ChunkedTraceReader reader;
+    if (reader.Open(filename) != 0)
+    {
+        printf("Failed to open chunked trace file %s\n", filename);
+        return -1;
+    }
+    printf("%s: %u frames in %u chunks\n", filename, reader.GetNumberOfFrames(), reader.GetNumberOfChunks());
+
+    osi3::GroundTruth gt;
+    std::string       static_data;
+    if (reader.ReadStatic(static_data) == 0 && gt.ParseFromString(static_data))
+    {
+        printf("static ground truth: %d lanes, %d lane boundaries, %d stationary objects\n",
+               gt.lane_size(),
+               gt.lane_boundary_size(),
+               gt.stationary_object_size());
+    }
+
+    // jump directly to the chunk of start time, then decode a number of chunks at a time in parallel
+    const unsigned int                                  batch_size = 16;
+    unsigned long long                                  start      = static_cast<unsigned long long>(1e9 * MAX(0.0, start_time));
+    int                                                 first      = reader.FindChunkByTime(start);
+    std::vector<std::vector<ChunkedTraceReader::Frame>> chunks;
+
+    for (unsigned int i = static_cast<unsigned int>(MAX(0, first)); first >= 0 && i < reader.GetNumberOfChunks() && !quit; i += batch_size)
+    {
+        if (reader.ReadChunks(i, batch_size, chunks) != 0)
+        {
+            printf("Failed to read chunks %u - %u\n", i, i + batch_size - 1);
+            return -1;
+        }
+
+        for (auto& chunk : chunks)
+        {
+            for (auto& frame : chunk)
+            {
+                if (frame.timestamp >= start && gt.ParseFromString(frame.data))
+                {
+                    PrintGroundTruth(gt);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
-    (void)argc;
-    (void)argv;
     static SE_SOCKET          sock;
     struct sockaddr_in        server_addr;
     struct sockaddr_in        sender_addr;
     static unsigned short int iPortIn = OSI_OUT_PORT;  // Port for incoming packages
-    static char               large_buf[MAX_MSG_SIZE];
+    static char               buf[sizeof(UDPFrameAssembler::Header) + OSI_MAX_UDP_DATA_SIZE];
     socklen_t                 sender_addr_size = sizeof(sender_addr);
 
-    // This struct must match the sender side
-    struct
-    {
-        int          counter;
-        unsigned int datasize;
-        char         data[OSI_MAX_UDP_DATA_SIZE];
-    } buf;
-
     quit = false;
 
     // Setup signal handler to catch Ctrl-C
     signal(SIGINT, signal_handler);
 
+    if (argc > 1)
+    {
+        if (!strcmp(argv[1], "--shm"))
+        {
+            return ReceiveSharedMemory(argc > 2 ? argv[2] : OSI_SHM_DEFAULT_NAME);
+        }
+        else if (!strcmp(argv[1], "--trace") && argc > 2)
+        {
+            return ReadTraceFile(argv[2], argc > 3 ? atof(argv[3]) : 0.0);
+        }
+        else
+        {
+            printf("Usage: %s [--shm [name]] [--trace <filename> [start time]]\n", argv[0]);
+            printf("  Receive OSI ground truth from esmini over UDP (port %d), or with --shm from shared memory (default name %s)\n",
+                   OSI_OUT_PORT,
+                   OSI_SHM_DEFAULT_NAME);
+            printf("  --trace prints content of a chunked OSI trace file (esmini --osi_file_chunked), optionally from given time\n");
+            return -1;
+        }
+    }
+
 #ifdef _WIN32
     WSADATA wsa_data;
     int     iResult = WSAStartup(MAKEWORD(2, 2), &wsa_data);
@@ -140,59 +264,33 @@ int main(int argc, char* argv[])
 
     osi3::GroundTruth gt;
 
+    UDPFrameAssembler assembler(MAX_MSG_SIZE);
+
     while (!quit)
     {
-        // Fetch and parse OSI message
-        buf.counter = 1;
-        int retval;
-        int receivedDataBytes = 0;
-        while (buf.counter > 0)
+        int retval = static_cast<int>(recvfrom(sock, buf, sizeof(buf), 0, reinterpret_cast<struct sockaddr*>(&sender_addr), &sender_addr_size));
+
+        if (retval <= 0)
         {
-            retval = static_cast<int>(
-                recvfrom(sock, reinterpret_cast<char*>(&buf), sizeof(buf), 0, reinterpret_cast<struct sockaddr*>(&sender_addr), &sender_addr_size));
-            if (retval > 0)
-            {
-                if (buf.counter == 1)
-                {
-                    // New message
-                    receivedDataBytes = 0;
-                }
-                memcpy(&large_buf[receivedDataBytes], buf.data, buf.datasize);
-                receivedDataBytes += static_cast<int>(buf.datasize);
-            }
+            // No incoming messages, wait for a little while before polling again
+            Sleep(10);
+            continue;
         }
 
-        if (retval > 0)
+        if (assembler.Add(buf, retval))
         {
-            gt.ParseFromArray(large_buf, receivedDataBytes);
-
-            // Print timestamp
-            printf("timestamp: %.2f\n",
-                   static_cast<double>(gt.mutable_timestamp()->seconds()) + 1E-9 * static_cast<double>(gt.mutable_timestamp()->nanos()));
+            // message complete
+            gt.ParseFromArray(assembler.GetFrame(), static_cast<int>(assembler.GetFrameSize()));
 
-            // Print object id, position, orientation and velocity
-            for (int i = 0; i < gt.mutable_moving_object()->size(); i++)
-            {
-                printf(" obj id %d pos (%.2f, %.2f, %.2f) orientation (%.2f, %.2f, %.2f) velocity (%.2f, %.2f, %.2f) assigned lane: %d\n",
-                       static_cast<int>(gt.moving_object(i).id().value()),
-                       gt.moving_object(i).base().position().x(),
-                       gt.moving_object(i).base().position().y(),
-                       gt.moving_object(i).base().position().z(),
-                       gt.moving_object(i).base().orientation().yaw(),
-                       gt.moving_object(i).base().orientation().pitch(),
-                       gt.moving_object(i).base().orientation().roll(),
-                       gt.moving_object(i).base().velocity().x(),
-                       gt.moving_object(i).base().velocity().y(),
-                       gt.moving_object(i).base().velocity().z(),
-                       gt.moving_object(i).assigned_lane_id_size() > 0 ? static_cast<int>(gt.moving_object(i).assigned_lane_id(0).value()) : -1);
-            }
-        }
-        else
-        {
-            // No incoming messages, wait for a little while before polling again
-            Sleep(10);
+            PrintGroundTruth(gt);
         }
     }
 
+    printf("Received %u complete frames, %u incomplete frames dropped, %u frames missed\n",
+           assembler.GetNumberOfFrames(),
+           assembler.GetNumberOfIncompleteFrames(),
+           assembler.GetNumberOfMissedFrames());
+    CloseGracefully(sock);
+
     return 0;
 }
@@ -432,6 +432,13 @@ namespace ESMini
         /// <returns> Number of identified objects, i.e.length of list. -1 on failure</returns>
         public static extern int SE_FetchSensorObjectList(int object_id, int[] list);
 
+        [DllImport(LIB_NAME, EntryPoint = "SE_SetObjectSensorOcclusion")]
+        /// <summary>Enable or disable occlusion check for an object sensor, i.e. skip objects hidden behind other objects</summary>
+        /// <param name="sensor_id">Handle (index) to the sensor</param>
+        /// <param name="enable">true to enable, false to disable (default)</param>
+        /// <returns>0 on success, -1 on failure for any reason</returns>
+        public static extern int SE_SetObjectSensorOcclusion(int sensor_id, bool enable);
+
         [DllImport(LIB_NAME, EntryPoint = "SE_GetRoadInfoAtDistance")]
         /// <summary>Get information suitable for driver modeling of a point at a specified distance from object along the road ahead</summary>
         /// <param name="object_id">Handle to the position object from which to measure</param>
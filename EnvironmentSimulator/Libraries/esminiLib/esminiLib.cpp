@@ -59,6 +59,9 @@ static std::vector<SE_ObjCallback> objCallback;
 // List of 3D models populated from any found found model_ids.txt file
 static std::map<int, std::string> entity_model_map_;
 
+// Buffer holding latest simulation state snapshot, see SE_SaveState()
+static SE_StateStream state_buffer;
+
 static void resetScenario(void)
 {
     if (player != nullptr)
@@ -84,6 +87,7 @@ static void resetScenario(void)
     StoryBoardElement::stateChangeCallback = nullptr;
 
     time_stamp = 0;
+    state_buffer.Clear();
 }
 
 static void AddArgument(const char *str, bool split = true)
@@ -980,6 +984,36 @@ extern "C"
         }
     }
 
+    SE_DLL_API const char *SE_SaveState(int *size)
+    {
+        if (player == nullptr)
+        {
+            return nullptr;
+        }
+
+        state_buffer.Clear();
+        player->scenarioEngine->SaveState(state_buffer);
+
+        if (size != nullptr)
+        {
+            *size = static_cast<int>(state_buffer.GetSize());
+        }
+
+        return state_buffer.GetData();
+    }
+
+    SE_DLL_API int SE_RestoreState(const char *state, int size)
+    {
+        if (player == nullptr || state == nullptr || size <= 0)
+        {
+            return -1;
+        }
+
+        SE_StateStream stream(state, static_cast<size_t>(size));
+
+        return player->scenarioEngine->RestoreState(stream);
+    }
+
     SE_DLL_API float SE_GetSimulationTime()
     {
         if (player == nullptr)
@@ -1088,7 +1122,7 @@ extern "C"
 
             if (object_type == scenarioengine::Object::Type::VEHICLE)
             {
-                vehicle               = new Vehicle();
+                vehicle               = player->scenarioEngine->entities_.NewVehicle();
                 object_id             = player->scenarioEngine->entities_.addObject(vehicle, true);
                 vehicle->name_        = name;
                 vehicle->scaleMode_   = static_cast<EntityScaleMode>(scale_mode);
@@ -1100,10 +1134,17 @@ extern "C"
 
                 Controller::InitArgs args = {"", "", 0, 0, 0, 0};
                 args.type                 = CONTROLLER_EXTERNAL_TYPE_NAME;
-                Controller *ctrl          = InstantiateControllerExternal(&args);
+                Controller *ctrl          = player->scenarioEngine->scenarioReader->ReuseController(&args);
+                if (ctrl == nullptr)
+                {
+                    ctrl = InstantiateControllerExternal(&args);
+                    if (ctrl != nullptr)
+                    {
+                        player->scenarioEngine->scenarioReader->AddController(ctrl);
+                    }
+                }
                 if (ctrl != nullptr)
                 {
-                    player->scenarioEngine->scenarioReader->AddController(ctrl);
                     vehicle->AssignController(ctrl);
                     ctrl->Activate({ControlActivationMode::ON, ControlActivationMode::ON, ControlActivationMode::OFF, ControlActivationMode::OFF});
                 }
@@ -1154,11 +1195,13 @@ extern "C"
 
         if (player != nullptr)
         {
-            for (auto &ctrl : obj->controllers_)
+            // controllers and object are kept for reuse by coming SE_AddObject calls
+            while (!obj->controllers_.empty())
             {
+                Controller *ctrl = obj->controllers_.back();
                 obj->UnassignController(ctrl);
                 ctrl->UnlinkObject();
-                player->scenarioEngine->scenarioReader->RemoveController(ctrl);
+                player->scenarioEngine->scenarioReader->ReleaseController(ctrl);
             }
             player->scenarioEngine->entities_.removeObject(object_id);
             player->scenarioGateway->removeObject(object_id);
@@ -1619,6 +1662,63 @@ extern "C"
         return 0;
     }
 
+    SE_DLL_API int SE_GetOSIGroundTruthBuffers(SE_OSIBuffer *static_gt, SE_OSIBuffer *dynamic_gt)
+    {
+#ifdef _USE_OSI
+        if (player != nullptr)
+        {
+            if (player->osiReporter->GetOSIFrequency() == 0)
+            {
+                player->osiReporter->SetOSIFrequency(1);
+            }
+            player->osiReporter->UpdateOSIGroundTruth(player->scenarioGateway->objectState_);
+
+            // the handle keeps a reference to the buffer until released
+            if (static_gt != nullptr)
+            {
+                OSIReporter::OSIBuffer *buffer = new OSIReporter::OSIBuffer();
+                *buffer                        = player->osiReporter->GetOSIStaticGroundTruthBuffer(static_gt->generation);
+                static_gt->data                = (*buffer)->data();
+                static_gt->size                = static_cast<int>((*buffer)->size());
+                static_gt->handle              = buffer;
+            }
+
+            if (dynamic_gt != nullptr)
+            {
+                OSIReporter::OSIBuffer *buffer = new OSIReporter::OSIBuffer();
+                *buffer                        = player->osiReporter->GetOSIDynamicGroundTruthBuffer(dynamic_gt->generation);
+                dynamic_gt->data               = (*buffer)->data();
+                dynamic_gt->size               = static_cast<int>((*buffer)->size());
+                dynamic_gt->handle             = buffer;
+            }
+
+            return 0;
+        }
+#else
+        (void)static_gt;
+        (void)dynamic_gt;
+#endif  // _USE_OSI
+
+        return -1;
+    }
+
+    SE_DLL_API void SE_ReleaseOSIBuffer(SE_OSIBuffer *buffer)
+    {
+        if (buffer == nullptr)
+        {
+            return;
+        }
+
+#ifdef _USE_OSI
+        delete reinterpret_cast<OSIReporter::OSIBuffer *>(buffer->handle);
+#endif  // _USE_OSI
+
+        buffer->data       = nullptr;
+        buffer->size       = 0;
+        buffer->generation = 0;
+        buffer->handle     = nullptr;
+    }
+
     SE_DLL_API const char *SE_GetOSITrafficCommandRaw()
     {
 #ifdef _USE_OSI
@@ -1747,6 +1847,28 @@ extern "C"
         return 0;
     }
 
+    SE_DLL_API int SE_SetOSIOutputRate(double rate)
+    {
+#ifdef _USE_OSI
+        if (player != nullptr)
+        {
+            if (player->osiReporter->GetOSIFrequency() == 0)
+            {
+                player->osiReporter->SetOSIFrequency(1);
+            }
+            return player->osiReporter->SetOSIOutputRate(rate);
+        }
+        else
+        {
+            SE_Env::Inst().GetOptions().SetOptionValue("osi_output_rate", std::to_string(rate));
+        }
+        return 0;
+#else
+        (void)rate;
+        return -1;
+#endif  // _USE_OSI
+    }
+
     SE_DLL_API void SE_CropOSIDynamicGroundTruth(int id, double radius)
     {
 #ifdef _USE_OSI
@@ -1764,6 +1886,23 @@ extern "C"
 #endif  // _USE_OSI
     }
 
+    SE_DLL_API void SE_CropOSIStaticGroundTruth(int id, double radius)
+    {
+#ifdef _USE_OSI
+        if (player != nullptr)
+        {
+            player->osiReporter->CropOSIStaticGroundTruth(id, radius);
+        }
+        else
+        {
+            SE_Env::Inst().GetOptions().SetOptionValue("osi_crop_static", std::to_string(id) + "," + std::to_string(radius), true);
+        }
+#else
+        (void)id;
+        (void)radius;
+#endif  // _USE_OSI
+    }
+
     SE_DLL_API int SE_UpdateOSITrafficCommand()
     {
 #ifdef _USE_OSI
@@ -1788,6 +1927,45 @@ extern "C"
         return 0;
     }
 
+    SE_DLL_API const char *SE_GetOSISensorView(int sensor_id, int *size)
+    {
+#ifdef _USE_OSI
+        if (player != nullptr)
+        {
+            if (player->osiReporter->GetOSIFrequency() == 0)
+            {
+                player->osiReporter->SetOSIFrequency(1);
+            }
+            player->osiReporter->UpdateOSIGroundTruth(player->scenarioGateway->objectState_);
+            return player->osiReporter->GetOSISensorView(sensor_id, size);
+        }
+
+        *size = 0;
+#else
+        (void)sensor_id;
+        (void)size;
+#endif  // _USE_OSI
+        return 0;
+    }
+
+    SE_DLL_API const char *SE_GetOSISensorViewRaw(int sensor_id)
+    {
+#ifdef _USE_OSI
+        if (player != nullptr)
+        {
+            if (player->osiReporter->GetOSIFrequency() == 0)
+            {
+                player->osiReporter->SetOSIFrequency(1);
+            }
+            player->osiReporter->UpdateOSIGroundTruth(player->scenarioGateway->objectState_);
+            return player->osiReporter->GetOSISensorViewRaw(sensor_id);
+        }
+#else
+        (void)sensor_id;
+#endif  // _USE_OSI
+        return 0;
+    }
+
     SE_DLL_API int SE_OSISetTimeStamp(unsigned long long nanoseconds)
     {
 #ifdef _USE_OSI
@@ -2203,6 +2381,24 @@ extern "C"
         return -1;
     }
 
+    SE_DLL_API int SE_SetObjectSensorOcclusion(int sensor_id, bool enable)
+    {
+        if (player != nullptr)
+        {
+            if (sensor_id < 0 || sensor_id >= static_cast<int>(player->sensor.size()))
+            {
+                LOG_ERROR("Invalid sensor_id ({} specified / {} available)", sensor_id, player->sensor.size());
+                return -1;
+            }
+
+            player->sensor[static_cast<unsigned int>(sensor_id)]->occlusion_ = enable;
+
+            return 0;
+        }
+
+        return -1;
+    }
+
     SE_DLL_API int SE_GetRoadInfoAtDistance(int          object_id,
                                             float        lookahead_distance,
                                             SE_RoadInfo *data,
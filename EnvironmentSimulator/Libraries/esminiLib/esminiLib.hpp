@@ -127,6 +127,14 @@ typedef struct
     id_t far_right_lb_id;
 } SE_LaneBoundaryId;
 
+typedef struct
+{
+    const char        *data;        // serialized message, read-only
+    int                size;        // size of data in bytes
+    unsigned long long generation;  // increased whenever the content changes
+    void              *handle;      // reference held until released by SE_ReleaseOSIBuffer
+} SE_OSIBuffer;
+
 typedef struct
 {
     float ds;             // delta s (longitudinal distance)
@@ -595,6 +603,23 @@ extern "C"
     */
     SE_DLL_API int SE_Step();
 
+    /**
+            Save complete simulation state, e.g. to rewind or branch the simulation from this point in time later on.
+            Includes entities, controllers, storyboard states, condition histories, parameters, variables and random generator state.
+            The data is valid for the same scenario only and for hosts of same architecture (native byte order)
+            @param size Returns size of the state data in bytes
+            @return Pointer to state data, valid until next call or SE_Close(). Copy data to keep several snapshots. NULL on error
+    */
+    SE_DLL_API const char *SE_SaveState(int *size);
+
+    /**
+            Restore simulation state previously saved by SE_SaveState() for the same scenario
+            @param state Pointer to state data
+            @param size Size of state data in bytes
+            @return 0 if successful, -1 if not
+    */
+    SE_DLL_API int SE_RestoreState(const char *state, int size);
+
     /**
             Stop simulation gracefully. Two purposes: 1. Release memory and 2. Prepare for next simulation, e.g. reset object lists.
     */
@@ -1371,6 +1396,15 @@ extern "C"
     */
     SE_DLL_API int SE_FetchSensorObjectList(int sensor_id, int *list);
 
+    /**
+            Enable or disable occlusion check for an object sensor. When enabled, objects hidden behind other
+            objects (approximated by their bounding boxes projected on the ground) are not identified.
+            @param sensor_id Handle (index) to the sensor
+            @param enable true to enable, false to disable (default)
+            @return 0 if successful, -1 if not
+    */
+    SE_DLL_API int SE_SetObjectSensorOcclusion(int sensor_id, bool enable);
+
     /**
             Register a function and optional parameter (ref) to be called back from esmini after each frame (update of scenario)
             The current state of specified entity will be returned.
@@ -1495,6 +1529,13 @@ extern "C"
      */
     SE_DLL_API void SE_CropOSIDynamicGroundTruth(int id, double radius);
 
+    /**
+     *      The SE_CropOSIStaticGroundTruth will limit the lanes and lane boundaries of the static groundtruth data to a circle with the specified
+     * radius around the given object id. Using the method repeatedly with different object ids will crop around all objects specified. Setting the
+     * radius to 0 will remove the cropping. Whenever lanes enter or leave the circles, the static groundtruth is reported again.
+     */
+    SE_DLL_API void SE_CropOSIStaticGroundTruth(int id, double radius);
+
     /**
      *      Setting the OSI report mode of the static ground truth data. Default is applied if function not used.
      *      @param mode DEFAULT=Static data in API and log first frame only, API=Static data always in API but only logged first frame and
@@ -1516,6 +1557,14 @@ extern "C"
      */
     SE_DLL_API int SE_SetOSIFrequency(int frequency);
 
+    /**
+     *      The SE_SetOSIOutputRate function makes OSI file and UDP output run at given rate, independent of the simulation step size.
+     *      Moving objects are interpolated between frames by position and velocity, and output in a separate thread.
+     *      @param rate Output rate (Hz), 0 to output each OSI update
+            @return 0 if successful, -1 if not
+     */
+    SE_DLL_API int SE_SetOSIOutputRate(double rate);
+
     /**
             @return 0
     */
@@ -1535,6 +1584,25 @@ extern "C"
     */
     SE_DLL_API const char *SE_GetOSIGroundTruthRaw();
 
+    /**
+            The SE_GetOSIGroundTruthBuffers function updates the OSI ground truth and gives read-only access to its serialized static and
+            dynamic parts without copying. The static part is only serialized again when changed, e.g. due to cropping, so by comparing its
+            generation with a previously fetched one re-fetching of unchanged static data can be skipped. Concatenating the static and dynamic
+            data gives the complete osi3::GroundTruth message. Each buffer is reference counted and stays intact, also when accessed from other
+            threads, until released by SE_ReleaseOSIBuffer, while the simulation keeps stepping.
+            @param static_gt Set to the static part, 0 to skip
+            @param dynamic_gt Set to the dynamic part, 0 to skip
+            @return 0 if successful, -1 if not
+    */
+    SE_DLL_API int SE_GetOSIGroundTruthBuffers(SE_OSIBuffer *static_gt, SE_OSIBuffer *dynamic_gt);
+
+    /**
+            Release a buffer retrieved by SE_GetOSIGroundTruthBuffers. The buffer data must not be accessed after this call.
+            Safe to call from any thread, also after SE_Close.
+            @param buffer Buffer to release, cleared by the call
+    */
+    SE_DLL_API void SE_ReleaseOSIBuffer(SE_OSIBuffer *buffer);
+
     /**
             Get a pointer to the internal OSI data structure, useful for direct access to OSI data in a C/C++ environment
             @return osi3::TrafficCommand*
@@ -1577,6 +1645,24 @@ extern "C"
     */
     SE_DLL_API const char *SE_GetOSISensorDataRaw();
 
+    /**
+            The SE_GetOSISensorView function updates the OSI ground truth and returns a char array containing the osi SensorView of
+            given object sensor serialized to a string. The view holds the host and the objects detected by the sensor, plus the lanes
+            and lane boundaries within its horizontal field of view.
+            @param sensor_id Id of the sensor, as returned by SE_AddObjectSensor
+            @param size Set to the size of the serialized message, 0 if sensor not found
+            @return osi3::SensorView serialized to a string, 0 if sensor not found
+    */
+    SE_DLL_API const char *SE_GetOSISensorView(int sensor_id, int *size);
+
+    /**
+            The SE_GetOSISensorViewRaw function updates the OSI ground truth and returns a pointer to the internal OSI SensorView of
+            given object sensor, see SE_GetOSISensorView
+            @param sensor_id Id of the sensor, as returned by SE_AddObjectSensor
+            @return osi3::SensorView*, 0 if sensor not found
+    */
+    SE_DLL_API const char *SE_GetOSISensorViewRaw(int sensor_id);
+
     /**
             Set explicit OSI timestap
             Note that this timestamp does NOT affect esmini simulation time
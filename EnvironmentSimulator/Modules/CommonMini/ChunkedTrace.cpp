@@ -0,0 +1,751 @@
+/*
+ * esmini - Environment Simulator Minimalistic
+ * https://github.com/esmini/esmini
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) partners of Simulation Scenarios
+ * https://sites.google.com/view/simulationscenarios
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+#include "ChunkedTrace.hpp"
+#include "logger.hpp"
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+#include <thread>
+#endif
+
+#define TRACE_VERSION 1
+
+static const char TRACE_FILE_MAGIC[8]  = {'E', 'S', 'M', 'T', 'R', 'A', 'C', 'E'};
+static const char TRACE_INDEX_MAGIC[8] = {'E', 'S', 'M', 'I', 'N', 'D', 'E', 'X'};
+static const char TRACE_CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+
+struct TraceFileHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct TraceChunkHeader
+{
+    char     magic[4];
+    uint32_t n_frames;     // 0 for static data
+    uint32_t raw_size;     // size of decoded chunk data
+    uint32_t stored_size;  // size of data following the header, equal to raw_size if not compressed
+};
+
+struct TraceIndexEntry
+{
+    uint64_t offset;
+    uint64_t first_timestamp;
+    uint64_t last_timestamp;
+    uint32_t first_frame;
+    uint32_t n_frames;
+};
+
+struct TraceTrailer
+{
+    uint64_t index_offset;
+    uint64_t static_offset;  // 0 if none
+    uint32_t n_chunks;
+    uint32_t n_frames;
+    char     magic[8];
+};
+
+#define TRACE_FRAME_HEADER_SIZE (sizeof(uint64_t) + sizeof(uint32_t))  // packed, no padding in the file
+
+static_assert(sizeof(TraceFileHeader) == 16 && sizeof(TraceChunkHeader) == 16 && sizeof(TraceIndexEntry) == 32 && sizeof(TraceTrailer) == 32,
+              "Unexpected padding of trace file structures");
+
+// LZ4 block format constants
+#define LZ4_MIN_MATCH     4
+#define LZ4_LAST_LITERALS 5   // last bytes of a block are always literals
+#define LZ4_MF_LIMIT      12  // last match must start at least this many bytes before end of block
+#define LZ4_MAX_OFFSET    65535
+#define LZ4_HASH_LOG      14
+
+static inline uint32_t Read32(const char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void LZ4WriteLength(std::string& dst, size_t length)
+{
+    // lengths of 15 and above continue in following bytes, 255 meaning more to come
+    for (length -= 15; length >= 255; length -= 255)
+    {
+        dst.push_back(static_cast<char>(255));
+    }
+    dst.push_back(static_cast<char>(length));
+}
+
+static void LZ4WriteSequence(std::string& dst, const char* literals, size_t n_literals, size_t offset, size_t match_length)
+{
+    size_t extra_match = match_length >= LZ4_MIN_MATCH ? match_length - LZ4_MIN_MATCH : 0;
+    dst.push_back(static_cast<char>((MIN(n_literals, 15) << 4) | (match_length > 0 ? MIN(extra_match, 15) : 0)));
+
+    if (n_literals >= 15)
+    {
+        LZ4WriteLength(dst, n_literals);
+    }
+    dst.append(literals, n_literals);
+
+    if (match_length > 0)
+    {
+        dst.push_back(static_cast<char>(offset & 0xff));
+        dst.push_back(static_cast<char>(offset >> 8));
+        if (extra_match >= 15)
+        {
+            LZ4WriteLength(dst, extra_match);
+        }
+    }
+}
+
+size_t LZ4CompressBlock(const char* src, size_t size, std::string& dst)
+{
+    dst.clear();
+    dst.reserve(size + size / 255 + 16);
+
+    size_t anchor = 0;
+
+    if (size >= LZ4_MF_LIMIT)
+    {
+        // greedy matching, hash table of latest position of each 4 byte sequence
+        std::vector<uint32_t> table(1 << LZ4_HASH_LOG, UINT32_MAX);
+        size_t                pos   = 0;
+        size_t                limit = size - LZ4_MF_LIMIT;
+
+        while (pos <= limit)
+        {
+            uint32_t seq  = Read32(&src[pos]);
+            uint32_t hash = (seq * 2654435761U) >> (32 - LZ4_HASH_LOG);
+            uint32_t ref  = table[hash];
+            table[hash]   = static_cast<uint32_t>(pos);
+
+            if (ref != UINT32_MAX && pos - ref <= LZ4_MAX_OFFSET && Read32(&src[ref]) == seq)
+            {
+                size_t length     = LZ4_MIN_MATCH;
+                size_t max_length = size - LZ4_LAST_LITERALS - pos;
+                while (length < max_length && src[ref + length] == src[pos + length])
+                {
+                    length++;
+                }
+
+                LZ4WriteSequence(dst, &src[anchor], pos - anchor, pos - ref, length);
+                pos += length;
+                anchor = pos;
+            }
+            else
+            {
+                pos++;
+            }
+        }
+    }
+
+    // remaining bytes as literals
+    LZ4WriteSequence(dst, &src[anchor], size - anchor, 0, 0);
+
+    return dst.size();
+}
+
+long long LZ4DecompressBlock(const char* src, size_t size, char* dst, size_t dst_size)
+{
+    const unsigned char* in  = reinterpret_cast<const unsigned char*>(src);
+    size_t               ip  = 0;
+    size_t               op  = 0;
+    unsigned char        tmp = 0;
+
+    while (ip < size)
+    {
+        unsigned char token      = in[ip++];
+        size_t        n_literals = token >> 4;
+
+        if (n_literals == 15)
+        {
+            do
+            {
+                if (ip >= size)
+                {
+                    return -1;
+                }
+                tmp = in[ip++];
+                n_literals += tmp;
+            } while (tmp == 255);
+        }
+
+        if (n_literals > size - ip || n_literals > dst_size - op)
+        {
+            return -1;
+        }
+        memcpy(&dst[op], &in[ip], n_literals);
+        ip += n_literals;
+        op += n_literals;
+
+        if (ip >= size)
+        {
+            break;  // last sequence has no match
+        }
+
+        if (size - ip < 2)
+        {
+            return -1;
+        }
+        size_t offset = in[ip] | (static_cast<size_t>(in[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op)
+        {
+            return -1;
+        }
+
+        size_t length = token & 0x0f;
+        if (length == 15)
+        {
+            do
+            {
+                if (ip >= size)
+                {
+                    return -1;
+                }
+                tmp = in[ip++];
+                length += tmp;
+            } while (tmp == 255);
+        }
+        length += LZ4_MIN_MATCH;
+
+        if (length > dst_size - op)
+        {
+            return -1;
+        }
+
+        // byte by byte, since source and destination may overlap
+        for (size_t i = 0; i < length; i++, op++)
+        {
+            dst[op] = dst[op - offset];
+        }
+    }
+
+    return static_cast<long long>(op);
+}
+
+ChunkedTraceWriter::ChunkedTraceWriter()
+    : chunk_frames_(CHUNKED_TRACE_DEFAULT_CHUNK_FRAMES),
+      chunk_n_frames_(0),
+      chunk_first_timestamp_(0),
+      chunk_last_timestamp_(0),
+      offset_(0),
+      static_offset_(0),
+      raw_size_(0),
+      n_frames_(0),
+      failed_(false)
+{
+}
+
+ChunkedTraceWriter::~ChunkedTraceWriter()
+{
+    Close();
+}
+
+int ChunkedTraceWriter::Open(const std::string& filename, unsigned int chunk_frames, size_t buffer_size)
+{
+    Close();
+
+    if (file_.Open(filename, std::ios_base::binary, buffer_size) != 0)
+    {
+        return -1;
+    }
+
+    chunk_frames_   = MAX(1, chunk_frames);
+    chunk_n_frames_ = 0;
+    offset_         = 0;
+    static_offset_  = 0;
+    raw_size_       = 0;
+    n_frames_       = 0;
+    failed_         = false;
+    chunk_.clear();
+    index_.clear();
+
+    TraceFileHeader header;
+    memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+    header.version  = TRACE_VERSION;
+    header.reserved = 0;
+
+    return WriteData(&header, sizeof(header));
+}
+
+int ChunkedTraceWriter::WriteData(const void* data, size_t size)
+{
+    // never drop data, it would break the offsets of the index
+    if (failed_ || !file_.Write(data, size) || !file_.Good())
+    {
+        failed_ = true;
+        return -1;
+    }
+    offset_ += size;
+
+    return 0;
+}
+
+int ChunkedTraceWriter::WriteChunk(const std::string& raw, unsigned int n_frames)
+{
+    // store uncompressed if compression does not pay off
+    bool             compress = LZ4CompressBlock(raw.data(), raw.size(), compressed_) < raw.size();
+    TraceChunkHeader header;
+
+    memcpy(header.magic, TRACE_CHUNK_MAGIC, sizeof(header.magic));
+    header.n_frames    = n_frames;
+    header.raw_size    = static_cast<uint32_t>(raw.size());
+    header.stored_size = static_cast<uint32_t>(compress ? compressed_.size() : raw.size());
+    raw_size_ += raw.size();
+
+    // header and data in one write, so that the chunk is never split by a full buffer
+    compressed_.insert(0, reinterpret_cast<char*>(&header), sizeof(header));
+    if (!compress)
+    {
+        compressed_.replace(sizeof(header), std::string::npos, raw);
+    }
+
+    return WriteData(compressed_.data(), compressed_.size());
+}
+
+int ChunkedTraceWriter::SetStatic(const char* data, size_t size)
+{
+    if (!IsOpen() || static_offset_ > 0)
+    {
+        return -1;
+    }
+
+    static_offset_ = offset_;
+
+    return WriteChunk(std::string(data, size), 0);
+}
+
+int ChunkedTraceWriter::AddFrame(unsigned long long timestamp, const char* data, size_t size)
+{
+    if (!IsOpen())
+    {
+        return -1;
+    }
+
+    if (chunk_n_frames_ == 0)
+    {
+        chunk_first_timestamp_ = timestamp;
+    }
+    chunk_last_timestamp_ = timestamp;
+
+    uint64_t ts         = timestamp;
+    uint32_t frame_size = static_cast<uint32_t>(size);
+    char     header[TRACE_FRAME_HEADER_SIZE];
+    memcpy(header, &ts, sizeof(ts));
+    memcpy(header + sizeof(ts), &frame_size, sizeof(frame_size));
+    chunk_.append(header, sizeof(header));
+    chunk_.append(data, size);
+    chunk_n_frames_++;
+    n_frames_++;
+
+    if (chunk_n_frames_ >= chunk_frames_)
+    {
+        Flush();
+    }
+
+    return failed_ ? -1 : 0;
+}
+
+void ChunkedTraceWriter::Flush()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    if (chunk_n_frames_ > 0)
+    {
+        index_.push_back({offset_, chunk_first_timestamp_, chunk_last_timestamp_, n_frames_ - chunk_n_frames_, chunk_n_frames_});
+        WriteChunk(chunk_, chunk_n_frames_);
+        chunk_.clear();
+        chunk_n_frames_ = 0;
+    }
+
+    file_.Flush();
+}
+
+void ChunkedTraceWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    Flush();
+
+    // index followed by trailer, which is found at fixed distance from end of file
+    std::vector<TraceIndexEntry> entries(index_.size());
+    for (size_t i = 0; i < index_.size(); i++)
+    {
+        entries[i] = {index_[i].offset, index_[i].first_timestamp, index_[i].last_timestamp, index_[i].first_frame, index_[i].n_frames};
+    }
+
+    TraceTrailer trailer;
+    trailer.index_offset  = offset_;
+    trailer.static_offset = static_offset_;
+    trailer.n_chunks      = static_cast<uint32_t>(index_.size());
+    trailer.n_frames      = n_frames_;
+    memcpy(trailer.magic, TRACE_INDEX_MAGIC, sizeof(trailer.magic));
+
+    if (!entries.empty())
+    {
+        WriteData(entries.data(), entries.size() * sizeof(TraceIndexEntry));
+    }
+    WriteData(&trailer, sizeof(trailer));
+
+    if (failed_)
+    {
+        LOG_ERROR("Failed writing trace file, index may be missing");
+    }
+
+    file_.Close();
+}
+
+int ChunkedTraceReader::Open(const std::string& filename)
+{
+    Close();
+
+    file_.open(filename, std::ios_base::binary);
+    if (!file_.is_open())
+    {
+        return -1;
+    }
+
+    file_.seekg(0, std::ios_base::end);
+    file_size_ = static_cast<unsigned long long>(file_.tellg());
+
+    TraceFileHeader header;
+    if (ReadAt(0, &header, sizeof(header)) != 0 || memcmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic)) != 0)
+    {
+        LOG_ERROR("{} is not a chunked trace file", filename);
+        Close();
+        return -1;
+    }
+
+    if (header.version != TRACE_VERSION)
+    {
+        LOG_ERROR("Unsupported trace file version {} (expected {})", header.version, TRACE_VERSION);
+        Close();
+        return -1;
+    }
+
+    TraceTrailer trailer;
+    if (file_size_ >= sizeof(header) + sizeof(trailer) && ReadAt(file_size_ - sizeof(trailer), &trailer, sizeof(trailer)) == 0 &&
+        memcmp(trailer.magic, TRACE_INDEX_MAGIC, sizeof(trailer.magic)) == 0 &&
+        trailer.index_offset + trailer.n_chunks * sizeof(TraceIndexEntry) + sizeof(trailer) == file_size_)
+    {
+        std::vector<TraceIndexEntry> entries(trailer.n_chunks);
+        if (trailer.n_chunks > 0 && ReadAt(trailer.index_offset, entries.data(), entries.size() * sizeof(TraceIndexEntry)) != 0)
+        {
+            Close();
+            return -1;
+        }
+
+        index_.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            index_[i] = {entries[i].offset, entries[i].first_timestamp, entries[i].last_timestamp, entries[i].first_frame, entries[i].n_frames};
+        }
+        static_offset_ = trailer.static_offset;
+        n_frames_      = trailer.n_frames;
+    }
+    else
+    {
+        LOG_WARN("Trace file {} has no index, scanning it", filename);
+        if (ScanChunks() != 0)
+        {
+            Close();
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void ChunkedTraceReader::Close()
+{
+    if (file_.is_open())
+    {
+        file_.close();
+    }
+    file_.clear();
+    index_.clear();
+    file_size_     = 0;
+    static_offset_ = 0;
+    n_frames_      = 0;
+}
+
+int ChunkedTraceReader::ReadAt(unsigned long long offset, void* data, size_t size)
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+
+    if (offset + size > file_size_)
+    {
+        return -1;
+    }
+
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(offset));
+    file_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+
+    return file_.good() ? 0 : -1;
+}
+
+int ChunkedTraceReader::ReadChunkData(unsigned long long offset, std::string& raw, unsigned int& n_frames)
+{
+    TraceChunkHeader header;
+    if (ReadAt(offset, &header, sizeof(header)) != 0 || memcmp(header.magic, TRACE_CHUNK_MAGIC, sizeof(header.magic)) != 0)
+    {
+        return -1;
+    }
+    n_frames = header.n_frames;
+
+    std::string stored(header.stored_size, '\0');
+    if (header.stored_size > 0 && ReadAt(offset + sizeof(header), &stored[0], stored.size()) != 0)
+    {
+        return -1;
+    }
+
+    if (header.stored_size == header.raw_size)
+    {
+        raw.swap(stored);
+        return 0;
+    }
+
+    // decompress outside the file lock, letting other threads read meanwhile
+    raw.resize(header.raw_size);
+    if (LZ4DecompressBlock(stored.data(), stored.size(), &raw[0], raw.size()) != static_cast<long long>(header.raw_size))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int ChunkedTraceReader::ScanChunks()
+{
+    unsigned long long offset = sizeof(TraceFileHeader);
+    TraceChunkHeader   header;
+
+    while (offset + sizeof(header) <= file_size_ && ReadAt(offset, &header, sizeof(header)) == 0 &&
+           memcmp(header.magic, TRACE_CHUNK_MAGIC, sizeof(header.magic)) == 0 && offset + sizeof(header) + header.stored_size <= file_size_)
+    {
+        if (header.n_frames == 0)
+        {
+            static_offset_ = offset;
+        }
+        else
+        {
+            // timestamps of the chunk are found in its frames
+            std::string  raw;
+            unsigned int n_frames = 0;
+            if (ReadChunkData(offset, raw, n_frames) != 0 || raw.size() < TRACE_FRAME_HEADER_SIZE)
+            {
+                break;
+            }
+
+            ChunkInfo info = {offset, 0, 0, n_frames_, n_frames};
+            size_t    pos  = 0;
+            for (unsigned int i = 0; i < n_frames && pos + TRACE_FRAME_HEADER_SIZE <= raw.size(); i++)
+            {
+                uint64_t timestamp;
+                uint32_t size;
+                memcpy(&timestamp, &raw[pos], sizeof(timestamp));
+                memcpy(&size, &raw[pos + sizeof(timestamp)], sizeof(size));
+                info.first_timestamp = i == 0 ? timestamp : info.first_timestamp;
+                info.last_timestamp  = timestamp;
+                pos += TRACE_FRAME_HEADER_SIZE + size;
+            }
+            index_.push_back(info);
+            n_frames_ += n_frames;
+        }
+        offset += sizeof(header) + header.stored_size;
+    }
+
+    return 0;
+}
+
+int ChunkedTraceReader::ReadStatic(std::string& data)
+{
+    unsigned int n_frames = 0;
+
+    if (!HasStatic() || ReadChunkData(static_offset_, data, n_frames) != 0 || n_frames != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int ChunkedTraceReader::FindChunkByFrame(unsigned int frame) const
+{
+    if (frame >= n_frames_)
+    {
+        return -1;
+    }
+
+    // last chunk starting at or before the frame
+    auto it = std::upper_bound(index_.begin(), index_.end(), frame, [](unsigned int f, const ChunkInfo& c) { return f < c.first_frame; });
+
+    return static_cast<int>(it - index_.begin()) - 1;
+}
+
+int ChunkedTraceReader::FindChunkByTime(unsigned long long timestamp) const
+{
+    if (index_.empty())
+    {
+        return -1;
+    }
+
+    // last chunk starting at or before the time
+    auto it = std::upper_bound(index_.begin(),
+                               index_.end(),
+                               timestamp,
+                               [](unsigned long long t, const ChunkInfo& c) { return t < c.first_timestamp; });
+
+    return MAX(0, static_cast<int>(it - index_.begin()) - 1);
+}
+
+int ChunkedTraceReader::ReadChunk(unsigned int chunk, std::vector<Frame>& frames)
+{
+    frames.clear();
+
+    if (chunk >= index_.size())
+    {
+        return -1;
+    }
+
+    std::string  raw;
+    unsigned int n_frames = 0;
+    if (ReadChunkData(index_[chunk].offset, raw, n_frames) != 0 || n_frames != index_[chunk].n_frames)
+    {
+        return -1;
+    }
+
+    frames.resize(n_frames);
+    size_t pos = 0;
+    for (unsigned int i = 0; i < n_frames; i++)
+    {
+        uint64_t timestamp;
+        uint32_t size;
+        if (pos + TRACE_FRAME_HEADER_SIZE > raw.size())
+        {
+            return -1;
+        }
+        memcpy(&timestamp, &raw[pos], sizeof(timestamp));
+        memcpy(&size, &raw[pos + sizeof(timestamp)], sizeof(size));
+        pos += TRACE_FRAME_HEADER_SIZE;
+        if (pos + size > raw.size())
+        {
+            return -1;
+        }
+        frames[i].timestamp = timestamp;
+        frames[i].data.assign(&raw[pos], size);
+        pos += size;
+    }
+
+    return 0;
+}
+
+int ChunkedTraceReader::ReadChunks(unsigned int first, unsigned int n, std::vector<std::vector<Frame>>& chunks, unsigned int n_threads)
+{
+    n = first < index_.size() ? MIN(n, static_cast<unsigned int>(index_.size()) - first) : 0;
+    chunks.resize(n);
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (n_threads == 0)
+    {
+        n_threads = MAX(1, std::thread::hardware_concurrency());
+    }
+    n_threads = MIN(n_threads, n);
+
+    // each thread picks next chunk not yet taken
+    std::atomic<unsigned int> next(0);
+    std::atomic<int>          result(0);
+    auto                      worker = [&]()
+    {
+        for (unsigned int i = next++; i < n; i = next++)
+        {
+            if (ReadChunk(first + i, chunks[i]) != 0)
+            {
+                result = -1;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < n_threads; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    return result;
+#else
+    (void)n_threads;
+    int result = 0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        if (ReadChunk(first + i, chunks[i]) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    return result;
+#endif
+}
+
+int ChunkedTraceReader::ReadFrame(unsigned int frame, Frame& result)
+{
+    std::vector<Frame> frames;
+    int                chunk = FindChunkByFrame(frame);
+
+    if (chunk < 0 || ReadChunk(static_cast<unsigned int>(chunk), frames) != 0)
+    {
+        return -1;
+    }
+
+    result = std::move(frames[frame - index_[static_cast<unsigned int>(chunk)].first_frame]);
+
+    return 0;
+}
+
+int ChunkedTraceReader::ReadFrameAtTime(unsigned long long timestamp, Frame& result)
+{
+    std::vector<Frame> frames;
+    int                chunk = FindChunkByTime(timestamp);
+
+    if (chunk < 0 || ReadChunk(static_cast<unsigned int>(chunk), frames) != 0 || frames.empty())
+    {
+        return -1;
+    }
+
+    // last frame at or before the time within the chunk
+    auto   it = std::upper_bound(frames.begin(), frames.end(), timestamp, [](unsigned long long t, const Frame& f) { return t < f.timestamp; });
+    size_t i  = it == frames.begin() ? 0 : static_cast<size_t>(it - frames.begin()) - 1;
+
+    result = std::move(frames[i]);
+
+    return static_cast<int>(index_[static_cast<unsigned int>(chunk)].first_frame + i);
+}
@@ -0,0 +1,262 @@
+/*
+ * esmini - Environment Simulator Minimalistic
+ * https://github.com/esmini/esmini
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) partners of Simulation Scenarios
+ * https://sites.google.com/view/simulationscenarios
+ */
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CommonMini.hpp"
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+#include <mutex>
+#endif
+
+#define CHUNKED_TRACE_DEFAULT_CHUNK_FRAMES 100
+
+/*
+ * Chunked trace file layout, all numbers little endian:
+ *   file header
+ *   chunks, each one a chunk header followed by the (compressed) chunk data. Frame data of a chunk is a sequence of
+ *     [uint64 timestamp][uint32 size][message]. A chunk without frames holds the static data, stored only once.
+ *   index, one entry per frame chunk
+ *   trailer, pointing out the index and the static data
+ * A file lacking index, e.g. after a crash, can still be read by scanning the chunks.
+ */
+
+/**
+Compress data using the LZ4 block format (plain implementation, no dictionary, no frame format)
+@param src Data to compress
+@param size Size of data
+@param dst Compressed data
+@return Size of compressed data
+*/
+size_t LZ4CompressBlock(const char* src, size_t size, std::string& dst);
+
+/**
+Decompress LZ4 block
+@param src Compressed data
+@param size Size of compressed data
+@param dst Destination buffer
+@param dst_size Size of destination buffer, i.e. max size of decompressed data
+@return Size of decompressed data, -1 if data is corrupt or does not fit the buffer
+*/
+long long LZ4DecompressBlock(const char* src, size_t size, char* dst, size_t dst_size);
+
+/**
+Writes messages, e.g. serialized OSI ground truth, into a chunked trace file. Frames are collected and compressed
+in chunks of given number of frames. An index of chunk timestamps and file offsets is appended when the file
+is closed, enabling quick random access and parallel decoding with ChunkedTraceReader.
+*/
+class ChunkedTraceWriter
+{
+public:
+    ChunkedTraceWriter();
+    ~ChunkedTraceWriter();
+
+    /**
+    Create trace file
+    @param filename Path of the file
+    @param chunk_frames Number of frames per chunk
+    @param buffer_size Size, in bytes, of the buffer handing over chunks to the writer thread. 0 writes synchronously.
+    @return 0 if successful, -1 if not
+    */
+    int Open(const std::string& filename, unsigned int chunk_frames = CHUNKED_TRACE_DEFAULT_CHUNK_FRAMES, size_t buffer_size = 0);
+
+    /**
+    Write pending chunk, the index and close the file
+    */
+    void Close();
+
+    bool IsOpen() const
+    {
+        return file_.IsOpen();
+    }
+
+    /**
+    Store static data, e.g. static OSI ground truth. Only the first call has effect.
+    @return 0 if successful, -1 if not
+    */
+    int SetStatic(const char* data, size_t size);
+
+    /**
+    Add a frame
+    @param timestamp Time of the frame, e.g. in nanoseconds. Assumed not to decrease between frames.
+    @param data Message
+    @param size Size of message
+    @return 0 if successful, -1 if not
+    */
+    int AddFrame(unsigned long long timestamp, const char* data, size_t size);
+
+    /**
+    Write any pending frames, as a chunk of its own, and wait for all data to reach the file
+    */
+    void Flush();
+
+    unsigned int GetNumberOfFrames() const
+    {
+        return n_frames_;
+    }
+    unsigned int GetNumberOfChunks() const
+    {
+        return static_cast<unsigned int>(index_.size());
+    }
+    unsigned long long GetRawSize() const
+    {
+        return raw_size_;
+    }
+    unsigned long long GetStoredSize() const
+    {
+        return offset_;
+    }
+
+    struct IndexEntry
+    {
+        unsigned long long offset;           // file position of the chunk header
+        unsigned long long first_timestamp;  // of first frame in the chunk
+        unsigned long long last_timestamp;   // of last frame in the chunk
+        unsigned int       first_frame;      // number of first frame in the chunk, counting all frames of the file
+        unsigned int       n_frames;         // number of frames in the chunk
+    };
+
+private:
+    int WriteChunk(const std::string& raw, unsigned int n_frames);
+    int WriteData(const void* data, size_t size);
+
+    SE_AsyncFileWriter      file_;
+    unsigned int            chunk_frames_;
+    std::string             chunk_;       // frames of current chunk
+    std::string             compressed_;  // buffer for compressed chunk
+    unsigned int            chunk_n_frames_;
+    unsigned long long      chunk_first_timestamp_;
+    unsigned long long      chunk_last_timestamp_;
+    std::vector<IndexEntry> index_;
+    unsigned long long      offset_;  // current file size
+    unsigned long long      static_offset_;
+    unsigned long long      raw_size_;
+    unsigned int            n_frames_;
+    bool                    failed_;
+};
+
+/**
+Random access reader for files written by ChunkedTraceWriter. Frames are located by frame number or timestamp using
+binary search in the chunk index, then only the chunk holding the frame is read and decoded. Chunks are independent,
+so ranges of chunks can be decoded in parallel.
+*/
+class ChunkedTraceReader
+{
+public:
+    struct Frame
+    {
+        unsigned long long timestamp;
+        std::string        data;
+    };
+
+    typedef ChunkedTraceWriter::IndexEntry ChunkInfo;
+
+    ChunkedTraceReader() = default;
+    ~ChunkedTraceReader()
+    {
+        Close();
+    }
+
+    /**
+    Open trace file and load its index. Files without index, e.g. not properly closed, are scanned instead.
+    @return 0 if successful, -1 if not
+    */
+    int  Open(const std::string& filename);
+    void Close();
+    bool IsOpen() const
+    {
+        return file_.is_open();
+    }
+
+    unsigned int GetNumberOfFrames() const
+    {
+        return n_frames_;
+    }
+    unsigned int GetNumberOfChunks() const
+    {
+        return static_cast<unsigned int>(index_.size());
+    }
+    const ChunkInfo& GetChunkInfo(unsigned int chunk) const
+    {
+        return index_[chunk];
+    }
+
+    bool HasStatic() const
+    {
+        return static_offset_ > 0;
+    }
+
+    /**
+    Read static data
+    @return 0 if successful, -1 if not or if the file has no static data
+    */
+    int ReadStatic(std::string& data);
+
+    /**
+    Find chunk holding given frame
+    @return chunk index, -1 if frame number out of range
+    */
+    int FindChunkByFrame(unsigned int frame) const;
+
+    /**
+    Find chunk holding the latest frame at or before given time, or the first chunk if time precedes all frames
+    @return chunk index, -1 if file is empty
+    */
+    int FindChunkByTime(unsigned long long timestamp) const;
+
+    /**
+    Read and decode all frames of a chunk. May be called from multiple threads simultaneously.
+    @return 0 if successful, -1 if not
+    */
+    int ReadChunk(unsigned int chunk, std::vector<Frame>& frames);
+
+    /**
+    Read and decode a range of chunks, in parallel
+    @param first First chunk
+    @param n Number of chunks
+    @param chunks Decoded frames, one vector per chunk
+    @param n_threads Number of threads, 0 for number of hardware threads
+    @return 0 if successful, -1 if any chunk failed
+    */
+    int ReadChunks(unsigned int first, unsigned int n, std::vector<std::vector<Frame>>& chunks, unsigned int n_threads = 0);
+
+    /**
+    Read a single frame
+    @param frame Frame number, counting from 0
+    @return 0 if successful, -1 if not
+    */
+    int ReadFrame(unsigned int frame, Frame& result);
+
+    /**
+    Read the latest frame at or before given time, or the first frame if time precedes all frames
+    @return Frame number, -1 if not found
+    */
+    int ReadFrameAtTime(unsigned long long timestamp, Frame& result);
+
+private:
+    int ReadAt(unsigned long long offset, void* data, size_t size);
+    int ReadChunkData(unsigned long long offset, std::string& raw, unsigned int& n_frames);
+    int ScanChunks();
+
+    std::ifstream          file_;
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    std::mutex mutex_;  // file access
+#endif
+    unsigned long long     file_size_     = 0;
+    unsigned long long     static_offset_ = 0;
+    unsigned int           n_frames_      = 0;
+    std::vector<ChunkInfo> index_;
+};
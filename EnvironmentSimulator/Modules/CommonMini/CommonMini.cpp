@@ -1653,10 +1653,7 @@ CSV_Logger::CSV_Logger() : data_index_(0), callback_(nullptr)
 
 CSV_Logger::~CSV_Logger()
 {
-    if (file_.is_open())
-    {
-        file_.close();
-    }
+    file_.Close();
 
     callback_ = 0;
 }
@@ -1665,7 +1662,7 @@ void CSV_Logger::LogEntryHeader(double timestamp)
 {
     static char data_entry[max_csv_entry_length];
     snprintf(data_entry, max_csv_entry_length, "%d, %f, ", data_index_, timestamp);
-    file_ << data_entry;
+    line_ = data_entry;
 }
 
 void CSV_Logger::LogVehicleData(bool        isendline,
@@ -1739,19 +1736,16 @@ void CSV_Logger::LogVehicleData(bool        isendline,
              curvature,
              collisions);
 
-    if (file_.is_open())
+    if (file_.IsOpen())
     {
-        // Add lines horizontally until the endline is reached
+        // Add lines horizontally until the endline is reached, then hand over the complete line to the file writer
+        line_ += data_entry;
         if (isendline == true)
         {
-            file_ << data_entry << std::endl;
-            file_.flush();
+            line_ += "\n";
+            file_.Write(line_);
             data_index_++;
         }
-        else
-        {
-            file_ << data_entry;
-        }
     }
 
     if (callback_)
@@ -1780,33 +1774,29 @@ void CSV_Logger::SetCallback(FuncPtr callback)
 // Filename and vehicle number are used for dynamic header creation
 void CSV_Logger::Open(std::string scenario_filename, int numvehicles, std::string csv_filename)
 {
-    if (file_.is_open())
-    {
-        file_.close();
-    }
-
-    file_.open(csv_filename);
-    if (file_.fail())
+    if (file_.Open(csv_filename, std::ios_base::out, SE_Env::Inst().GetWriteBufferSize()) != 0)
     {
         throw std::iostream::failure(std::string("Cannot open file: ") + csv_filename);
     }
 
     data_index_ = 0;
 
+    std::string header;
+
     // Standard ESMINI log header, appended with Scenario file name and vehicle count
     static char message[max_csv_entry_length];
     snprintf(message, max_csv_entry_length, "esmini GIT REV: %s", esmini_git_rev());
-    file_ << message << std::endl;
+    header += std::string(message) + "\n";
     snprintf(message, max_csv_entry_length, "esmini GIT TAG: %s", esmini_git_tag());
-    file_ << message << std::endl;
+    header += std::string(message) + "\n";
     snprintf(message, max_csv_entry_length, "esmini GIT BRANCH: %s", esmini_git_branch());
-    file_ << message << std::endl;
+    header += std::string(message) + "\n";
     snprintf(message, max_csv_entry_length, "esmini BUILD VERSION: %s", esmini_build_version());
-    file_ << message << std::endl;
+    header += std::string(message) + "\n";
     snprintf(message, max_csv_entry_length, "Scenario File Name: %s", scenario_filename.c_str());
-    file_ << message << std::endl;
+    header += std::string(message) + "\n";
     snprintf(message, max_csv_entry_length, "Number of Vehicles: %d", numvehicles);
-    file_ << message << std::endl;
+    header += std::string(message) + "\n";
 
     // Ego vehicle is always present, at least one set of vehicle data values should be stored
     // Index and TimeStamp are included in this first set of columns
@@ -1824,7 +1814,7 @@ void CSV_Logger::Open(std::string scenario_filename, int numvehicles, std::strin
              "#1 Heading_Angle_Rate [rad/s] , #1 Relative_Heading_Angle [rad] , "
              "#1 Relative_Heading_Angle_Drive_Direction [rad] , #1 World_Pitch_Angle [rad] , "
              "#1 Road_Curvature [1/m] , #1 collision_ids , ");
-    file_ << message;
+    header += message;
 
     // Based on number of vehicels in the Entities vector, extend the header accordingly
     for (int i = 2; i <= numvehicles; i++)
@@ -1873,11 +1863,12 @@ void CSV_Logger::Open(std::string scenario_filename, int numvehicles, std::strin
                  i,
                  i,
                  i);
-        file_ << message;
+        header += message;
     }
-    file_ << std::endl;
+    header += "\n";
 
-    file_.flush();
+    file_.Write(header);
+    file_.SetDropWhenFull(SE_Env::Inst().GetWriteDropWhenFull());
 
     callback_ = 0;
 }
@@ -1914,6 +1905,358 @@ void SE_Thread::Wait()
 #endif
 }
 
+SE_WorkerPool::~SE_WorkerPool()
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    StopWorkers();
+#endif
+}
+
+void SE_WorkerPool::SetNumberOfThreads(unsigned int n_threads)
+{
+    n_threads_ = MAX(1u, n_threads);
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (workers_.size() + 1 == n_threads_)
+    {
+        return;
+    }
+
+    StopWorkers();
+
+    for (unsigned int i = 1; i < n_threads_; i++)
+    {
+        workers_.emplace_back(&SE_WorkerPool::WorkerLoop, this);
+    }
+#else
+    n_threads_ = 1;
+#endif
+}
+
+void SE_WorkerPool::Run(size_t n_tasks, const std::function<void(size_t)>& task)
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (!workers_.empty() && n_tasks > 1)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_      = &task;
+            n_tasks_   = n_tasks;
+            next_task_ = 0;
+            n_busy_    = static_cast<unsigned int>(workers_.size());
+            exception_ = nullptr;
+            generation_++;
+        }
+        cv_start_.notify_all();
+
+        ProcessTasks();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_done_.wait(lock, [this] { return n_busy_ == 0; });
+        task_ = nullptr;
+
+        if (exception_ != nullptr)
+        {
+            std::rethrow_exception(exception_);
+        }
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < n_tasks; i++)
+    {
+        task(i);
+    }
+}
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+void SE_WorkerPool::ProcessTasks()
+{
+    size_t i;
+    while ((i = next_task_.fetch_add(1)) < n_tasks_)
+    {
+        try
+        {
+            (*task_)(i);
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (exception_ == nullptr)
+            {
+                exception_ = std::current_exception();
+            }
+        }
+    }
+}
+
+void SE_WorkerPool::WorkerLoop()
+{
+    unsigned long long generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_start_.wait(lock, [this, generation] { return quit_ || generation_ != generation; });
+            if (quit_)
+            {
+                return;
+            }
+            generation = generation_;
+        }
+
+        ProcessTasks();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (--n_busy_ == 0)
+        {
+            cv_done_.notify_one();
+        }
+    }
+}
+
+void SE_WorkerPool::StopWorkers()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    cv_start_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+    workers_.clear();
+    quit_       = false;
+    generation_ = 0;
+}
+#endif
+
+SE_AsyncFileWriter::~SE_AsyncFileWriter()
+{
+    Close();
+}
+
+int SE_AsyncFileWriter::Open(const std::string& filename, std::ios_base::openmode mode, size_t buffer_size)
+{
+    Close();
+
+    file_.open(filename, mode);
+    if (file_.fail())
+    {
+        return -1;
+    }
+
+    filename_         = filename;
+    error_            = false;
+    n_dropped_        = 0;
+    n_back_pressured_ = 0;
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    buffer_.resize(buffer_size);
+    head_        = 0;
+    tail_        = 0;
+    quit_        = false;
+    idle_        = false;
+    write_error_ = false;
+
+    if (buffer_size > 0)
+    {
+        writer_ = std::thread(&SE_AsyncFileWriter::WriterLoop, this);
+    }
+#else
+    (void)buffer_size;
+#endif
+
+    return 0;
+}
+
+void SE_AsyncFileWriter::Close()
+{
+    if (!file_.is_open())
+    {
+        return;
+    }
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (writer_.joinable())
+    {
+        // writer thread empties the buffer before quitting
+        quit_ = true;
+        WakeWriter();
+        writer_.join();
+    }
+#endif
+
+    file_.close();
+
+    if (!Good())
+    {
+        LOG_ERROR("Failed to write file {}", filename_);
+    }
+
+    if (n_dropped_ > 0 || n_back_pressured_ > 0)
+    {
+        LOG_WARN("File {}: {} frames dropped, {} frames waited for write buffer", filename_, n_dropped_, n_back_pressured_);
+    }
+}
+
+bool SE_AsyncFileWriter::Good() const
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (write_error_)
+    {
+        return false;
+    }
+#endif
+    return !error_;
+}
+
+bool SE_AsyncFileWriter::Write(const void* data, size_t size)
+{
+    if (!file_.is_open())
+    {
+        return false;
+    }
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (writer_.joinable())
+    {
+        const char*  src      = static_cast<const char*>(data);
+        const size_t capacity = buffer_.size();
+        size_t       head     = head_.load(std::memory_order_relaxed);
+
+        if (drop_when_full_ && capacity - (head - tail_.load(std::memory_order_acquire)) < size)
+        {
+            n_dropped_++;
+            return false;
+        }
+
+        bool waited = false;
+        while (size > 0)
+        {
+            // frames larger than the buffer are handed over in pieces
+            size_t free_space = capacity - (head - tail_.load(std::memory_order_acquire));
+            size_t n          = MIN(size, capacity);
+            if (free_space < n)
+            {
+                waited = true;
+                WakeWriter();
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+
+            // copy into the ring, possibly wrapping around the end
+            size_t pos   = head % capacity;
+            size_t first = MIN(n, capacity - pos);
+            memcpy(&buffer_[pos], src, first);
+            memcpy(&buffer_[0], src + first, n - first);
+
+            head += n;
+            head_.store(head, std::memory_order_release);
+            src += n;
+            size -= n;
+        }
+
+        if (waited)
+        {
+            n_back_pressured_++;
+        }
+
+        if (idle_)
+        {
+            WakeWriter();
+        }
+
+        return true;
+    }
+#endif
+
+    file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!file_.good())
+    {
+        error_ = true;
+    }
+
+    return true;
+}
+
+void SE_AsyncFileWriter::Flush()
+{
+    if (!file_.is_open())
+    {
+        return;
+    }
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (writer_.joinable())
+    {
+        // tail is updated after data has been written, hence the file is idle once caught up
+        while (tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_relaxed))
+        {
+            WakeWriter();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+#endif
+
+    file_.flush();
+}
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+void SE_AsyncFileWriter::WakeWriter()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.notify_one();
+}
+
+void SE_AsyncFileWriter::WriterLoop()
+{
+    const size_t capacity = buffer_.size();
+
+    while (true)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+
+        if (head == tail)
+        {
+            if (quit_)
+            {
+                return;
+            }
+
+            // Wait for data. The producer only notifies when it sees the idle flag, so a notification might
+            // be missed right when going idle. The timeout bounds the delay in that case.
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_ = true;
+            cv_.wait_for(lock, std::chrono::milliseconds(10), [this, tail] { return quit_ || head_.load(std::memory_order_acquire) != tail; });
+            idle_ = false;
+            continue;
+        }
+
+        // write all available data, in at most two pieces due to wrap around
+        size_t n     = head - tail;
+        size_t pos   = tail % capacity;
+        size_t first = MIN(n, capacity - pos);
+        file_.write(&buffer_[pos], static_cast<std::streamsize>(first));
+        if (n > first)
+        {
+            file_.write(&buffer_[0], static_cast<std::streamsize>(n - first));
+        }
+
+        if (!file_.good())
+        {
+            write_error_ = true;
+        }
+
+        tail_.store(head, std::memory_order_release);
+    }
+}
+#endif
+
 SE_Mutex::SE_Mutex()
 {
 #if (defined WINVER && WINVER == _WIN32_WINNT_WIN7 || MINGW32)
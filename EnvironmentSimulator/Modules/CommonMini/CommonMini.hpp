@@ -19,9 +19,11 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <condition_variable>
+#include <atomic>
 #include <cstring>
 #include <map>
 #include <unordered_map>
+#include <type_traits>
 
 #ifndef _WIN32
 #include <inttypes.h>
@@ -71,6 +73,7 @@ using idx_t = uint32_t;
 #define REPLAYER_LOG_FILENAME         "replayer_log.txt"
 #define DAT_FILENAME                  "sim.dat"
 #define GHOST_TRAIL_SAMPLE_TIME       0.2
+#define DEFAULT_WRITE_BUFFER_SIZE     (4 * 1024 * 1024)
 #define LOGICAL_OR(X, Y)              ((X || Y) && !(X && Y))
 
 const std::string CONFIG_FILE_OPTION_NAME = "config_file_path";
@@ -733,6 +736,9 @@ double GetSecondsToFactor(int seconds);
 #else
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
 #endif
 
 class SE_Thread
@@ -832,6 +838,210 @@ private:
     bool flag;
 };
 
+// Pool of worker threads for data parallel work within a frame, e.g. one task per entity or controller
+// Tasks are identified by index and fetched by any idle thread, hence results must not depend on execution order
+// The calling thread participates in the work. Without thread support all tasks are executed by the calling thread.
+class SE_WorkerPool
+{
+public:
+    SE_WorkerPool()
+    {
+    }
+    ~SE_WorkerPool();
+
+    /**
+    Set number of threads, including the calling one. Values 0 and 1 means all tasks are executed by the calling thread.
+    @param n_threads Number of threads
+    */
+    void SetNumberOfThreads(unsigned int n_threads);
+
+    unsigned int GetNumberOfThreads() const
+    {
+        return n_threads_;
+    }
+
+    /**
+    Execute a task for each index in the range [0, n_tasks), returns when all tasks are done
+    Any exception thrown by a task is re-thrown in the calling thread
+    @param n_tasks Number of tasks
+    @param task Function to execute, taking the task index as argument
+    */
+    void Run(size_t n_tasks, const std::function<void(size_t)>& task);
+
+private:
+    unsigned int n_threads_ = 1;
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    void WorkerLoop();
+    void ProcessTasks();
+    void StopWorkers();
+
+    std::vector<std::thread>           workers_;
+    std::mutex                         mutex_;
+    std::condition_variable            cv_start_;
+    std::condition_variable            cv_done_;
+    const std::function<void(size_t)>* task_       = nullptr;
+    size_t                             n_tasks_    = 0;
+    std::atomic<size_t>                next_task_  = {0};
+    unsigned int                       n_busy_     = 0;
+    unsigned long long                 generation_ = 0;
+    bool                               quit_       = false;
+    std::exception_ptr                 exception_  = nullptr;
+#endif
+};
+
+// Writes a file from a separate thread, so that the calling thread never blocks on file I/O
+// Data is handed over in frames, e.g. one serialized simulation step, through a lock-free single producer / single consumer
+// ring buffer. Hence Write() must not be called by several threads at the same time. The writer thread writes all data
+// available in as few calls as possible. When the buffer is full, Write() either waits for space (back-pressure) or drops
+// the frame, see SetDropWhenFull(). Close() and the destructor write all remaining data before closing the file.
+// With buffer size 0, or without thread support, data is written directly by the calling thread.
+class SE_AsyncFileWriter
+{
+public:
+    SE_AsyncFileWriter()
+    {
+    }
+    ~SE_AsyncFileWriter();
+
+    /**
+    Open file for writing, any previously opened file is closed first
+    @param filename Path of the file
+    @param mode Open mode, as for std::ofstream
+    @param buffer_size Size of ring buffer in bytes, 0 for synchronous writing
+    @return 0 if successful, -1 if file could not be opened
+    */
+    int Open(const std::string& filename, std::ios_base::openmode mode, size_t buffer_size);
+
+    /**
+    Write remaining data and close the file
+    */
+    void Close();
+
+    bool IsOpen() const
+    {
+        return file_.is_open();
+    }
+
+    /**
+    Hand over a frame of data to the writer
+    @param data Pointer to data
+    @param size Number of bytes
+    @return true if the frame was accepted, false if dropped or file not open
+    */
+    bool Write(const void* data, size_t size);
+
+    bool Write(const std::string& str)
+    {
+        return Write(str.data(), str.size());
+    }
+
+    /**
+    Wait until all handed over data is written, and flush the file
+    */
+    void Flush();
+
+    /**
+    Select behavior when the buffer is full. Default is to wait for space, so that no data is lost.
+    @param drop true to drop frames that does not fit, false to wait until they fit
+    */
+    void SetDropWhenFull(bool drop)
+    {
+        drop_when_full_ = drop;
+    }
+
+    unsigned int GetNumberOfDroppedFrames() const
+    {
+        return n_dropped_;
+    }
+
+    // Number of frames that had to wait for buffer space
+    unsigned int GetNumberOfBackPressuredFrames() const
+    {
+        return n_back_pressured_;
+    }
+
+    // false if any write to the file failed
+    bool Good() const;
+
+private:
+    std::ofstream file_;
+    std::string   filename_;
+    bool          drop_when_full_   = false;
+    unsigned int  n_dropped_        = 0;
+    unsigned int  n_back_pressured_ = 0;
+    bool          error_            = false;
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    void WriterLoop();
+    void WakeWriter();
+
+    std::vector<char>       buffer_;
+    std::atomic<size_t>     head_        = {0};  // total number of bytes handed over, only changed by the producer
+    std::atomic<size_t>     tail_        = {0};  // total number of bytes written, only changed by the writer thread
+    std::atomic<bool>       quit_        = {false};
+    std::atomic<bool>       idle_        = {false};  // writer thread waiting for data
+    std::atomic<bool>       write_error_ = {false};
+    std::thread             writer_;
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+#endif
+};
+
+// Lock-free exchange of a data set from one producer thread to one consumer thread, e.g. simulation state to the viewer
+// The producer fills the write buffer and publishes it. The consumer picks up the latest published buffer, if any. Neither
+// side ever waits. Intermediate data sets are skipped when the producer is faster than the consumer. Buffers are reused,
+// so containers within T keep their storage between frames.
+template <class T>
+class SE_TripleBuffer
+{
+public:
+    SE_TripleBuffer() : write_(0), read_(1), shared_(2)
+    {
+    }
+
+    // Buffer for the producer to fill in
+    T& GetWriteBuffer()
+    {
+        return buffer_[write_];
+    }
+
+    // Make write buffer available to the consumer, and continue with a free buffer
+    void Publish()
+    {
+        write_ = shared_.exchange(write_ | NEW_DATA, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /**
+    Pick up latest published buffer, if any
+    @return true if new data was published since last call, else false and the read buffer is unchanged
+    */
+    bool Consume()
+    {
+        if (!(shared_.load(std::memory_order_relaxed) & NEW_DATA))
+        {
+            return false;
+        }
+        read_ = shared_.exchange(read_, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // Latest data picked up by the consumer
+    T& GetReadBuffer()
+    {
+        return buffer_[read_];
+    }
+
+private:
+    static const unsigned int INDEX_MASK = 0x3;
+    static const unsigned int NEW_DATA   = 0x4;
+
+    T                         buffer_[3];
+    unsigned int              write_;   // owned by producer
+    unsigned int              read_;    // owned by consumer
+    std::atomic<unsigned int> shared_;  // index of the buffer in between, with flag set when published but not consumed
+};
+
 // Converts string to bool pair, first is set if value is bool and second is value of conversion
 // caller should check first before using second. This function will take:
 // true, True, TRUE as true
@@ -924,8 +1134,11 @@ private:
     // Counter for indexing each log entry
     int data_index_;
 
-    // File output stream
-    std::ofstream file_;
+    // File output, written by separate thread
+    SE_AsyncFileWriter file_;
+
+    // Current data line, written when complete
+    std::string line_;
 
     // Callback function pointer for error logging
     FuncPtr callback_;
@@ -1232,6 +1445,119 @@ private:
     bool   critical_;
 };
 
+// Compact binary buffer used for serialization of simulation state (snapshots)
+// Values are stored in native byte order, hence blobs are only portable between hosts of same architecture
+class SE_StateStream
+{
+public:
+    SE_StateStream() : pos_(0), good_(true)
+    {
+    }
+
+    SE_StateStream(const char* data, size_t size) : buf_(data, data + size), pos_(0), good_(true)
+    {
+    }
+
+    template <typename T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SE_StateStream::Write requires trivially copyable type");
+        const char* p = reinterpret_cast<const char*>(&value);
+        buf_.insert(buf_.end(), p, p + sizeof(T));
+    }
+
+    void WriteString(const std::string& str)
+    {
+        Write(static_cast<uint32_t>(str.size()));
+        buf_.insert(buf_.end(), str.begin(), str.end());
+    }
+
+    template <typename T>
+    void WriteVector(const std::vector<T>& v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SE_StateStream::WriteVector requires trivially copyable type");
+        Write(static_cast<uint32_t>(v.size()));
+        if (!v.empty())
+        {
+            const char* p = reinterpret_cast<const char*>(v.data());
+            buf_.insert(buf_.end(), p, p + v.size() * sizeof(T));
+        }
+    }
+
+    template <typename T>
+    bool Read(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SE_StateStream::Read requires trivially copyable type");
+        if (!good_ || pos_ + sizeof(T) > buf_.size())
+        {
+            good_ = false;
+            return false;
+        }
+        memcpy(&value, &buf_[pos_], sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& str)
+    {
+        uint32_t size = 0;
+        if (!Read(size) || pos_ + size > buf_.size())
+        {
+            good_ = false;
+            return false;
+        }
+        str.assign(buf_.begin() + static_cast<std::ptrdiff_t>(pos_), buf_.begin() + static_cast<std::ptrdiff_t>(pos_ + size));
+        pos_ += size;
+        return true;
+    }
+
+    template <typename T>
+    bool ReadVector(std::vector<T>& v)
+    {
+        uint32_t size = 0;
+        if (!Read(size) || pos_ + size * sizeof(T) > buf_.size())
+        {
+            good_ = false;
+            return false;
+        }
+        v.resize(size);
+        if (size > 0)
+        {
+            memcpy(v.data(), &buf_[pos_], size * sizeof(T));
+        }
+        pos_ += size * sizeof(T);
+        return true;
+    }
+
+    // false if any read has failed, e.g. due to truncated or corrupt data
+    bool Good() const
+    {
+        return good_;
+    }
+
+    const char* GetData() const
+    {
+        return buf_.data();
+    }
+
+    size_t GetSize() const
+    {
+        return buf_.size();
+    }
+
+    void Clear()
+    {
+        buf_.clear();
+        pos_  = 0;
+        good_ = true;
+    }
+
+private:
+    std::vector<char> buf_;
+    size_t            pos_;
+    bool              good_;
+};
+
 class SE_Rand
 {
 public:
@@ -1302,7 +1628,10 @@ public:
           saveImagesToRAM_(false),
           ghost_mode_(GhostMode::NORMAL),
           ghost_headstart_(0.0),
-          osiTimeStamp_(OSI_TIMESTAMP_UNDEFINED)
+          osiTimeStamp_(OSI_TIMESTAMP_UNDEFINED),
+          writeBufferSize_(DEFAULT_WRITE_BUFFER_SIZE),
+          writeDropWhenFull_(false),
+          trailHorizon_(0.0)
     {
     }
 
@@ -1454,6 +1783,46 @@ public:
         return opt;
     };
 
+    /**
+        Set size of buffers used for writing output files (recording, CSV log, OSI trace) from a separate thread
+        @param size Buffer size in bytes, 0 to write directly from the simulation thread
+    */
+    void SetWriteBufferSize(size_t size)
+    {
+        writeBufferSize_ = size;
+    }
+    size_t GetWriteBufferSize() const
+    {
+        return writeBufferSize_;
+    }
+
+    /**
+        Set behavior of output files when the write buffer is full
+        @param drop true to drop frames, false to wait for the writer thread (default)
+    */
+    void SetWriteDropWhenFull(bool drop)
+    {
+        writeDropWhenFull_ = drop;
+    }
+    bool GetWriteDropWhenFull() const
+    {
+        return writeDropWhenFull_;
+    }
+
+    /**
+        Set time span of entity trails. Older trail vertices are discarded, so that memory stays bounded in long runs.
+        Any ghost headstart time is added to make sure the trail covers what ghost followers look for.
+        @param horizon Time span in seconds, 0 to keep complete trails (default)
+    */
+    void SetTrailHorizon(double horizon)
+    {
+        trailHorizon_ = horizon;
+    }
+    double GetTrailHorizon() const
+    {
+        return trailHorizon_;
+    }
+
 private:
     std::vector<std::string>   paths_;
     double                     osiMaxLongitudinalDistance_;
@@ -1469,6 +1838,9 @@ private:
     double                     ghost_headstart_;
     SE_Options                 opt;
     unsigned long long         osiTimeStamp_;
+    size_t                     writeBufferSize_;
+    bool                       writeDropWhenFull_;
+    double                     trailHorizon_;
 };
 
 /**
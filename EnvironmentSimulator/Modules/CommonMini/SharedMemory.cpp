@@ -0,0 +1,435 @@
+/*
+ * esmini - Environment Simulator Minimalistic
+ * https://github.com/esmini/esmini
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) partners of Simulation Scenarios
+ * https://sites.google.com/view/simulationscenarios
+ */
+
+/*
+ * No dependencies on other esmini modules, so that external applications can include it as is.
+ * Errors are reported by return values, logging is up to the caller.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string.h>
+
+#include "SharedMemory.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+#endif
+
+#define SHM_MAGIC   0x4f534d45
+#define SHM_VERSION 1
+#define SHM_ALIGN   64
+
+// Layout of the shared memory: header followed by n_slots slots, each a slot header followed by the message
+struct SharedMemoryHeader
+{
+    uint32_t              magic;  // written last by the writer, when the layout is ready
+    uint32_t              version;
+    uint32_t              n_slots;
+    uint32_t              reserved;
+    uint64_t              slot_size;
+    std::atomic<uint32_t> closed;     // set when the writer is gone
+    std::atomic<uint64_t> write_seq;  // latest published message
+    std::atomic<uint32_t> notify;     // futex word, incremented for each message
+    std::atomic<uint32_t> n_waiters;  // number of readers blocked on the futex
+};
+
+struct SharedMemorySlot
+{
+    std::atomic<uint64_t> seq;  // 2 * message sequence number when complete, odd while being written
+    uint64_t              size;
+};
+
+static_assert(sizeof(SharedMemoryHeader) <= SHM_ALIGN && sizeof(SharedMemorySlot) <= SHM_ALIGN, "Shared memory headers do not fit alignment");
+
+#define HEADER(base)    (reinterpret_cast<SharedMemoryHeader*>(base))
+#define SLOT_STRIDE(sz) (SHM_ALIGN + ((sz) + SHM_ALIGN - 1) / SHM_ALIGN * SHM_ALIGN)
+
+static std::string ShmPath(const std::string& name)
+{
+    // POSIX shared memory names start with a single slash
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+static void FutexWake(std::atomic<uint32_t>* addr)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)addr;
+#endif
+}
+
+static void FutexWait(std::atomic<uint32_t>* addr, uint32_t value, unsigned int timeoutMs)
+{
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec  = timeoutMs / 1000;
+    ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, value, &ts, nullptr, 0);
+#elif !defined _WIN32
+    // no cross-process wait primitive in use, poll
+    (void)addr;
+    (void)value;
+    usleep(1000 * (timeoutMs < 1 ? timeoutMs : 1));
+#else
+    (void)addr;
+    (void)value;
+    (void)timeoutMs;
+#endif
+}
+
+#ifndef _WIN32
+static void Unlink(const std::string& path)
+{
+    // a previous writer may have died without closing, tell readers still attached to it that it is gone
+    // unlink first, so that they can not re-attach to the old memory
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    shm_unlink(path.c_str());
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= SHM_ALIGN)
+    {
+        void* ptr = mmap(nullptr, SHM_ALIGN, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr != MAP_FAILED)
+        {
+            SharedMemoryHeader* hdr = HEADER(ptr);
+            if (hdr->magic == SHM_MAGIC && hdr->version == SHM_VERSION)
+            {
+                hdr->closed.store(1);
+                hdr->notify.fetch_add(1);
+                FutexWake(&hdr->notify);
+            }
+            munmap(ptr, SHM_ALIGN);
+        }
+    }
+    close(fd);
+}
+#endif
+
+SharedMemoryBase::SharedMemoryBase(std::string name) : name_(name), fd_(-1), base_(nullptr), map_size_(0), n_slots_(0), slot_size_(0)
+{
+}
+
+int SharedMemoryBase::Map(bool create)
+{
+#ifdef _WIN32
+    (void)create;
+    return -1;
+#else
+    std::string path = ShmPath(name_);
+
+    if (create)
+    {
+        if (n_slots_ < 2 || slot_size_ == 0)
+        {
+            return -1;
+        }
+
+        // start from scratch, readers of any previous instance are notified to re-attach
+        Unlink(path);
+        fd_ = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+        if (fd_ < 0)
+        {
+            return -1;
+        }
+
+        map_size_ = SHM_ALIGN + n_slots_ * SLOT_STRIDE(slot_size_);
+        if (ftruncate(fd_, static_cast<off_t>(map_size_)) != 0)
+        {
+            Unmap();
+            return -1;
+        }
+    }
+    else
+    {
+        fd_ = shm_open(path.c_str(), O_RDWR, 0);
+        if (fd_ < 0)
+        {
+            return -1;
+        }
+
+        struct stat st;
+        if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < SHM_ALIGN)
+        {
+            Unmap();
+            return -1;
+        }
+        map_size_ = static_cast<size_t>(st.st_size);
+    }
+
+    void* ptr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (ptr == MAP_FAILED)
+    {
+        Unmap();
+        return -1;
+    }
+    base_ = static_cast<char*>(ptr);
+
+    SharedMemoryHeader* hdr = HEADER(base_);
+    if (create)
+    {
+        // memory from ftruncate is zeroed, i.e. all counters start at 0
+        new (&hdr->write_seq) std::atomic<uint64_t>(0);
+        new (&hdr->notify) std::atomic<uint32_t>(0);
+        new (&hdr->n_waiters) std::atomic<uint32_t>(0);
+        new (&hdr->closed) std::atomic<uint32_t>(0);
+        for (unsigned int i = 0; i < n_slots_; i++)
+        {
+            new (&reinterpret_cast<SharedMemorySlot*>(GetSlot(i + 1))->seq) std::atomic<uint64_t>(0);
+        }
+        hdr->version   = SHM_VERSION;
+        hdr->n_slots   = n_slots_;
+        hdr->slot_size = slot_size_;
+        std::atomic_thread_fence(std::memory_order_release);
+        hdr->magic = SHM_MAGIC;
+    }
+    else
+    {
+        if (hdr->magic != SHM_MAGIC || hdr->version != SHM_VERSION || hdr->n_slots < 2 ||
+            SHM_ALIGN + hdr->n_slots * SLOT_STRIDE(hdr->slot_size) > map_size_)
+        {
+            Unmap();
+            return -1;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        n_slots_   = hdr->n_slots;
+        slot_size_ = static_cast<size_t>(hdr->slot_size);
+    }
+
+    return 0;
+#endif
+}
+
+void SharedMemoryBase::Unmap()
+{
+#ifndef _WIN32
+    if (base_ != nullptr)
+    {
+        munmap(base_, map_size_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+#endif
+}
+
+char* SharedMemoryBase::GetSlot(uint64_t seq) const
+{
+    return base_ + SHM_ALIGN + static_cast<size_t>((seq - 1) % n_slots_) * SLOT_STRIDE(slot_size_);
+}
+
+SharedMemoryWriter::SharedMemoryWriter(std::string name, unsigned int n_slots, size_t slot_size) : SharedMemoryBase(name), seq_(0), pending_(0), writing_(false)
+{
+    n_slots_   = n_slots;
+    slot_size_ = slot_size;
+    Map(true);
+}
+
+SharedMemoryWriter::~SharedMemoryWriter()
+{
+#ifndef _WIN32
+    if (base_ != nullptr)
+    {
+        // unlink first, so that readers can not re-attach to this memory once notified
+        // unless already replaced by another writer, then the name belongs to that one
+        SharedMemoryHeader* hdr = HEADER(base_);
+        if (hdr->closed == 0)
+        {
+            shm_unlink(ShmPath(name_).c_str());
+        }
+        hdr->closed.store(1);
+        hdr->notify.fetch_add(1);
+        FutexWake(&hdr->notify);
+        Unmap();
+    }
+#endif
+}
+
+char* SharedMemoryWriter::BeginWrite(size_t size)
+{
+    if (base_ == nullptr || size > slot_size_)
+    {
+        return nullptr;
+    }
+
+    // mark slot as being written, before touching the data
+    SharedMemorySlot* slot = reinterpret_cast<SharedMemorySlot*>(GetSlot(seq_ + 1));
+    slot->seq.store(2 * (seq_ + 1) - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    pending_ = size;
+    writing_ = true;
+
+    return reinterpret_cast<char*>(slot) + SHM_ALIGN;
+}
+
+int SharedMemoryWriter::EndWrite(size_t size)
+{
+    if (base_ == nullptr || !writing_ || size > pending_)
+    {
+        return -1;
+    }
+
+    SharedMemoryHeader* hdr  = HEADER(base_);
+    SharedMemorySlot*   slot = reinterpret_cast<SharedMemorySlot*>(GetSlot(++seq_));
+    slot->size               = size;
+    slot->seq.store(2 * seq_, std::memory_order_release);
+    hdr->write_seq.store(seq_, std::memory_order_release);
+    writing_ = false;
+
+    // only pay for the system call when someone is actually waiting
+    hdr->notify.fetch_add(1);
+    if (hdr->n_waiters.load() > 0)
+    {
+        FutexWake(&hdr->notify);
+    }
+
+    return 0;
+}
+
+int SharedMemoryWriter::Write(const char* buf, size_t size)
+{
+    char* dst = BeginWrite(size);
+    if (dst == nullptr)
+    {
+        return -1;
+    }
+    memcpy(dst, buf, size);
+
+    return EndWrite(size);
+}
+
+SharedMemoryReader::SharedMemoryReader(std::string name) : SharedMemoryBase(name), next_seq_(1), acquired_(0), n_skipped_(0)
+{
+    if (Map(false) == 0)
+    {
+        uint64_t latest = HEADER(base_)->write_seq.load(std::memory_order_acquire);
+        next_seq_       = latest > 0 ? latest : 1;
+    }
+}
+
+bool SharedMemoryReader::IsWriterClosed() const
+{
+    return base_ == nullptr || HEADER(base_)->closed != 0;
+}
+
+const char* SharedMemoryReader::Acquire(size_t& size, unsigned int timeoutMs)
+{
+    if (base_ == nullptr)
+    {
+        return nullptr;
+    }
+
+    SharedMemoryHeader*                   hdr      = HEADER(base_);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (hdr->closed == 0)
+    {
+        uint64_t latest = hdr->write_seq.load(std::memory_order_acquire);
+
+        if (latest >= next_seq_)
+        {
+            // the slot after latest may already be in progress, so only n_slots - 1 messages are safe to read
+            if (latest - next_seq_ >= n_slots_ - 1)
+            {
+                n_skipped_ += latest - next_seq_;
+                next_seq_ = latest;
+            }
+
+            SharedMemorySlot* slot = reinterpret_cast<SharedMemorySlot*>(GetSlot(next_seq_));
+            if (slot->seq.load(std::memory_order_acquire) == 2 * next_seq_)
+            {
+                acquired_ = next_seq_;
+                size      = static_cast<size_t>(slot->size);
+                return reinterpret_cast<char*>(slot) + SHM_ALIGN;
+            }
+
+            // overwritten already, go for the latest one
+            n_skipped_ += latest - next_seq_ + 1;
+            next_seq_ = latest + 1;
+            continue;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            break;
+        }
+
+        // register as waiter before re-checking, so that the writer can not miss waking us up
+        hdr->n_waiters.fetch_add(1);
+        uint32_t notify = hdr->notify.load();
+        if (hdr->write_seq.load(std::memory_order_acquire) < next_seq_ && hdr->closed == 0)
+        {
+            long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+            FutexWait(&hdr->notify, notify, static_cast<unsigned int>(remaining > 0 ? remaining : 1));
+        }
+        hdr->n_waiters.fetch_sub(1);
+    }
+
+    return nullptr;
+}
+
+bool SharedMemoryReader::Release()
+{
+    if (base_ == nullptr || acquired_ == 0)
+    {
+        return false;
+    }
+
+    // check that the writer did not start overwriting the slot while we were reading it
+    std::atomic_thread_fence(std::memory_order_acquire);
+    SharedMemorySlot* slot = reinterpret_cast<SharedMemorySlot*>(GetSlot(acquired_));
+    bool              ok   = slot->seq.load(std::memory_order_relaxed) == 2 * acquired_;
+
+    if (!ok)
+    {
+        n_skipped_++;
+    }
+    next_seq_ = acquired_ + 1;
+
+    return ok;
+}
+
+int SharedMemoryReader::Receive(std::string& buf, unsigned int timeoutMs)
+{
+    size_t      size = 0;
+    const char* data = nullptr;
+
+    while ((data = Acquire(size, timeoutMs)) != nullptr)
+    {
+        buf.assign(data, size);
+        if (Release())
+        {
+            return static_cast<int>(size);
+        }
+    }
+
+    return IsWriterClosed() ? -1 : 0;
+}
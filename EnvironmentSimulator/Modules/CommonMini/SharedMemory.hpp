@@ -0,0 +1,178 @@
+/*
+ * esmini - Environment Simulator Minimalistic
+ * https://github.com/esmini/esmini
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) partners of Simulation Scenarios
+ * https://sites.google.com/view/simulationscenarios
+ */
+
+#pragma once
+
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHM_DEFAULT_N_SLOTS   4
+#define SHM_DEFAULT_SLOT_SIZE (16 * 1024 * 1024)
+
+/**
+Message transport between processes on the same host through a named POSIX shared memory ring buffer.
+One writer publishes complete messages, any number of readers consume them. Each slot holds one message and
+carries a sequence counter, so a reader can tell whether the message it is looking at has been overwritten
+(seqlock). The writer never waits for readers, slow readers skip messages instead. Readers waiting for a message
+are woken via a futex on a counter in the shared memory (Linux), other platforms poll.
+Not supported on Windows, where GetStatus() always reports failure.
+*/
+class SharedMemoryBase
+{
+public:
+    int GetStatus() const
+    {
+        return base_ == nullptr ? -1 : 0;
+    }  // -1 = NOK, 0 = OK
+
+    const std::string& GetName() const
+    {
+        return name_;
+    }
+
+    unsigned int GetNumberOfSlots() const
+    {
+        return n_slots_;
+    }
+
+    size_t GetSlotSize() const
+    {
+        return slot_size_;
+    }
+
+protected:
+    SharedMemoryBase(std::string name);
+    ~SharedMemoryBase()
+    {
+        Unmap();
+    }
+    int   Map(bool create);
+    void  Unmap();
+    char* GetSlot(uint64_t seq) const;
+
+    std::string  name_;
+    int          fd_;
+    char*        base_;
+    size_t       map_size_;
+    unsigned int n_slots_;
+    size_t       slot_size_;
+};
+
+class SharedMemoryWriter : public SharedMemoryBase
+{
+public:
+    /**
+    Create (or re-create) named shared memory. Any existing memory with the same name is replaced, readers attached
+    to it are notified that the writer is gone.
+    @param name Name of the shared memory, e.g. "esmini_osi"
+    @param n_slots Number of messages in the ring, at least 2
+    @param slot_size Max size of a message, in bytes
+    */
+    SharedMemoryWriter(std::string name, unsigned int n_slots = SHM_DEFAULT_N_SLOTS, size_t slot_size = SHM_DEFAULT_SLOT_SIZE);
+    ~SharedMemoryWriter();
+
+    /**
+    Reserve next slot for a message. The message is written directly into the returned buffer, then published
+    by EndWrite().
+    @param size Size of the message, in bytes
+    @return Pointer to the buffer, nullptr if message does not fit into a slot or memory is not open
+    */
+    char* BeginWrite(size_t size);
+
+    /**
+    Publish the message written into the buffer returned by BeginWrite() and wake up waiting readers
+    @param size Actual size of the message, not larger than the one reserved
+    @return 0 if successful, -1 if not
+    */
+    int EndWrite(size_t size);
+
+    /**
+    Publish a message in one go, i.e. copy into next slot
+    @return 0 if successful, -1 if not
+    */
+    int Write(const char* buf, size_t size);
+
+    /**
+    @return Number of messages published so far
+    */
+    uint64_t GetSequenceNumber() const
+    {
+        return seq_;
+    }
+
+private:
+    uint64_t seq_;      // last published message, first one is 1
+    size_t   pending_;  // size reserved by BeginWrite
+    bool     writing_;  // between BeginWrite and EndWrite
+};
+
+class SharedMemoryReader : public SharedMemoryBase
+{
+public:
+    /**
+    Attach to shared memory created by a SharedMemoryWriter. Check GetStatus(), fails if the writer is not yet
+    running. The latest published message, if any, is the first one to be received.
+    @param name Name of the shared memory, same as given to the writer
+    */
+    SharedMemoryReader(std::string name);
+    ~SharedMemoryReader()
+    {
+    }
+
+    /**
+    Wait for next message and give direct access to it, without copying. Messages the reader has fallen
+    too far behind on are skipped. Call Release() when done with the message.
+    @param size Size of the message, in bytes
+    @param timeoutMs Max time to wait, 0 to only check for an available message
+    @return Pointer to the message, nullptr on timeout or if the writer is gone (see IsWriterClosed())
+    */
+    const char* Acquire(size_t& size, unsigned int timeoutMs);
+
+    /**
+    Finish access to the message returned by Acquire()
+    @return true if the message stayed intact while in use, false if the writer overwrote it meanwhile, in which
+    case anything read from it must be discarded
+    */
+    bool Release();
+
+    /**
+    Wait for next message and copy it
+    @param buf Destination, resized to the message
+    @param timeoutMs Max time to wait, 0 to only check for an available message
+    @return Size of the message, 0 on timeout, -1 on error or if the writer is gone
+    */
+    int Receive(std::string& buf, unsigned int timeoutMs);
+
+    bool IsWriterClosed() const;
+
+    /**
+    @return Sequence number of the latest acquired message
+    */
+    uint64_t GetSequenceNumber() const
+    {
+        return acquired_;
+    }
+
+    /**
+    @return Number of messages skipped since the reader could not keep up or the message was overwritten during access
+    */
+    uint64_t GetNumberOfSkippedMessages() const
+    {
+        return n_skipped_;
+    }
+
+private:
+    uint64_t next_seq_;  // next message to receive
+    uint64_t acquired_;  // message currently acquired, 0 if none
+    uint64_t n_skipped_;
+};
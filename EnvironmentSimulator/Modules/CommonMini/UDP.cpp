@@ -14,7 +14,14 @@
 
 #ifndef _WIN32
 #include <sys/time.h>
+#include <sys/select.h>
+#include <fcntl.h>
 #endif
+#ifdef __linux__
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#endif
+#include <thread>
 
 #include "UDP.hpp"
 #include "CommonMini.hpp"
@@ -112,8 +119,27 @@ int UDPServer::Receive(char* buf, unsigned int size)
     return static_cast<int>(recvfrom(sock_, buf, size, 0, reinterpret_cast<struct sockaddr*>(&sender_addr_), &sender_addr_size_));
 }
 
-UDPClient::UDPClient(unsigned short int port, std::string ipAddress) : UDPBase(port), ipAddress_(ipAddress)
+int UDPServer::SetNonBlocking()
 {
+#ifdef _WIN32
+    u_long mode = 1;
+    if (ioctlsocket(sock_, FIONBIO, &mode) != 0)
+#else
+    int flags = fcntl(sock_, F_GETFL, 0);
+    if (flags < 0 || fcntl(sock_, F_SETFL, flags | O_NONBLOCK) < 0)
+#endif
+    {
+        LOG_ERROR("Failed to make socket on port {} non-blocking", port_);
+        return -1;
+    }
+
+    return 0;
+}
+
+UDPClient::UDPClient(unsigned short int port, std::string ipAddress) : UDPBase(port), ipAddress_(ipAddress), rate_limit_(0.0)
+{
+    next_send_time_ = std::chrono::steady_clock::now();
+
     // Prepare the sockaddr_in structure
     memset(reinterpret_cast<char*>(&server_addr_), 0, sizeof(server_addr_));
     server_addr_.sin_family = AF_INET;
@@ -127,4 +153,540 @@ int UDPClient::Send(char* buf, unsigned int size)
     // Casting to int can cause overflow in this situation. Not a good idea.
     // Let's fix it in a way that we actually return size_t and design the flow like that
     return static_cast<int>(sendto(sock_, buf, size, 0, reinterpret_cast<struct sockaddr*>(&server_addr_), sizeof(server_addr_)));
-}
\ No newline at end of file
+}
+
+int UDPClient::SendBurst(const Datagram* datagrams, unsigned int n)
+{
+    unsigned int n_sent = 0;
+
+#ifdef __linux__
+    // all datagrams in one system call, header and payload gathered by the kernel
+    const unsigned int max_batch = 64;
+    struct mmsghdr     msgs[max_batch];
+    struct iovec       iovs[max_batch][2];
+
+    while (n_sent < n)
+    {
+        unsigned int n_batch = MIN(n - n_sent, max_batch);
+        memset(msgs, 0, n_batch * sizeof(struct mmsghdr));
+        for (unsigned int i = 0; i < n_batch; i++)
+        {
+            const Datagram& d           = datagrams[n_sent + i];
+            iovs[i][0].iov_base         = const_cast<char*>(d.header);
+            iovs[i][0].iov_len          = d.header_size;
+            iovs[i][1].iov_base         = const_cast<char*>(d.data);
+            iovs[i][1].iov_len          = d.data_size;
+            msgs[i].msg_hdr.msg_iov     = iovs[i];
+            msgs[i].msg_hdr.msg_iovlen  = 2;
+            msgs[i].msg_hdr.msg_name    = &server_addr_;
+            msgs[i].msg_hdr.msg_namelen = sizeof(server_addr_);
+        }
+
+        int retval = sendmmsg(sock_, msgs, n_batch, 0);
+        stats_.n_calls++;
+        if (retval <= 0)
+        {
+            break;
+        }
+
+        for (int i = 0; i < retval; i++)
+        {
+            stats_.n_bytes += msgs[i].msg_len;
+        }
+        n_sent += static_cast<unsigned int>(retval);
+    }
+#else
+    for (; n_sent < n; n_sent++)
+    {
+        const Datagram& d    = datagrams[n_sent];
+        unsigned int    size = d.header_size + d.data_size;
+
+        scratch_.resize(size);
+        memcpy(scratch_.data(), d.header, d.header_size);
+        memcpy(scratch_.data() + d.header_size, d.data, d.data_size);
+
+        stats_.n_calls++;
+        if (Send(scratch_.data(), size) != static_cast<int>(size))
+        {
+            break;
+        }
+        stats_.n_bytes += size;
+    }
+#endif
+
+    stats_.n_datagrams += n_sent;
+
+    return static_cast<int>(n_sent);
+}
+
+int UDPClient::SendMultiple(const Datagram* datagrams, unsigned int n)
+{
+    std::chrono::steady_clock::time_point start  = std::chrono::steady_clock::now();
+    unsigned int                          n_sent = 0;
+
+    if (rate_limit_ > SMALL_NUMBER)
+    {
+        // send in bursts, each one starting when the previous one has been paid for according to the rate limit
+        while (n_sent < n)
+        {
+            unsigned int n_burst    = 0;
+            unsigned int burst_size = 0;
+            while (n_sent + n_burst < n)
+            {
+                unsigned int size = datagrams[n_sent + n_burst].header_size + datagrams[n_sent + n_burst].data_size;
+                if (n_burst > 0 && burst_size + size > pacing_burst_size)
+                {
+                    break;
+                }
+                burst_size += size;
+                n_burst++;
+            }
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (next_send_time_ > now)
+            {
+                std::this_thread::sleep_until(next_send_time_);
+            }
+            else
+            {
+                next_send_time_ = now;  // no credit for idle time, else a large burst would follow
+            }
+            next_send_time_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(burst_size / rate_limit_));
+
+            int retval = SendBurst(&datagrams[n_sent], n_burst);
+            n_sent += static_cast<unsigned int>(retval);
+            if (static_cast<unsigned int>(retval) < n_burst)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        n_sent = static_cast<unsigned int>(SendBurst(datagrams, n));
+    }
+
+    stats_.n_failed += n - n_sent;
+    stats_.send_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return static_cast<int>(n_sent);
+}
+
+bool UDPFrameAssembler::Add(const char* package, int size)
+{
+    Header header;
+
+    if (size < static_cast<int>(sizeof(Header)))
+    {
+        return false;  // not a valid package
+    }
+    memcpy(&header, package, sizeof(Header));
+
+    if (static_cast<unsigned int>(size) - sizeof(Header) != header.datasize)
+    {
+        return false;  // not a valid package
+    }
+
+    if (header.counter == 1 || header.counter == -1)
+    {
+        // New frame, possibly complete in this single package. Drop any incomplete one and check for frames lost altogether
+        if (receiving_)
+        {
+            n_incomplete_++;
+        }
+        if (started_ && header.frame_id > frame_id_ + 1)
+        {
+            n_missed_ += header.frame_id - frame_id_ - 1;
+        }
+        frame_id_     = header.frame_id;
+        frame_size_   = 0;
+        next_counter_ = 1;
+        receiving_    = true;
+        started_      = true;
+    }
+    else if (!receiving_ || header.frame_id != frame_id_ || abs(header.counter) != next_counter_)
+    {
+        // Package lost or out of order, skip rest of the frame
+        if (receiving_)
+        {
+            n_incomplete_++;
+            receiving_ = false;
+        }
+        return false;
+    }
+
+    if (frame_size_ + header.datasize > max_frame_size_)
+    {
+        LOG_ERROR("UDP frame exceeds max size {}, skipping", max_frame_size_);
+        n_incomplete_++;
+        receiving_ = false;
+        return false;
+    }
+
+    if (frame_.size() < frame_size_ + header.datasize)
+    {
+        frame_.resize(frame_size_ + header.datasize);
+    }
+    memcpy(&frame_[frame_size_], package + sizeof(Header), header.datasize);
+    frame_size_ += header.datasize;
+    next_counter_++;
+
+    if (header.counter < 0)
+    {
+        // Last package, frame complete
+        receiving_ = false;
+        n_frames_++;
+        return true;
+    }
+
+    return false;
+}
+
+void UDPInputMultiplexer::Mailbox::Put(const char* buf, unsigned int size)
+{
+    unsigned long long head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= mailbox_capacity)
+    {
+        // reader not keeping up, drop the message just like a full socket buffer would
+        n_overflow_++;
+        return;
+    }
+
+    Message& message = messages_[head % mailbox_capacity];
+    message.size     = MIN(size, max_message_size);
+    memcpy(message.data, buf, message.size);
+
+    // publish, also wakes any reader in WaitForMessages() via the multiplexer
+    head_.store(head + 1);
+}
+
+int UDPInputMultiplexer::Mailbox::Drain(char* buf)
+{
+    int n_received = 0;
+    int size       = 0;
+
+    while ((size = server_.Receive(buf, max_message_size)) >= 0)
+    {
+        if (size > 0)
+        {
+            Put(buf, static_cast<unsigned int>(size));
+            n_received++;
+        }
+    }
+
+    return n_received;
+}
+
+int UDPInputMultiplexer::Mailbox::Copy(unsigned long long index, char* buf, unsigned int size)
+{
+    const Message& message = messages_[index % mailbox_capacity];
+    unsigned int   n       = MIN(message.size, size);
+    memcpy(buf, message.data, n);
+
+    // release the slot to the receiver
+    tail_.store(index + 1, std::memory_order_release);
+
+    return static_cast<int>(n);
+}
+
+int UDPInputMultiplexer::Mailbox::Take(char* buf, unsigned int size)
+{
+#if (defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    // no receiver thread, pick up any pending messages now
+    char tmp[max_message_size];
+    Drain(tmp);
+#endif
+
+    unsigned long long tail = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == tail)
+    {
+        return 0;
+    }
+
+    return Copy(tail, buf, size);
+}
+
+int UDPInputMultiplexer::Mailbox::TakeLatest(char* buf, unsigned int size)
+{
+#if (defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    char tmp[max_message_size];
+    Drain(tmp);
+#endif
+
+    unsigned long long tail = tail_.load(std::memory_order_relaxed);
+    unsigned long long head = head_.load(std::memory_order_acquire);
+    if (head == tail)
+    {
+        return 0;
+    }
+
+    n_skipped_ += head - 1 - tail;
+
+    return Copy(head - 1, buf, size);
+}
+
+UDPInputMultiplexer& UDPInputMultiplexer::Inst()
+{
+    static UDPInputMultiplexer instance;
+    return instance;
+}
+
+UDPInputMultiplexer::UDPInputMultiplexer() : epoll_fd_(-1), quit_(false), n_waiting_(0)
+{
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+    {
+        LOG_WARN("UDPInputMultiplexer: epoll not available, using select");
+    }
+#endif
+}
+
+UDPInputMultiplexer::~UDPInputMultiplexer()
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    StopThread();
+#endif
+    mailboxes_.clear();
+
+#ifdef __linux__
+    if (epoll_fd_ >= 0)
+    {
+        close(epoll_fd_);
+    }
+#endif
+}
+
+UDPInputMultiplexer::Mailbox* UDPInputMultiplexer::Open(unsigned short port)
+{
+    Mailbox* mailbox = new Mailbox(port);
+    if (mailbox->server_.GetStatus() != 0 || mailbox->server_.SetNonBlocking() != 0)
+    {
+        delete mailbox;
+        return nullptr;
+    }
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    std::unique_lock<std::mutex> lock(mutex_);
+#endif
+
+#ifdef __linux__
+    if (epoll_fd_ >= 0)
+    {
+        struct epoll_event event;
+        event.events   = EPOLLIN;
+        event.data.ptr = mailbox;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, mailbox->server_.GetSocket(), &event) != 0)
+        {
+            LOG_ERROR("UDPInputMultiplexer: Failed to add socket on port {}", port);
+            delete mailbox;
+            return nullptr;
+        }
+    }
+#endif
+
+    mailboxes_.push_back(std::unique_ptr<Mailbox>(mailbox));
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    StartThread();
+#endif
+
+    return mailbox;
+}
+
+void UDPInputMultiplexer::Close(Mailbox* mailbox)
+{
+    bool empty = false;
+    {
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+        std::unique_lock<std::mutex> lock(mutex_);
+#endif
+        for (size_t i = 0; i < mailboxes_.size(); i++)
+        {
+            if (mailboxes_[i].get() == mailbox)
+            {
+#ifdef __linux__
+                if (epoll_fd_ >= 0)
+                {
+                    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, mailbox->server_.GetSocket(), nullptr);
+                }
+#endif
+                mailboxes_.erase(mailboxes_.begin() + static_cast<std::ptrdiff_t>(i));
+                break;
+            }
+        }
+        empty = mailboxes_.empty();
+    }
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (empty)
+    {
+        StopThread();
+    }
+#else
+    (void)empty;
+#endif
+}
+
+int UDPInputMultiplexer::Refresh(Mailbox* mailbox)
+{
+    char buf[max_message_size];
+
+    // mailboxes have a single writer at a time
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    std::unique_lock<std::mutex> lock(mutex_);
+#endif
+    return mailbox->Drain(buf);
+}
+
+int UDPInputMultiplexer::Poll(unsigned int timeoutMs)
+{
+    char buf[max_message_size];
+    int  n_received = 0;
+
+#ifdef __linux__
+    if (epoll_fd_ >= 0)
+    {
+        const int          max_events = 64;
+        struct epoll_event events[max_events];
+        int                n_events = epoll_wait(epoll_fd_, events, max_events, static_cast<int>(timeoutMs));
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+        std::unique_lock<std::mutex> lock(mutex_);
+#endif
+        for (int i = 0; i < n_events; i++)
+        {
+            // the mailbox might have been closed while waiting
+            Mailbox* mailbox = static_cast<Mailbox*>(events[i].data.ptr);
+            for (auto& m : mailboxes_)
+            {
+                if (m.get() == mailbox)
+                {
+                    n_received += mailbox->Drain(buf);
+                    break;
+                }
+            }
+        }
+    }
+    else
+#endif
+    {
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+        std::unique_lock<std::mutex> lock(mutex_);
+#endif
+        fd_set    fds;
+        SE_SOCKET max_sock = 0;
+        FD_ZERO(&fds);
+        for (auto& m : mailboxes_)
+        {
+            FD_SET(m->server_.GetSocket(), &fds);
+            max_sock = MAX(max_sock, m->server_.GetSocket());
+        }
+
+        // short timeout when mailboxes are registered, since opening and closing waits for the lock
+        struct timeval tv;
+        tv.tv_sec  = 0;
+        tv.tv_usec = static_cast<long>(MIN(timeoutMs, 10U) * 1000);
+
+        if (select(static_cast<int>(max_sock) + 1, &fds, nullptr, nullptr, &tv) > 0)
+        {
+            for (auto& m : mailboxes_)
+            {
+                if (FD_ISSET(m->server_.GetSocket(), &fds))
+                {
+                    n_received += m->Drain(buf);
+                }
+            }
+        }
+    }
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (n_received > 0 && n_waiting_.load() > 0)
+    {
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+        }
+        cv_.notify_all();
+    }
+#endif
+
+    return n_received;
+}
+
+bool UDPInputMultiplexer::WaitForMessages(const std::vector<Mailbox*>& mailboxes, unsigned int timeoutMs)
+{
+    auto all_arrived = [&mailboxes]()
+    {
+        for (auto mailbox : mailboxes)
+        {
+            if (!mailbox->HasMessage())
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (all_arrived())
+    {
+        return true;
+    }
+
+    n_waiting_++;
+    bool result = false;
+    {
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        result = cv_.wait_for(lock, std::chrono::milliseconds(timeoutMs), all_arrived);
+    }
+    n_waiting_--;
+
+    return result;
+#else
+    // no receiver thread, receive here until all messages arrived
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true)
+    {
+        Poll(0);
+        if (all_arrived())
+        {
+            return true;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+        Poll(static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1);
+    }
+#endif
+}
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+void UDPInputMultiplexer::StartThread()
+{
+    if (!thread_.joinable())
+    {
+        quit_   = false;
+        thread_ = std::thread(&UDPInputMultiplexer::ThreadLoop, this);
+    }
+}
+
+void UDPInputMultiplexer::StopThread()
+{
+    if (thread_.joinable())
+    {
+        quit_ = true;
+        thread_.join();
+    }
+}
+
+void UDPInputMultiplexer::ThreadLoop()
+{
+    while (!quit_)
+    {
+        Poll(50);
+    }
+}
+#endif
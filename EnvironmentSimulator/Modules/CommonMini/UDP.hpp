@@ -12,7 +12,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 // UDP network includes
 #ifdef _WIN32
@@ -44,6 +54,11 @@ public:
         return sock_ == SE_INVALID_SOCKET ? -1 : 0;
     }  // -1 = NOK, 0 = OK
 
+    SE_SOCKET GetSocket() const
+    {
+        return sock_;
+    }
+
 protected:
     UDPBase(unsigned short int port);
     ~UDPBase()
@@ -68,6 +83,12 @@ public:
     {
     }
     int            Receive(char* buf, unsigned int size);
+
+    /**
+    Make Receive() return immediately, with -1, when no message is available instead of waiting for timeout
+    @return 0 if successful, -1 if not
+    */
+    int            SetNonBlocking();
     unsigned short GetPort() const
     {
         return port_;
@@ -84,11 +105,59 @@ private:
 class UDPClient : public UDPBase
 {
 public:
+    /**
+    Datagram composed of a header and a payload, sent as one package without first copying them together
+    */
+    struct Datagram
+    {
+        const char*  header;
+        unsigned int header_size;
+        const char*  data;
+        unsigned int data_size;
+    };
+
+    struct Statistics
+    {
+        unsigned long long n_datagrams = 0;    // successfully sent
+        unsigned long long n_bytes     = 0;    // successfully sent, incl. headers
+        unsigned long long n_failed    = 0;    // datagrams failed to send
+        unsigned long long n_calls     = 0;    // send system calls
+        double             send_time   = 0.0;  // time spent sending, incl. pacing, in seconds
+    };
+
     UDPClient(unsigned short int port, std::string ipAddress);
     ~UDPClient()
     {
     }
-    int            Send(char* buf, unsigned int size);
+    int Send(char* buf, unsigned int size);
+
+    /**
+    Send a number of datagrams. On Linux in as few system calls as possible (sendmmsg), elsewhere one by one.
+    If a rate limit is set, datagrams are sent in bursts spread over time.
+    @param datagrams Datagrams to send
+    @param n Number of datagrams
+    @return Number of datagrams sent, sending stops at first failure
+    */
+    int SendMultiple(const Datagram* datagrams, unsigned int n);
+
+    /**
+    Limit rate of SendMultiple() to avoid overflowing receiver socket buffers with large bursts
+    @param bytes_per_second Max average rate, 0 means no limit
+    */
+    void SetRateLimit(double bytes_per_second)
+    {
+        rate_limit_ = bytes_per_second;
+    }
+    double GetRateLimit() const
+    {
+        return rate_limit_;
+    }
+
+    const Statistics& GetStatistics() const
+    {
+        return stats_;
+    }
+
     unsigned short GetPort() const
     {
         return port_;
@@ -98,6 +167,226 @@ public:
         return ipAddress_;
     }
 
+    // Max number of bytes sent in one go when pacing
+    static const unsigned int pacing_burst_size = 65536;
+
 private:
-    std::string ipAddress_;
-};
\ No newline at end of file
+    int SendBurst(const Datagram* datagrams, unsigned int n);
+
+    std::string                           ipAddress_;
+    double                                rate_limit_;
+    std::chrono::steady_clock::time_point next_send_time_;
+    Statistics                            stats_;
+    std::vector<char>                     scratch_;  // for composing datagrams on platforms without scatter/gather send
+};
+
+/**
+Reassembles frames, e.g. OSI messages, split into multiple UDP packages. Each package starts with a Header. Packages of
+a frame are numbered 1, 2, 3... and the number of the last one is negated, e.g. -1 for a frame fitting in one package.
+Frames with any package lost or out of order are dropped.
+*/
+class UDPFrameAssembler
+{
+public:
+    // This struct must match the sender side, see OSIReporter
+    struct Header
+    {
+        int          counter;   // package number within frame, negative for the last package
+        unsigned int datasize;  // number of payload bytes following the header
+        unsigned int frame_id;  // shared by all packages of a frame, increasing by one per frame
+    };
+
+    UDPFrameAssembler(unsigned int max_frame_size) : max_frame_size_(max_frame_size)
+    {
+    }
+
+    /**
+    Add a received package
+    @param package Header followed by payload
+    @param size Size of the package, including header
+    @return true if the package completed a frame, available by GetFrame() until next call
+    */
+    bool Add(const char* package, int size);
+
+    const char* GetFrame() const
+    {
+        return frame_.data();
+    }
+    unsigned int GetFrameSize() const
+    {
+        return frame_size_;
+    }
+
+    unsigned int GetNumberOfFrames() const
+    {
+        return n_frames_;
+    }
+    unsigned int GetNumberOfIncompleteFrames() const
+    {
+        return n_incomplete_;
+    }
+    unsigned int GetNumberOfMissedFrames() const
+    {
+        return n_missed_;
+    }
+
+private:
+    unsigned int      max_frame_size_;
+    std::vector<char> frame_;
+    unsigned int      frame_size_   = 0;
+    int               next_counter_ = 1;
+    bool              receiving_    = false;  // current frame intact so far
+    bool              started_      = false;  // any frame started
+    unsigned int      frame_id_     = 0;      // latest frame started
+    unsigned int      n_frames_     = 0;
+    unsigned int      n_incomplete_ = 0;
+    unsigned int      n_missed_     = 0;
+};
+
+/**
+Receives messages on any number of UDP ports in one thread, instead of one blocking receive per port and frame.
+Each port is opened as a mailbox, a lock-free single producer single consumer queue of messages. The thread (epoll
+on Linux, select elsewhere) drains all ready sockets into the mailboxes, from which readers pick up messages without
+waiting. WaitForMessages() acts as barrier, returning when all given mailboxes have a message. Hence waiting for
+N senders costs the time of the slowest one, not the sum of all.
+On platforms without thread support messages are received by the reader instead.
+*/
+class UDPInputMultiplexer
+{
+public:
+    static const unsigned int max_message_size = 1024;
+    static const unsigned int mailbox_capacity = 64;  // max number of queued messages per mailbox
+
+    class Mailbox
+    {
+    public:
+        unsigned short GetPort() const
+        {
+            return server_.GetPort();
+        }
+
+        /**
+        @return true if there is any message not yet taken
+        */
+        bool HasMessage() const
+        {
+            return head_.load() > tail_.load();
+        }
+
+        /**
+        Copy oldest message not yet taken
+        @param buf Destination
+        @param size Size of destination, longer messages are truncated
+        @return Size of message, 0 if no message
+        */
+        int Take(char* buf, unsigned int size);
+
+        /**
+        Copy latest message, skipping any older ones not yet taken
+        @param buf Destination
+        @param size Size of destination, longer messages are truncated
+        @return Size of message, 0 if no message
+        */
+        int TakeLatest(char* buf, unsigned int size);
+
+        /**
+        @return Number of messages received so far
+        */
+        unsigned long long GetNumberOfMessages() const
+        {
+            return head_.load() + n_overflow_.load();
+        }
+
+        /**
+        @return Number of messages never taken, either skipped by TakeLatest() or lost since the mailbox was full
+        */
+        unsigned long long GetNumberOfDropped() const
+        {
+            return n_skipped_ + n_overflow_.load();
+        }
+
+    private:
+        friend class UDPInputMultiplexer;
+
+        struct Message
+        {
+            unsigned int size;
+            char         data[max_message_size];
+        };
+
+        Mailbox(unsigned short port) : server_(port, 0), head_(0), tail_(0), n_overflow_(0), n_skipped_(0)
+        {
+        }
+        void Put(const char* buf, unsigned int size);
+        int  Drain(char* buf);  // receive all queued messages, buf is scratch of max_message_size
+        int  Copy(unsigned long long index, char* buf, unsigned int size);
+
+        UDPServer                       server_;
+        Message                         messages_[mailbox_capacity];
+        std::atomic<unsigned long long> head_;  // number of messages put, written by receiver only
+        std::atomic<unsigned long long> tail_;  // number of messages taken or skipped, written by reader only
+        std::atomic<unsigned long long> n_overflow_;
+        unsigned long long              n_skipped_;
+    };
+
+    /**
+    Shared instance, used by all controllers receiving input over UDP
+    */
+    static UDPInputMultiplexer& Inst();
+
+    UDPInputMultiplexer();
+    ~UDPInputMultiplexer();
+
+    /**
+    Open a UDP port and start receiving into a mailbox. The receiver thread is started with the first mailbox.
+    @param port Port number
+    @return Mailbox, owned by the multiplexer until closed, nullptr if the port could not be opened
+    */
+    Mailbox* Open(unsigned short port);
+
+    /**
+    Stop receiving on the port of the mailbox and delete it. The receiver thread is stopped with the last mailbox.
+    */
+    void Close(Mailbox* mailbox);
+
+    /**
+    Receive messages already queued on the port of the mailbox right away, instead of waiting for the receiver thread
+    @return Number of messages received
+    */
+    int Refresh(Mailbox* mailbox);
+
+    /**
+    Barrier, wait until all given mailboxes have a message, i.e. HasMessage() is true for each one
+    @param mailboxes Mailboxes to wait for
+    @param timeoutMs Max time to wait
+    @return true if all mailboxes have a message, false on timeout
+    */
+    bool WaitForMessages(const std::vector<Mailbox*>& mailboxes, unsigned int timeoutMs);
+
+    /**
+    Receive all pending messages, waiting for any to arrive at most given time. Normally done by the receiver thread.
+    @return Number of messages received
+    */
+    int Poll(unsigned int timeoutMs);
+
+    unsigned int GetNumberOfMailboxes() const
+    {
+        return static_cast<unsigned int>(mailboxes_.size());
+    }
+
+private:
+    std::vector<std::unique_ptr<Mailbox>> mailboxes_;
+    int                                   epoll_fd_;  // -1 if not used
+    std::atomic<bool>                     quit_;
+    std::atomic<int>                      n_waiting_;  // readers in WaitForMessages
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    std::mutex              mutex_;       // mailbox registry, held by the thread while delivering
+    std::mutex              wait_mutex_;  // for signaling new messages to waiting readers
+    std::condition_variable cv_;
+    std::thread             thread_;
+
+    void StartThread();
+    void StopThread();
+    void ThreadLoop();
+#endif
+};
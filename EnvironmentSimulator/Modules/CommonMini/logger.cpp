@@ -309,6 +309,8 @@ namespace esmini::common
 
     void TxtLogger::Log(const std::string& msg)
     {
+        std::lock_guard<std::mutex> lock(mutex_);
+
         try
         {
             if (consoleLoggingEnabled_)
@@ -19,6 +19,8 @@
 #include <string>
 #include <iostream>
 #include <cstdio>
+#include <mutex>
+#include <atomic>
 
 // Converts enum to its underlying integer type and formats it
 template <typename T>
@@ -144,11 +146,15 @@ namespace esmini::common
         // log verbosity level
         LogLevel logLevel_ = LogLevel::info;
         // log file
-        FILE* logFile_               = nullptr;
-        bool  firstConsoleLog_       = true;
-        bool  firstFileLog_          = true;
-        bool  consoleLoggingEnabled_ = true;
-        bool  fileLoggingEnabled_    = true;
+        FILE* logFile_         = nullptr;
+        bool  firstConsoleLog_ = true;
+        bool  firstFileLog_    = true;
+        // updated by each log call, possibly from multiple threads
+        std::atomic<bool> consoleLoggingEnabled_{true};
+        std::atomic<bool> fileLoggingEnabled_{true};
+
+        // serialize output from multiple threads, e.g. parallel controller stepping
+        std::mutex mutex_;
 
     };  // class TxtLogger
 
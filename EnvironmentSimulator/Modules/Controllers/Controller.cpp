@@ -95,6 +95,20 @@ void Controller::Step(double timeStep)
     }
 }
 
+void Controller::SaveState(SE_StateStream& stream)
+{
+    stream.Write(active_domains_);
+    stream.Write(mode_);
+}
+
+int Controller::RestoreState(SE_StateStream& stream)
+{
+    stream.Read(active_domains_);
+    stream.Read(mode_);
+
+    return stream.Good() ? 0 : -1;
+}
+
 void Controller::LinkObject(Object* object)
 {
     object_ = object;
@@ -107,6 +107,49 @@ namespace scenarioengine
         // Base class Step function should be called from derived classes
         virtual void Step(double timeStep);
 
+        /**
+        Perception phase, e.g. detection of surrounding entities, performed prior to Step
+        All active controllers are prepared before any of them is stepped, so they perceive the same state.
+        May run in parallel with other controllers, hence it must not modify any entity nor log,
+        only update internal state of the controller itself. Step() will call it unless already done.
+        Safe to use: const Position queries, e.g. Delta(), Distance() and GetProbeInfo(), which only read the
+        road network and use local path search state; Object::FreeSpaceDistance(); Entities::GetObjectsInRadius()
+        and Entities::GetClosestInLane() with scratch buffers owned by the controller; ScenarioEngine::GetDistance(),
+        which locks its cache.
+        @param timeStep Step size of the upcoming step
+        */
+        virtual void Prepare(double timeStep)
+        {
+            (void)timeStep;
+            prepared_ = true;
+        }
+
+        /**
+        Serialize runtime state of the controller into a binary stream, e.g. for simulation snapshots
+        Derived controllers with internal state should extend it, calling the base class first
+        @param stream Stream to append the state to
+        */
+        virtual void SaveState(SE_StateStream& stream);
+
+        /**
+        Restore runtime state previously stored by SaveState()
+        @param stream Stream to read the state from
+        @return 0 on success, -1 on corrupt data
+        */
+        virtual int RestoreState(SE_StateStream& stream);
+
+        /**
+        Reset controller to the state of a newly created instance, so that it can be reused instead of deleted
+        Controller types supporting reuse need to override it, the base class version refuses
+        @param args Arguments as for instantiating a new controller
+        @return 0 on success, -1 if reuse not supported
+        */
+        virtual int ResetInstance(InitArgs* args)
+        {
+            (void)args;
+            return -1;
+        }
+
         bool Active() const
         {
             return (active_domains_ != static_cast<unsigned int>(ControlDomainMasks::DOMAIN_MASK_NONE));
@@ -165,6 +208,7 @@ namespace scenarioengine
         ScenarioPlayer*      player_;
         bool                 align_to_road_heading_on_deactivation_ = false;
         bool                 align_to_road_heading_on_activation_   = false;
+        bool                 prepared_                              = false;  // Prepare() done for upcoming step
 
         void AlignToRoadHeading();
     };
@@ -81,15 +81,16 @@ void ControllerACC::InitPostPlayer()
     // player_->AddObjectSensor(object_, 4.0, 0.0, 0.5, 0.0, 1.0, 50.0, 1.2, 100);
 }
 
-void ControllerACC::Step(double timeStep)
+void ControllerACC::Prepare(double timeStep)
 {
+    (void)timeStep;
     double minGapLength = LARGE_NUMBER;
     // double minSpeedDiff = 0.0; // TODO: Commented out because it is not used
-    int          minObjIndex        = -1;
-    const double minDist            = 3.0;  // minimum distance to keep to lead vehicle
-    const double accelerationFactor = 0.7;
+    Object*      minObj  = nullptr;
+    const double minDist = 3.0;  // minimum distance to keep to lead vehicle
 
     // First check if speed has been set from somewhere else (another action or controller), respect it and update setSpeed
+    setSpeedUpdated_ = false;
     if (virtual_)
     {
         currentSpeed_ = object_->GetSpeed();
@@ -98,74 +99,70 @@ void ControllerACC::Step(double timeStep)
         // mode_ == ControlOperationMode::MODE_ADDITIVE &&
         abs(object_->GetSpeed() - currentSpeed_) > 1e-3)
     {
-        LOG_INFO("New setspeed: {:5.2f}", setSpeed_);
-        setSpeed_ = object_->GetSpeed();
+        setSpeedUpdated_ = true;  // log in Step, since Prepare might run in parallel with other controllers
+        setSpeed_        = object_->GetSpeed();
     }
 
     // Lookahead distance is at least 50m or twice the distance required to stop
     // https://www.symbolab.com/solver/equation-calculator/s%5Cleft(t%5Cright)%3D2%5Cleft(m%2Bvt%2B%5Cfrac%7B1%7D%7B2%7Dat%5E%7B2%7D%5Cright)%2C%20t%3D%5Cfrac%7B-v%7D%7Ba%7D
     double lookaheadDist = MAX(50.0, 2 * minDist - pow(currentSpeed_, 2) / -object_->GetMaxDeceleration());  // (m)
-    for (size_t i = 0; i < entities_->object_.size(); i++)
+
+    // Closest vehicle ahead in own lane, along any linked roads, within double timeGap
+    LaneNeighbor lead;
+    if (entities_->GetClosestInLane(object_, 0, true, lookaheadDist, lateralDist_, lead, neighbors_, neighbor_scratch_))
     {
-        Object* pivot_obj = entities_->object_[i];
-        if (pivot_obj == nullptr || pivot_obj == object_)
+        minGapLength = lead.gap;
+        minObj       = lead.object;
+    }
+
+    // Also check for really close entities in front, e.g. cutting in, among the candidates of the lane query
+    for (size_t i = 0; i < neighbors_.size(); i++)
+    {
+        Object* pivot_obj = neighbors_[i];
+        if (pivot_obj == nullptr || pivot_obj == object_ || pivot_obj == lead.object)
         {
             continue;
         }
 
-        // Measure longitudinal distance to all vehicles, don't utilize costly freespace option, instead measure ref point to ref point
-        roadmanager::PositionDiff diff;
-        if (object_->pos_.Delta(&pivot_obj->pos_, diff, false, lookaheadDist) == true)  // look only double timeGap ahead
-        {
-            // path exists between position objects
-
-            // adjust longitudinal dist wrt bounding boxes
-            double adjustedGapLength = diff.ds;
-            double dHeading          = GetAbsAngleDifference(object_->pos_.GetH(), pivot_obj->pos_.GetH());
-            if (dHeading < M_PI_2)  // objects are pointing roughly in the same direction
-            {
-                adjustedGapLength -=
-                    (static_cast<double>(object_->boundingbox_.dimensions_.length_) / 2.0 + static_cast<double>(object_->boundingbox_.center_.x_)) +
-                    (static_cast<double>(pivot_obj->boundingbox_.dimensions_.length_) / 2.0 -
-                     static_cast<double>(pivot_obj->boundingbox_.center_.x_));
-            }
-            else  // objects are pointing roughly in the opposite direction
-            {
-                adjustedGapLength -=
-                    (static_cast<double>(object_->boundingbox_.dimensions_.length_) / 2.0 + static_cast<double>(object_->boundingbox_.center_.x_)) +
-                    (static_cast<double>(pivot_obj->boundingbox_.dimensions_.length_) / 2.0 +
-                     static_cast<double>(pivot_obj->boundingbox_.center_.x_));
-            }
-
-            // dLaneId == 0 indicates there is linked path between object lanes, i.e. no lane changes needed
-            if (diff.dLaneId == 0 && adjustedGapLength > 0 && adjustedGapLength < minGapLength && abs(diff.dt) < lateralDist_)
-            {
-                minGapLength = adjustedGapLength;
-                // minSpeedDiff = currentSpeed_ - pivot_obj->GetSpeed();
-                minObjIndex = static_cast<int>(i);  // TODO: size_t to int
-            }
-        }
+        double x_local, y_local;
+        object_->FreeSpaceDistance(pivot_obj, &y_local, &x_local);
 
-        // Also check for really close entities in front
-        if (static_cast<unsigned int>(minObjIndex) != i)
+        if (x_local > 0 && x_local < minGapLength &&
+            x_local < 1.0 + static_cast<double>(pivot_obj->boundingbox_.dimensions_.length_) + 0.5 * MAX(0.0, currentSpeed_ - pivot_obj->GetSpeed()) &&
+            y_local < 0.2 && y_local > -0.5)  // yield some more for right hand traffic
         {
-            double x_local, y_local;
-            object_->FreeSpaceDistance(pivot_obj, &y_local, &x_local);
-
-            if (x_local > 0 &&
-                x_local <
-                    1.0 + static_cast<double>(pivot_obj->boundingbox_.dimensions_.length_) + 0.5 * MAX(0.0, currentSpeed_ - pivot_obj->GetSpeed()) &&
-                y_local < 0.2 && y_local > -0.5)  // yield some more for right hand traffic
-            {
-                minGapLength = x_local;
-                // minSpeedDiff = currentSpeed_ - pivot_obj->GetSpeed();
-                minObjIndex = static_cast<int>(i);
-            }
+            minGapLength = x_local;
+            // minSpeedDiff = currentSpeed_ - pivot_obj->GetSpeed();
+            minObj = pivot_obj;
         }
     }
 
+    leadObj_  = minObj;
+    leadGap_  = minGapLength;
+    prepared_ = true;
+}
+
+void ControllerACC::Step(double timeStep)
+{
+    const double minDist            = 3.0;  // minimum distance to keep to lead vehicle
+    const double accelerationFactor = 0.7;
+
+    if (!prepared_)
+    {
+        Prepare(timeStep);
+    }
+    prepared_ = false;
+
+    if (setSpeedUpdated_)
+    {
+        LOG_INFO("New setspeed: {:5.2f}", setSpeed_);
+    }
+
+    double  minGapLength = leadGap_;
+    Object* minObj       = leadObj_;
+
     double acc = 0.0;
-    if (minObjIndex > -1)
+    if (minObj != nullptr)
     {
         if (minGapLength < 1)
         {
@@ -174,12 +171,12 @@ void ControllerACC::Step(double timeStep)
         else
         {
             // Follow distance = minimum distance + timeGap_ seconds
-            double speedForTimeGap = MAX(currentSpeed_, entities_->object_[static_cast<unsigned int>(minObjIndex)]->GetSpeed());
+            double speedForTimeGap = MAX(currentSpeed_, minObj->GetSpeed());
             double followDist      = minDist + timeGap_ * fabs(speedForTimeGap);  // (m)
             double dist            = minGapLength - followDist;
             double distFactor      = MIN(1.0, dist / followDist);
 
-            double dvMin = currentSpeed_ - MIN(setSpeed_, entities_->object_[static_cast<unsigned int>(minObjIndex)]->GetSpeed());
+            double dvMin = currentSpeed_ - MIN(setSpeed_, minObj->GetSpeed());
             double dvSet = currentSpeed_ - setSpeed_;
 
             acc = 2.5 * distFactor - distFactor * dvSet - (1 - distFactor) * dvMin;  // weighted combination of relative distance and speed
@@ -191,9 +188,7 @@ void ControllerACC::Step(double timeStep)
             currentSpeed_ = MIN(MAX(0.0, currentSpeed_), setSpeed_);
         }
 
-        object_->SetSensorPosition(entities_->object_[static_cast<unsigned int>(minObjIndex)]->pos_.GetX(),
-                                   entities_->object_[static_cast<unsigned int>(minObjIndex)]->pos_.GetY(),
-                                   entities_->object_[static_cast<unsigned int>(minObjIndex)]->pos_.GetZ());
+        object_->SetSensorPosition(minObj->pos_.GetX(), minObj->pos_.GetY(), minObj->pos_.GetZ());
     }
     else
     {
@@ -263,4 +258,47 @@ void ControllerACC::ReportKeyEvent(int key, bool down)
 {
     (void)key;
     (void)down;
-}
\ No newline at end of file
+}
+
+void ControllerACC::SaveState(SE_StateStream& stream)
+{
+    Controller::SaveState(stream);
+    stream.Write(vehicle_);
+    stream.Write(active_);
+    stream.Write(setSpeed_);
+    stream.Write(currentSpeed_);
+    stream.Write(setSpeedSet_);
+    stream.Write(lateralDist_);
+}
+
+int ControllerACC::RestoreState(SE_StateStream& stream)
+{
+    if (Controller::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(vehicle_);
+    stream.Read(active_);
+    stream.Read(setSpeed_);
+    stream.Read(currentSpeed_);
+    stream.Read(setSpeedSet_);
+    stream.Read(lateralDist_);
+
+    return stream.Good() ? 0 : -1;
+}
+
+int ControllerACC::ResetInstance(InitArgs* args)
+{
+    // move assignment from a new instance would discard allocated storage of the neighbor query, so keep it aside
+    std::vector<Object*> neighbors = std::move(neighbors_);
+    std::vector<size_t>  scratch   = std::move(neighbor_scratch_);
+
+    *this = ControllerACC(args);
+
+    neighbors_        = std::move(neighbors);
+    neighbor_scratch_ = std::move(scratch);
+    neighbors_.clear();
+    neighbor_scratch_.clear();
+
+    return 0;
+}
@@ -38,6 +38,10 @@ namespace scenarioengine
         void Init();
         void InitPostPlayer();
         void Step(double timeStep);
+        void Prepare(double timeStep);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
+        int  ResetInstance(InitArgs* args);
         int  Activate(const ControlActivationMode (&mode)[static_cast<unsigned int>(ControlDomains::COUNT)]);
         void ReportKeyEvent(int key, bool down);
         void SetSetSpeed(double setSpeed)
@@ -46,14 +50,19 @@ namespace scenarioengine
         }
 
     private:
-        vehicle::Vehicle vehicle_;
-        bool             active_;
-        double           timeGap_;  // target headway time
-        double           setSpeed_;
-        double           lateralDist_;
-        double           currentSpeed_;
-        bool             setSpeedSet_;
-        bool             virtual_;
+        vehicle::Vehicle     vehicle_;
+        bool                 active_;
+        double               timeGap_;  // target headway time
+        double               setSpeed_;
+        double               lateralDist_;
+        double               currentSpeed_;
+        bool                 setSpeedSet_;
+        bool                 virtual_;
+        bool                 setSpeedUpdated_ = false;         // speed changed externally, detected in Prepare()
+        Object*              leadObj_         = nullptr;       // lead vehicle found in Prepare(), nullptr if none
+        double               leadGap_         = LARGE_NUMBER;  // free space to lead vehicle
+        std::vector<Object*> neighbors_;                       // entities close enough to be considered, reused between steps
+        std::vector<size_t>  neighbor_scratch_;                // working memory for the neighbor query
     };
 
     Controller* InstantiateControllerACC(void* args);
@@ -230,8 +230,16 @@ void ControllerALKS_R157SM::Init()
     Controller::Init();
 }
 
+void ControllerALKS_R157SM::Prepare(double timeStep)
+{
+    (void)timeStep;
+    model_->Prepare();
+    prepared_ = true;
+}
+
 void ControllerALKS_R157SM::Step(double timeStep)
 {
+    prepared_    = false;
     double speed = model_->Step(timeStep);
 
     if (mode_ == ControlOperationMode::MODE_OVERRIDE)
@@ -282,6 +290,37 @@ void ControllerALKS_R157SM::ReportKeyEvent(int key, bool down)
     (void)down;
 }
 
+bool ControllerALKS_R157SM::Model::TrackFocusOnly()
+{
+    return object_in_focus_.obj && GetModelType() == ModelType::ReferenceDriver &&
+           (reinterpret_cast<ReferenceDriver*>(this))->GetPhase() != ControllerALKS_R157SM::ReferenceDriver::Phase::INACTIVE && GetFullStop();
+}
+
+void ControllerALKS_R157SM::Model::Prepare()
+{
+    measured_.clear();
+    prepared_ = true;
+
+    if (entities_ == 0 || TrackFocusOnly())
+    {
+        return;  // nothing to scan
+    }
+
+    // Only entities nearby can be within detection range along the road. Radius is generous since road distance might be
+    // shorter than euclidean distance on outer lanes of curves, and entities might have moved since indexed.
+    entities_->GetObjectsInRadius(veh_->pos_.GetX(), veh_->pos_.GetY(), 2 * GetMaxRange() + 20.0, neighbors_, neighbor_scratch_);
+
+    for (size_t i = 0; i < neighbors_.size(); i++)
+    {
+        ObjectInfo info;
+        info.obj = neighbors_[i];
+        if (Measure(info) == 0)
+        {
+            measured_.push_back(info);
+        }
+    }
+}
+
 int ControllerALKS_R157SM::Model::Detect()
 {
     ObjectInfo candidate_obj_info, tmp_obj_info;
@@ -292,14 +331,25 @@ int ControllerALKS_R157SM::Model::Detect()
         return -1;
     }
 
-    for (size_t i = 0; i < entities_->object_.size(); i++)
+    if (!prepared_)
     {
-        tmp_obj_info.obj = entities_->object_[i];
+        Prepare();
+    }
+    prepared_ = false;
 
-        if (Process(tmp_obj_info) != 0)
-        {
-            continue;
-        }
+    for (size_t i = 0; i < measured_.size(); i++)
+    {
+        // take over the measurements, other fields, e.g. action, are kept from previous object as in a full scan
+        const ObjectInfo& info = measured_[i];
+        tmp_obj_info.obj       = info.obj;
+        tmp_obj_info.dLaneId   = info.dLaneId;
+        tmp_obj_info.dist_lat  = info.dist_lat;
+        tmp_obj_info.dist_long = info.dist_long;
+        tmp_obj_info.dv_s      = info.dv_s;
+        tmp_obj_info.dv_t      = info.dv_t;
+        tmp_obj_info.thw       = info.thw;
+        tmp_obj_info.ttc       = info.ttc;
+        LogObjectInfo(tmp_obj_info);
 
         if (!CheckSafety(&tmp_obj_info))
         {
@@ -357,6 +407,31 @@ int ControllerALKS_R157SM::Model::Detect()
 }
 
 int ControllerALKS_R157SM::Model::Process(ObjectInfo& info)
+{
+    if (Measure(info) != 0)
+    {
+        return -1;
+    }
+
+    LogObjectInfo(info);
+
+    return 0;
+}
+
+void ControllerALKS_R157SM::Model::LogObjectInfo(const ObjectInfo& info)
+{
+    R157_LOG(3,
+             "{} relative speed s, t: {:.2f}, {:.2f} dist: {:.2f}, {:.2f} dLane {} TTC: {:.2f}",
+             info.obj->GetName(),
+             info.dv_s,
+             info.dv_t,
+             info.dist_long,
+             info.dist_lat,
+             info.dLaneId,
+             info.ttc);
+}
+
+int ControllerALKS_R157SM::Model::Measure(ObjectInfo& info)
 {
     // Find closest object
     // Consider all vehicles:
@@ -425,16 +500,6 @@ int ControllerALKS_R157SM::Model::Process(ObjectInfo& info)
                     info.ttc = LARGE_NUMBER;
                 }
 
-                R157_LOG(3,
-                         "{} relative speed s, t: {:.2f}, {:.2f} dist: {:.2f}, {:.2f} dLane {} TTC: {:.2f}",
-                         info.obj->GetName(),
-                         info.dv_s,
-                         info.dv_t,
-                         info.dist_long,
-                         info.dist_lat,
-                         info.dLaneId,
-                         info.ttc);
-
                 return 0;
             }
         }
@@ -447,12 +512,12 @@ double ControllerALKS_R157SM::Model::Step(double timeStep)
 {
     dt_ = timeStep;
 
-    if (object_in_focus_.obj && GetModelType() == ModelType::ReferenceDriver &&
-        (reinterpret_cast<ReferenceDriver*>(this))->GetPhase() != ControllerALKS_R157SM::ReferenceDriver::Phase::INACTIVE && GetFullStop())
+    if (TrackFocusOnly())
     {
         // reference driver ongoing action in combination with FullStop mode
         // skip full re-scan, just update measurements for object already in focus
         Process(object_in_focus_);
+        prepared_ = false;
     }
     else
     {
@@ -173,7 +173,16 @@ namespace scenarioengine
             // Scan traffic and select object to focus on, if any
             int Detect();
 
-            int Process(ObjectInfo& info);
+            // Measure objects for the next Detect(), see Controller::Prepare(). Does not log nor modify any entity.
+            void Prepare();
+
+            // Measure and log distance and relative speed of an object. Returns 0 if the object is relevant, i.e. ahead
+            int  Process(ObjectInfo& info);
+            int  Measure(ObjectInfo& info);
+            void LogObjectInfo(const ObjectInfo& info);
+
+            // True if only the object in focus is tracked, instead of a full scan
+            bool TrackFocusOnly();
 
             // Returns true if object is not in or intruding the ego lane, else false
             virtual bool CheckSafety(ObjectInfo* info)
@@ -208,11 +217,15 @@ namespace scenarioengine
             {
             }
 
-            ModelType  type_;
-            Vehicle*   veh_;
-            Entities*  entities_;
-            ObjectInfo object_in_focus_;
-            double     cut_in_detected_timestamp_;
+            ModelType               type_;
+            Vehicle*                veh_;
+            Entities*               entities_;
+            ObjectInfo              object_in_focus_;
+            double                  cut_in_detected_timestamp_;
+            std::vector<Object*>    neighbors_;         // candidates from neighbor index, reused between steps
+            std::vector<size_t>     neighbor_scratch_;  // working memory for the neighbor query
+            std::vector<ObjectInfo> measured_;          // objects ahead, measured by Prepare() for next Detect()
+            bool                    prepared_ = false;  // measured_ is up to date
 
             // driver parameters
             double rt_;          // reaction time
@@ -612,6 +625,7 @@ namespace scenarioengine
 
         void Init();
         void Step(double timeStep);
+        void Prepare(double timeStep);
         void LinkObject(Object* object);
         int  Activate(const ControlActivationMode (&mode)[static_cast<unsigned int>(ControlDomains::COUNT)]);
         void ReportKeyEvent(int key, bool down);
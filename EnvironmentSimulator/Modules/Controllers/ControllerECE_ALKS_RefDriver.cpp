@@ -502,3 +502,38 @@ void ControllerECE_ALKS_REF_DRIVER::ReportKeyEvent(int key, bool down)
     (void)key;
     (void)down;
 }
+
+void ControllerECE_ALKS_REF_DRIVER::SaveState(SE_StateStream& stream)
+{
+    Controller::SaveState(stream);
+    stream.Write(vehicle_);
+    stream.Write(active_);
+    stream.Write(setSpeed_);
+    stream.Write(currentSpeed_);
+    stream.Write(dtFreeCutOut_);
+    stream.Write(cutInDetected_);
+    stream.Write(waitTime_);
+    stream.Write(driverBraking_);
+    stream.Write(aebBraking_);
+    stream.Write(timeSinceBraking_);
+}
+
+int ControllerECE_ALKS_REF_DRIVER::RestoreState(SE_StateStream& stream)
+{
+    if (Controller::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(vehicle_);
+    stream.Read(active_);
+    stream.Read(setSpeed_);
+    stream.Read(currentSpeed_);
+    stream.Read(dtFreeCutOut_);
+    stream.Read(cutInDetected_);
+    stream.Read(waitTime_);
+    stream.Read(driverBraking_);
+    stream.Read(aebBraking_);
+    stream.Read(timeSinceBraking_);
+
+    return stream.Good() ? 0 : -1;
+}
@@ -37,6 +37,13 @@ ControllerExternal::ControllerExternal(InitArgs* args) : Controller(args), useGh
     }
 }
 
+int ControllerExternal::ResetInstance(InitArgs* args)
+{
+    *this = ControllerExternal(args);
+
+    return 0;
+}
+
 void ControllerExternal::Init()
 {
     if (object_)
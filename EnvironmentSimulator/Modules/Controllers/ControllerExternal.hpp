@@ -43,6 +43,7 @@ namespace scenarioengine
         }
 
         void Init();
+        int  ResetInstance(InitArgs* args);
         void Step(double timeStep);
         int  Activate(const ControlActivationMode (&mode)[static_cast<unsigned int>(ControlDomains::COUNT)]);
         void ReportKeyEvent(int key, bool down);
@@ -267,4 +267,21 @@ void ControllerFollowGhost::ReportKeyEvent(int key, bool down)
 {
     (void)key;
     (void)down;
-}
\ No newline at end of file
+}
+
+void ControllerFollowGhost::SaveState(SE_StateStream& stream)
+{
+    Controller::SaveState(stream);
+    stream.Write(vehicle_);
+}
+
+int ControllerFollowGhost::RestoreState(SE_StateStream& stream)
+{
+    if (Controller::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(vehicle_);
+
+    return stream.Good() ? 0 : -1;
+}
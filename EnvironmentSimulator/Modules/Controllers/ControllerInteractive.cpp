@@ -180,3 +180,24 @@ void ControllerInteractive::ReportKeyEvent(int key, bool down)
         }
     }
 }
+
+void ControllerInteractive::SaveState(SE_StateStream& stream)
+{
+    Controller::SaveState(stream);
+    stream.Write(vehicle_);
+    stream.Write(accelerate);
+    stream.Write(steer);
+}
+
+int ControllerInteractive::RestoreState(SE_StateStream& stream)
+{
+    if (Controller::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(vehicle_);
+    stream.Read(accelerate);
+    stream.Read(steer);
+
+    return stream.Good() ? 0 : -1;
+}
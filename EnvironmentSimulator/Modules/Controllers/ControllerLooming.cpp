@@ -44,8 +44,10 @@ ControllerLooming::ControllerLooming(InitArgs* args) : Controller(args)
     align_to_road_heading_on_activation_   = true;
 }
 
-void ControllerLooming::Step(double timeStep)
+void ControllerLooming::Prepare(double timeStep)
 {
+    (void)timeStep;
+
     // looming controller properties
     double const nearPointDistance = 10.0;
     double       farPointDistance  = 80.0;
@@ -59,6 +61,10 @@ void ControllerLooming::Step(double timeStep)
     bool   isIntersection = false;
     double dist           = 0.0;
 
+    // any issue is logged in Step, since Prepare might run in parallel with other controllers
+    prepareStatus_ = PrepareStatus::OK;
+    prepared_      = true;
+
     currentSpeed_ = object_->GetSpeed();
 
     roadmanager::RoadProbeInfo s_data;
@@ -72,7 +78,7 @@ void ControllerLooming::Step(double timeStep)
         roadmanager::Road* road = odr->GetRoadById(object_->pos_.GetTrackId());
         if (road == nullptr)
         {
-            LOG_INFO("Road ID {}", object_->pos_.GetTrackId());
+            prepareStatus_ = PrepareStatus::MISSING_ROAD;
             return;
         }
 
@@ -150,7 +156,7 @@ void ControllerLooming::Step(double timeStep)
                 lsec = roadTemp->GetLaneSectionByIdx(current_laneSec_idx);  // pick lanesec by lanesec id
                 if (lsec == nullptr)
                 {
-                    LOG_WARN("Unexpected missing lane Section");
+                    prepareStatus_ = PrepareStatus::MISSING_LANE_SECTION;
                     return;
                 }
                 if (road_counter == 0)
@@ -173,7 +179,7 @@ void ControllerLooming::Step(double timeStep)
                         lane->GetLink(direction_prev == 1 ? roadmanager::LinkType::SUCCESSOR : roadmanager::LinkType::PREDECESSOR);
                     if (link == nullptr)
                     {
-                        LOG_WARN("Unexpected missing lane link");
+                        prepareStatus_ = PrepareStatus::MISSING_LANE_LINK;
                         return;
                     }
 
@@ -246,7 +252,6 @@ void ControllerLooming::Step(double timeStep)
                                 if (abs(angleDiff) > SMALL_NUMBER &&  // skip points at same angle (e.g. identical position)
                                     SIGN(angleDiff) != SIGN(angle_diff_prev[m]))
                                 {
-                                    LOG_DEBUG("has far tan");
                                     hasFarTan = true;
                                     far_x     = far_x_prev[m];
                                     far_y     = far_y_prev[m];
@@ -288,10 +293,9 @@ void ControllerLooming::Step(double timeStep)
         }
     }
 
-    bool         hasLeadFar   = false;
-    int          minObjIndex  = -1;
-    double       minGapLength = LARGE_NUMBER;
-    const double minDist      = 3.0;  // minimum distance to keep to lead vehicle
+    bool    hasLeadFar   = false;
+    Object* minObj       = nullptr;
+    double  minGapLength = LARGE_NUMBER;
 
     const double minLateralDist = 5.0;
     for (size_t i = 0; i < entities_->object_.size(); i++)
@@ -330,7 +334,7 @@ void ControllerLooming::Step(double timeStep)
             if (diff.dLaneId == 0 && adjustedGapLength > 0 && adjustedGapLength < minGapLength && abs(diff.dt) < minLateralDist)
             {
                 minGapLength = adjustedGapLength;
-                minObjIndex  = static_cast<int>(i);  // TODO: size_t to int
+                minObj       = pivot_obj;
 
                 // find far point from lead as reference, if lead <= farPointDistance(80) m
                 if (minGapLength <= farPointDistance)
@@ -347,7 +351,6 @@ void ControllerLooming::Step(double timeStep)
                     hasLeadFar = true;
                     far_angle  = GetAngleInIntervalMinusPIPlusPI(
                         atan2(object_->pos_.GetY() - pivot_obj->pos_.GetY(), object_->pos_.GetX() - pivot_obj->pos_.GetX()) - object_->pos_.GetH());
-                    LOG_DEBUG("new far: {:.2f}, {:.2f}", pivot_obj->pos_.GetX(), pivot_obj->pos_.GetY());
                     far_x = pivot_obj->pos_.GetX();
                     far_y = pivot_obj->pos_.GetY();
                 }
@@ -365,7 +368,55 @@ void ControllerLooming::Step(double timeStep)
         far_y = s_data.road_lane_info.pos[1];
     }
 
-    if (minObjIndex > -1)
+    nearAngle_  = nearAngle;
+    farAngle_   = far_angle;
+    farX_       = far_x;
+    farY_       = far_y;
+    hasLeadFar_ = hasLeadFar;
+    leadObj_    = minObj;
+    leadGap_    = minGapLength;
+}
+
+void ControllerLooming::Step(double timeStep)
+{
+    const double minDist = 3.0;  // minimum distance to keep to lead vehicle
+
+    if (!prepared_)
+    {
+        Prepare(timeStep);
+    }
+    prepared_ = false;
+
+    if (prepareStatus_ == PrepareStatus::MISSING_ROAD)
+    {
+        LOG_INFO("Road ID {}", object_->pos_.GetTrackId());
+        return;
+    }
+    else if (prepareStatus_ == PrepareStatus::MISSING_LANE_SECTION)
+    {
+        LOG_WARN("Unexpected missing lane Section");
+        return;
+    }
+    else if (prepareStatus_ == PrepareStatus::MISSING_LANE_LINK)
+    {
+        LOG_WARN("Unexpected missing lane link");
+        return;
+    }
+
+    if (hasFarTan)
+    {
+        LOG_DEBUG("has far tan");
+    }
+    if (hasLeadFar_)
+    {
+        LOG_DEBUG("new far: {:.2f}, {:.2f}", farX_, farY_);
+    }
+
+    double nearAngle    = nearAngle_;
+    double far_angle    = farAngle_;
+    double minGapLength = leadGap_;
+
+    if (leadObj_ != nullptr)
     {
         if (minGapLength < 1)
         {
@@ -373,12 +424,12 @@ void ControllerLooming::Step(double timeStep)
         }
         else
         {
-            double speedForTimeGap = MAX(currentSpeed_, entities_->object_[static_cast<unsigned int>(minObjIndex)]->GetSpeed());
+            double speedForTimeGap = MAX(currentSpeed_, leadObj_->GetSpeed());
             double followDist      = minDist + timeGap_ * fabs(speedForTimeGap);  // (m)
             double distRem         = minGapLength - followDist;
             double distFactor      = MIN(1.0, distRem / followDist);
 
-            double dvMin = currentSpeed_ - MIN(setSpeed_, entities_->object_[static_cast<unsigned int>(minObjIndex)]->GetSpeed());
+            double dvMin = currentSpeed_ - MIN(setSpeed_, leadObj_->GetSpeed());
             double dvSet = currentSpeed_ - setSpeed_;
 
             acc = distFactor - distFactor * dvSet - (1 - distFactor) * dvMin;  // weighted combination of relative distance and speed
@@ -412,10 +463,10 @@ void ControllerLooming::Step(double timeStep)
     gateway_->updateObjectWheelAngle(object_->GetId(), 0.0, vehicle_.wheelAngle_);
 
     gateway_->updateObjectSpeed(object_->GetId(), 0.0, vehicle_.speed_);
-    object_->sensor_pos_[0] = far_x;
-    object_->sensor_pos_[1] = far_y;
+    object_->sensor_pos_[0] = farX_;
+    object_->sensor_pos_[1] = farY_;
 
-    object_->SetSensorPosition(far_x, far_y, 0.0);
+    object_->SetSensorPosition(farX_, farY_, 0.0);
 
     Controller::Step(timeStep);
 }
@@ -464,3 +515,36 @@ void ControllerLooming::ReportKeyEvent(int key, bool down)
     (void)key;
     (void)down;
 }
+
+void ControllerLooming::SaveState(SE_StateStream& stream)
+{
+    Controller::SaveState(stream);
+    stream.Write(vehicle_);
+    stream.Write(active_);
+    stream.Write(setSpeed_);
+    stream.Write(currentSpeed_);
+    stream.Write(setSpeedSet_);
+    stream.Write(prevNearAngle);
+    stream.Write(prevFarAngle);
+    stream.Write(steering);
+    stream.Write(acc);
+}
+
+int ControllerLooming::RestoreState(SE_StateStream& stream)
+{
+    if (Controller::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(vehicle_);
+    stream.Read(active_);
+    stream.Read(setSpeed_);
+    stream.Read(currentSpeed_);
+    stream.Read(setSpeedSet_);
+    stream.Read(prevNearAngle);
+    stream.Read(prevFarAngle);
+    stream.Read(steering);
+    stream.Read(acc);
+
+    return stream.Good() ? 0 : -1;
+}
@@ -56,6 +56,9 @@ namespace scenarioengine
             setSpeed_ = setSpeed;
         }
         void Step(double timeStep);
+        void Prepare(double timeStep);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
         bool hasFarTan;
         bool getHasFarTan() const
         {
@@ -75,6 +78,23 @@ namespace scenarioengine
         double           acc            = 0.0;
         double           steering_rate_ = 4.0;
         double           angleDiff      = 0.0;
+
+        // perception result of Prepare(), for next Step()
+        enum class PrepareStatus
+        {
+            OK,
+            MISSING_ROAD,
+            MISSING_LANE_SECTION,
+            MISSING_LANE_LINK
+        };
+        PrepareStatus prepareStatus_ = PrepareStatus::OK;
+        double        nearAngle_     = 0.0;
+        double        farAngle_      = 0.0;
+        double        farX_          = 0.0;
+        double        farY_          = 0.0;
+        bool          hasLeadFar_    = false;
+        Object*       leadObj_       = nullptr;  // lead vehicle, nullptr if none
+        double        leadGap_       = LARGE_NUMBER;
     };
 
     Controller* InstantiateControllerLooming(void* args);
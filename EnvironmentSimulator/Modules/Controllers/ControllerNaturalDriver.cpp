@@ -127,9 +127,21 @@ void ControllerNaturalDriver::InitPostPlayer()
     // player_->AddObjectSensor(object_, 4.0, 0.0, 0.5, 0.0, 1.0, 50.0, 1.2, 100);
 }
 
-void ControllerNaturalDriver::Step(double dt)
+void ControllerNaturalDriver::Prepare(double dt)
 {
+    (void)dt;
     UpdateSurroundingVehicles();
+    prepared_ = true;
+}
+
+void ControllerNaturalDriver::Step(double dt)
+{
+    if (!prepared_)
+    {
+        Prepare(dt);
+    }
+    prepared_ = false;
+
     double acceleration = 0.0;
 
     if (State::DRIVE == state_)
@@ -295,7 +307,10 @@ void ControllerNaturalDriver::UpdateSurroundingVehicles()
 // Simple distance calc to find only relevant vehicles around ego
 void ControllerNaturalDriver::FilterSurroundingVehicles()
 {
-    for (const auto& obj : entities_->object_)
+    // Pre-select by means of the neighbor index, using the tracking limit as radius
+    entities_->GetObjectsInRadius(object_->pos_.GetX(), object_->pos_.GetY(), lookahead_dist_ * 2, neighbors_, neighbor_scratch_);
+
+    for (const auto& obj : neighbors_)
     {
         if (obj->GetId() == object_->GetId())
         {
@@ -603,3 +618,36 @@ bool ControllerNaturalDriver::AdjacentLanesAvailable()
 
     return true;
 }
+
+void ControllerNaturalDriver::SaveState(SE_StateStream& stream)
+{
+    Controller::SaveState(stream);
+    stream.Write(active_);
+    stream.Write(desired_speed_);
+    stream.Write(current_speed_);
+    stream.Write(lane_change_injected);
+    stream.Write(state_);
+    stream.Write(lane_change_delay_);
+    stream.Write(lane_change_cooldown_);
+    stream.Write(target_lane_);
+    stream.Write(initiate_lanechange_);
+}
+
+int ControllerNaturalDriver::RestoreState(SE_StateStream& stream)
+{
+    if (Controller::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(active_);
+    stream.Read(desired_speed_);
+    stream.Read(current_speed_);
+    stream.Read(lane_change_injected);
+    stream.Read(state_);
+    stream.Read(lane_change_delay_);
+    stream.Read(lane_change_cooldown_);
+    stream.Read(target_lane_);
+    stream.Read(initiate_lanechange_);
+
+    return stream.Good() ? 0 : -1;
+}
@@ -60,6 +60,9 @@ namespace scenarioengine
         void Init();
         void InitPostPlayer();
         void Step(double dt);
+        void Prepare(double dt);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
         int  Activate(const ControlActivationMode (&mode)[static_cast<unsigned int>(ControlDomains::COUNT)]);
 
         bool   AdjacentLanesAvailable();
@@ -94,6 +97,8 @@ namespace scenarioengine
         double                           max_acceleration_;
         std::array<int, 2>               lane_ids_available_;
         std::vector<Object*>             vehicles_in_radius_;
+        std::vector<Object*>             neighbors_;         // candidates from neighbor index, reused between steps
+        std::vector<size_t>              neighbor_scratch_;  // working memory for the neighbor query
         std::unordered_map<VoIType, VoI> vehicles_of_interest_;
         bool                             lane_change_injected;
         State                            state_;
@@ -134,4 +134,21 @@ void ControllerOffroadFollower::ReportKeyEvent(int key, bool down)
 {
     (void)key;
     (void)down;
-}
\ No newline at end of file
+}
+
+void ControllerOffroadFollower::SaveState(SE_StateStream& stream)
+{
+    Controller::SaveState(stream);
+    stream.Write(vehicle_);
+}
+
+int ControllerOffroadFollower::RestoreState(SE_StateStream& stream)
+{
+    if (Controller::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(vehicle_);
+
+    return stream.Good() ? 0 : -1;
+}
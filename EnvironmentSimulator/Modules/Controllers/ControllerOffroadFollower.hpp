@@ -34,6 +34,8 @@ namespace scenarioengine
 
         void Init();
         void Step(double timeStep);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
         int  Activate(const ControlActivationMode (&mode)[static_cast<unsigned int>(ControlDomains::COUNT)]);
         void ReportKeyEvent(int key, bool down);
 
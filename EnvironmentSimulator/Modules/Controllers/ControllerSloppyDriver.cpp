@@ -206,4 +206,41 @@ void ControllerSloppyDriver::ReportKeyEvent(int key, bool down)
 {
     (void)key;
     (void)down;
-}
\ No newline at end of file
+}
+
+void ControllerSloppyDriver::SaveState(SE_StateStream& stream)
+{
+    Controller::SaveState(stream);
+    stream.Write(time_);
+    stream.Write(speedTimer_);
+    stream.Write(referenceSpeed_);
+    stream.Write(initSpeed_);
+    stream.Write(currentSpeed_);
+    stream.Write(targetFactor_);
+    stream.Write(lateralTimer_);
+    stream.Write(currentT_);
+    stream.Write(tFuzz0);
+    stream.Write(tFuzzTarget);
+    stream.Write(currentH_);
+}
+
+int ControllerSloppyDriver::RestoreState(SE_StateStream& stream)
+{
+    if (Controller::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(time_);
+    stream.Read(speedTimer_);
+    stream.Read(referenceSpeed_);
+    stream.Read(initSpeed_);
+    stream.Read(currentSpeed_);
+    stream.Read(targetFactor_);
+    stream.Read(lateralTimer_);
+    stream.Read(currentT_);
+    stream.Read(tFuzz0);
+    stream.Read(tFuzzTarget);
+    stream.Read(currentH_);
+
+    return stream.Good() ? 0 : -1;
+}
@@ -22,11 +22,15 @@
 #include "ScenarioGateway.hpp"
 #include "logger.hpp"
 
+#include <algorithm>
 #include <random>
 
 using namespace scenarioengine;
 
-int ControllerUDPDriver::basePort_ = DEFAULT_UDP_DRIVER_PORT;
+int                               ControllerUDPDriver::basePort_         = DEFAULT_UDP_DRIVER_PORT;
+std::vector<ControllerUDPDriver*> ControllerUDPDriver::syncControllers_;
+unsigned long long                ControllerUDPDriver::syncFrame_        = 1;
+unsigned long long                ControllerUDPDriver::syncBarrierFrame_ = 0;
 
 Controller* scenarioengine::InstantiateControllerUDPDriver(void* args)
 {
@@ -38,9 +42,10 @@ Controller* scenarioengine::InstantiateControllerUDPDriver(void* args)
 ControllerUDPDriver::ControllerUDPDriver(InitArgs* args)
     : Controller(args),
       inputMode_(InputMode::DRIVER_INPUT),
-      udpServer_(nullptr),
+      mailbox_(nullptr),
       port_(0),
-      execMode_(ExecMode::EXEC_MODE_ASYNCHRONOUS)
+      execMode_(ExecMode::EXEC_MODE_ASYNCHRONOUS),
+      syncStepFrame_(0)
 {
     if (args && args->properties && args->properties->ValueExists("inputMode"))
     {
@@ -121,9 +126,11 @@ ControllerUDPDriver::ControllerUDPDriver(InitArgs* args)
 
 ControllerUDPDriver::~ControllerUDPDriver()
 {
-    if (udpServer_ != nullptr)
+    syncControllers_.erase(std::remove(syncControllers_.begin(), syncControllers_.end(), this), syncControllers_.end());
+
+    if (mailbox_ != nullptr)
     {
-        delete udpServer_;
+        UDPInputMultiplexer::Inst().Close(mailbox_);
     }
 }
 
@@ -173,29 +180,56 @@ void ControllerUDPDriver::Init()
     Controller::Init();
 }
 
-void ControllerUDPDriver::Step(double timeStep)
+void ControllerUDPDriver::WaitForSyncDrivers()
 {
-    int retval            = 0;
-    int receivedNrOfBytes = 0;
+    // Only wait once per frame, for all synchronous drivers not yet stepped in this frame
+    if (syncBarrierFrame_ == syncFrame_)
+    {
+        return;
+    }
+    syncBarrierFrame_ = syncFrame_;
 
-    if (execMode_ == ExecMode::EXEC_MODE_ASYNCHRONOUS)
+    std::vector<UDPInputMultiplexer::Mailbox*> mailboxes;
+    for (auto controller : syncControllers_)
     {
-        // Pick all queued messages - store only the last/latest
-        while (retval >= 0)
+        if (controller->Active() && controller->mailbox_ != nullptr && (controller == this || controller->syncStepFrame_ != syncFrame_))
         {
-            retval = udpServer_->Receive(reinterpret_cast<char*>(&msg), sizeof(msg));
-            if (retval > 0)
-            {
-                receivedNrOfBytes = retval;
-            }
+            mailboxes.push_back(controller->mailbox_);
         }
     }
-    else
+
+    UDPInputMultiplexer::Inst().WaitForMessages(mailboxes, UDP_SYNCHRONOUS_MODE_TIMEOUT_MS);
+}
+
+void ControllerUDPDriver::Step(double timeStep)
+{
+    int receivedNrOfBytes = 0;
+
+    if (mailbox_ != nullptr)
     {
-        retval = udpServer_->Receive(reinterpret_cast<char*>(&msg), sizeof(msg));
-        if (retval >= 0)
+        // pick up messages sent just before the step, which the receiver thread might not have handled yet
+        UDPInputMultiplexer::Inst().Refresh(mailbox_);
+
+        if (execMode_ == ExecMode::EXEC_MODE_ASYNCHRONOUS)
         {
-            receivedNrOfBytes = retval;
+            // Pick latest message only, any earlier ones queued since last step are skipped
+            receivedNrOfBytes = mailbox_->TakeLatest(reinterpret_cast<char*>(&msg), sizeof(msg));
+        }
+        else
+        {
+            // A controller stepping twice within the same frame means a new frame has begun
+            if (syncStepFrame_ == syncFrame_)
+            {
+                syncFrame_++;
+            }
+            syncStepFrame_ = syncFrame_;
+
+            // One message per step, wait for it unless already received
+            if (!mailbox_->HasMessage())
+            {
+                WaitForSyncDrivers();
+            }
+            receivedNrOfBytes = mailbox_->Take(reinterpret_cast<char*>(&msg), sizeof(msg));
         }
     }
 
@@ -289,7 +323,7 @@ void ControllerUDPDriver::Step(double timeStep)
         }
         else
         {
-            LOG_ERROR("ControllerExternalDriverModel received {} bytes and unexpected input mode {}", retval, msg.header.inputMode);
+            LOG_ERROR("ControllerExternalDriverModel received {} bytes and unexpected input mode {}", receivedNrOfBytes, msg.header.inputMode);
         }
     }
 
@@ -364,23 +398,29 @@ int ControllerUDPDriver::Activate(const ControlActivationMode (&mode)[static_cas
             port_ = basePort_ + object_->GetId();
         }
 
-        if (udpServer_ == nullptr ||         // not created yet
-            udpServer_->GetPort() != port_)  // port nr changed. Need to recreate the socket.
+        if (mailbox_ == nullptr ||         // not created yet
+            mailbox_->GetPort() != port_)  // port nr changed. Need to recreate the socket.
         {
             // Close socket in case the controller is assigned again with different port
-            if (udpServer_ != nullptr)
+            if (mailbox_ != nullptr)
             {
-                delete udpServer_;
+                UDPInputMultiplexer::Inst().Close(mailbox_);
             }
-            if (execMode_ == ExecMode::EXEC_MODE_ASYNCHRONOUS)
+            mailbox_ = UDPInputMultiplexer::Inst().Open(static_cast<unsigned short>(port_));
+            if (mailbox_ == nullptr)
             {
-                udpServer_ = new UDPServer(static_cast<unsigned short>(port_), 1);
+                LOG_ERROR("ExternalDriverModel failed to open port {}", port_);
             }
             else
             {
-                udpServer_ = new UDPServer(static_cast<unsigned short>(port_), UDP_SYNCHRONOUS_MODE_TIMEOUT_MS);
+                LOG_INFO("ExternalDriverModel server listening on port {} execMode: {}", port_, ExecMode2Str(execMode_));
             }
-            LOG_INFO("ExternalDriverModel server listening on port {} execMode: {}", port_, ExecMode2Str(execMode_));
+        }
+
+        if (execMode_ == ExecMode::EXEC_MODE_SYNCHRONOUS &&
+            std::find(syncControllers_.begin(), syncControllers_.end(), this) == syncControllers_.end())
+        {
+            syncControllers_.push_back(this);
         }
 
         vehicle_.Reset();
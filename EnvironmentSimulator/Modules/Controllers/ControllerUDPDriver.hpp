@@ -13,6 +13,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "Controller.hpp"
 #include "Parameters.hpp"
 #include "vehicle.hpp"
@@ -126,13 +127,21 @@ namespace scenarioengine
         vehicle::Vehicle  vehicle_;
         vehicle::THROTTLE accelerate = vehicle::THROTTLE_NONE;
         vehicle::STEERING steer      = vehicle::STEERING_NONE;
-        InputMode         inputMode_;
-        UDPServer*        udpServer_;
-        int               port_;
-        static int        basePort_;
-        ExecMode          execMode_;
-        DMMessage         msg;
-        DMMessage         lastMsg;
+        InputMode                     inputMode_;
+        UDPInputMultiplexer::Mailbox* mailbox_;  // latest message received on port_
+        int                           port_;
+        static int                    basePort_;
+        ExecMode                      execMode_;
+        DMMessage                     msg;
+        DMMessage                     lastMsg;
+
+        // Synchronous controllers share one frame barrier, waiting for all drivers at once
+        static std::vector<ControllerUDPDriver*> syncControllers_;
+        static unsigned long long                syncFrame_;         // counts frames, i.e. rounds of synchronous steps
+        static unsigned long long                syncBarrierFrame_;  // frame of last barrier
+        unsigned long long                       syncStepFrame_;     // frame this controller last stepped in
+
+        void WaitForSyncDrivers();
     };
 
     Controller* InstantiateControllerUDPDriver(void* args);
@@ -0,0 +1,380 @@
+/*
+ * esmini - Environment Simulator Minimalistic
+ * https://github.com/esmini/esmini
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) partners of Simulation Scenarios
+ * https://sites.google.com/view/simulationscenarios
+ */
+
+#include "FrameScheduler.hpp"
+#include "logger.hpp"
+
+using namespace scenarioengine;
+
+#define N_STAGES static_cast<int>(FrameScheduler::Stage::N_STAGES)
+
+static bool IsOutputStage(FrameScheduler::Stage stage)
+{
+    return stage == FrameScheduler::Stage::RECORDING || stage == FrameScheduler::Stage::CSV_LOG;
+}
+
+static bool IsPresentationStage(FrameScheduler::Stage stage)
+{
+    return stage == FrameScheduler::Stage::VIEWER || stage == FrameScheduler::Stage::PLOT;
+}
+
+FrameScheduler::FrameScheduler()
+    : budget_(0.0),
+      n_frames_(0),
+      n_deadline_misses_(0),
+      n_background_misses_(0),
+      n_frames_in_budget_(0),
+      max_frame_time_(0.0),
+      total_frame_time_(0.0),
+      outside_time_(0.0),
+      in_frame_(false)
+{
+    for (int i = 0; i < N_STAGES; i++)
+    {
+        last_cost_[i] = 0.0;
+    }
+    frame_start_ = Clock::now();
+}
+
+FrameScheduler::~FrameScheduler()
+{
+    Flush();
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    StopWorker();
+#endif
+}
+
+const char* FrameScheduler::StageName(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::SCENARIO:
+            return "scenario";
+        case Stage::SENSORS:
+            return "sensors";
+        case Stage::RECORDING:
+            return "recording";
+        case Stage::CSV_LOG:
+            return "csv_log";
+        case Stage::VIEWER:
+            return "viewer";
+        case Stage::PLOT:
+            return "plot";
+        default:
+            return "unknown";
+    }
+}
+
+void FrameScheduler::SetBudget(double budget)
+{
+    budget_ = budget;
+
+    if (budget_ <= 0.0)
+    {
+        // back to plain sequential execution
+        Flush();
+        for (int i = 0; i < N_STAGES; i++)
+        {
+            stats_[i].background   = false;
+            stats_[i].rate_divisor = 1;
+        }
+    }
+}
+
+void FrameScheduler::BeginFrame()
+{
+    frame_start_ = Clock::now();
+    in_frame_    = true;
+}
+
+void FrameScheduler::AddTime(Stage stage, double time)
+{
+    StageStats& stats = stats_[static_cast<int>(stage)];
+    stats.total_time += time;
+    stats.max_time = MAX(stats.max_time, time);
+}
+
+void FrameScheduler::Execute(Job& job)
+{
+    Clock::time_point start = Clock::now();
+    job.func();
+    double time = std::chrono::duration<double>(Clock::now() - start).count();
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    std::unique_lock<std::mutex> lock(mutex_);
+#endif
+    AddTime(job.stage, time);
+}
+
+void FrameScheduler::Run(Stage stage, const std::function<void()>& job)
+{
+    Clock::time_point start = Clock::now();
+    job();
+    double time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    stats_[static_cast<int>(stage)].n_runs++;
+    last_cost_[static_cast<int>(stage)] = time;
+    AddTime(stage, time);
+
+    if (!in_frame_)
+    {
+        outside_time_ += time;
+    }
+}
+
+bool FrameScheduler::ShouldRun(Stage stage)
+{
+    StageStats& stats = stats_[static_cast<int>(stage)];
+
+    if (stats.rate_divisor > 1 && n_frames_ % stats.rate_divisor != 0)
+    {
+        stats.n_skipped++;
+        return false;
+    }
+
+    return true;
+}
+
+void FrameScheduler::RunOutput(Stage stage, std::function<void()> job)
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    StageStats& stats = stats_[static_cast<int>(stage)];
+
+    if (stats.background)
+    {
+        Clock::time_point            start = Clock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // deadline of pending output passed, wait for the background thread to catch up
+        if (!queue_.empty() && queue_.front().frame + max_pending_frames <= n_frames_)
+        {
+            n_background_misses_++;
+            cv_done_.wait(lock, [this] { return queue_.empty() || queue_.front().frame + max_pending_frames > n_frames_; });
+        }
+
+        queue_.push_back({stage, n_frames_, std::move(job)});
+        stats.n_runs++;
+        stats.n_deferred++;
+        lock.unlock();
+        cv_work_.notify_one();
+
+        // cost of the stage in this frame is only handover and any waiting
+        last_cost_[static_cast<int>(stage)] = std::chrono::duration<double>(Clock::now() - start).count();
+        return;
+    }
+#endif
+
+    Run(stage, job);
+}
+
+void FrameScheduler::Flush()
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_done_.wait(lock, [this] { return queue_.empty() && !busy_; });
+#endif
+}
+
+void FrameScheduler::EndFrame()
+{
+    double frame_time = std::chrono::duration<double>(Clock::now() - frame_start_).count() + outside_time_;
+
+    outside_time_ = 0.0;
+    in_frame_     = false;
+    n_frames_++;
+    total_frame_time_ += frame_time;
+    max_frame_time_ = MAX(max_frame_time_, frame_time);
+
+    if (budget_ <= 0.0)
+    {
+        return;
+    }
+
+    if (frame_time > budget_)
+    {
+        n_deadline_misses_++;
+        n_frames_in_budget_ = 0;
+        Degrade();
+    }
+    else if (frame_time < 0.5 * budget_)
+    {
+        if (++n_frames_in_budget_ >= restore_frames)
+        {
+            n_frames_in_budget_ = 0;
+            Restore();
+        }
+    }
+    else
+    {
+        n_frames_in_budget_ = 0;
+    }
+}
+
+void FrameScheduler::Degrade()
+{
+    // Offload or slow down the most expensive non-critical stage still running at full rate in the frame
+    int    worst      = -1;
+    double worst_cost = 0.0;
+
+    for (int i = 0; i < N_STAGES; i++)
+    {
+        Stage stage = static_cast<Stage>(i);
+        bool  can_degrade =
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+            (IsOutputStage(stage) && !stats_[i].background) ||
+#endif
+            (IsPresentationStage(stage) && stats_[i].rate_divisor < max_rate_divisor);
+
+        if (can_degrade && last_cost_[i] > worst_cost)
+        {
+            worst      = i;
+            worst_cost = last_cost_[i];
+        }
+    }
+
+    if (worst < 0)
+    {
+        return;
+    }
+
+    if (IsOutputStage(static_cast<Stage>(worst)))
+    {
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+        StartWorker();
+        stats_[worst].background = true;
+#endif
+    }
+    else
+    {
+        stats_[worst].rate_divisor *= 2;
+    }
+}
+
+void FrameScheduler::Restore()
+{
+    // First bring presentation back to full rate, the most reduced one first, then output back into the frame
+    int worst = -1;
+    for (int i = 0; i < N_STAGES; i++)
+    {
+        if (stats_[i].rate_divisor > 1 && (worst < 0 || stats_[i].rate_divisor > stats_[worst].rate_divisor))
+        {
+            worst = i;
+        }
+    }
+
+    if (worst >= 0)
+    {
+        stats_[worst].rate_divisor /= 2;
+        return;
+    }
+
+    for (int i = 0; i < N_STAGES; i++)
+    {
+        if (stats_[i].background)
+        {
+            // keep order of output by finishing pending jobs before running the stage in the frame again
+            Flush();
+            stats_[i].background = false;
+            return;
+        }
+    }
+}
+
+void FrameScheduler::PrintStatistics() const
+{
+    if (n_frames_ == 0)
+    {
+        return;
+    }
+
+    LOG_INFO("Frame scheduler: {} frames, budget {:.2f} ms, frame time avg {:.2f} ms max {:.2f} ms",
+             n_frames_,
+             1e3 * budget_,
+             1e3 * total_frame_time_ / n_frames_,
+             1e3 * max_frame_time_);
+
+    if (budget_ > 0.0)
+    {
+        LOG_INFO("Frame scheduler: {} deadline misses ({:.1f}%), {} background deadline misses",
+                 n_deadline_misses_,
+                 100.0 * n_deadline_misses_ / n_frames_,
+                 n_background_misses_);
+    }
+
+    for (int i = 0; i < N_STAGES; i++)
+    {
+        const StageStats& stats = stats_[i];
+        if (stats.n_runs == 0)
+        {
+            continue;
+        }
+
+        LOG_INFO("  {:<10} runs {} (deferred {}, skipped {}) avg {:.3f} ms max {:.3f} ms",
+                 StageName(static_cast<Stage>(i)),
+                 stats.n_runs,
+                 stats.n_deferred,
+                 stats.n_skipped,
+                 1e3 * stats.total_time / stats.n_runs,
+                 1e3 * stats.max_time);
+    }
+}
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+void FrameScheduler::StartWorker()
+{
+    if (!worker_.joinable())
+    {
+        quit_   = false;
+        worker_ = std::thread(&FrameScheduler::WorkerLoop, this);
+    }
+}
+
+void FrameScheduler::StopWorker()
+{
+    if (worker_.joinable())
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            quit_ = true;
+        }
+        cv_work_.notify_one();
+        worker_.join();
+    }
+}
+
+void FrameScheduler::WorkerLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_work_.wait(lock, [this] { return quit_ || !queue_.empty(); });
+            if (queue_.empty())
+            {
+                return;  // quit, all work done
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+        }
+
+        Execute(job);
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        cv_done_.notify_all();
+    }
+}
+#endif
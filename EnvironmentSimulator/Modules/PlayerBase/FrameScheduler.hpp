@@ -0,0 +1,202 @@
+/*
+ * esmini - Environment Simulator Minimalistic
+ * https://github.com/esmini/esmini
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) partners of Simulation Scenarios
+ * https://sites.google.com/view/simulationscenarios
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+
+#include "CommonMini.hpp"
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace scenarioengine
+{
+    /**
+    Keeps track of the cost of each stage of a player frame and, given a frame time budget, moves non-critical work
+    out of the way when the budget is exceeded:
+      - Output stages (recording, CSV log) are handed over to a background thread. Data is captured in the frame,
+        only the writing is deferred, so no data is lost. Pending output must be written within a few frames,
+        else the frame waits for it (counted as a background deadline miss).
+      - Presentation stages (viewer, plot) are run at a lower rate, i.e. every n:th frame.
+    When frames are well within budget again, stages are gradually brought back to normal.
+    Without a budget the stages are only measured, behavior is unchanged.
+    */
+    class FrameScheduler
+    {
+    public:
+        enum class Stage
+        {
+            SCENARIO = 0,  // scenario step, incl. controllers
+            SENSORS,       // sensors and OSI ground truth
+            RECORDING,     // .dat file
+            CSV_LOG,
+            VIEWER,
+            PLOT,
+            N_STAGES
+        };
+
+        struct StageStats
+        {
+            unsigned int n_runs       = 0;  // number of executions
+            unsigned int n_deferred   = 0;  // of which handed over to the background thread
+            unsigned int n_skipped    = 0;  // frames skipped due to reduced rate
+            double       total_time   = 0.0;
+            double       max_time     = 0.0;
+            unsigned int rate_divisor = 1;  // run every n:th frame
+            bool         background   = false;
+        };
+
+        FrameScheduler();
+        ~FrameScheduler();
+
+        /**
+        Set frame time budget
+        @param budget Max time, in seconds, for a frame. 0 or negative to disable adaptation.
+        */
+        void SetBudget(double budget);
+
+        double GetBudget() const
+        {
+            return budget_;
+        }
+
+        /**
+        Start timing of a frame. Any stages run between frames, e.g. plot updates by the application, are added
+        to the next frame.
+        */
+        void BeginFrame();
+
+        /**
+        Evaluate the frame and adapt stage modes and rates for the next frame
+        */
+        void EndFrame();
+
+        /**
+        Run a critical stage, always executed in the calling thread
+        @param stage Stage
+        @param job Work of the stage
+        */
+        void Run(Stage stage, const std::function<void()> &job);
+
+        /**
+        Check whether a presentation stage should run in current frame, based on its current rate
+        @param stage Stage
+        @return true if stage should run, else false
+        */
+        bool ShouldRun(Stage stage);
+
+        /**
+        Run an output stage, either directly or on the background thread depending on current mode of the stage.
+        The job must not access any simulation data, only the captured data it owns.
+        @param stage Stage
+        @param job Work of the stage
+        */
+        void RunOutput(Stage stage, std::function<void()> job);
+
+        /**
+        Wait until all background work is done
+        */
+        void Flush();
+
+        /**
+        Check whether the stage is currently handed over to the background thread, so that the caller can
+        decide whether to capture data or run synchronously
+        */
+        bool IsBackground(Stage stage) const
+        {
+            return stats_[static_cast<int>(stage)].background;
+        }
+
+        const StageStats &GetStats(Stage stage) const
+        {
+            return stats_[static_cast<int>(stage)];
+        }
+        unsigned int GetNumberOfFrames() const
+        {
+            return n_frames_;
+        }
+        unsigned int GetNumberOfDeadlineMisses() const
+        {
+            return n_deadline_misses_;
+        }
+        unsigned int GetNumberOfBackgroundMisses() const
+        {
+            return n_background_misses_;
+        }
+
+        /**
+        Log frame and stage statistics
+        */
+        void PrintStatistics() const;
+
+        static const char *StageName(Stage stage);
+
+        // Max number of frames an output job may remain in the background queue
+        static const unsigned int max_pending_frames = 4;
+
+        // Number of consecutive frames within half the budget needed before stages are restored one step
+        static const unsigned int restore_frames = 20;
+
+        // Max rate reduction of presentation stages
+        static const unsigned int max_rate_divisor = 16;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Job
+        {
+            Stage                 stage;
+            unsigned int          frame;  // frame in which the job was queued
+            std::function<void()> func;
+        };
+
+        double            budget_;
+        Clock::time_point frame_start_;
+        StageStats        stats_[static_cast<int>(Stage::N_STAGES)];
+        double            last_cost_[static_cast<int>(Stage::N_STAGES)];  // time of latest execution per stage
+        unsigned int      n_frames_;
+        unsigned int      n_deadline_misses_;
+        unsigned int      n_background_misses_;
+        unsigned int      n_frames_in_budget_;
+        double            max_frame_time_;
+        double            total_frame_time_;
+        double            outside_time_;  // time of stages run between frames
+        bool              in_frame_;
+        std::deque<Job>   queue_;
+
+        void AddTime(Stage stage, double time);
+        void Degrade();
+        void Restore();
+        void Execute(Job &job);
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+        void WorkerLoop();
+        void StartWorker();
+        void StopWorker();
+
+        std::thread             worker_;
+        std::mutex              mutex_;
+        std::condition_variable cv_work_;
+        std::condition_variable cv_done_;
+        bool                    busy_ = false;
+        bool                    quit_ = false;
+#endif
+    };
+
+}  // namespace scenarioengine
@@ -104,6 +104,14 @@ ScenarioPlayer::~ScenarioPlayer()
         }
     }
 #endif  // _USE_OSG
+
+    // write any deferred output before files are closed
+    scheduler.Flush();
+    if (scheduler.GetBudget() > 0.0)
+    {
+        scheduler.PrintStatistics();
+    }
+
     for (auto& s : sensor)
     {
         delete s;
@@ -164,9 +172,9 @@ void ScenarioPlayer::Draw()
 #ifdef _USE_OSG
         if (!threads)
         {
-            if (!viewer_->GetQuitRequest())
+            if (!viewer_->GetQuitRequest() && scheduler.ShouldRun(FrameScheduler::Stage::VIEWER))
             {
-                ViewerFrame();
+                scheduler.Run(FrameScheduler::Stage::VIEWER, [this]() { ViewerFrame(); });
             }
 
             if (viewer_->GetQuitRequest())
@@ -185,6 +193,8 @@ int ScenarioPlayer::Frame(double timestep_s, bool server_mode)
     int         retval        = 0;
     double      ghost_solo_dt = 0.05;
 
+    scheduler.BeginFrame();
+
     if (!IsPaused() || server_mode)
     {
 #ifdef _USE_OSI
@@ -236,6 +246,8 @@ int ScenarioPlayer::Frame(double timestep_s, bool server_mode)
         }
     }
 
+    scheduler.EndFrame();
+
     return retval;
 }
 
@@ -259,7 +271,9 @@ int ScenarioPlayer::ScenarioFrame(double timestep_s, bool keyframe)
     int retval = 0;
     mutex.Lock();
 
-    if ((retval = scenarioEngine->step(timestep_s)) == 0)
+    scheduler.Run(FrameScheduler::Stage::SCENARIO, [this, timestep_s, &retval]() { retval = scenarioEngine->step(timestep_s); });
+
+    if (retval == 0)
     {
         if (keyframe)
         {
@@ -280,7 +294,7 @@ int ScenarioPlayer::ScenarioFrame(double timestep_s, bool keyframe)
 
         if (SE_Env::Inst().GetGhostMode() != GhostMode::RESTART)
         {
-            scenarioGateway->WriteStatesToFile();
+            WriteRecording();
 
             if (CSV_Log)
             {
@@ -292,6 +306,11 @@ int ScenarioPlayer::ScenarioFrame(double timestep_s, bool keyframe)
         {
             frame_counter_++;
         }
+        else
+        {
+            // no post frame for intermediate ghost steps, show progress anyway
+            PublishViewerSnapshot();
+        }
     }
 
     scenarioEngine->UpdateGhostMode();
@@ -307,44 +326,130 @@ void ScenarioPlayer::ScenarioPostFrame()
 {
     mutex.Lock();
 
-    for (size_t i = 0; i < sensor.size(); i++)
+    scheduler.Run(FrameScheduler::Stage::SENSORS,
+                  [this]()
+                  {
+                      if (sensor.size() > 0)
+                      {
+                          // entities have moved since index was built during the scenario step
+                          scenarioEngine->entities_.UpdateNeighborIndex();
+                      }
+
+                      sensorManager.Update(scenarioEngine->entities_, sensor);
+#ifdef _USE_OSI
+                      if (NEAR_NUMBERS(scenarioEngine->getSimulationTime(), scenarioEngine->GetTrueTime()))
+                      {
+                          // Update OSI info
+                          if (osiReporter->GetOSIFrequency() > 0)
+                          {
+                              osiReporter->ReportSensors(sensor);
+
+                              osiReporter->UpdateOSIGroundTruth(scenarioGateway->objectState_);
+
+                              osiReporter->UpdateOSITrafficCommand();
+                          }
+                      }
+#endif  // _USE_OSI
+                  });
+
+    PublishViewerSnapshot();
+
+    mutex.Unlock();
+}
+
+void ScenarioPlayer::PublishViewerSnapshot()
+{
+    if (viewer_ == nullptr)
     {
-        sensor[i]->Update();
+        return;
     }
-#ifdef _USE_OSI
-    if (NEAR_NUMBERS(scenarioEngine->getSimulationTime(), scenarioEngine->GetTrueTime()))
+
+    ViewerSnapshot& snapshot = viewer_snapshot_.GetWriteBuffer();
+
+    snapshot.sim_time = scenarioEngine->getSimulationTime();
+    snapshot.entities.resize(scenarioEngine->entities_.object_.size());
+
+    for (size_t i = 0; i < scenarioEngine->entities_.object_.size(); i++)
     {
-        // Update OSI info
-        if (osiReporter->GetOSIFrequency() > 0)
-        {
-            osiReporter->ReportSensors(sensor);
+        Object*             obj   = scenarioEngine->entities_.object_[i];
+        EntityRenderState&  state = snapshot.entities[i];
+        roadmanager::Route* route = obj->pos_.GetRoute();
+
+        state.obj     = obj;
+        state.id      = obj->GetId();
+        state.name    = obj->name_;
+        state.model3d = obj->model3d_;
+        state.pos.CopyLocation(obj->pos_);
+        state.trajectory        = obj->pos_.GetTrajectory();
+        state.has_route         = route != nullptr;
+        state.route_dirty       = obj->CheckDirtyBits(Object::DirtyBit::ROUTE);
+        state.route_valid       = route != nullptr && route->IsValid();
+        state.route_track_id    = state.route_valid ? route->GetTrackId() : ID_UNDEFINED;
+        state.route_lane_id     = state.route_valid ? route->GetLaneId() : 0;
+        state.route_s           = state.route_valid ? route->GetTrackS() : 0.0;
+        state.wheel_angle       = obj->wheel_angle_;
+        state.wheel_rot         = obj->wheel_rot_;
+        state.sensor_pos[0]     = obj->sensor_pos_[0];
+        state.sensor_pos[1]     = obj->sensor_pos_[1];
+        state.sensor_pos[2]     = obj->sensor_pos_[2];
+        state.trail_closest_pos = obj->trail_closest_pos_;
+        state.trail_n_vertices  = obj->trail_.GetNumberOfVertices();
+        state.trail_n_discarded = obj->trail_.GetNumberOfDiscardedVertices();
+        state.odometer          = obj->odometer_;
+        state.speed             = obj->speed_;
+        state.bb_center_x       = static_cast<double>(obj->boundingbox_.center_.x_);
+    }
+
+    snapshot.sensors.resize(sensor.size());
+    for (size_t i = 0; i < sensor.size(); i++)
+    {
+        ObjectSensor*      s     = sensor[i];
+        SensorRenderState& state = snapshot.sensors[i];
 
-            osiReporter->UpdateOSIGroundTruth(scenarioGateway->objectState_);
+        state.sensor = s;
+        state.hits.clear();
+        for (int j = 0; j < s->nObj_; j++)
+        {
+            // compensate z for vehicle pitch angle
+            double z_add =
+                GetLengthOfLine2D(s->hitList_[j].obj_->pos_.GetX(), s->hitList_[j].obj_->pos_.GetY(), s->host_->pos_.GetX(), s->host_->pos_.GetY()) *
+                tan(s->host_->pos_.GetP());
 
-            osiReporter->UpdateOSITrafficCommand();
+            state.hits.push_back(s->hitList_[j].x_);
+            state.hits.push_back(s->hitList_[j].y_);
+            state.hits.push_back(s->hitList_[j].z_ + z_add);
         }
     }
-#endif  // _USE_OSI
 
-    mutex.Unlock();
+    viewer_snapshot_.Publish();
 }
 
 #ifdef _USE_OSG
-void ScenarioPlayer::ViewerFrame(bool init)
+bool ScenarioPlayer::ViewerNeedsSync(const ViewerSnapshot& snapshot)
 {
-    if (viewer_ == nullptr)
+    if (snapshot.entities.size() != viewer_->entities_.size())
     {
-        return;
+        return true;
     }
 
-    if (scenarioEngine->environment.IsEnvironment() && !scenarioEngine->environment.IsEnvironmentUpdatedInViewer())
+    for (size_t i = 0; i < snapshot.entities.size(); i++)
     {
-        scenarioEngine->environment.SetEnvironmentUpdatedInViewer(true);
-        viewer_->CreateWeatherGroup(scenarioEngine->environment);
+        const EntityRenderState& state  = snapshot.entities[i];
+        viewer::EntityModel*     entity = viewer_->entities_[i];
+
+        if (state.name != entity->name_ || state.model3d != entity->filename_ || state.trajectory != entity->trajectory_->activeRMTrajectory_ ||
+            state.route_dirty || (!state.has_route && entity->routewaypoints_->group_all_wp_->getNumChildren()) ||
+            entity->trail_->n_discarded_ + entity->trail_->pline_vertex_data_->size() > state.trail_n_discarded + state.trail_n_vertices)
+        {
+            return true;
+        }
     }
 
-    mutex.Lock();
+    return false;
+}
 
+void ScenarioPlayer::SyncViewerEntities(bool init)
+{
     // remove deleted cars
     osg::Vec4 trail_color;
     trail_color.set(SE_Color::Color2RBG(SE_Color::Color::BLUE)[0],
@@ -391,155 +496,223 @@ void ScenarioPlayer::ViewerFrame(bool init)
         viewer_->RemoveCar(static_cast<int>(viewer_->entities_.size() - 1));
     }
 
-    if (!init)
+    if (init)
     {
-        // Visualize entities
-        for (size_t i = 0; i < scenarioEngine->entities_.object_.size(); i++)
+        return;
+    }
+
+    for (size_t i = 0; i < scenarioEngine->entities_.object_.size(); i++)
+    {
+        viewer::EntityModel* entity = viewer_->entities_[i];
+        Object*              obj    = scenarioEngine->entities_.object_[i];
+
+        if (obj->pos_.GetTrajectory() && obj->pos_.GetTrajectory() != entity->trajectory_->activeRMTrajectory_)
         {
-            viewer::EntityModel* entity = viewer_->entities_[i];
-            Object*              obj    = scenarioEngine->entities_.object_[i];
+            entity->trajectory_->SetActiveRMTrajectory(obj->pos_.GetTrajectory());
+        }
+        else if (entity->trajectory_->activeRMTrajectory_ && !obj->pos_.GetTrajectory())
+        {
+            // Trajectory has been deactivated on the entity, disable visualization
+            entity->trajectory_->Disable();
+        }
 
-            entity->SetPosition(obj->pos_.GetX(), obj->pos_.GetY(), obj->pos_.GetZ());
-            entity->SetRotation(obj->pos_.GetH(), obj->pos_.GetP(), obj->pos_.GetR());
+        if (obj->CheckDirtyBits(Object::DirtyBit::ROUTE))
+        {
+            entity->routewaypoints_->SetWayPoints(obj->pos_.GetRoute());
+            obj->ClearDirtyBits(Object::DirtyBit::ROUTE);
+        }
+        else if (entity->routewaypoints_->group_all_wp_->getNumChildren() && obj->pos_.GetRoute() == nullptr)
+        {
+            entity->routewaypoints_->SetWayPoints(nullptr);
+        }
 
-            if (obj->pos_.GetTrajectory() && obj->pos_.GetTrajectory() != entity->trajectory_->activeRMTrajectory_)
-            {
-                entity->trajectory_->SetActiveRMTrajectory(obj->pos_.GetTrajectory());
-            }
-            else if (entity->trajectory_->activeRMTrajectory_ && !obj->pos_.GetTrajectory())
+        if (entity->trail_->n_discarded_ + entity->trail_->pline_vertex_data_->size() >
+            obj->trail_.GetNumberOfDiscardedVertices() + obj->trail_.GetNumberOfVertices())
+        {
+            // Reset the trail, probably there has been a ghost restart
+            entity->trail_->Reset();
+            entity->trail_->n_discarded_ = obj->trail_.GetNumberOfDiscardedVertices();
+            for (unsigned int j = 0; j < obj->trail_.GetNumberOfVertices(); j++)
             {
-                // Trajectory has been deactivated on the entity, disable visualization
-                entity->trajectory_->Disable();
+                entity->trail_->AddPoint(obj->trail_.vertex_[j].x,
+                                         obj->trail_.vertex_[j].y,
+                                         obj->trail_.vertex_[j].z + (obj->GetId() + 1) * TRAIL_Z_OFFSET);
             }
+        }
+    }
+}
 
-            if (obj->CheckDirtyBits(Object::DirtyBit::ROUTE))
-            {
-                entity->routewaypoints_->SetWayPoints(obj->pos_.GetRoute());
-                obj->ClearDirtyBits(Object::DirtyBit::ROUTE);
-            }
-            else if (entity->routewaypoints_->group_all_wp_->getNumChildren() && obj->pos_.GetRoute() == nullptr)
+void ScenarioPlayer::ViewerFrame(bool init)
+{
+    if (viewer_ == nullptr)
+    {
+        return;
+    }
+
+    if (scenarioEngine->environment.IsEnvironment() && !scenarioEngine->environment.IsEnvironmentUpdatedInViewer())
+    {
+        scenarioEngine->environment.SetEnvironmentUpdatedInViewer(true);
+        viewer_->CreateWeatherGroup(scenarioEngine->environment);
+    }
+
+    // Pick up latest state published by the scenario, no locking needed
+    bool            new_data = viewer_snapshot_.Consume();
+    ViewerSnapshot& snapshot = viewer_snapshot_.GetReadBuffer();
+
+    if (init || (new_data && ViewerNeedsSync(snapshot)))
+    {
+        // Structural changes are rare, synchronize with the scenario in between steps
+        mutex.Lock();
+        SyncViewerEntities(init);
+        mutex.Unlock();
+    }
+
+    if (init)
+    {
+        return;
+    }
+
+    if (new_data)
+    {
+        // Visualize entities. Snapshot might be older than latest synchronization, skip any entity not matching.
+        for (size_t i = 0; i < snapshot.entities.size() && i < viewer_->entities_.size(); i++)
+        {
+            viewer::EntityModel*     entity = viewer_->entities_[i];
+            const EntityRenderState& state  = snapshot.entities[i];
+            roadmanager::Position&   pos    = snapshot.entities[i].pos;
+
+            if (state.name != entity->name_)
             {
-                entity->routewaypoints_->SetWayPoints(nullptr);
+                continue;
             }
 
+            entity->SetPosition(pos.GetX(), pos.GetY(), pos.GetZ());
+            entity->SetRotation(pos.GetH(), pos.GetP(), pos.GetR());
+
             if (entity->IsMoving())
             {
                 if (entity->IsVehicle())
                 {
                     viewer::CarModel* car = static_cast<viewer::CarModel*>(entity);
-                    car->UpdateWheels(obj->wheel_angle_, obj->wheel_rot_);
+                    car->UpdateWheels(state.wheel_angle, state.wheel_rot);
                 }
 
                 viewer::MovingModel* mov = static_cast<viewer::MovingModel*>(entity);
 
                 if (mov->steering_sensor_ && mov->steering_sensor_->IsVisible())
                 {
-                    viewer_->SensorSetPivotPos(mov->steering_sensor_, obj->pos_.GetX(), obj->pos_.GetY(), obj->pos_.GetZ());
-                    viewer_->SensorSetTargetPos(mov->steering_sensor_, obj->sensor_pos_[0], obj->sensor_pos_[1], obj->sensor_pos_[2]);
+                    viewer_->SensorSetPivotPos(mov->steering_sensor_, pos.GetX(), pos.GetY(), pos.GetZ());
+                    viewer_->SensorSetTargetPos(mov->steering_sensor_, state.sensor_pos[0], state.sensor_pos[1], state.sensor_pos[2]);
                     viewer_->UpdateSensor(mov->steering_sensor_);
                 }
                 if (mov->trail_sensor_ && mov->steering_sensor_->IsVisible())
                 {
-                    viewer_->SensorSetPivotPos(mov->trail_sensor_, obj->trail_closest_pos_.x, obj->trail_closest_pos_.y, obj->trail_closest_pos_.z);
-                    viewer_->SensorSetTargetPos(mov->trail_sensor_, obj->pos_.GetX(), obj->pos_.GetY(), obj->pos_.GetZ());
+                    viewer_->SensorSetPivotPos(mov->trail_sensor_, state.trail_closest_pos.x, state.trail_closest_pos.y, state.trail_closest_pos.z);
+                    viewer_->SensorSetTargetPos(mov->trail_sensor_, pos.GetX(), pos.GetY(), pos.GetZ());
                     viewer_->UpdateSensor(mov->trail_sensor_);
                 }
 
                 if (odr_manager->GetNumOfRoads() > 0 && mov->road_sensor_)
                 {
-                    mov->ShowRouteSensor(obj->pos_.GetRoute() ? true : false);
-                    viewer_->UpdateRoadSensors(mov->road_sensor_, mov->route_sensor_, mov->lane_sensor_, &obj->pos_);
+                    mov->ShowRouteSensor(state.has_route);
+                    viewer_->UpdateRoadSensors(mov->road_sensor_,
+                                               mov->route_sensor_,
+                                               mov->lane_sensor_,
+                                               &pos,
+                                               state.route_valid,
+                                               state.route_track_id,
+                                               state.route_lane_id,
+                                               state.route_s);
                 }
             }
 
-            if (entity->trail_->pline_vertex_data_->size() > obj->trail_.GetNumberOfVertices())
+            // keep the trail in sync with the one of the entity, which might have discarded old vertices
+            if (state.trail_n_discarded > entity->trail_->n_discarded_)
             {
-                // Reset the trail, probably there has been a ghost restart
-                entity->trail_->Reset();
-                for (unsigned int j = 0; j < obj->trail_.GetNumberOfVertices(); j++)
-                {
-                    entity->trail_->AddPoint(obj->trail_.vertex_[j].x,
-                                             obj->trail_.vertex_[j].y,
-                                             obj->trail_.vertex_[j].z + (obj->GetId() + 1) * TRAIL_Z_OFFSET);
-                }
+                entity->trail_->DiscardPoints(state.trail_n_discarded - entity->trail_->n_discarded_);
             }
 
-            if (obj->trail_.GetNumberOfVertices() > entity->trail_->pline_vertex_data_->size())
+            if (state.trail_n_discarded + state.trail_n_vertices > entity->trail_->n_discarded_ + entity->trail_->pline_vertex_data_->size())
             {
-                entity->trail_->AddPoint(obj->pos_.GetX(), obj->pos_.GetY(), obj->pos_.GetZ() + (obj->GetId() + 1) * TRAIL_Z_OFFSET);
+                entity->trail_->AddPoint(pos.GetX(), pos.GetY(), pos.GetZ() + (state.id + 1) * TRAIL_Z_OFFSET);
             }
 
             // on screen text following each entity
             snprintf(entity->on_screen_info_.string_,
                      sizeof(entity->on_screen_info_.string_),
                      " %s (%d) %.2fm\n %.2fkm/h road %d lane %d/%.2f s %.2f\n x %.2f y %.2f hdg %.2f\n osi x %.2f y %.2f \n|",
-                     obj->name_.c_str(),
-                     obj->GetId(),
-                     obj->odometer_,
-                     3.6 * obj->speed_,
-                     obj->pos_.GetTrackId(),
-                     obj->pos_.GetLaneId(),
-                     fabs(obj->pos_.GetOffset()) < SMALL_NUMBER ? 0 : obj->pos_.GetOffset(),
-                     obj->pos_.GetS(),
-                     obj->pos_.GetX(),
-                     obj->pos_.GetY(),
-                     obj->pos_.GetH(),
-                     obj->pos_.GetX() + static_cast<double>(obj->boundingbox_.center_.x_) * cos(obj->pos_.GetH()),
-                     obj->pos_.GetY() + static_cast<double>(obj->boundingbox_.center_.x_) * sin(obj->pos_.GetH()));
+                     state.name.c_str(),
+                     state.id,
+                     state.odometer,
+                     3.6 * state.speed,
+                     pos.GetTrackId(),
+                     pos.GetLaneId(),
+                     fabs(pos.GetOffset()) < SMALL_NUMBER ? 0 : pos.GetOffset(),
+                     pos.GetS(),
+                     pos.GetX(),
+                     pos.GetY(),
+                     pos.GetH(),
+                     pos.GetX() + state.bb_center_x * cos(pos.GetH()),
+                     pos.GetY() + state.bb_center_x * sin(pos.GetH()));
             entity->on_screen_info_.osg_text_->setText(entity->on_screen_info_.string_);
         }
 
+        // Sensor frustums are created in the same order as the sensors
+        size_t k = 0;
         for (size_t i = 0; i < sensorFrustum.size(); i++)
         {
-            sensorFrustum[i]->Update();
+            while (k < snapshot.sensors.size() && snapshot.sensors[k].sensor != sensorFrustum[i]->sensor_)
+            {
+                k++;
+            }
+            if (k < snapshot.sensors.size())
+            {
+                sensorFrustum[i]->Update(snapshot.sensors[k].hits);
+            }
         }
 
         // Update info text
         static char str_buf[128];
-        if (viewer_->currentCarInFocus_ >= 0 && static_cast<unsigned int>(viewer_->currentCarInFocus_) < viewer_->entities_.size())
+        if (viewer_->currentCarInFocus_ >= 0 && static_cast<unsigned int>(viewer_->currentCarInFocus_) < viewer_->entities_.size() &&
+            static_cast<unsigned int>(viewer_->currentCarInFocus_) < snapshot.entities.size())
         {
-            Object* obj = scenarioEngine->entities_.object_[static_cast<unsigned int>(viewer_->currentCarInFocus_)];
+            EntityRenderState& state = snapshot.entities[static_cast<unsigned int>(viewer_->currentCarInFocus_)];
             snprintf(str_buf,
                      sizeof(str_buf),
                      "%.2fs entity[%d]: %s (%d) %.2fkm/h %.2fm (%d, %d, %.2f, %.2f) / (%.2f, %.2f %.2f)",
-                     scenarioEngine->getSimulationTime(),
+                     snapshot.sim_time,
                      viewer_->currentCarInFocus_,
-                     obj->name_.c_str(),
-                     obj->GetId(),
-                     3.6 * obj->speed_,
-                     obj->odometer_,
-                     obj->pos_.GetTrackId(),
-                     obj->pos_.GetLaneId(),
-                     fabs(obj->pos_.GetOffset()) < SMALL_NUMBER ? 0 : obj->pos_.GetOffset(),
-                     obj->pos_.GetS(),
-                     obj->pos_.GetX(),
-                     obj->pos_.GetY(),
-                     obj->pos_.GetH());
+                     state.name.c_str(),
+                     state.id,
+                     3.6 * state.speed,
+                     state.odometer,
+                     state.pos.GetTrackId(),
+                     state.pos.GetLaneId(),
+                     fabs(state.pos.GetOffset()) < SMALL_NUMBER ? 0 : state.pos.GetOffset(),
+                     state.pos.GetS(),
+                     state.pos.GetX(),
+                     state.pos.GetY(),
+                     state.pos.GetH());
         }
         else
         {
             if (viewer_->currentCarInFocus_ < 0 && viewer_->entities_.size() > 1)
             {
-                snprintf(str_buf, sizeof(str_buf), "%.2fs Environment in focus", scenarioEngine->getSimulationTime());
+                snprintf(str_buf, sizeof(str_buf), "%.2fs Environment in focus", snapshot.sim_time);
             }
             else if (viewer_->currentCarInFocus_ > 0 && static_cast<unsigned int>(viewer_->currentCarInFocus_) >= viewer_->entities_.size())
             {
-                snprintf(str_buf, sizeof(str_buf), "%.2fs All entities in focus", scenarioEngine->getSimulationTime());
+                snprintf(str_buf, sizeof(str_buf), "%.2fs All entities in focus", snapshot.sim_time);
             }
             else
             {
-                snprintf(str_buf, sizeof(str_buf), "%.2fs", scenarioEngine->getSimulationTime());
+                snprintf(str_buf, sizeof(str_buf), "%.2fs", snapshot.sim_time);
             }
         }
         viewer_->SetInfoText(str_buf);
     }
 
-    mutex.Unlock();
-
-    if (!init)
-    {
-        viewer_->Frame(scenarioEngine->getSimulationTime());
-    }
+    viewer_->Frame(snapshot.sim_time);
 }
 
 int ScenarioPlayer::SaveImagesToRAM(bool state)
@@ -1283,6 +1456,9 @@ int ScenarioPlayer::Init()
     opt.AddOption("csv_logger", "Log data for each vehicle in ASCII csv format", "csv_filename", "log.csv");
     opt.AddOption("collision", "Enable global collision detection, potentially reducing performance");
     opt.AddOption(CONFIG_FILE_OPTION_NAME, "Configuration file path/filename, e.g. \"../my_config.txt\"", "path", DEFAULT_CONFIG_FILE, false, false);
+    opt.AddOption("controller_threads",
+                  "Number of threads for perception phase of controllers (0 and 1 = serial). Result does not depend on number of threads",
+                  "number");
     opt.AddOption("custom_camera", "Additional custom camera position <x,y,z>[,h,p]", "position", "", false, false);
     opt.AddOption("custom_fixed_camera",
                   "Additional custom fixed camera position <x,y,z>[,h,p]",
@@ -1305,6 +1481,9 @@ int ScenarioPlayer::Init()
     opt.AddOption("follow_object",
                   "Set index of initial object for camera to follow (change with Tab/shift-Tab)",
                   "object index (0, 1, 2..., ALL, ROAD)");
+    opt.AddOption("frame_budget",
+                  "Max frame time in realtime mode. When exceeded, output is written in background and viewer/plot updated less often",
+                  "milliseconds");
     opt.AddOption("generate_no_road_objects", "Do not generate any OpenDRIVE road objects (e.g. when part of referred 3D model)");
     opt.AddOption("generate_without_textures", "Do not apply textures on any generated road model (set colors instead as for missing textures)");
     opt.AddOption("ground_plane", "Add a large flat ground surface");
@@ -1330,16 +1509,44 @@ int ScenarioPlayer::Init()
     opt.AddOption("osg_screenshot_event_handler", "Revert to OSG default jpg images ('c'/'C' keys handler)");
 #ifdef _USE_OSI
     opt.AddOption("osi_crop_dynamic", "Crop the dynamic osi data around the given object id with given radius", "id,radius", "", false, false);
+    opt.AddOption("osi_crop_static",
+                  "Crop the static osi lanes and lane boundaries around the given object id with given radius",
+                  "id,radius",
+                  "",
+                  false,
+                  false);
+    opt.AddOption("osi_delta",
+                  "Save/send only moving objects changed beyond tolerance since last output (m, rad, m/s, m/s2). Implies osi_in_place",
+                  "tolerance",
+                  "0.001");
     opt.AddOption("osi_exclude_ghost", "Excludes ghost from osi dynamic osi ground truth");
     opt.AddOption("osi_file", "Save osi trace file", "filename", DEFAULT_OSI_TRACE_FILENAME);
+    opt.AddOption("osi_file_chunked",
+                  "Save osi trace file in compressed chunks of given number of frames, indexed for random access. Static data stored once",
+                  "frames",
+                  std::to_string(CHUNKED_TRACE_DEFAULT_CHUNK_FRAMES));
     opt.AddOption("osi_freq", "Decrease OSI file entries, e.g. --osi_freq 2 -> OSI written every two simulation steps", "frequency");
+    opt.AddOption("osi_in_place", "Update OSI moving objects in place, matched by id, instead of rebuilding them every frame");
     opt.AddOption("osi_lines", "Show OSI road lines. Toggle key 'u'");
+    opt.AddOption("osi_output_rate",
+                  "Save/send OSI at given rate, independent of step size. Moving objects interpolated between frames, in a separate thread",
+                  "Hz");
     opt.AddOption("osi_points", "Show OSI road points. Toggle key 'y'");
     opt.AddOption("osi_receiver_ip", "IP address where to send OSI UDP packages", "IP address", "127.0.0.1");
+    opt.AddOption("osi_sensor_view",
+                  "Create OSI SensorView per object sensor, with objects and lanes in field of view, built by given number of threads (0=all)",
+                  "threads",
+                  "0");
+    opt.AddOption("osi_shm", "Publish OSI ground truth in shared memory (POSIX only), for receivers on same host", "name", "esmini_osi");
     opt.AddOption("osi_static_reporting",
                   "Decide how the static data should be reported, 0=Default (first frame), 1=API (expose on API) 2=API_AND_LOG (Always log)",
                   "mode",
                   "0");
+    opt.AddOption("osi_threads",
+                  "Number of threads for preparing OSI moving and stationary objects (0=off). Result does not depend on number of threads",
+                  "number");
+    opt.AddOption("osi_udp_fragment_size", "Max payload of each OSI UDP package (default 8192, max 65495). Must match the receiver", "bytes");
+    opt.AddOption("osi_udp_rate", "Pace OSI UDP packages to avoid bursts overflowing the receiver, max average rate", "Mbit/s");
 #endif
     opt.AddOption("param_dist", "Run variations of the scenario according to specified parameter distribution file", "filename");
     opt.AddOption("param_permutation", "Run specific permutation of parameter distribution, index in range (0 .. NumberOfPermutations-1)", "index");
@@ -1360,15 +1567,21 @@ int ScenarioPlayer::Init()
                   "continue",
                   false);
     opt.AddOption("seed", "Specify seed number for random generator", "number");
+    opt.AddOption("sensor_threads",
+                  "Number of threads for updating ideal object sensors (0=off). Result does not depend on number of threads",
+                  "number");
     opt.AddOption("sensors", "Show sensor frustums. Toggle key 'r'");
     opt.AddOption("server", "Launch server to receive state of external Ego simulator");
     opt.AddOption("text_scale", "Scale screen overlay text", "size factor", "1.0", true);
     opt.AddOption("threads", "Run viewer in a separate thread, parallel to scenario engine");
+    opt.AddOption("trail_horizon", "Time span of entity trails, e.g. ghost trail. Older trail is discarded. Set 0 to keep all", "seconds", "0");
     opt.AddOption("trail_mode", "Show trail lines and/or dots. Modes: 0=None 1=lines 2=dots 3=both. Toggle key 'j'", "mode", "0");
     opt.AddOption("traj_filter", "Simple filter merging close points. Set 0.0 to disable", "radius", "0.1", true);
     opt.AddOption("tunnel_transparency", "Set level of transparency for generated tunnels [0:1]", "transparency", "0.0");
     opt.AddOption("use_signs_in_external_model", "When external scenegraph 3D model is loaded, skip creating signs from OpenDRIVE");
     opt.AddOption("version", "Show version and quit");
+    opt.AddOption("write_buffer", "Size of buffer for file output written by separate thread. Set 0 to write in main thread", "size kB", "4096");
+    opt.AddOption("write_drop", "Drop frames of file output when write buffer is full, instead of waiting for space");
 
     if (int ret = OnRequestShowHelpOrVersion(argc_, argv_, opt); ret > 0)
     {
@@ -1536,12 +1749,43 @@ int ScenarioPlayer::Init()
 #endif
     }
 
+    if (opt.GetOptionSet("sensor_threads"))
+    {
+        sensorManager.SetNumberOfThreads(static_cast<unsigned int>(MAX(1, strtoi(opt.GetOptionArg("sensor_threads")))));
+    }
+
     if (opt.GetOptionSet("server"))
     {
         launch_server = true;
         LOG_INFO("Launch server to receive state of external Ego simulator");
     }
 
+    if (opt.GetOptionSet("frame_budget"))
+    {
+        scheduler.SetBudget(1e-3 * strtod(opt.GetOptionArg("frame_budget")));
+        LOG_INFO("Frame time budget: {:.2f} ms", 1e3 * scheduler.GetBudget());
+    }
+
+    if (opt.GetOptionSet("write_buffer"))
+    {
+        SE_Env::Inst().SetWriteBufferSize(static_cast<size_t>(1024 * MAX(0, strtoi(opt.GetOptionArg("write_buffer")))));
+    }
+    else
+    {
+        SE_Env::Inst().SetWriteBufferSize(DEFAULT_WRITE_BUFFER_SIZE);
+    }
+    SE_Env::Inst().SetWriteDropWhenFull(opt.GetOptionSet("write_drop"));
+
+    if (opt.GetOptionSet("trail_horizon"))
+    {
+        SE_Env::Inst().SetTrailHorizon(MAX(0.0, strtod(opt.GetOptionArg("trail_horizon"))));
+        LOG_INFO("Trail horizon: {:.2f} s", SE_Env::Inst().GetTrailHorizon());
+    }
+    else
+    {
+        SE_Env::Inst().SetTrailHorizon(0.0);
+    }
+
     int index = 0;
     for (; (arg_str = opt.GetOptionArg("fixed_timestep", index)) != ""; index++)
     {
@@ -1698,6 +1942,7 @@ int ScenarioPlayer::Init()
 #ifdef _USE_OSI
     osiReporter = new OSIReporter(scenarioEngine);
     osiReporter->SetCounterPtr(&frame_counter_);
+    osiReporter->SetSensors(&sensor);
     osiReporter->SetStationaryModelReference(scenarioEngine->getSceneGraphFilename());
     scenarioEngine->storyBoard.SetOSIReporter(osiReporter);
 
@@ -1710,6 +1955,15 @@ int ScenarioPlayer::Init()
         }
     }
 
+    if (opt.GetOptionSet("osi_shm"))
+    {
+        osiReporter->OpenSharedMemory(opt.GetOptionArg("osi_shm"));
+        if (osiReporter->GetOSIFrequency() == 0)
+        {
+            osiReporter->SetOSIFrequency(1);
+        }
+    }
+
     if (opt.GetOptionSet("osi_crop_dynamic") == true)
     {
         int counter = 0;
@@ -1730,13 +1984,48 @@ int ScenarioPlayer::Init()
         }
     }
 
+    if (opt.GetOptionSet("osi_crop_static") == true)
+    {
+        int counter = 0;
+
+        while ((arg_str = opt.GetOptionArg("osi_crop_static", counter)) != "")
+        {
+            const auto splitted = SplitString(arg_str, ',');
+            if (splitted.size() == 2)
+            {
+                osiReporter->CropOSIStaticGroundTruth(strtoi(splitted[0]), strtod(splitted[1]));
+            }
+            else
+            {
+                LOG_ERROR("Expected osi_crop_static <id,radius>. Got {} values instead of 2.", splitted.size());
+            }
+
+            counter++;
+        }
+    }
+
     if (opt.GetOptionSet("osi_exclude_ghost"))
     {
         osiReporter->ExcludeGhost();
     }
 
+    if (opt.GetOptionSet("osi_in_place"))
+    {
+        osiReporter->SetOSIUpdateInPlace(true);
+    }
+
+    if (opt.GetOptionSet("osi_delta"))
+    {
+        osiReporter->SetOSIDeltaOutput(MAX(0.0, strtod(opt.GetOptionArg("osi_delta"))));
+    }
+
     std::string osi_filename;
     // First check arguments
+    if (opt.GetOptionSet("osi_file_chunked"))
+    {
+        osiReporter->SetOSIFileChunked(static_cast<unsigned int>(MAX(1, strtoi(opt.GetOptionArg("osi_file_chunked")))));
+    }
+
     if (opt.GetOptionSet("osi_file"))
     {
         osi_filename = opt.GetOptionArg("osi_file");
@@ -1758,6 +2047,39 @@ int ScenarioPlayer::Init()
         osiReporter->SetOSIStaticReportMode(static_cast<OSIReporter::OSIStaticReportMode>(atoi(arg_str.c_str())));
         LOG_INFO("OSI static data reporting mode: {}", arg_str);
     }
+
+    if (opt.GetOptionSet("osi_threads"))
+    {
+        osiReporter->SetNumberOfThreads(static_cast<unsigned int>(MAX(1, strtoi(opt.GetOptionArg("osi_threads")))));
+    }
+
+    if ((arg_str = opt.GetOptionArg("osi_udp_fragment_size")) != "")
+    {
+        osiReporter->SetUDPFragmentSize(static_cast<unsigned int>(MAX(0, strtoi(arg_str))));
+    }
+
+    if ((arg_str = opt.GetOptionArg("osi_udp_rate")) != "")
+    {
+        osiReporter->SetUDPRateLimit(strtod(arg_str));
+    }
+
+    if ((arg_str = opt.GetOptionArg("osi_output_rate")) != "")
+    {
+        osiReporter->SetOSIOutputRate(strtod(arg_str));
+        if (osiReporter->GetOSIFrequency() == 0)
+        {
+            osiReporter->SetOSIFrequency(1);
+        }
+    }
+
+    if (opt.GetOptionSet("osi_sensor_view"))
+    {
+        osiReporter->SetOSISensorViews(true, static_cast<unsigned int>(MAX(0, strtoi(opt.GetOptionArg("osi_sensor_view")))));
+        if (osiReporter->GetOSIFrequency() == 0)
+        {
+            osiReporter->SetOSIFrequency(1);
+        }
+    }
 #endif  // _USE_OSI
 
     // Initialize CSV logger for recording vehicle data
@@ -1905,71 +2227,150 @@ void ScenarioPlayer::RegisterObjCallback(int id, ObjCallbackFunc func, void* dat
     objCallback.push_back(cb);
 }
 
-void ScenarioPlayer::UpdateCSV_Log()
+void ScenarioPlayer::GetCSV_LogRecords(std::vector<CSV_LogRecord>& records)
 {
-    // Flag for signalling end of data line, all vehicles reported
-    bool isendline = false;
-
-    CSV_Log->LogEntryHeader(scenarioEngine->getSimulationTime());
+    records.resize(scenarioEngine->entities_.object_.size());
 
     // For each vehicle (entitity) stored in the ScenarioPlayer
     for (size_t i = 0; i < scenarioEngine->entities_.object_.size(); i++)
     {
-        // Create a pointer to the object at position i in the entities vector
-        Object* obj = scenarioEngine->entities_.object_[i];
-
-        // Create a Position object for extracting this vehicles XYZ coordinates
-        roadmanager::Position pos = obj->pos_;
-
-        // Extract the String name of the object and store in a compatable const char array
-        const char* name_ = &(*obj->name_.c_str());
-
-        if ((i + 1) == scenarioEngine->entities_.object_.size())
-        {
-            isendline = true;
-        }
-
-        // Log the extracted data of ego vehicle and additonal scenario vehicles
-        std::string collision_ids;
+        Object*                      obj    = scenarioEngine->entities_.object_[i];
+        const roadmanager::Position& pos    = obj->pos_;
+        CSV_LogRecord&               record = records[i];
+
+        record.name        = obj->name_;
+        record.id          = obj->id_;
+        record.speed       = obj->speed_;
+        record.wheel_angle = obj->wheel_angle_;
+        record.wheel_rot   = obj->wheel_rot_;
+        record.bb_x        = static_cast<double>(obj->boundingbox_.center_.x_);
+        record.bb_y        = static_cast<double>(obj->boundingbox_.center_.y_);
+        record.bb_z        = static_cast<double>(obj->boundingbox_.center_.z_);
+        record.bb_length   = static_cast<double>(obj->boundingbox_.dimensions_.length_);
+        record.bb_width    = static_cast<double>(obj->boundingbox_.dimensions_.width_);
+        record.bb_height   = static_cast<double>(obj->boundingbox_.dimensions_.height_);
+        record.x           = pos.GetX();
+        record.y           = pos.GetY();
+        record.z           = pos.GetZ();
+        record.vel_x       = pos.GetVelX();
+        record.vel_y       = pos.GetVelY();
+        record.vel_z       = pos.GetVelZ();
+        record.acc_x       = pos.GetAccX();
+        record.acc_y       = pos.GetAccY();
+        record.acc_z       = pos.GetAccZ();
+        record.s           = pos.GetS();
+        record.t           = pos.GetT();
+        record.lane_id     = pos.GetLaneId();
+        record.offset      = pos.GetOffset();
+        record.h           = pos.GetH();
+        record.h_rate      = pos.GetHRate();
+        record.h_relative  = pos.GetHRelative();
+        record.p           = pos.GetP();
+        record.curvature   = pos.GetCurvature();
+
+        record.h_relative_driving_direction = pos.GetHRelativeDrivingDirection();
+
+        record.collision_ids.clear();
         if (SE_Env::Inst().GetCollisionDetection())
         {
             for (size_t j = 0; j < obj->collisions_.size(); j++)
             {
-                collision_ids += std::to_string(obj->collisions_[j]->GetId()) + " ";
+                record.collision_ids += std::to_string(obj->collisions_[j]->GetId()) + " ";
             }
         }
-        CSV_Log->LogVehicleData(isendline,
-                                name_,
-                                obj->id_,
-                                obj->speed_,
-                                obj->wheel_angle_,
-                                obj->wheel_rot_,
-                                obj->boundingbox_.center_.x_,
-                                obj->boundingbox_.center_.y_,
-                                obj->boundingbox_.center_.z_,
-                                obj->boundingbox_.dimensions_.length_,
-                                obj->boundingbox_.dimensions_.width_,
-                                obj->boundingbox_.dimensions_.height_,
-                                pos.GetX(),
-                                pos.GetY(),
-                                pos.GetZ(),
-                                pos.GetVelX(),
-                                pos.GetVelY(),
-                                pos.GetVelZ(),
-                                pos.GetAccX(),
-                                pos.GetAccY(),
-                                pos.GetAccZ(),
-                                pos.GetS(),
-                                pos.GetT(),
-                                pos.GetLaneId(),
-                                pos.GetOffset(),
-                                pos.GetH(),
-                                pos.GetHRate(),
-                                pos.GetHRelative(),
-                                pos.GetHRelativeDrivingDirection(),
-                                pos.GetP(),
-                                pos.GetCurvature(),
-                                collision_ids.c_str());
+    }
+}
+
+void ScenarioPlayer::WriteCSV_Log(CSV_Logger* logger, double timestamp, const std::vector<CSV_LogRecord>& records)
+{
+    logger->LogEntryHeader(timestamp);
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const CSV_LogRecord& record = records[i];
+
+        // Flag for signalling end of data line, all vehicles reported
+        bool isendline = (i + 1) == records.size();
+
+        // Log the extracted data of ego vehicle and additonal scenario vehicles
+        logger->LogVehicleData(isendline,
+                               record.name.c_str(),
+                               record.id,
+                               record.speed,
+                               record.wheel_angle,
+                               record.wheel_rot,
+                               record.bb_x,
+                               record.bb_y,
+                               record.bb_z,
+                               record.bb_length,
+                               record.bb_width,
+                               record.bb_height,
+                               record.x,
+                               record.y,
+                               record.z,
+                               record.vel_x,
+                               record.vel_y,
+                               record.vel_z,
+                               record.acc_x,
+                               record.acc_y,
+                               record.acc_z,
+                               record.s,
+                               record.t,
+                               record.lane_id,
+                               record.offset,
+                               record.h,
+                               record.h_rate,
+                               record.h_relative,
+                               record.h_relative_driving_direction,
+                               record.p,
+                               record.curvature,
+                               record.collision_ids.c_str());
+    }
+}
+
+void ScenarioPlayer::UpdateCSV_Log()
+{
+    double timestamp = scenarioEngine->getSimulationTime();
+
+    if (scheduler.IsBackground(FrameScheduler::Stage::CSV_LOG))
+    {
+        // capture data now, write it later
+        std::vector<CSV_LogRecord> records;
+        GetCSV_LogRecords(records);
+        CSV_Logger* logger = CSV_Log;
+        scheduler.RunOutput(FrameScheduler::Stage::CSV_LOG,
+                            [logger, timestamp, records = std::move(records)]() { WriteCSV_Log(logger, timestamp, records); });
+    }
+    else
+    {
+        scheduler.Run(FrameScheduler::Stage::CSV_LOG,
+                      [this, timestamp]()
+                      {
+                          GetCSV_LogRecords(csv_records_);
+                          WriteCSV_Log(CSV_Log, timestamp, csv_records_);
+                      });
+    }
+}
+
+void ScenarioPlayer::WriteRecording()
+{
+    if (!scenarioGateway->IsRecording())
+    {
+        return;
+    }
+
+    if (scheduler.IsBackground(FrameScheduler::Stage::RECORDING))
+    {
+        // capture states now, write them later
+        std::vector<ObjectStateStructDat> states;
+        scenarioGateway->GetStatesForFile(states);
+        ScenarioGateway* gateway = scenarioGateway;
+        scheduler.RunOutput(FrameScheduler::Stage::RECORDING,
+                            [gateway, states = std::move(states)]() { gateway->WriteStatesToFile(states); });
+    }
+    else
+    {
+        scheduler.Run(FrameScheduler::Stage::RECORDING, [this]() { scenarioGateway->WriteStatesToFile(); });
     }
 }
 
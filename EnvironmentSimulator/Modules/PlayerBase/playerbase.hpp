@@ -20,6 +20,7 @@
 #include "CommonMini.hpp"
 #include "Server.hpp"
 #include "IdealSensor.hpp"
+#include "FrameScheduler.hpp"
 
 #ifdef _USE_OSI
 #include "OSIReporter.hpp"
@@ -246,6 +247,8 @@ namespace scenarioengine
 #endif
         roadmanager::OpenDrive     *odr_manager;
         std::vector<ObjectSensor *> sensor;
+        ObjectSensorManager         sensorManager;
+        FrameScheduler              scheduler;
         const double                maxStepSize;
         const double                minStepSize;
         std::vector<ObjCallback>    objCallback;
@@ -254,6 +257,104 @@ namespace scenarioengine
         SE_Semaphore                viewer_init_semaphore;
 
     private:
+        // Data of one entity for the CSV log, captured in the frame so that writing can be deferred
+        struct CSV_LogRecord
+        {
+            std::string name;
+            int         id;
+            double      speed;
+            double      wheel_angle;
+            double      wheel_rot;
+            double      bb_x;
+            double      bb_y;
+            double      bb_z;
+            double      bb_length;
+            double      bb_width;
+            double      bb_height;
+            double      x;
+            double      y;
+            double      z;
+            double      vel_x;
+            double      vel_y;
+            double      vel_z;
+            double      acc_x;
+            double      acc_y;
+            double      acc_z;
+            double      s;
+            double      t;
+            int         lane_id;
+            double      offset;
+            double      h;
+            double      h_rate;
+            double      h_relative;
+            double      h_relative_driving_direction;
+            double      p;
+            double      curvature;
+            std::string collision_ids;
+        };
+
+        void        GetCSV_LogRecords(std::vector<CSV_LogRecord> &records);
+        static void WriteCSV_Log(CSV_Logger *logger, double timestamp, const std::vector<CSV_LogRecord> &records);
+        void        WriteRecording();
+
+        std::vector<CSV_LogRecord> csv_records_;  // reused buffer for synchronous logging
+
+        // Render state of one entity, as published by the scenario thread for the viewer
+        struct EntityRenderState
+        {
+            Object                    *obj;  // identity only, not to be accessed by the viewer
+            int                        id;
+            std::string                name;
+            std::string                model3d;
+            roadmanager::Position      pos;  // location only, no route
+            roadmanager::RMTrajectory *trajectory;
+            bool                       has_route;
+            bool                       route_dirty;
+            bool                       route_valid;
+            id_t                       route_track_id;
+            int                        route_lane_id;
+            double                     route_s;
+            double                     wheel_angle;
+            double                     wheel_rot;
+            double                     sensor_pos[3];
+            roadmanager::TrajVertex    trail_closest_pos;
+            unsigned int               trail_n_vertices;   // retained trail vertices
+            unsigned int               trail_n_discarded;  // trail vertices discarded from the start, see trail horizon
+            double                     odometer;
+            double                     speed;
+            double                     bb_center_x;
+        };
+
+        struct SensorRenderState
+        {
+            ObjectSensor       *sensor;
+            std::vector<double> hits;  // x, y, z of each detected object, z compensated for host pitch
+        };
+
+        struct ViewerSnapshot
+        {
+            double                         sim_time = 0.0;
+            std::vector<EntityRenderState> entities;
+            std::vector<SensorRenderState> sensors;
+        };
+
+        /**
+        Capture render state of entities and sensors and hand it over to the viewer. Called by the scenario thread,
+        the viewer picks up the latest snapshot without locking. Only structural changes, e.g. added or removed
+        entities, make the viewer synchronize with the scenario under the mutex.
+        */
+        void PublishViewerSnapshot();
+
+        SE_TripleBuffer<ViewerSnapshot> viewer_snapshot_;
+
+#ifdef _USE_OSG
+        // Check whether viewer entities no longer match the scenario, e.g. entity added or trajectory changed
+        bool ViewerNeedsSync(const ViewerSnapshot &snapshot);
+
+        // Add, remove and reset viewer entities to match the scenario. Accesses scenario data, call with mutex locked.
+        void SyncViewerEntities(bool init);
+#endif
+
         double      trail_dt;
         SE_Thread   thread;
         SE_Mutex    mutex;
@@ -6787,6 +6787,175 @@ void Position::CopyLocation(const Position& from)
     route_waypoint_dir_     = from.route_waypoint_dir_;
 }
 
+void Position::SaveState(SE_StateStream& stream) const
+{
+    stream.Write(track_id_);
+    stream.Write(s_);
+    stream.Write(t_);
+    stream.Write(lane_id_);
+    stream.Write(offset_);
+    stream.Write(h_road_);
+    stream.Write(h_offset_);
+    stream.Write(h_relative_);
+    stream.Write(z_relative_);
+    stream.Write(t_trajectory_);
+    stream.Write(curvature_);
+    stream.Write(p_relative_);
+    stream.Write(r_relative_);
+    stream.Write(mode_update_);
+    stream.Write(mode_set_);
+    stream.Write(mode_init_);
+    stream.Write(type_);
+    stream.Write(direction_mode_);
+    stream.Write(snapToLaneTypes_);
+    stream.Write(status_);
+    stream.Write(lockOnLane_);
+    stream.Write(x_);
+    stream.Write(y_);
+    stream.Write(z_);
+    stream.Write(h_);
+    stream.Write(p_);
+    stream.Write(r_);
+    stream.Write(h_rate_);
+    stream.Write(p_rate_);
+    stream.Write(r_rate_);
+    stream.Write(h_acc_);
+    stream.Write(p_acc_);
+    stream.Write(r_acc_);
+    stream.Write(velX_);
+    stream.Write(velY_);
+    stream.Write(velZ_);
+    stream.Write(accX_);
+    stream.Write(accY_);
+    stream.Write(accZ_);
+    stream.Write(z_road_);
+    stream.Write(p_road_);
+    stream.Write(r_road_);
+    stream.Write(z_roadPrim_);
+    stream.Write(z_roadPrimPrim_);
+    stream.Write(roadSuperElevationPrim_);
+    stream.Write(osi_x_);
+    stream.Write(osi_y_);
+    stream.Write(osi_z_);
+    stream.Write(track_idx_);
+    stream.Write(lane_idx_);
+    stream.Write(roadmark_idx_);
+    stream.Write(roadmarktype_idx_);
+    stream.Write(roadmarkline_idx_);
+    stream.Write(lane_section_idx_);
+    stream.Write(geometry_idx_);
+    stream.Write(elevation_idx_);
+    stream.Write(super_elevation_idx_);
+    stream.Write(osi_point_idx_);
+    stream.Write(routeStrategy_);
+    stream.Write(route_waypoint_s_);
+    stream.Write(route_waypoint_dir_);
+    stream.Write(relative_);
+    stream.WriteVector(overlapping_roads);
+
+    stream.Write(route_ != nullptr);
+    if (route_ != nullptr)
+    {
+        stream.Write(route_->path_s_);
+        stream.Write(route_->waypoint_idx_);
+        stream.Write(route_->on_route_);
+        route_->currentPos_.SaveState(stream);
+    }
+}
+
+int Position::RestoreState(SE_StateStream& stream)
+{
+    stream.Read(track_id_);
+    stream.Read(s_);
+    stream.Read(t_);
+    stream.Read(lane_id_);
+    stream.Read(offset_);
+    stream.Read(h_road_);
+    stream.Read(h_offset_);
+    stream.Read(h_relative_);
+    stream.Read(z_relative_);
+    stream.Read(t_trajectory_);
+    stream.Read(curvature_);
+    stream.Read(p_relative_);
+    stream.Read(r_relative_);
+    stream.Read(mode_update_);
+    stream.Read(mode_set_);
+    stream.Read(mode_init_);
+    stream.Read(type_);
+    stream.Read(direction_mode_);
+    stream.Read(snapToLaneTypes_);
+    stream.Read(status_);
+    stream.Read(lockOnLane_);
+    stream.Read(x_);
+    stream.Read(y_);
+    stream.Read(z_);
+    stream.Read(h_);
+    stream.Read(p_);
+    stream.Read(r_);
+    stream.Read(h_rate_);
+    stream.Read(p_rate_);
+    stream.Read(r_rate_);
+    stream.Read(h_acc_);
+    stream.Read(p_acc_);
+    stream.Read(r_acc_);
+    stream.Read(velX_);
+    stream.Read(velY_);
+    stream.Read(velZ_);
+    stream.Read(accX_);
+    stream.Read(accY_);
+    stream.Read(accZ_);
+    stream.Read(z_road_);
+    stream.Read(p_road_);
+    stream.Read(r_road_);
+    stream.Read(z_roadPrim_);
+    stream.Read(z_roadPrimPrim_);
+    stream.Read(roadSuperElevationPrim_);
+    stream.Read(osi_x_);
+    stream.Read(osi_y_);
+    stream.Read(osi_z_);
+    stream.Read(track_idx_);
+    stream.Read(lane_idx_);
+    stream.Read(roadmark_idx_);
+    stream.Read(roadmarktype_idx_);
+    stream.Read(roadmarkline_idx_);
+    stream.Read(lane_section_idx_);
+    stream.Read(geometry_idx_);
+    stream.Read(elevation_idx_);
+    stream.Read(super_elevation_idx_);
+    stream.Read(osi_point_idx_);
+    stream.Read(routeStrategy_);
+    stream.Read(route_waypoint_s_);
+    stream.Read(route_waypoint_dir_);
+    stream.Read(relative_);
+    stream.ReadVector(overlapping_roads);
+
+    bool has_route = false;
+    stream.Read(has_route);
+    if (has_route)
+    {
+        Route tmp_route;
+        Route* route = route_ != nullptr ? route_ : &tmp_route;
+
+        if (route_ == nullptr)
+        {
+            LOG_WARN("Position::RestoreState: Route missing, can't be re-created from state. Skipping route progress.");
+        }
+
+        stream.Read(route->path_s_);
+        stream.Read(route->waypoint_idx_);
+        stream.Read(route->on_route_);
+        route->currentPos_.RestoreState(stream);
+    }
+    else if (route_ != nullptr)
+    {
+        // route assigned after state was saved, drop it
+        delete route_;
+        route_ = nullptr;
+    }
+
+    return stream.Good() ? 0 : -1;
+}
+
 void Position::Duplicate(const Position& from)
 {
     if (this == &from)
@@ -11629,14 +11798,15 @@ void PolyLineBase::AddVertex(TrajVertex v)
 
 idx_t PolyLineBase::Evaluate(double s, TrajVertex& pos, idx_t startAtIndex)
 {
-    double       s_local = 0;
-    unsigned int i       = CLAMP(startAtIndex, 0, GetNumberOfVertices() - 1);
+    double s_local = 0;
 
     if (GetNumberOfVertices() < 1)
     {
         return IDX_UNDEFINED;
     }
 
+    unsigned int i = CLAMP(ToVertexIndex(startAtIndex), 0, GetNumberOfVertices() - 1);
+
     if (s > GetVertices().back().s - SMALL_NUMBER)
     {
         // end of trajectory
@@ -11644,15 +11814,14 @@ idx_t PolyLineBase::Evaluate(double s, TrajVertex& pos, idx_t startAtIndex)
         s_local = 0;
         i       = GetNumberOfVertices() - 1;
     }
-    else if (s > vertex_[i].s + SMALL_NUMBER)
-    {
-        for (; i < GetNumberOfVertices() - 1 && s > vertex_[i + 1].s + SMALL_NUMBER; i++)
-            ;  // move to the firstmost segment matching the provided s value
-    }
-    else if (s < vertex_[i].s + SMALL_NUMBER)
+    else if (!(i < GetNumberOfVertices() - 1 && s > vertex_[i].s + SMALL_NUMBER && s <= vertex_[i + 1].s + SMALL_NUMBER))
     {
-        for (; i > 0 && s < vertex_[i].s + SMALL_NUMBER; i--)
-            ;  // move to the firstmost segment matching the provided s value
+        // not in the segment of the start index, find the firstmost segment matching the provided s value
+        auto it = std::lower_bound(vertex_.begin() + 1,
+                                   vertex_.end(),
+                                   s - SMALL_NUMBER,
+                                   [](const TrajVertex& v, double value) { return v.s < value; });
+        i       = static_cast<unsigned int>(it - vertex_.begin()) - 1;
     }
 
     double s0 = vertex_[i].s;
@@ -11665,7 +11834,7 @@ idx_t PolyLineBase::Evaluate(double s, TrajVertex& pos, idx_t startAtIndex)
 
     pos.s = s;
 
-    return i;
+    return FromVertexIndex(i);
 }
 
 idx_t PolyLineBase::Evaluate(double s, TrajVertex& pos)
@@ -11675,13 +11844,11 @@ idx_t PolyLineBase::Evaluate(double s, TrajVertex& pos)
 
 idx_t PolyLineBase::Evaluate(double s)
 {
-    return Evaluate(s, current_val_, current_index_);
+    return Evaluate(s, current_val_, FromVertexIndex(current_index_));
 }
 
 PolyLineBase::GhostTrailReturnCode PolyLineBase::Time2S(double time, double& s, idx_t& index) const
 {
-    int direction = 1;
-
     if (GetNumberOfVertices() < 1)
     {
         s     = 0.0;
@@ -11690,20 +11857,21 @@ PolyLineBase::GhostTrailReturnCode PolyLineBase::Time2S(double time, double& s,
     }
     else if (GetNumberOfVertices() == 1)
     {
-        s     = 0;
-        index = 0;
+        s     = vertex_[0].s;
+        index = FromVertexIndex(0);
         return GhostTrailReturnCode::GHOST_TRAIL_OK;
     }
     else if (time < vertex_[0].time)
     {
-        s     = 0.0;
-        index = 0;
+        // snap to oldest vertex, which is not at s=0 if vertices have been discarded
+        s     = vertex_[0].s;
+        index = FromVertexIndex(0);
         return GhostTrailReturnCode::GHOST_TRAIL_TIME_PRIOR;
     }
     else if (time > vertex_.back().time)
     {
         s     = vertex_.back().s;
-        index = vertex_.size() > 0 ? static_cast<unsigned int>(vertex_.size()) - 1 : IDX_UNDEFINED;
+        index = FromVertexIndex(GetNumberOfVertices() - 1);
         return GhostTrailReturnCode::GHOST_TRAIL_TIME_PAST;
     }
 
@@ -11711,57 +11879,32 @@ PolyLineBase::GhostTrailReturnCode PolyLineBase::Time2S(double time, double& s,
     idx_t i = current_index_;
 
     // override with any specified start index
-    if (index != IDX_UNDEFINED && index < GetNumberOfVertices())
+    if (index != IDX_UNDEFINED && ToVertexIndex(index) < GetNumberOfVertices())
     {
-        i = index;
+        i = ToVertexIndex(index);
     }
 
-    if (time < vertex_[i].time)
+    if (!(i < GetNumberOfVertices() - 1 && vertex_[i].time <= time && vertex_[i + 1].time > time))
     {
-        direction = -1;  // Search backwards
-    }
+        // not in the segment of the start index, find first vertex after given time
+        auto it = std::upper_bound(vertex_.begin(), vertex_.end(), time, [](double value, const TrajVertex& v) { return value < v.time; });
 
-    for (size_t j = 0; j < GetNumberOfVertices(); j++)
-    {
-        if (vertex_[i].time <= time && vertex_[i + 1].time > time)
+        if (it == vertex_.end())
         {
-            double w = (time - vertex_[i].time) / (vertex_[i + 1].time - vertex_[i].time);
-            s        = vertex_[i].s + w * (vertex_[i + 1].s - vertex_[i].s);
-            index    = i;
-            return GhostTrailReturnCode::GHOST_TRAIL_OK;
+            // time at very end of the trajectory, grab last element
+            s     = vertex_.back().s;
+            index = FromVertexIndex(GetNumberOfVertices() - 1);
+            return GhostTrailReturnCode::GHOST_TRAIL_TIME_PAST;
         }
 
-        if (direction < 0)
-        {
-            if (i > 0)
-            {
-                i--;
-            }
-            else
-            {
-                // wrap from start to end
-                i = GetNumberOfVertices() - 1;
-            }
-        }
-        else
-        {
-            if (i < GetNumberOfVertices() - 1)
-            {
-                i++;
-            }
-            else
-            {
-                // wrap from end to start
-                i = 0;
-            }
-        }
+        i = static_cast<idx_t>(it - vertex_.begin()) - 1;
     }
 
-    // s seems out of range, grab last element
-    s     = vertex_.back().s;
-    index = static_cast<unsigned int>(vertex_.size() - 1);
+    double w = (time - vertex_[i].time) / (vertex_[i + 1].time - vertex_[i].time);
+    s        = vertex_[i].s + w * (vertex_[i + 1].s - vertex_[i].s);
+    index    = FromVertexIndex(i);
 
-    return GhostTrailReturnCode::GHOST_TRAIL_TIME_PAST;
+    return GhostTrailReturnCode::GHOST_TRAIL_OK;
 }
 
 void PolyLineBase::SetInterpolationMode(InterpolationMode mode)
@@ -11776,6 +11919,11 @@ int PolyLineBase::FindClosestPoint(double xin, double yin, TrajVertex& pos, idx_
         // treat as 0, look globally
         startAtIndex = 0;
     }
+    else
+    {
+        // a start index among discarded vertices becomes 0 as well
+        startAtIndex = ToVertexIndex(startAtIndex);
+    }
 
     // look along the line segments
     TrajVertex   tmpPos;
@@ -11875,7 +12023,7 @@ int PolyLineBase::FindClosestPoint(double xin, double yin, TrajVertex& pos, idx_
     if (distMin < LARGE_NUMBER)
     {
         EvaluateSegmentByLocalS(iMin, sLocalMin, pos);
-        index = iMin;
+        index = FromVertexIndex(iMin);
         return 0;
     }
     else
@@ -11911,7 +12059,7 @@ int PolyLineBase::FindPointAtTimeRelative(double time, TrajVertex& pos, idx_t& i
 {
     double s = 0;
 
-    GhostTrailReturnCode returncode = Time2S(vertex_[0].time + time, s, index);
+    GhostTrailReturnCode returncode = Time2S(GetStartTime() + time, s, index);
 
     if (returncode == GhostTrailReturnCode::GHOST_TRAIL_ERROR)
     {
@@ -11938,11 +12086,40 @@ TrajVertex* PolyLineBase::GetCurrentVertex()
     return &vertex_[current_index_];
 }
 
+void PolyLineBase::DiscardVerticesBefore(double time)
+{
+    if (GetNumberOfVertices() < 3)
+    {
+        return;
+    }
+
+    // keep the latest vertex at or before given time, for interpolation
+    auto   it = std::upper_bound(vertex_.begin(), vertex_.end(), time, [](double value, const TrajVertex& v) { return value < v.time; });
+    size_t n  = static_cast<size_t>(it - vertex_.begin());
+    n         = MIN(n > 0 ? n - 1 : 0, vertex_.size() - 2);
+
+    if (n == 0 || 2 * n < vertex_.size())
+    {
+        // wait until half of the vertices are obsolete, so that each vertex is moved at most once on average
+        return;
+    }
+
+    if (n_discarded_ == 0)
+    {
+        start_time_ = vertex_[0].time;
+    }
+    vertex_.erase(vertex_.begin(), vertex_.begin() + static_cast<std::ptrdiff_t>(n));
+    current_index_ = current_index_ > n ? current_index_ - static_cast<idx_t>(n) : 0;
+    n_discarded_ += static_cast<idx_t>(n);
+}
+
 void PolyLineBase::Reset(bool clear_vertices)
 {
     if (clear_vertices)
     {
         vertex_.clear();
+        n_discarded_ = 0;
+        start_time_  = 0.0;
     }
     current_index_    = 0;
     length_           = 0.0;
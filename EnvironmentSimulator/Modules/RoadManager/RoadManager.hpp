@@ -3199,6 +3199,21 @@ namespace roadmanager
         // Copy only location data from other position object
         void CopyLocation(const Position &from);
 
+        /**
+        Serialize complete position state, including any assigned route progress, into a binary stream
+        References to trajectory and relative position objects are not included
+        @param stream Stream to append the state to
+        */
+        void SaveState(SE_StateStream &stream) const;
+
+        /**
+        Restore position state previously stored by SaveState()
+        An assigned route is kept and its progress restored, it can not be re-created from the stream
+        @param stream Stream to read the state from
+        @return 0 on success, -1 on corrupt or incompatible data
+        */
+        int RestoreState(SE_StateStream &stream);
+
         void Clean();
 
         void              Init();
@@ -4434,6 +4449,12 @@ namespace roadmanager
         bool CheckRoad(Road *checkRoad, RoadPath::PathNode *srcNode, Road *fromRoad, int fromLaneId);
     };
 
+    /**
+     * Polyline of trajectory vertices, e.g. trajectory shapes and entity (ghost) trails.
+     * Lookups by s and time use binary search, starting with a check of any given index hint.
+     * Old vertices can be discarded to bound the size of ever growing trails. Indices given to and returned by
+     * the lookup functions count from the very first vertex added, so indices held by the caller stay valid.
+     */
     class PolyLineBase
     {
     public:
@@ -4468,6 +4489,30 @@ namespace roadmanager
             length_ = 0.0;
         }
 
+        /**
+         * Discard vertices older than given time. The latest vertex at or before the time is kept, as well as at least
+         * two vertices. Storage is compacted when at least half of the vertices are obsolete, to keep cost constant
+         * per added vertex and memory bounded by twice the time span.
+         * @param time Timestamp of oldest data of interest
+         */
+        void DiscardVerticesBefore(double time);
+
+        /**
+         * Get number of vertices discarded from the start since last reset, i.e. index of first vertex in vertex_
+         */
+        idx_t GetNumberOfDiscardedVertices() const
+        {
+            return n_discarded_;
+        }
+
+        /**
+         * Get timestamp of the very first vertex added since last reset, also when discarded
+         */
+        double GetStartTime() const
+        {
+            return n_discarded_ > 0 ? start_time_ : (vertex_.size() > 0 ? vertex_[0].time : 0.0);
+        }
+
         /**
          * Evaluate and return position along the polyline, allow specifying start index for segment lookup
          * @param s Distance along the polyline
@@ -4506,7 +4551,7 @@ namespace roadmanager
 
         /**
          * Get ghost state at a point in time
-         * @param time Time offset from first timestamp
+         * @param time Time offset from first timestamp, also when the first vertices have been discarded
          * @param pos Returns state including position, heading, speed. See TrajVertex type.
          * @param index In: If >= 0 start search at given index. Out: Returns the index of matching trajectory segment, -1 on error
          */
@@ -4535,9 +4580,21 @@ namespace roadmanager
         TrajVertex              current_val_;
         double                  length_             = 0.0;
         InterpolationMode       interpolation_mode_ = InterpolationMode::INTERPOLATE_NONE;
+        idx_t                   n_discarded_        = 0;    // vertices removed from the start, see DiscardVerticesBefore()
+        double                  start_time_         = 0.0;  // timestamp of first vertex, valid only when vertices have been discarded
 
     protected:
         int EvaluateSegmentByLocalS(idx_t i, double local_s, TrajVertex &pos);
+
+        // convert between index in the lookup interface and index in vertex_
+        idx_t ToVertexIndex(idx_t index) const
+        {
+            return index == IDX_UNDEFINED ? IDX_UNDEFINED : (index > n_discarded_ ? index - n_discarded_ : 0);
+        }
+        idx_t FromVertexIndex(idx_t index) const
+        {
+            return index == IDX_UNDEFINED ? IDX_UNDEFINED : index + n_discarded_;
+        }
     };
 
     // Trajectory stuff
@@ -18,13 +18,11 @@
 
 #include <cmath>
 #include <vector>
-#include <memory>
 #include <iostream>
 #include <algorithm>
 
 using namespace aabbTree;
 using roadmanager::Geometry;
-using std::make_shared;
 using std::max;
 using std::min;
 using triangle2D::overlap2d;
@@ -39,10 +37,9 @@ using namespace STGeometry;
  *                          |___/         *
  *****************************************/
 
-bool Triangle::collide(ptTriangle const triangle) const
+bool Triangle::collide(Triangle const &triangle) const
 {
-    Triangle const &tr = *triangle;
-    return overlap2d(a, b, c, tr.a, tr.b, tr.c);
+    return overlap2d(a, b, c, triangle.a, triangle.b, triangle.c);
 }
 
 /***************************
@@ -53,71 +50,31 @@ bool Triangle::collide(ptTriangle const triangle) const
  * |____/|____/ \___/_/\_\ *
  **************************/
 
-BBox::BBox(ptTriangle triangle) : triangle_(triangle)
+BBox::BBox(Triangle const &triangle)
 {
-    Point a = triangle->a;
-    Point b = triangle->b;
-    Point c = triangle->c;
-    blhc_.x = min(a.x, min(b.x, c.x));
-    urhc_.x = max(a.x, max(b.x, c.x));
-    blhc_.y = min(a.y, min(b.y, c.y));
-    urhc_.y = max(a.y, max(b.y, c.y));
-}
-
-BBox::BBox(BBoxVec const &bboxes)
-{
-    merge(bboxes.begin(), bboxes.end());
-}
-
-BBox::BBox(BBoxVec::const_iterator start, BBoxVec::const_iterator end)
-{
-    triangle_ = nullptr;
-    merge(start, end);
-}
-
-inline bool BBox::collide(ptBBox const bbox) const
-{
-    return collide(*bbox);
+    Point const &a = triangle.a;
+    Point const &b = triangle.b;
+    Point const &c = triangle.c;
+    blhc_.x        = min(a.x, min(b.x, c.x));
+    urhc_.x        = max(a.x, max(b.x, c.x));
+    blhc_.y        = min(a.y, min(b.y, c.y));
+    urhc_.y        = max(a.y, max(b.y, c.y));
 }
 
 bool BBox::collide(BBox const &bbox) const
 {
-    Point const &urhc = bbox.urhCorner();
-    Point const &blhc = bbox.blhCorner();
+    Point const &urhc = bbox.urhc_;
+    Point const &blhc = bbox.blhc_;
 
     return !((urhc_.x < blhc.x) || (blhc_.x > urhc.x) || (urhc_.y < blhc.y) || (blhc_.y > urhc.y));
 }
 
-double inline BBox::midPointX() const
-{
-    return (urhc_.x + blhc_.x) / 2;
-}
-
-double inline BBox::midPointY() const
+void BBox::merge(BBox const &bbox)
 {
-    return (urhc_.y + blhc_.y) / 2;
-}
-
-void BBox::merge(BBoxVec::const_iterator start, BBoxVec::const_iterator end)
-{
-    BBoxVec::const_iterator it   = start;
-    double                 &xmin = blhc_.x;
-    double                 &xmax = urhc_.x;
-    double                 &ymin = blhc_.y;
-    double                 &ymax = urhc_.y;
-
-    xmin = (*it)->blhCorner().x;
-    ymin = (*it)->blhCorner().y;
-    xmax = (*it)->urhCorner().x;
-    ymax = (*it)->urhCorner().y;
-
-    while (end > ++it)
-    {
-        xmin = min(xmin, (*it)->blhCorner().x);
-        ymin = min(ymin, (*it)->blhCorner().y);
-        xmax = max(xmax, (*it)->urhCorner().x);
-        ymax = max(ymax, (*it)->urhCorner().y);
-    }
+    blhc_.x = min(blhc_.x, bbox.blhc_.x);
+    blhc_.y = min(blhc_.y, bbox.blhc_.y);
+    urhc_.x = max(urhc_.x, bbox.urhc_.x);
+    urhc_.y = max(urhc_.y, bbox.urhc_.y);
 }
 
 /************************
@@ -128,190 +85,213 @@ void BBox::merge(BBoxVec::const_iterator start, BBoxVec::const_iterator end)
  *   |_||_|  \___|\___| *
  ***********************/
 
-Tree::~Tree()
+void Tree::clear()
 {
-    childeren.clear();
-    bbox.reset();
+    triangles_.clear();
+    nodes_.clear();
+    nodeCount_ = 0;
+    leafCount_ = 0;
 }
 
-/*
- * Builds the AABB tree structure. Uses an external function.
- * If the number of nodes should be greater equal than the number
- * of bounding boxes.
- */
-void Tree::build(BBoxVec &bboxes)
+bool Tree::empty() const
 {
-    childeren.clear();
-    if (bboxes.empty())
-        return;
-    nodeCount_ = 1;
-    leafCount_ = 0;
-    __build(bboxes.begin(), bboxes.end());
+    return nodes_.empty();
 }
 
-bool Tree::empty() const
+idx_t Tree::addNode()
 {
-    return (!bbox && childeren.empty());
+    Node node;
+    node.child[0] = IDX_UNDEFINED;
+    node.child[1] = IDX_UNDEFINED;
+    node.triangle = IDX_UNDEFINED;
+    nodes_.push_back(node);
+    return static_cast<idx_t>(nodes_.size() - 1);
 }
 
 /*
  * This implements the construction of an AABB Tree.
  * It exploits an iterative algorithm instead of a recursive one
- * to handle huge networks.
+ * to handle huge networks. The triangles are not moved, instead
+ * an array of triangle indices is partitioned.
  */
-void Tree::__build(BBoxVec::iterator const start, BBoxVec::iterator const end)
+void Tree::build()
 {
-    vector<StackRecord> stack;
-    stack.reserve(static_cast<unsigned int>((log(end - start) * 2)));
-    stack.clear();
-
-    BBoxVec::iterator cut;
-    BBoxVec::iterator first = start;
-    BBoxVec::iterator last  = end;
+    nodes_.clear();
+    nodeCount_ = 0;
+    leafCount_ = 0;
 
-    ptTree currentTree_ = nullptr;
+    if (triangles_.empty())
+    {
+        return;
+    }
 
-    auto currentTree = [&currentTree_, this]() -> Tree &
+    unsigned int n = static_cast<unsigned int>(triangles_.size());
+    leafBoxes_.resize(n);
+    order_.resize(n);
+    for (unsigned int i = 0; i < n; i++)
     {
-        if (currentTree_)
-            return *currentTree_;
-        else
-            return *this;
-    };
+        leafBoxes_[i] = aabbTree::BBox(triangles_[i]);
+        order_[i]     = i;
+    }
+
+    stack_.clear();
+    nodeCount_           = 1;
+    unsigned int first   = 0;
+    unsigned int last    = n;
+    idx_t        current = addNode();
 
     while (last > first)
     {
         if (last - first == 1)
         {
-            currentTree().bbox = *first;
+            nodes_[current].bbox     = leafBoxes_[order_[first]];
+            nodes_[current].triangle = order_[first];
             leafCount_++;
-            if (!stack.empty())
+            if (!stack_.empty())
             {
-                auto record = stack.back();
-                stack.pop_back();
-                first        = record.first;
-                last         = record.last;
-                currentTree_ = record.tree;
+                StackRecord record = stack_.back();
+                stack_.pop_back();
+                first   = record.first;
+                last    = record.last;
+                current = record.node;
             }
             else
                 break;
         }
         else
         {
-            ptBBox tmpBbox     = make_shared<aabbTree::BBox>(first, last);
-            currentTree().bbox = tmpBbox;
-            cut                = divide(first, last, tmpBbox);
-            ptTree pos         = make_shared<Tree>();
-            ptTree neg         = make_shared<Tree>();
-
-            if (cut - first > 0 && last - cut > 0)
+            aabbTree::BBox bbox = leafBoxes_[order_[first]];
+            for (unsigned int i = first + 1; i < last; i++)
             {
-            kids:
-                currentTree().childeren.push_back(pos);
-                currentTree().childeren.push_back(neg);
-                nodeCount_ += 2;
-                StackRecord record = {cut, last, neg};
-                stack.push_back(record);
-                currentTree_ = pos;
-                last         = cut;
+                bbox.merge(leafBoxes_[order_[i]]);
             }
-            else
+            nodes_[current].bbox = bbox;
+
+            unsigned int cut = divide(first, last, bbox);
+            if (!(cut - first > 0 && last - cut > 0))
             {
                 cut = first + (last - first) / 2;
-                goto kids;
             }
+
+            idx_t pos                = addNode();
+            idx_t neg                = addNode();
+            nodes_[current].child[0] = pos;
+            nodes_[current].child[1] = neg;
+            nodeCount_ += 2;
+
+            StackRecord record = {cut, last, neg};
+            stack_.push_back(record);
+            current = pos;
+            last    = cut;
         }
     }
 }
 
 /*
- * It separates the array in two parts according to a partition
- * line of the current bounding box.
- * It returns a pointer to the first element of the right side of the partition
+ * It separates the index range in two parts according to a partition
+ * line of the given bounding box.
+ * It returns the position of the first element of the right side of the partition
  */
-BBoxVec::iterator Tree::divide(BBoxVec::iterator const start, BBoxVec::iterator const end, ptBBox bboxTmp)
+unsigned int Tree::divide(unsigned int start, unsigned int end, aabbTree::BBox const &bbox)
 {
     if (end - start == 0)
         return start;
     if (end - start == 1)
         return end;
 
-    std::function<bool(ptBBox)> compare;
-    double                      mid;
-    Point                       blhc = bboxTmp->blhCorner();
-    Point                       urhc = bboxTmp->urhCorner();
+    double mid;
+    bool   alongX;
+    Point  blhc = bbox.blhCorner();
+    Point  urhc = bbox.urhCorner();
 
     if (urhc.x - blhc.x > urhc.y - blhc.y)
     {
-        mid     = (urhc.x + blhc.x) / 2.0;
-        compare = [mid](ptBBox bbx) { return bbx->midPointX() < mid; };
+        mid    = (urhc.x + blhc.x) / 2.0;
+        alongX = true;
     }
     else
     {
-        mid     = (urhc.y + blhc.y) / 2.0;
-        compare = [mid](ptBBox bbx) { return bbx->midPointY() < mid; };
+        mid    = (urhc.y + blhc.y) / 2.0;
+        alongX = false;
     }
 
-    auto first = start;
-    auto last  = end;
+    auto compare = [this, mid, alongX](unsigned int i)
+    {
+        aabbTree::BBox const &leaf = leafBoxes_[order_[i]];
+        return (alongX ? leaf.midPointX() : leaf.midPointY()) < mid;
+    };
+
+    unsigned int first = start;
+    unsigned int last  = end;
     while (true)
     {
-        while (first < last && compare(*first))
+        while (first < last && compare(first))
         {
             first++;
         }
         last--;
-        while (first < last && !compare(*last))
+        while (first < last && !compare(last))
             last--;
         if (!(first < last))
             return first;
-        std::iter_swap(first, last);
+        std::swap(order_[first], order_[last]);
         first++;
     }
 }
 
 /*
- * It Intersects two trees and puts the possible candidate bounding boxes in
+ * It Intersects two trees and puts the possible candidate triangle pairs in
  * a vector. This function has been adapted from:
  *   https://github.com/ebertolazzi/Clothoids/blob/master/src/AABBtree.cc
  *
  */
 void Tree::intersect(Tree const &tree, Candidates &candidates) const
 {
-    if (!bbox || !tree.BBox() || !tree.BBox()->collide(bbox))
+    if (empty() || tree.empty())
+        return;
+
+    intersect(0, tree, 0, candidates);
+}
+
+void Tree::intersect(idx_t node, Tree const &tree, idx_t otherNode, Candidates &candidates) const
+{
+    Node const &n1 = nodes_[node];
+    Node const &n2 = tree.nodes_[otherNode];
+
+    if (!n2.bbox.collide(n1.bbox))
         return;
 
-    int case_ = (this->childeren.empty() ? 0 : 1) + (tree.Children().empty() ? 0 : 2);
+    int case_ = (n1.child[0] == IDX_UNDEFINED ? 0 : 1) + (n2.child[0] == IDX_UNDEFINED ? 0 : 2);
 
     switch (case_)
     {
         case 0:
         {  // Leaf & Leaf
-            candidates.push_back(Candidate(bbox, tree.BBox()));
+            candidates.push_back(Candidate(n1.triangle, n2.triangle));
             break;
         }
         case 1:
         {  // Tree & Leaf
-            for (ptTree const &child : childeren)
+            for (idx_t child : n1.child)
             {
-                child->intersect(tree, candidates);
+                intersect(child, tree, otherNode, candidates);
             }
             break;
         }
         case 2:
         {  // Leaf & Tree
-            for (ptTree const &child : tree.Children())
+            for (idx_t child : n2.child)
             {
-                intersect(*child, candidates);
+                intersect(node, tree, child, candidates);
             }
             break;
         }
         case 3:
         {  // Tree & Tree
-            for (ptTree const &child1 : childeren)
+            for (idx_t child1 : n1.child)
             {
-                for (ptTree const &child2 : tree.Children())
-                    child1->intersect(*child2, candidates);
+                for (idx_t child2 : n2.child)
+                    intersect(child1, tree, child2, candidates);
             }
             break;
         }
@@ -326,41 +306,34 @@ void Tree::intersect(Tree const &tree, Candidates &candidates) const
  *  \___/ \__|_|_|___/ *
  ***********************/
 
-aabbTree::ptBBox aabbTree::makeTriangleAndBbx(double x0, double y0, double x1, double y1, double x2, double y2, Geometry *gm, double s0, double s1)
+aabbTree::Triangle aabbTree::makeTriangle(double x0, double y0, double x1, double y1, double x2, double y2, Geometry *gm, double s0, double s1)
 {
-    ptTriangle triangle = make_shared<Triangle>(gm);
-    triangle->a         = Point(x0, y0);
-    triangle->b         = Point(x1, y1);
-    triangle->c         = Point(x2, y2);
-    triangle->sI        = s0;
-    triangle->sF        = s1;
-    return make_shared<BBox>(triangle);
+    Triangle triangle(gm);
+    triangle.a  = Point(x0, y0);
+    triangle.b  = Point(x1, y1);
+    triangle.c  = Point(x2, y2);
+    triangle.sI = s0;
+    triangle.sF = s1;
+    return triangle;
 }
 
-void aabbTree::processCandidates(Candidates const &candidates, vector<ptTriangle> &solutions)
+void aabbTree::processCandidates(Tree const &tree1, Tree const &tree2, Candidates const &candidates, vector<Triangle const *> &solutions)
 {
     for (auto const &candidate : candidates)
     {
-        ptTriangle const tr1 = candidate.bbox1->triangle();
-        ptTriangle const tr2 = candidate.bbox2->triangle();
-        if (tr1 && tr2)
+        Triangle const &tr1 = tree1.GetTriangle(candidate.triangle1);
+        Triangle const &tr2 = tree2.GetTriangle(candidate.triangle2);
+        if (tr1.collide(tr2))
         {
-            // cppcheck-suppress nullPointer
-            // Suppress false positives: guaranteed non-null due to check above
-            if (tr1->collide(tr2))
-            {
-                // cppcheck-suppress nullPointer
-                // Suppress false positives: guaranteed non-null due to check above
-                if (tr2->geometry())
-                    solutions.push_back(tr2);
-                else
-                    solutions.push_back(tr1);
-            }
+            if (tr2.geometry())
+                solutions.push_back(&tr2);
+            else
+                solutions.push_back(&tr1);
         }
     }
 }
 
-void aabbTree::findPoints(vector<ptTriangle> const &triangles, EllipseInfo &eInfo, Solutions &points)
+void aabbTree::findPoints(vector<Triangle const *> const &triangles, EllipseInfo &eInfo, Solutions &points)
 {
     for (auto const &tr : triangles)
     {
@@ -373,7 +346,7 @@ void aabbTree::findPoints(vector<ptTriangle> const &triangles, EllipseInfo &eInf
     }
 }
 
-void aabbTree::curve2triangles(Geometry *geometry, double segmSize, double maxAngle, BBoxVec &vec)
+void aabbTree::curve2triangles(Geometry *geometry, double segmSize, double maxAngle, TriangleVec &vec)
 {
     double s0     = 0;
     double length = geometry->GetLength();
@@ -398,8 +371,7 @@ void aabbTree::curve2triangles(Geometry *geometry, double segmSize, double maxAn
 
         tangentIntersection(x0, y0, s0, t0, x1, y1, s1, t1, x2, y2);
 
-        ptBBox bbx = makeTriangleAndBbx(x0, y0, x1, y1, x2, y2, geometry, s0, s1);
-        vec.push_back(bbx);
+        vec.push_back(makeTriangle(x0, y0, x1, y1, x2, y2, geometry, s0, s1));
         s0 = s1;
     }
 }
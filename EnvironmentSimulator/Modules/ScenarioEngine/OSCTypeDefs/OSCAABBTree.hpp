@@ -12,14 +12,12 @@
 
 #pragma once
 #include "RoadManager.hpp"
-#include <memory>
 #include <vector>
 
 namespace aabbTree
 {
 
     using namespace roadmanager;
-    using std::shared_ptr;
     using std::vector;
 
     class Point;
@@ -27,12 +25,8 @@ namespace aabbTree
     class BBox;
     class Tree;
 
-    typedef shared_ptr<Triangle> ptTriangle;
-    typedef shared_ptr<BBox>     ptBBox;
-    typedef shared_ptr<Tree>     ptTree;
-
-    typedef vector<ptBBox> BBoxVec;
-    typedef vector<Point>  Solutions;
+    typedef vector<Triangle> TriangleVec;
+    typedef vector<Point>    Solutions;
 
     typedef struct
     {
@@ -60,33 +54,26 @@ namespace aabbTree
         Triangle() : sI(0), sF(0), geometry_(nullptr)
         {
         }
-        Triangle(Geometry *geometry) : geometry_(geometry)
-        {
-        }
-        ~Triangle()
+        Triangle(Geometry *geometry) : sI(0), sF(0), geometry_(geometry)
         {
         }
-        Geometry *geometry()
+        Geometry *geometry() const
         {
             return geometry_;
         }
-        bool collide(ptTriangle const triangle) const;
+        bool collide(Triangle const &triangle) const;
 
     private:
         Geometry *geometry_;
-
-        Triangle(Triangle const &triangle);
     };
 
     class BBox
     {
     public:
-        BBox(ptTriangle triangle);
-        BBox(BBoxVec const &bboxes);
-        BBox(BBoxVec::const_iterator start, BBoxVec::const_iterator end);
-        ~BBox()
+        BBox()
         {
         }
+        BBox(Triangle const &triangle);
         Point blhCorner() const
         {
             return blhc_;
@@ -95,51 +82,91 @@ namespace aabbTree
         {
             return urhc_;
         }
-        ptTriangle triangle() const
+        bool collide(BBox const &bbox) const;
+        double inline midPointX() const
+        {
+            return (urhc_.x + blhc_.x) / 2;
+        }
+        double inline midPointY() const
         {
-            return triangle_;
+            return (urhc_.y + blhc_.y) / 2;
         }
-        inline bool collide(ptBBox const bbox) const;
-        bool        collide(BBox const &bbox) const;
-        double inline midPointX() const;
-        double inline midPointY() const;
 
-    private:
-        Point      blhc_, urhc_;
-        ptTriangle triangle_;
+        /**
+         * Grow the box to enclose given box as well
+         * @param bbox Box to include
+         */
+        void merge(BBox const &bbox);
 
-        void merge(BBoxVec::const_iterator start, BBoxVec::const_iterator end);
+    private:
+        Point blhc_, urhc_;
     };
 
-    struct CandidateStruct;
+    /**
+     * A pair of overlapping leaves, referring to triangle indices of the two intersected trees
+     */
     typedef struct CandidateStruct
     {
-        ptBBox bbox1;
-        ptBBox bbox2;
-        CandidateStruct(ptBBox bbx1, ptBBox bbx2) : bbox1(bbx1), bbox2(bbx2)
+        unsigned int triangle1;
+        unsigned int triangle2;
+        CandidateStruct(unsigned int tr1, unsigned int tr2) : triangle1(tr1), triangle2(tr2)
         {
         }
     } Candidate;
 
     typedef vector<Candidate> Candidates;
 
+    /**
+     * AABB tree over a set of triangles. Triangles, nodes and build scratch buffers are
+     * stored in contiguous arrays linked by index. They are kept between builds, so
+     * rebuilding a tree of similar size does not allocate any memory.
+     */
     class Tree
     {
     public:
-        Tree() : bbox(nullptr), nodeCount_(0)
+        struct Node
+        {
+            aabbTree::BBox bbox;
+            idx_t          child[2];  // both IDX_UNDEFINED for leaves
+            idx_t          triangle;  // triangle index for leaves, IDX_UNDEFINED for inner nodes
+        };
+
+        Tree() : nodeCount_(0), leafCount_(0)
+        {
+        }
+
+        /**
+         * Triangles to build the tree from. Fill (or update) before calling build().
+         */
+        TriangleVec &Triangles()
         {
+            return triangles_;
         }
-        ~Tree();
-        void                  intersect(Tree const &tree, Candidates &candidates) const;
-        void                  build(BBoxVec &bboxes);
-        bool                  empty() const;
-        vector<ptTree> const &Children() const
+        TriangleVec const &Triangles() const
         {
-            return childeren;
+            return triangles_;
         }
-        ptBBox BBox() const
+        Triangle const &GetTriangle(unsigned int index) const
         {
-            return bbox;
+            return triangles_[index];
+        }
+
+        /**
+         * Remove all triangles and nodes, keeping allocated storage for reuse
+         */
+        void clear();
+
+        /**
+         * Builds the tree over current set of triangles
+         */
+        void build();
+
+        void intersect(Tree const &tree, Candidates &candidates) const;
+        bool empty() const;
+
+        vector<Node> const &Nodes() const
+        {
+            return nodes_;
         }
         unsigned long nodeCount() const
         {
@@ -151,24 +178,36 @@ namespace aabbTree
         }
 
     private:
-        ptBBox         bbox;
-        vector<ptTree> childeren;
-        unsigned long  nodeCount_, leafCount_;  // for debug;
-
-        Tree(Tree const &tree);
-        BBoxVec::iterator divide(BBoxVec::iterator const start, BBoxVec::iterator const end, ptBBox bbox);
-        void              __build(BBoxVec::iterator const start, const BBoxVec::iterator end);
-        void              __build(BBoxVec &bboxes);
+        TriangleVec   triangles_;
+        vector<Node>  nodes_;  // root at index 0, siblings stored next to each other
+        unsigned long nodeCount_, leafCount_;  // for debug;
 
         typedef struct
         {
-            BBoxVec::iterator first, last;
-            ptTree            tree;
+            unsigned int first, last;
+            idx_t        node;
         } StackRecord;
+
+        // scratch buffers reused between builds
+        vector<BBox>         leafBoxes_;
+        vector<unsigned int> order_;
+        vector<StackRecord>  stack_;
+
+        idx_t        addNode();
+        unsigned int divide(unsigned int start, unsigned int end, BBox const &bbox);
+        void         intersect(idx_t node, Tree const &tree, idx_t otherNode, Candidates &candidates) const;
     };
 
-    void   processCandidates(Candidates const &candidates, vector<ptTriangle> &solutions);
-    void   findPoints(vector<ptTriangle> const &triangles, EllipseInfo &eInfo, Solutions &points);
-    void   curve2triangles(Geometry *geometry, double segmSize, double maxAngle, BBoxVec &vec);
-    ptBBox makeTriangleAndBbx(double x0, double y0, double x1, double y1, double x2, double y2, Geometry *gm = nullptr, double s0 = 0, double s1 = 0);
-}  // namespace aabbTree
\ No newline at end of file
+    /**
+     * Narrow phase of the tree intersection. Adds the triangles of candidate pairs that actually
+     * overlap, preferably the one associated with a road geometry.
+     * @param tree1 Tree which intersect() was called on
+     * @param tree2 Tree passed to intersect()
+     * @param candidates Candidate pairs found by tree1.intersect(tree2, candidates)
+     * @param solutions Overlapping triangles are added here
+     */
+    void processCandidates(Tree const &tree1, Tree const &tree2, Candidates const &candidates, vector<Triangle const *> &solutions);
+    void findPoints(vector<Triangle const *> const &triangles, EllipseInfo &eInfo, Solutions &points);
+    void curve2triangles(Geometry *geometry, double segmSize, double maxAngle, TriangleVec &vec);
+    Triangle makeTriangle(double x0, double y0, double x1, double y1, double x2, double y2, Geometry *gm = nullptr, double s0 = 0, double s1 = 0);
+}  // namespace aabbTree
@@ -278,6 +278,23 @@ void OSCCondition::Reset()
     cond_value_ = false;
 }
 
+void OSCCondition::SaveState(SE_StateStream& stream)
+{
+    stream.Write(last_result_);
+    stream.Write(state_);
+    stream.Write(cond_value_);
+    history_.SaveState(stream);
+}
+
+int OSCCondition::RestoreState(SE_StateStream& stream)
+{
+    stream.Read(last_result_);
+    stream.Read(state_);
+    stream.Read(cond_value_);
+
+    return history_.RestoreState(stream);
+}
+
 bool OSCCondition::Evaluate(double sim_time)
 {
     bool result        = CheckCondition(sim_time);
@@ -393,6 +410,49 @@ void Trigger::Reset()
     }
 }
 
+void Trigger::SaveState(SE_StateStream& stream)
+{
+    stream.Write(static_cast<uint32_t>(conditionGroup_.size()));
+    for (auto cg : conditionGroup_)
+    {
+        stream.Write(static_cast<uint32_t>(cg->condition_.size()));
+        for (auto c : cg->condition_)
+        {
+            c->SaveState(stream);
+        }
+    }
+}
+
+int Trigger::RestoreState(SE_StateStream& stream)
+{
+    uint32_t n_groups = 0;
+    stream.Read(n_groups);
+    if (n_groups != conditionGroup_.size())
+    {
+        return -1;
+    }
+
+    for (auto cg : conditionGroup_)
+    {
+        uint32_t n_conditions = 0;
+        stream.Read(n_conditions);
+        if (n_conditions != cg->condition_.size())
+        {
+            return -1;
+        }
+
+        for (auto c : cg->condition_)
+        {
+            if (c->RestoreState(stream) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return stream.Good() ? 0 : -1;
+}
+
 bool TrigByState::CheckCondition(double sim_time)
 {
     (void)sim_time;
@@ -586,6 +646,24 @@ void TrigByState::Reset()
     OSCCondition::Reset();
 }
 
+void TrigByState::SaveState(SE_StateStream& stream)
+{
+    // pending state changes refer to elements by pointer, which are persistent. Only state and transition is stored.
+    OSCCondition::SaveState(stream);
+    stream.Write(latest_state_change_.state);
+    stream.Write(latest_state_change_.transition);
+}
+
+int TrigByState::RestoreState(SE_StateStream& stream)
+{
+    state_change_.clear();
+    int retval = OSCCondition::RestoreState(stream);
+    stream.Read(latest_state_change_.state);
+    stream.Read(latest_state_change_.transition);
+
+    return stream.Good() ? retval : -1;
+}
+
 bool TrigBySimulationTime::CheckCondition(double sim_time)
 {
     sim_time_   = sim_time;
@@ -1702,6 +1780,20 @@ void ConditionDelay::Reset()
     current_index_ = 0;
 }
 
+void ConditionDelay::SaveState(SE_StateStream& stream) const
+{
+    stream.WriteVector(values_);
+    stream.Write(current_index_);
+}
+
+int ConditionDelay::RestoreState(SE_StateStream& stream)
+{
+    stream.ReadVector(values_);
+    stream.Read(current_index_);
+
+    return stream.Good() ? 0 : -1;
+}
+
 void ConditionDelay::ResetCurrentIndex(double time)
 {
     current_index_ = 0;
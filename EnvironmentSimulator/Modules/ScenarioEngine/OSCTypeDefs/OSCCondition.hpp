@@ -49,6 +49,8 @@ namespace scenarioengine
         void                               ResetCurrentIndex(double time = 0.0);
         bool                               GetValueAtTime(double time);
         size_t                             GetNumberOfEntries() const;
+        void                               SaveState(SE_StateStream& stream) const;
+        int                                RestoreState(SE_StateStream& stream);
         const std::vector<ConditionValue>& GetValues() const
         {
             return values_;
@@ -114,6 +116,8 @@ namespace scenarioengine
         bool                CheckEdge(bool new_value, bool old_value, OSCCondition::ConditionEdge edge) const;
         std::string         Edge2Str() const;
         virtual void        Reset();
+        virtual void        SaveState(SE_StateStream& stream);
+        virtual int         RestoreState(SE_StateStream& stream);
     };
 
     class ConditionGroup
@@ -151,6 +155,19 @@ namespace scenarioengine
         bool         Evaluate(double sim_time);
         virtual void Reset();
 
+        /**
+        Serialize evaluation state of all conditions, e.g. edge detection and delay history
+        @param stream Stream to append the state to
+        */
+        void SaveState(SE_StateStream& stream);
+
+        /**
+        Restore evaluation state of all conditions, previously stored by SaveState()
+        @param stream Stream to read the state from
+        @return 0 on success, -1 on corrupt data or mismatching number of conditions
+        */
+        int RestoreState(SE_StateStream& stream);
+
     private:
         bool defaultValue_;  // applied on empty conditions
     };
@@ -536,6 +553,8 @@ namespace scenarioengine
         std::string StateChangeToStr(StateChange state_change);
         std::string GetAdditionalLogInfo() override;
         void        Reset();
+        void        SaveState(SE_StateStream& stream) override;
+        int         RestoreState(SE_StateStream& stream) override;
     };
 
     class TrigByValue : public OSCCondition
@@ -27,20 +27,15 @@
 using namespace scenarioengine;
 using namespace STGeometry;
 using aabbTree::BBox;
-using aabbTree::BBoxVec;
 using aabbTree::curve2triangles;
-using aabbTree::makeTriangleAndBbx;
-using aabbTree::ptBBox;
-using aabbTree::ptTriangle;
-using std::make_shared;
+using aabbTree::makeTriangle;
+using aabbTree::TriangleVec;
 using std::vector;
 
 #define USELESS_THRESHOLD     5    // Max check count before deleting uneffective vehicles
 #define VEHICLE_DISTANCE      12   // Min distance between two spawned vehicles
 #define SWARM_TIME_INTERVAL   0.1  // Sleep time between update steps
 #define SWARM_SPAWN_FREQUENCY 1.1  // Sleep time between spawns
-#define MAX_CARS              1000
-#define MAX_LANES             32
 
 int SwarmTrafficAction::counter_ = 0;
 
@@ -215,39 +210,39 @@ void DeleteEntityAction::Step(double simTime, double dt)
     OSCAction::Stop();
 }
 
-void print_triangles(const BBoxVec& vec, char const filename[])
+void print_triangles(const TriangleVec& vec, char const filename[])
 {
     std::ofstream file;
     file.open(filename);
-    for (auto const& bbx : vec)
+    for (auto const& tr : vec)
     {
-        auto trPtr = bbx->triangle();
-        auto pt    = trPtr->a;
+        auto pt = tr.a;
         file << pt.x << "," << pt.y;
-        file << "," << trPtr->b.x << "," << trPtr->b.y;
-        file << "," << trPtr->c.x << "," << trPtr->c.y << "\n";
+        file << "," << tr.b.x << "," << tr.b.y;
+        file << "," << tr.c.x << "," << tr.c.y << "\n";
     }
     file.close();
 }
 
-void print_bbx(const BBoxVec& vec, char const filename[])
+void print_bbx(const TriangleVec& vec, char const filename[])
 {
     std::ofstream file;
     file.open(filename);
-    for (auto const& bbx : vec)
+    for (auto const& tr : vec)
     {
-        auto pt = bbx->blhCorner();
+        BBox bbx(tr);
+        auto pt = bbx.blhCorner();
         file << pt.x << "," << pt.y;
-        file << "," << bbx->urhCorner().x << "," << bbx->urhCorner().y << "\n";
+        file << "," << bbx.urhCorner().x << "," << bbx.urhCorner().y << "\n";
     }
     file.close();
 }
 
-void printTree(aabbTree::Tree& tree, const char filename[])
+void printTree(aabbTree::Tree const& tree, const char filename[])
 {
     std::ofstream file;
     file.open(filename);
-    std::vector<aabbTree::ptTree> v1, v2;
+    std::vector<idx_t> v1, v2;
     v1.clear();
     v2.clear();
 
@@ -257,19 +252,23 @@ void printTree(aabbTree::Tree& tree, const char filename[])
         return;
     }
 
-    auto bbx = tree.BBox();
-    file << bbx->blhCorner().x << "," << bbx->blhCorner().y << "," << bbx->urhCorner().x << "," << bbx->urhCorner().y << "\n";
-    v1.insert(v1.end(), tree.Children().begin(), tree.Children().end());
+    auto const& nodes = tree.Nodes();
+    auto        bbx   = nodes[0].bbox;
+    file << bbx.blhCorner().x << "," << bbx.blhCorner().y << "," << bbx.urhCorner().x << "," << bbx.urhCorner().y << "\n";
+    if (nodes[0].child[0] != IDX_UNDEFINED)
+    {
+        v1.insert(v1.end(), nodes[0].child, nodes[0].child + 2);
+    }
 
     while (!v1.empty())
     {
-        for (auto const& tr : v1)
+        for (auto const& idx : v1)
         {
-            if (!tr->empty())
+            auto bbox = nodes[idx].bbox;
+            file << bbox.blhCorner().x << "," << bbox.blhCorner().y << "," << bbox.urhCorner().x << "," << bbox.urhCorner().y << ",";
+            if (nodes[idx].child[0] != IDX_UNDEFINED)
             {
-                auto bbox = tr->BBox();
-                file << bbox->blhCorner().x << "," << bbox->blhCorner().y << "," << bbox->urhCorner().x << "," << bbox->urhCorner().y << ",";
-                v2.insert(v2.end(), tr->Children().begin(), tr->Children().end());
+                v2.insert(v2.end(), nodes[idx].child, nodes[idx].child + 2);
             }
         }
         file << "\n";
@@ -309,13 +308,12 @@ void SwarmTrafficAction::Start(double simTime)
     if (minSize_ == 0)
         minSize_ = 1.0;
 
-    aabbTree::ptTree  tree = std::make_shared<aabbTree::Tree>();
-    aabbTree::BBoxVec vec;
-    vec.clear();
-    createRoadSegments(vec);
+    rTree.clear();
+    createRoadSegments(rTree.Triangles());
+    rTree.build();
 
-    tree->build(vec);
-    rTree = tree;
+    initEllipseSegments(midSMjA, midSMnA);
+    eTree_.clear();
 
     // Register model filenames from vehicle catalog
     // if no catalog loaded, use same model as central object
@@ -344,35 +342,47 @@ void SwarmTrafficAction::Start(double simTime)
 
 void SwarmTrafficAction::Step(double simTime, double dt)
 {
-    (void)simTime;
-    (void)dt;
-
-    // Executes the step at each TIME_INTERVAL
+    // Spawn points are updated and new vehicles requested at each TIME_INTERVAL. Despawn
+    // checks and instantiation of requested vehicles are spread over the frames in between.
     if (lastTime < 0 || abs(simTime - lastTime) > SWARM_TIME_INTERVAL)
     {
-        double SMjA = midSMjA;
-        double SMnA = midSMnA;
+        updateSpawnPoints();
+        spawnPoints_ = sols_;
+        queueSpawns(spawnPoints_, despawnCount_, dt);
+        despawnCount_ = 0;
+        lastTime      = simTime;
+    }
+
+    // check each vehicle once per interval
+    double share = dt > SMALL_NUMBER ? MIN(1.0, dt / SWARM_TIME_INTERVAL) : 1.0;
+    despawnCount_ += despawn(static_cast<size_t>(ceil(share * static_cast<double>(spawnedV.size()))));
+
+    spawnQueued(spawnBudget_, simTime);
+}
 
-        BBoxVec                 vec;
-        aabbTree::Candidates    candidates;
-        std::vector<ptTriangle> triangle;
-        Solutions               sols;
-        vec.clear();
-        candidates.clear();
-        triangle.clear();
-        sols.clear();
+void SwarmTrafficAction::updateSpawnPoints()
+{
+    roadmanager::Position& pos = centralObject_->pos_;
 
-        EllipseInfo info = {SMjA, SMnA, centralObject_->pos_};
+    // The road tree is static, so intersection points only need to be
+    // recalculated when the central object has moved since last update
+    if (eTree_.empty() || pos.GetX() != solsX_ || pos.GetY() != solsY_ || pos.GetH() != solsH_)
+    {
+        EllipseInfo info = {midSMjA, midSMnA, pos};
 
-        createEllipseSegments(vec, SMjA, SMnA);
-        aabbTree::Tree eTree;
-        eTree.build(vec);
-        rTree->intersect(eTree, candidates);
-        aabbTree::processCandidates(candidates, triangle);
-        aabbTree::findPoints(triangle, info, sols);
+        candidates_.clear();
+        hits_.clear();
+        sols_.clear();
 
-        spawn(sols, despawn(simTime), simTime);
-        lastTime = simTime;
+        createEllipseSegments(eTree_.Triangles());
+        eTree_.build();
+        rTree.intersect(eTree_, candidates_);
+        aabbTree::processCandidates(rTree, eTree_, candidates_, hits_);
+        aabbTree::findPoints(hits_, info, sols_);
+
+        solsX_ = pos.GetX();
+        solsY_ = pos.GetY();
+        solsH_ = pos.GetH();
     }
 }
 
@@ -382,7 +392,7 @@ void scenarioengine::SwarmTrafficAction::SetScenarioEngine(ScenarioEngine* scena
     entities_        = scenario_engine_ != nullptr ? &scenario_engine_->entities_ : nullptr;
 }
 
-void SwarmTrafficAction::createRoadSegments(BBoxVec& vec)
+void SwarmTrafficAction::createRoadSegments(TriangleVec& vec)
 {
     for (unsigned int i = 0; i < odrManager_->GetNumOfRoads(); i++)
     {
@@ -412,15 +422,7 @@ void SwarmTrafficAction::createRoadSegments(BBoxVec& vec)
                         l  = sqrt(pow(x1 - x0, 2) + pow(y1 - y0, 2));
                         x2 = (x1 + x0) / 2 + l / 4.0;
                         y2 = (y1 + y0) / 2 + l / 4.0;
-                        Point      a(x0, y0), b(x1, y1), c(x2, y2);
-                        ptTriangle triangle = make_shared<Triangle>(gm);
-                        triangle->a         = a;
-                        triangle->b         = b;
-                        triangle->c         = c;
-                        triangle->sI        = dist;
-                        triangle->sF        = ds;
-                        ptBBox bbox         = make_shared<BBox>(triangle);
-                        vec.push_back(bbox);
+                        vec.push_back(makeTriangle(x0, y0, x1, y1, x2, y2, gm, dist, ds));
                         dist = ds;
                     }
                     break;
@@ -435,34 +437,58 @@ void SwarmTrafficAction::createRoadSegments(BBoxVec& vec)
     }
 }
 
-void SwarmTrafficAction::createEllipseSegments(aabbTree::BBoxVec& vec, double SMjA, double SMnA)
+void SwarmTrafficAction::initEllipseSegments(double SMjA, double SMnA)
 {
     double alpha  = -M_PI / 72.0;
     double dAlpha = M_PI / 36.0;
-    auto   pos    = centralObject_->pos_;
-    double x0, y0, x1, y1, x2, y2;
 
-    while (alpha < (2 * M_PI - M_PI / 72.0))
+    ellipseVertices_.clear();
+    while (true)
     {
-        double da = alpha + dAlpha;
-        if (da > 2 * M_PI - M_PI / 72.0)
+        ellipseVertices_.push_back({alpha, SMjA * cos(alpha), SMjA * sin(alpha), SMnA * cos(alpha), SMnA * sin(alpha)});
+
+        if (!(alpha < (2 * M_PI - M_PI / 72.0)))
         {
-            da = 2 * M_PI - M_PI / 72.0;
+            break;
         }
 
-        paramEllipse(alpha, pos.GetX(), pos.GetY(), SMjA, SMnA, pos.GetH(), x0, y0);
-        paramEllipse(da, pos.GetX(), pos.GetY(), SMjA, SMnA, pos.GetH(), x1, y1);
+        alpha += dAlpha;
+        if (alpha > 2 * M_PI - M_PI / 72.0)
+        {
+            alpha = 2 * M_PI - M_PI / 72.0;
+        }
+    }
+}
 
-        double theta0, theta1;
-        theta0 = angleTangentEllipse(SMjA, SMnA, alpha, pos.GetH());
-        theta1 = angleTangentEllipse(SMjA, SMnA, da, pos.GetH());
+void SwarmTrafficAction::createEllipseSegments(TriangleVec& vec)
+{
+    // Same points and tangents as paramEllipse() and angleTangentEllipse(), but with
+    // the pose independent terms taken from ellipseVertices_
+    auto&  pos    = centralObject_->pos_;
+    double h      = pos.GetX();
+    double k      = pos.GetY();
+    double cosHdg = cos(pos.GetH());
+    double sinHdg = sin(pos.GetH());
+    double x0 = 0.0, y0 = 0.0, theta0 = 0.0, x1, y1, theta1, x2, y2;
 
-        tangentIntersection(x0, y0, alpha, theta0, x1, y1, da, theta1, x2, y2);
+    vec.clear();
+    for (size_t i = 0; i < ellipseVertices_.size(); i++)
+    {
+        EllipseVertex& v = ellipseVertices_[i];
+        x1               = v.majCos * cosHdg - v.minSin * sinHdg + h;
+        y1               = v.majCos * sinHdg + v.minSin * cosHdg + k;
+        theta1           = atan2((v.majSin * sinHdg - v.minCos * cosHdg), (v.majSin * cosHdg + v.minCos * sinHdg));
 
-        ptBBox bbx = makeTriangleAndBbx(x0, y0, x1, y1, x2, y2);
-        vec.push_back(bbx);
+        if (i > 0)
+        {
+            double alpha = ellipseVertices_[i - 1].alpha;
+            tangentIntersection(x0, y0, alpha, theta0, x1, y1, v.alpha, theta1, x2, y2);
+            vec.push_back(makeTriangle(x0, y0, x1, y1, x2, y2));
+        }
 
-        alpha = da;
+        x0     = x1;
+        y0     = y1;
+        theta0 = theta1;
     }
 }
 
@@ -471,6 +497,8 @@ inline void SwarmTrafficAction::sampleRoads(int minN, int maxN, Solutions& sols,
     // printf("Entered road selection\n");
     // printf("Min: %d, Max: %d\n", minN, maxN);
 
+    info.clear();
+
     // Sample the number of cars to spawn
     if (maxN < minN)
     {
@@ -485,20 +513,18 @@ inline void SwarmTrafficAction::sampleRoads(int minN, int maxN, Solutions& sols,
     }
 
     info.reserve(nCarsToSpawn);
-    info.clear();
     // We have more points than number of vehicles to spawn.
     // We sample the selected number and each point will be assigned a lane
     if (nCarsToSpawn <= sols.size() && nCarsToSpawn > 0)
     {
         // Shuffle and randomly select the points
-        // Solutions selected(nCarsToSpawn);
-        static Point selected[MAX_CARS];  // Remove macro when/if found a solution for dynamic array
+        selected_.resize(nCarsToSpawn);
         std::shuffle(sols.begin(), sols.end(), SE_Env::Inst().GetRand().GetGenerator());
-        sample(sols.begin(), sols.end(), selected, nCarsToSpawn, SE_Env::Inst().GetRand().GetGenerator());
+        sample(sols.begin(), sols.end(), selected_.begin(), nCarsToSpawn, SE_Env::Inst().GetRand().GetGenerator());
 
         for (unsigned int i = 0; i < nCarsToSpawn; i++)
         {
-            Point& pt = selected[i];
+            Point& pt = selected_[i];
             // Find road
             roadmanager::Position pos(pt.x, pt.y, 0.0, pt.h, 0.0, 0.0);
             if (pos.IsInJunction())
@@ -554,155 +580,272 @@ inline void SwarmTrafficAction::sampleRoads(int minN, int maxN, Solutions& sols,
     }
 }
 
-void SwarmTrafficAction::spawn(Solutions sols, int replace, double simTime)
+void SwarmTrafficAction::queueSpawns(Solutions& sols, int replace, double dt)
 {
-    int maxCars = static_cast<int>(
-        MIN(MAX_CARS, static_cast<unsigned int>(numberOfVehicles) - spawnedV.size()));  // Remove MIN check when/if found a solution for dynamic array
+    // Any requests left from previous interval refer to outdated spawn points
+    spawnQueue_.clear();
+    spawnQueueHead_ = 0;
+    spawnBudget_    = 0;
+
+    int maxCars = static_cast<int>(numberOfVehicles) - static_cast<int>(spawnedV.size());
     if (maxCars <= 0)
     {
         return;
     }
 
-    vector<SelectInfo> info;
-    sampleRoads(replace, maxCars, sols, info);
+    sampleRoads(replace, maxCars, sols, selectInfo_);
 
-    for (SelectInfo inf : info)
+    for (SelectInfo& inf : selectInfo_)
     {
-        unsigned int        lanesNo = MIN(MAX_LANES, inf.road->GetNumberOfDrivingLanes(inf.pos.GetS()));
-        static unsigned int elements[MAX_LANES];
-        std::iota(elements, elements + lanesNo, 0);
+        unsigned int lanesNo = inf.road->GetNumberOfDrivingLanes(inf.pos.GetS());
+        laneElements_.resize(lanesNo);
+        std::iota(laneElements_.begin(), laneElements_.end(), 0);
+        laneSample_.resize(inf.nLanes);
 
-        static idx_t lanes[MAX_LANES];
+        sample(laneElements_.begin(), laneElements_.end(), laneSample_.begin(), inf.nLanes, SE_Env::Inst().GetRand().GetGenerator());
 
-        sample(elements, elements + lanesNo, lanes, MIN(MAX_LANES, inf.nLanes), SE_Env::Inst().GetRand().GetGenerator());
-
-        for (unsigned int i = 0; i < MIN(MAX_LANES, inf.nLanes); i++)
+        for (unsigned int i = 0; i < MIN(lanesNo, inf.nLanes); i++)
         {
-            auto Lane = inf.road->GetDrivingLaneByIdx(inf.pos.GetS(), lanes[i]);
-            int  laneID;
+            auto Lane = inf.road->GetDrivingLaneByIdx(inf.pos.GetS(), laneSample_[i]);
 
             if (!Lane)
             {
                 LOG_WARN("Warning: invalid lane index");
                 continue;
             }
-            else
-            {
-                laneID = Lane->GetId();
-            }
 
-            if (!ensureDistance(inf.pos, laneID, MIN(MAX(40.0, velocity_ * 2.0), 0.7 * semiMajorAxis_)))
-                continue;  // distance = speed * 2 seconds
+            spawnQueue_.push_back({inf.pos, inf.road, Lane->GetId()});
+        }
+    }
+
+    // spread the requests over the frames of the interval
+    size_t frames = dt > SMALL_NUMBER ? static_cast<size_t>(MAX(1.0, ceil(SWARM_TIME_INTERVAL / dt - SMALL_NUMBER))) : 1;
+    spawnBudget_  = (spawnQueue_.size() + frames - 1) / frames;
+}
+
+void SwarmTrafficAction::spawnQueued(size_t budget, double simTime)
+{
+    size_t end = MIN(spawnQueue_.size(), spawnQueueHead_ + budget);
+    if (spawnQueueHead_ >= end)
+    {
+        return;
+    }
+
+    // Index current swarm vehicles for the distance checks
+    occupancyObjects_.clear();
+    for (SpawnInfo& info : spawnedV)
+    {
+        occupancyObjects_.push_back(info.vehicle);
+    }
+    occupancy_.Build(occupancyObjects_);
+    recentSpawns_.clear();
+
+    for (; spawnQueueHead_ < end; spawnQueueHead_++)
+    {
+        if (spawnedV.size() >= numberOfVehicles)
+        {
+            spawnQueueHead_ = spawnQueue_.size();
+            break;
+        }
+
+        SpawnRequest& request = spawnQueue_[spawnQueueHead_];
+        if (!ensureDistance(request.pos, request.laneID, MIN(MAX(40.0, velocity_ * 2.0), 0.7 * semiMajorAxis_)))
+            continue;  // distance = speed * 2 seconds
 
-            Controller::InitArgs args;
-            args.name            = "Swarm ACC controller";
-            args.type            = CONTROLLER_ACC_TYPE_NAME;
-            args.scenario_engine = scenario_engine_;
-            args.gateway         = gateway_;
-            args.parameters      = 0;
-            args.properties      = 0;
+        spawnVehicle(request, simTime);
+    }
+}
+
+void SwarmTrafficAction::spawnVehicle(SpawnRequest& request, double simTime)
+{
+    Controller::InitArgs args;
+    args.name            = "Swarm ACC controller";
+    args.type            = CONTROLLER_ACC_TYPE_NAME;
+    args.scenario_engine = scenario_engine_;
+    args.gateway         = gateway_;
+    args.parameters      = 0;
+    args.properties      = 0;
 
 #if 0  // This is one way of setting the ACC setSpeed property
-            args.properties = new OSCProperties();
-            OSCProperties::Property property;
-            property.name_ = "setSpeed";
-            property.value_ = std::to_string(velocity_);
-            args.properties->property_.push_back(property);
+    args.properties = new OSCProperties();
+    OSCProperties::Property property;
+    property.name_ = "setSpeed";
+    property.value_ = std::to_string(velocity_);
+    args.properties->property_.push_back(property);
 #endif
-            Controller* acc = InstantiateControllerACC(&args);
+    Controller* acc = reader_->ReuseController(&args);
+    if (acc == nullptr)
+    {
+        acc = InstantiateControllerACC(&args);
+        reader_->AddController(acc);
+    }
+
+    // Pick random model from vehicle catalog
+    Vehicle* vehicle = entities_->NewVehicle(vehicle_pool_.GetRandomVehicle());
 
 #if 1  // This is another way of setting the ACC setSpeed property
-            (static_cast<ControllerACC*>(acc))->SetSetSpeed(velocity_);
+    (static_cast<ControllerACC*>(acc))->SetSetSpeed(velocity_);
 #endif
-            reader_->AddController(acc);
 
-            // Pick random model from vehicle catalog
-            Vehicle* vehicle = new Vehicle(*vehicle_pool_.GetRandomVehicle());
-            vehicle->pos_.SetLanePos(inf.pos.GetTrackId(), laneID, inf.pos.GetS(), 0.0);
+    int laneID = request.laneID;
+    vehicle->pos_.SetLanePos(request.pos.GetTrackId(), laneID, request.pos.GetS(), 0.0);
 
-            // Set swarm traffic direction based on RHT or LHT
-            if (inf.road->GetRule() == roadmanager::Road::RoadRule::RIGHT_HAND_TRAFFIC)
-            {
-                vehicle->pos_.SetHeadingRelativeRoadDirection(laneID < 0 ? 0.0 : M_PI);
-            }
-            else if (inf.road->GetRule() == roadmanager::Road::RoadRule::LEFT_HAND_TRAFFIC)
-            {
-                vehicle->pos_.SetHeadingRelativeRoadDirection(laneID > 0 ? 0.0 : M_PI);
-            }
-            else
-            {
-                // do something if undefined... maybe default to RHT?
-                vehicle->pos_.SetHeadingRelativeRoadDirection(laneID < 0 ? 0.0 : M_PI);
-            }
+    // Set swarm traffic direction based on RHT or LHT
+    if (request.road->GetRule() == roadmanager::Road::RoadRule::RIGHT_HAND_TRAFFIC)
+    {
+        vehicle->pos_.SetHeadingRelativeRoadDirection(laneID < 0 ? 0.0 : M_PI);
+    }
+    else if (request.road->GetRule() == roadmanager::Road::RoadRule::LEFT_HAND_TRAFFIC)
+    {
+        vehicle->pos_.SetHeadingRelativeRoadDirection(laneID > 0 ? 0.0 : M_PI);
+    }
+    else
+    {
+        // do something if undefined... maybe default to RHT?
+        vehicle->pos_.SetHeadingRelativeRoadDirection(laneID < 0 ? 0.0 : M_PI);
+    }
 
-            vehicle->SetSpeed(velocity_);
-            // vehicle->scaleMode_ = EntityScaleMode::BB_TO_MODEL;
-            vehicle->name_ = "swarm_" + std::to_string(counter_++);
-            int id         = entities_->addObject(vehicle, true);
+    vehicle->SetSpeed(velocity_);
+    // vehicle->scaleMode_ = EntityScaleMode::BB_TO_MODEL;
+    vehicle->name_ = "swarm_" + std::to_string(counter_++);
 
-            // align trailers
-            Vehicle* v = vehicle;
-            if (!v->TowVehicle() && v->TrailerVehicle())
-            {
-                v->AlignTrailers();
-            }
+    int id = entities_->addObject(vehicle, true);
 
-            vehicle->AssignController(acc);
-            acc->LinkObject(vehicle);
-            acc->Activate({ControlActivationMode::ON, ControlActivationMode::OFF, ControlActivationMode::OFF, ControlActivationMode::OFF});
-
-            SpawnInfo sInfo = {
-                id,                    // Vehicle ID
-                0,                     // Useless detection counter
-                inf.pos.GetTrackId(),  // Road ID
-                laneID,                // Lane
-                simTime                // Simulation time
-            };
-            spawnedV.push_back(sInfo);
-        }
+    // align trailers
+    Vehicle* v = vehicle;
+    if (!v->TowVehicle() && v->TrailerVehicle())
+    {
+        v->AlignTrailers();
     }
+
+    vehicle->AssignController(acc);
+    acc->LinkObject(vehicle);
+    acc->Activate({ControlActivationMode::ON, ControlActivationMode::OFF, ControlActivationMode::OFF, ControlActivationMode::OFF});
+
+    SpawnInfo sInfo = {
+        id,                        // Vehicle ID
+        0,                         // Useless detection counter
+        request.pos.GetTrackId(),  // Road ID
+        laneID,                    // Lane
+        simTime,                   // Simulation time
+        vehicle                    // Vehicle
+    };
+    spawnedV.push_back(sInfo);
+    recentSpawns_.push_back(vehicle);
 }
 
 inline bool SwarmTrafficAction::ensureDistance(roadmanager::Position pos, int lane, double dist)
 {
-    for (SpawnInfo info : spawnedV)
-    {
-        Object* vehicle = entities_->GetObjectById(info.vehicleID);
+    pos.SetLaneId(lane);
 
+    auto tooClose = [&pos, dist](Object* vehicle)
+    {
         // First apply minimal radius filter to avoid vehicles appear too close, e.g. next to each other in neighbor lanes
         if (PointDistance2D(pos.GetX(), pos.GetY(), vehicle->pos_.GetX(), vehicle->pos_.GetY()) < 20)
         {
-            return false;
+            return true;
         }
 
-        pos.SetLaneId(lane);
         roadmanager::PositionDiff posDiff;
         if (pos.Delta(&vehicle->pos_, posDiff, true, 100.0))  // potentially expensive since trying to resolve path between vehicles...
         {
             // If close and in same lane -> NOK
             if (posDiff.dLaneId == 0 && fabs(posDiff.ds) < dist)
             {
-                return false;
+                return true;
             }
         }
+        return false;
+    };
+
+    // Road distance might be somewhat shorter than euclidean distance in curves, use a generous radius
+    occupancy_.GetObjectsInRadius(pos.GetX(), pos.GetY(), 2 * MAX(dist, 20.0) + 20.0, nearby_, nearbyScratch_);
+    for (Object* vehicle : nearby_)
+    {
+        if (tooClose(vehicle))
+        {
+            return false;
+        }
+    }
+
+    for (Object* vehicle : recentSpawns_)
+    {
+        if (tooClose(vehicle))
+        {
+            return false;
+        }
     }
 
     return true;
 }
 
-int SwarmTrafficAction::despawn(double simTime)
+void SwarmTrafficAction::removeVehicle(SpawnInfo& info)
 {
-    (void)simTime;
-    auto infoPtr       = spawnedV.begin();
-    bool increase      = true;
-    bool deleteVehicle = false;
-    int  count         = 0;
+    Object* vehicle = info.vehicle;
+
+    // Controllers and removed vehicles are kept by reader and entities, for reuse by coming spawns
+    while (!vehicle->controllers_.empty())
+    {
+        Controller* ctrl = vehicle->controllers_.back();
+        vehicle->UnassignController(ctrl);
+        ctrl->UnlinkObject();
+        reader_->ReleaseController(ctrl);
+    }
+
+    if (vehicle->type_ == Object::Type::VEHICLE)
+    {
+        Vehicle* v       = static_cast<Vehicle*>(vehicle);
+        Vehicle* trailer = nullptr;
+        while (v)  // remove all linked trailers
+        {
+            trailer = static_cast<Vehicle*>(v->TrailerVehicle());
+
+            gateway_->removeObject(v->name_);
+
+            if (v->objectEvents_.size() > 0 || v->initActions_.size() > 0)
+            {
+                entities_->deactivateObject(v);
+            }
+            else
+            {
+                entities_->removeObject(v, false);
+            }
+            v = trailer;
+
+            vehicle = nullptr;  // indicate vehicle removed
+        }
+    }
+
+    if (vehicle)
+    {
+        gateway_->removeObject(vehicle->name_);
+        if (vehicle->objectEvents_.size() > 0 || vehicle->initActions_.size() > 0)
+        {
+            entities_->deactivateObject(vehicle);
+        }
+        else
+        {
+            entities_->removeObject(vehicle, false);
+        }
+    }
+}
+
+int SwarmTrafficAction::despawn(size_t budget)
+{
+    int count = 0;
 
-    roadmanager::Position cPos = centralObject_->pos_;
+    roadmanager::Position& cPos = centralObject_->pos_;
 
-    while (infoPtr != spawnedV.end())
+    for (size_t i = 0; i < budget && !spawnedV.empty(); i++)
     {
-        Object* vehicle = entities_->GetObjectById(infoPtr->vehicleID);
+        if (despawnCursor_ >= spawnedV.size())
+        {
+            despawnCursor_ = 0;
+        }
+
+        SpawnInfo& info          = spawnedV[despawnCursor_];
+        Object*    vehicle       = info.vehicle;
+        bool       deleteVehicle = false;
 
         if (vehicle->IsOffRoad() || vehicle->IsEndOfRoad())
         {
@@ -710,9 +853,9 @@ int SwarmTrafficAction::despawn(double simTime)
         }
         else
         {
-            roadmanager::Position vPos = vehicle->pos_;
-            auto                  e0   = ellipse(cPos.GetX(), cPos.GetY(), cPos.GetH(), semiMajorAxis_, semiMinorAxis_, vPos.GetX(), vPos.GetY());
-            auto                  e1   = ellipse(cPos.GetX(), cPos.GetY(), cPos.GetH(), midSMjA, midSMnA, vPos.GetX(), vPos.GetY());
+            roadmanager::Position& vPos = vehicle->pos_;
+            auto                   e0   = ellipse(cPos.GetX(), cPos.GetY(), cPos.GetH(), semiMajorAxis_, semiMinorAxis_, vPos.GetX(), vPos.GetY());
+            auto                   e1   = ellipse(cPos.GetX(), cPos.GetY(), cPos.GetH(), midSMjA, midSMnA, vPos.GetX(), vPos.GetY());
 
             if (e0 > 0.001)  // outside major ellipse
             {
@@ -720,76 +863,32 @@ int SwarmTrafficAction::despawn(double simTime)
             }
             else if (e1 > 0.001 || (0 <= e1 && e1 <= 0.001))  // outside middle ellipse or on the border
             {
-                infoPtr->outMidAreaCount++;
-                if (infoPtr->outMidAreaCount > USELESS_THRESHOLD)
+                info.outMidAreaCount++;
+                if (info.outMidAreaCount > USELESS_THRESHOLD)
                 {
                     deleteVehicle = true;
                 }
             }
             else
             {
-                infoPtr->outMidAreaCount = 0;
+                info.outMidAreaCount = 0;
             }
         }
 
         if (deleteVehicle)
         {
-            for (auto ctrl : vehicle->controllers_)
-            {
-                vehicle->UnassignController(ctrl);
-                ctrl->UnlinkObject();
-                reader_->RemoveController(ctrl);
-            }
-
-            if (vehicle->type_ == Object::Type::VEHICLE)
-            {
-                Vehicle* v       = static_cast<Vehicle*>(vehicle);
-                Vehicle* trailer = nullptr;
-                while (v)  // remove all linked trailers
-                {
-                    trailer = static_cast<Vehicle*>(v->TrailerVehicle());
-
-                    gateway_->removeObject(v->name_);
-
-                    if (v->objectEvents_.size() > 0 || v->initActions_.size() > 0)
-                    {
-                        entities_->deactivateObject(v);
-                    }
-                    else
-                    {
-                        entities_->removeObject(v, false);
-                    }
-                    v = trailer;
-
-                    vehicle = nullptr;  // indicate vehicle removed
-                }
-            }
-
-            if (vehicle)
-            {
-                gateway_->removeObject(vehicle->name_);
-                if (vehicle->objectEvents_.size() > 0 || vehicle->initActions_.size() > 0)
-                {
-                    entities_->deactivateObject(vehicle);
-                }
-                else
-                {
-                    entities_->removeObject(vehicle, false);
-                }
-            }
+            removeVehicle(info);
 
-            infoPtr  = spawnedV.erase(infoPtr);
-            increase = deleteVehicle = false;
+            // fill the gap with last vehicle, which is checked next
+            info = spawnedV.back();
+            spawnedV.pop_back();
             count++;
         }
-
-        if (increase)
+        else
         {
-            ++infoPtr;
+            despawnCursor_++;
         }
-
-        increase = true;
     }
 
     return count;
-}
\ No newline at end of file
+}
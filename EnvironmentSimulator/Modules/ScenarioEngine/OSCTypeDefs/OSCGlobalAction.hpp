@@ -342,11 +342,12 @@ namespace scenarioengine
     public:
         struct SpawnInfo
         {
-            int    vehicleID;
-            int    outMidAreaCount;
-            id_t   roadID;
-            int    lane;
-            double simTime;
+            int      vehicleID;
+            int      outMidAreaCount;
+            id_t     roadID;
+            int      lane;
+            double   simTime;
+            Vehicle* vehicle;
         };
 
         typedef struct
@@ -414,25 +415,71 @@ namespace scenarioengine
         }
 
     private:
-        double                  velocity_;
-        Entities*               entities_;
-        ScenarioGateway*        gateway_;
-        ScenarioReader*         reader_;
-        ScenarioEngine*         scenario_engine_;
-        Object*                 centralObject_;
-        aabbTree::ptTree        rTree;
-        unsigned long           numberOfVehicles;
-        std::vector<SpawnInfo>  spawnedV;
-        roadmanager::OpenDrive* odrManager_;
-        double                  innerRadius_, semiMajorAxis_, semiMinorAxis_, midSMjA, midSMnA, minSize_, lastTime;
-        VehiclePool             vehicle_pool_;
-        static int              counter_;
-
-        int         despawn(double simTime);
-        void        createRoadSegments(aabbTree::BBoxVec& vec);
-        void        spawn(Solutions sols, int replace, double simTime);
+        // Vehicle requested at last spawn point update, to be instantiated in coming frames
+        struct SpawnRequest
+        {
+            roadmanager::Position pos;
+            roadmanager::Road*    road;
+            int                   laneID;
+        };
+
+        // Ellipse sample point, terms not depending on the central object pose precalculated
+        struct EllipseVertex
+        {
+            double alpha;   // parametrization angle
+            double majCos;  // SMjA * cos(alpha)
+            double majSin;  // SMjA * sin(alpha)
+            double minCos;  // SMnA * cos(alpha)
+            double minSin;  // SMnA * sin(alpha)
+        };
+
+        double                            velocity_;
+        Entities*                         entities_;
+        ScenarioGateway*                  gateway_;
+        ScenarioReader*                   reader_;
+        ScenarioEngine*                   scenario_engine_;
+        Object*                           centralObject_;
+        aabbTree::Tree                    rTree;
+        unsigned long                     numberOfVehicles;
+        std::vector<SpawnInfo>            spawnedV;
+        roadmanager::OpenDrive*           odrManager_;
+        double                            innerRadius_, semiMajorAxis_, semiMinorAxis_, midSMjA, midSMnA, minSize_, lastTime;
+        VehiclePool                       vehicle_pool_;
+        static int                        counter_;
+        std::vector<EllipseVertex>        ellipseVertices_;
+        aabbTree::Tree                    eTree_;  // ellipse triangles, storage reused between updates
+        aabbTree::Candidates              candidates_;
+        vector<aabbTree::Triangle const*> hits_;
+        Solutions                         sols_;         // ellipse/road intersection points for the pose below
+        double                            solsX_ = 0.0;  // central object pose sols_ was calculated for
+        double                            solsY_ = 0.0;
+        double                            solsH_ = 0.0;
+        Solutions                         spawnPoints_;  // copy of sols_ which queueSpawns() may reorder
+        vector<SelectInfo>                selectInfo_;
+        Solutions                         selected_;
+        vector<idx_t>                     laneElements_;
+        vector<idx_t>                     laneSample_;
+        vector<SpawnRequest>              spawnQueue_;
+        size_t                            spawnQueueHead_ = 0;  // next request to process
+        size_t                            spawnBudget_    = 0;  // max number of requests to process per frame
+        size_t                            despawnCursor_  = 0;  // next vehicle to check for despawn
+        int                               despawnCount_   = 0;  // number of despawned vehicles since last spawn point update
+        NeighborIndex                     occupancy_;  // swarm vehicles at start of current frame spawn phase
+        vector<Object*>                   occupancyObjects_;
+        vector<Object*>                   recentSpawns_;  // vehicles spawned after occupancy_ was built
+        vector<Object*>                   nearby_;
+        vector<size_t>                    nearbyScratch_;  // working memory for occupancy_ queries
+
+        void        updateSpawnPoints();
+        int         despawn(size_t budget);
+        void        removeVehicle(SpawnInfo& info);
+        void        createRoadSegments(aabbTree::TriangleVec& vec);
+        void        queueSpawns(Solutions& sols, int replace, double dt);
+        void        spawnQueued(size_t budget, double simTime);
+        void        spawnVehicle(SpawnRequest& request, double simTime);
         inline bool ensureDistance(roadmanager::Position pos, int lane, double dist);
-        void        createEllipseSegments(aabbTree::BBoxVec& vec, double SMjA, double SMnA);
+        void        initEllipseSegments(double SMjA, double SMnA);
+        void        createEllipseSegments(aabbTree::TriangleVec& vec);
         inline void sampleRoads(int minN, int maxN, Solutions& sols, vector<SelectInfo>& info);
     };
 
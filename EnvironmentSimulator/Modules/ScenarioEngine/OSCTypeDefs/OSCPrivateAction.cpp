@@ -3146,3 +3146,120 @@ double OverrideControlAction::RangeCheckAndErrorLog(Object::OverrideType type, d
     }
     return valueCheck;
 }
+
+void LongSpeedAction::SaveState(SE_StateStream& stream)
+{
+    OSCPrivateAction::SaveState(stream);
+    stream.Write(transition_);
+    stream.Write(target_speed_reached_);
+}
+
+int LongSpeedAction::RestoreState(SE_StateStream& stream)
+{
+    if (OSCPrivateAction::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(transition_);
+    stream.Read(target_speed_reached_);
+
+    return stream.Good() ? 0 : -1;
+}
+
+
+void LongSpeedProfileAction::SaveState(SE_StateStream& stream)
+{
+    OSCPrivateAction::SaveState(stream);
+    stream.Write(cur_index_);
+    stream.Write(start_time_);
+    stream.Write(elapsed_);
+    stream.Write(speed_);
+    stream.Write(acc_);
+    stream.Write(init_acc_);
+    stream.WriteVector(segment_);
+}
+
+int LongSpeedProfileAction::RestoreState(SE_StateStream& stream)
+{
+    if (OSCPrivateAction::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(cur_index_);
+    stream.Read(start_time_);
+    stream.Read(elapsed_);
+    stream.Read(speed_);
+    stream.Read(acc_);
+    stream.Read(init_acc_);
+    stream.ReadVector(segment_);
+
+    return stream.Good() ? 0 : -1;
+}
+
+
+void LatLaneChangeAction::SaveState(SE_StateStream& stream)
+{
+    OSCPrivateAction::SaveState(stream);
+    stream.Write(transition_);
+    stream.Write(target_lane_offset_);
+    stream.Write(start_offset_);
+    stream.Write(heading_agnostic_);
+    internal_pos_.SaveState(stream);
+}
+
+int LatLaneChangeAction::RestoreState(SE_StateStream& stream)
+{
+    if (OSCPrivateAction::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(transition_);
+    stream.Read(target_lane_offset_);
+    stream.Read(start_offset_);
+    stream.Read(heading_agnostic_);
+    internal_pos_.RestoreState(stream);
+
+    return stream.Good() ? 0 : -1;
+}
+
+
+void LatLaneOffsetAction::SaveState(SE_StateStream& stream)
+{
+    OSCPrivateAction::SaveState(stream);
+    stream.Write(transition_);
+}
+
+int LatLaneOffsetAction::RestoreState(SE_StateStream& stream)
+{
+    if (OSCPrivateAction::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(transition_);
+
+    return stream.Good() ? 0 : -1;
+}
+
+
+void FollowTrajectoryAction::SaveState(SE_StateStream& stream)
+{
+    OSCPrivateAction::SaveState(stream);
+    stream.Write(time_);
+    stream.Write(initialDistanceOffset_);
+    stream.Write(initialHeadingSign_);
+    stream.Write(movingDirection_);
+}
+
+int FollowTrajectoryAction::RestoreState(SE_StateStream& stream)
+{
+    if (OSCPrivateAction::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.Read(time_);
+    stream.Read(initialDistanceOffset_);
+    stream.Read(initialHeadingSign_);
+    stream.Read(movingDirection_);
+
+    return stream.Good() ? 0 : -1;
+}
@@ -292,6 +292,8 @@ namespace scenarioengine
 
         void Start(double simTime);
         void Step(double simTime, double dt);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
 
         void print()
         {
@@ -404,6 +406,8 @@ namespace scenarioengine
 
         void Start(double simTime);
         void Step(double simTime, double dt = 0.0);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
 
         void print()
         {
@@ -732,6 +736,8 @@ namespace scenarioengine
         };
 
         void Step(double simTime, double dt);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
         void Start(double simTime);
 
         void ReplaceObjectRefs(Object* obj1, Object* obj2);
@@ -816,6 +822,8 @@ namespace scenarioengine
 
         void Start(double simTime);
         void Step(double simTime, double dt);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
 
         void ReplaceObjectRefs(Object* obj1, Object* obj2);
     };
@@ -1216,6 +1224,8 @@ namespace scenarioengine
         };
 
         void Step(double simTime, double dt);
+        void SaveState(SE_StateStream& stream);
+        int  RestoreState(SE_StateStream& stream);
         void Start(double simTime);
         void End();
 
@@ -208,7 +208,7 @@ namespace STGeometry
     /*
      * Checks whether the intersection points found belong to the segment of road
      */
-    void checkRange(aabbTree::Triangle &triangle, Solutions &sols, size_t pos)
+    void checkRange(aabbTree::Triangle const &triangle, Solutions &sols, size_t pos)
     {
         double xmin, ymin, xmax, ymax;
         xmin = triangle.a.x;
@@ -300,7 +300,7 @@ namespace STGeometry
      * @return true if a solution is found
      * @return false if no solutions have been found
      */
-    bool geometryIntersect(Triangle &triangle, EllipseInfo &eInfo, Solutions &sol)
+    bool geometryIntersect(Triangle const &triangle, EllipseInfo &eInfo, Solutions &sol)
     {
         double                 res;
         double                 h, k, AA, SMjA, SMnA;
@@ -129,7 +129,7 @@ namespace STGeometry
     /*
      * Checks whether the intersection points found belong to the segment of road
      */
-    void checkRange(aabbTree::Triangle& triangle, Solutions& sols, size_t pos);
+    void checkRange(aabbTree::Triangle const& triangle, Solutions& sols, size_t pos);
 
     /**
      * @brief Finds the zeros of a function 'f' given the guess
@@ -149,6 +149,6 @@ namespace STGeometry
      * @return true if a solution is found
      * @return false if no solutions have been found
      */
-    bool geometryIntersect(Triangle& triangle, EllipseInfo& eInfo, Solutions& sol);
+    bool geometryIntersect(Triangle const& triangle, EllipseInfo& eInfo, Solutions& sol);
 
 }  // namespace STGeometry
\ No newline at end of file
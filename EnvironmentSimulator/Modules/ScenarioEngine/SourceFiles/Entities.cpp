@@ -11,6 +11,7 @@
  */
 
 #include <random>
+#include <cstring>
 #include "Entities.hpp"
 #include "Controller.hpp"
 #include "Storyboard.hpp"
@@ -19,6 +20,25 @@ using namespace scenarioengine;
 using namespace roadmanager;
 
 #define ELEVATION_DIFF_THRESHOLD 2.5
+// The SAT check treats boxes closer than SMALL_NUMBER as overlapping, so the broad phase has to include those as well.
+// Margin is applied to the enclosing boxes, covering gaps measured along rotated axes by SAT as well.
+#define BROAD_PHASE_MARGIN (4 * SMALL_NUMBER)
+
+// AVX2 kernel is compiled for x86-64 only, and selected at runtime depending on CPU support
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define SE_KINEMATICS_AVX2
+#define SE_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define SE_KINEMATICS_AVX2
+#define SE_TARGET_AVX2
+#endif
+
+#ifdef SE_KINEMATICS_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 
 Object::Object(Type type)
     : type_(type),
@@ -51,8 +71,10 @@ Object::Object(Type type)
 
     state_old.pos_x  = 0;
     state_old.pos_y  = 0;
+    state_old.pos_z  = 0;
     state_old.vel_x  = 0;
     state_old.vel_y  = 0;
+    state_old.vel_z  = 0;
     state_old.h      = 0;
     state_old.h_rate = 0;
 
@@ -1428,6 +1450,772 @@ Object::OverlapType Object::OverlappingFront(Object* target, double tolerance)
     return OverlapType::NONE;
 }
 
+void Object::SaveState(SE_StateStream& stream) const
+{
+    stream.Write(speed_);
+    stream.Write(wheel_angle_);
+    stream.Write(wheel_rot_);
+    stream.Write(ghost_trail_s_);
+    stream.Write(trail_follow_index_);
+    stream.Write(odometer_);
+    stream.Write(end_of_road_timestamp_);
+    stream.Write(off_road_timestamp_);
+    stream.Write(stand_still_timestamp_);
+    stream.Write(reset_);
+    stream.Write(headstart_time_);
+    stream.Write(visibilityMask_);
+    stream.Write(junctionSelectorStrategy_);
+    stream.Write(nextJunctionSelectorAngle_);
+    stream.Write(trail_closest_pos_);
+    stream.Write(sensor_pos_);
+    stream.Write(overrideActionList);
+    stream.Write(state_old);
+    stream.Write(dirty_);
+    pos_.SaveState(stream);
+    stream.WriteVector(trail_.vertex_);
+    stream.Write(trail_.current_index_);
+    stream.Write(trail_.current_val_);
+    stream.Write(trail_.length_);
+    stream.Write(trail_.interpolation_mode_);
+    stream.Write(trail_.n_discarded_);
+    stream.Write(trail_.start_time_);
+}
+
+int Object::RestoreState(SE_StateStream& stream)
+{
+    stream.Read(speed_);
+    stream.Read(wheel_angle_);
+    stream.Read(wheel_rot_);
+    stream.Read(ghost_trail_s_);
+    stream.Read(trail_follow_index_);
+    stream.Read(odometer_);
+    stream.Read(end_of_road_timestamp_);
+    stream.Read(off_road_timestamp_);
+    stream.Read(stand_still_timestamp_);
+    stream.Read(reset_);
+    stream.Read(headstart_time_);
+    stream.Read(visibilityMask_);
+    stream.Read(junctionSelectorStrategy_);
+    stream.Read(nextJunctionSelectorAngle_);
+    stream.Read(trail_closest_pos_);
+    stream.Read(sensor_pos_);
+    stream.Read(overrideActionList);
+    stream.Read(state_old);
+    stream.Read(dirty_);
+    if (pos_.RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.ReadVector(trail_.vertex_);
+    stream.Read(trail_.current_index_);
+    stream.Read(trail_.current_val_);
+    stream.Read(trail_.length_);
+    stream.Read(trail_.interpolation_mode_);
+    stream.Read(trail_.n_discarded_);
+    stream.Read(trail_.start_time_);
+
+    return stream.Good() ? 0 : -1;
+}
+
+void Vehicle::SaveState(SE_StateStream& stream) const
+{
+    Object::SaveState(stream);
+    stream.WriteVector(wheel_data);
+}
+
+int Vehicle::RestoreState(SE_StateStream& stream)
+{
+    if (Object::RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+    stream.ReadVector(wheel_data);
+
+    return stream.Good() ? 0 : -1;
+}
+
+void Entities::SaveState(SE_StateStream& stream) const
+{
+    stream.Write(nextId_);
+
+    stream.Write(static_cast<uint32_t>(object_.size() + object_pool_.size()));
+    for (auto obj_list : {&object_, &object_pool_})
+    {
+        for (auto obj : *obj_list)
+        {
+            stream.Write(obj->id_);
+            stream.Write(obj->IsActive());
+            obj->SaveState(stream);
+
+            stream.Write(static_cast<uint32_t>(obj->collisions_.size()));
+            for (auto c : obj->collisions_)
+            {
+                stream.Write(c->id_);
+            }
+        }
+    }
+}
+
+int Entities::RestoreState(SE_StateStream& stream)
+{
+    std::vector<Object*> all_objects = object_;
+    all_objects.insert(all_objects.end(), object_pool_.begin(), object_pool_.end());
+
+    auto find_by_id = [&all_objects](int id) -> Object*
+    {
+        for (auto obj : all_objects)
+        {
+            if (obj->id_ == id)
+            {
+                return obj;
+            }
+        }
+        return nullptr;
+    };
+
+    stream.Read(nextId_);
+
+    uint32_t n_objects = 0;
+    stream.Read(n_objects);
+
+    std::vector<Object*> active;
+    std::vector<Object*> inactive;
+
+    for (uint32_t i = 0; i < n_objects && stream.Good(); i++)
+    {
+        int  id        = -1;
+        bool is_active = false;
+        stream.Read(id);
+        stream.Read(is_active);
+
+        Object* obj = find_by_id(id);
+        if (obj == nullptr)
+        {
+            LOG_ERROR("Restore state: Object with id {} does not exist", id);
+            return -1;
+        }
+
+        if (obj->RestoreState(stream) != 0)
+        {
+            LOG_ERROR("Restore state: Failed to restore object {}", obj->GetName());
+            return -1;
+        }
+
+        uint32_t n_collisions = 0;
+        stream.Read(n_collisions);
+        obj->collisions_.clear();
+        for (uint32_t j = 0; j < n_collisions && stream.Good(); j++)
+        {
+            int     collision_id = -1;
+            Object* collision    = nullptr;
+            stream.Read(collision_id);
+            if ((collision = find_by_id(collision_id)) != nullptr)
+            {
+                obj->collisions_.push_back(collision);
+            }
+        }
+
+        obj->SetActive(is_active);
+        if (is_active)
+        {
+            active.push_back(obj);
+        }
+        else
+        {
+            inactive.push_back(obj);
+        }
+    }
+
+    if (!stream.Good())
+    {
+        return -1;
+    }
+
+    // objects created after the snapshot was taken are kept, but deactivated
+    for (auto obj : all_objects)
+    {
+        if (std::find(active.begin(), active.end(), obj) == active.end() && std::find(inactive.begin(), inactive.end(), obj) == inactive.end())
+        {
+            obj->SetActive(false);
+            inactive.push_back(obj);
+        }
+    }
+
+    object_      = active;
+    object_pool_ = inactive;
+    neighbor_index_.Invalidate();
+
+    return 0;
+}
+
+void Entities::UpdateStateBlock()
+{
+    state_block_.Resize(object_.size());
+    for (size_t i = 0; i < object_.size(); i++)
+    {
+        state_block_.Set(i, object_[i]);
+    }
+}
+
+void Entities::UpdateNeighborIndex()
+{
+    neighbor_index_.Build(object_);
+}
+
+void Entities::GetObjectsInRadius(double x, double y, double radius, std::vector<Object*>& result, std::vector<size_t>& scratch) const
+{
+    if (neighbor_index_.IsValid())
+    {
+        neighbor_index_.GetObjectsInRadius(x, y, radius, result, scratch);
+        return;
+    }
+
+    result.clear();
+    for (auto* obj : object_)
+    {
+        double dx = obj->pos_.GetX() - x;
+        double dy = obj->pos_.GetY() - y;
+        if (dx * dx + dy * dy <= radius * radius)
+        {
+            result.push_back(obj);
+        }
+    }
+}
+
+bool Entities::GetClosestInLane(Object*               ref,
+                                int                   lane_offset,
+                                bool                  ahead,
+                                double                max_dist,
+                                double                max_lateral,
+                                LaneNeighbor&         result,
+                                std::vector<Object*>& candidates,
+                                std::vector<size_t>&  scratch) const
+{
+    result = LaneNeighbor();
+
+    // Distance along the road might be shorter than euclidean distance on outer lanes of curves, and entities might
+    // have moved since indexed. Hence a generous radius for the pre-selection.
+    GetObjectsInRadius(ref->pos_.GetX(), ref->pos_.GetY(), 2 * max_dist + 20.0, candidates, scratch);
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        Object* obj = candidates[i];
+        if (obj == nullptr || obj == ref)
+        {
+            continue;
+        }
+
+        // measure in driving direction of the following object
+        Object*                   follow = ahead ? ref : obj;
+        Object*                   lead   = ahead ? obj : ref;
+        roadmanager::PositionDiff diff;
+        if (follow->pos_.Delta(&lead->pos_, diff, false, max_dist) == false)
+        {
+            continue;
+        }
+
+        // dLaneId from following to leading object, i.e. reversed for a follow object
+        if (diff.dLaneId != (ahead ? lane_offset : -lane_offset) || !(abs(diff.dt) < max_lateral))
+        {
+            continue;
+        }
+
+        // adjust longitudinal distance wrt bounding boxes
+        double gap = diff.ds - (static_cast<double>(follow->boundingbox_.dimensions_.length_) / 2.0 +
+                                static_cast<double>(follow->boundingbox_.center_.x_));
+        if (GetAbsAngleDifference(follow->pos_.GetH(), lead->pos_.GetH()) < M_PI_2)
+        {
+            // objects are pointing roughly in the same direction, consider rear end of lead object
+            gap -= static_cast<double>(lead->boundingbox_.dimensions_.length_) / 2.0 - static_cast<double>(lead->boundingbox_.center_.x_);
+        }
+        else
+        {
+            // objects are pointing roughly in the opposite direction, consider front end of lead object
+            gap -= static_cast<double>(lead->boundingbox_.dimensions_.length_) / 2.0 + static_cast<double>(lead->boundingbox_.center_.x_);
+        }
+
+        if (gap > 0.0 && gap < result.gap)
+        {
+            result.object = obj;
+            result.diff   = diff;
+            result.gap    = gap;
+        }
+    }
+
+    return result.object != nullptr;
+}
+
+uint64_t NeighborIndex::CellKey(int64_t cx, int64_t cy) const
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+uint64_t NeighborIndex::CellKey(double x, double y) const
+{
+    return CellKey(static_cast<int64_t>(floor(x / cell_size_)), static_cast<int64_t>(floor(y / cell_size_)));
+}
+
+void NeighborIndex::Build(const std::vector<Object*>& objects)
+{
+    objects_ = objects;
+    x_.resize(objects.size());
+    y_.resize(objects.size());
+    cell_entries_.resize(objects.size());
+
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        x_[i]            = objects[i]->pos_.GetX();
+        y_[i]            = objects[i]->pos_.GetY();
+        cell_entries_[i] = {CellKey(x_[i], y_[i]), i};
+    }
+
+    std::sort(cell_entries_.begin(),
+              cell_entries_.end(),
+              [](const CellEntry& a, const CellEntry& b) { return a.key < b.key || (a.key == b.key && a.index < b.index); });
+
+    cell_range_.clear();
+    for (size_t i = 0; i < cell_entries_.size();)
+    {
+        size_t end = i + 1;
+        while (end < cell_entries_.size() && cell_entries_[end].key == cell_entries_[i].key)
+        {
+            end++;
+        }
+        cell_range_[cell_entries_[i].key] = {i, end};
+        i                                  = end;
+    }
+
+    valid_ = true;
+}
+
+void NeighborIndex::GetObjectsInRadius(double x, double y, double radius, std::vector<Object*>& result, std::vector<size_t>& scratch) const
+{
+    result.clear();
+    scratch.clear();
+
+    int64_t cx_min = static_cast<int64_t>(floor((x - radius) / cell_size_));
+    int64_t cx_max = static_cast<int64_t>(floor((x + radius) / cell_size_));
+    int64_t cy_min = static_cast<int64_t>(floor((y - radius) / cell_size_));
+    int64_t cy_max = static_cast<int64_t>(floor((y + radius) / cell_size_));
+
+    if ((cx_max - cx_min + 1) * (cy_max - cy_min + 1) > static_cast<int64_t>(cell_range_.size()))
+    {
+        // huge radius compared to populated area, check each object instead of each cell
+        for (size_t i = 0; i < objects_.size(); i++)
+        {
+            if ((x_[i] - x) * (x_[i] - x) + (y_[i] - y) * (y_[i] - y) <= radius * radius)
+            {
+                result.push_back(objects_[i]);
+            }
+        }
+        return;
+    }
+
+    for (int64_t cx = cx_min; cx <= cx_max; cx++)
+    {
+        for (int64_t cy = cy_min; cy <= cy_max; cy++)
+        {
+            auto it = cell_range_.find(CellKey(cx, cy));
+            if (it == cell_range_.end())
+            {
+                continue;
+            }
+
+            for (size_t j = it->second.first; j < it->second.second; j++)
+            {
+                size_t index = cell_entries_[j].index;
+                if ((x_[index] - x) * (x_[index] - x) + (y_[index] - y) * (y_[index] - y) <= radius * radius)
+                {
+                    scratch.push_back(index);
+                }
+            }
+        }
+    }
+
+    // keep order of object list, for deterministic results
+    std::sort(scratch.begin(), scratch.end());
+    for (size_t index : scratch)
+    {
+        result.push_back(objects_[index]);
+    }
+}
+
+void EntityStateBlock::Resize(size_t size)
+{
+    object_.resize(size);
+    x_.resize(size);
+    y_.resize(size);
+    z_.resize(size);
+    h_.resize(size);
+    speed_.resize(size);
+    vel_x_.resize(size);
+    vel_y_.resize(size);
+    vel_z_.resize(size);
+    acc_x_.resize(size);
+    acc_y_.resize(size);
+    acc_z_.resize(size);
+    h_rate_.resize(size);
+    h_acc_.resize(size);
+    dirty_.resize(size);
+    x_old_.resize(size);
+    y_old_.resize(size);
+    z_old_.resize(size);
+    vel_x_old_.resize(size);
+    vel_y_old_.resize(size);
+    vel_z_old_.resize(size);
+    h_old_.resize(size);
+    h_rate_old_.resize(size);
+    bb_min_x_.resize(size);
+    bb_min_y_.resize(size);
+    bb_max_x_.resize(size);
+    bb_max_y_.resize(size);
+    h_rate_new_.resize(size);
+    dist_.resize(size);
+    update_.resize(size);
+}
+
+void EntityStateBlock::Set(size_t index, Object* obj)
+{
+    object_[index]     = obj;
+    obj->state_index_  = static_cast<int>(index);
+    x_[index]          = obj->pos_.GetX();
+    y_[index]          = obj->pos_.GetY();
+    z_[index]          = obj->pos_.GetZ();
+    h_[index]          = obj->pos_.GetH();
+    speed_[index]      = obj->GetSpeed();
+    vel_x_[index]      = obj->pos_.GetVelX();
+    vel_y_[index]      = obj->pos_.GetVelY();
+    vel_z_[index]      = obj->pos_.GetVelZ();
+    acc_x_[index]      = obj->pos_.GetAccX();
+    acc_y_[index]      = obj->pos_.GetAccY();
+    acc_z_[index]      = obj->pos_.GetAccZ();
+    h_rate_[index]     = obj->pos_.GetHRate();
+    h_acc_[index]      = obj->pos_.GetHAcc();
+    dirty_[index]      = obj->GetDirtyBitMask();
+    x_old_[index]      = obj->state_old.pos_x;
+    y_old_[index]      = obj->state_old.pos_y;
+    z_old_[index]      = obj->state_old.pos_z;
+    vel_x_old_[index]  = obj->state_old.vel_x;
+    vel_y_old_[index]  = obj->state_old.vel_y;
+    vel_z_old_[index]  = obj->state_old.vel_z;
+    h_old_[index]      = obj->state_old.h;
+    h_rate_old_[index] = obj->state_old.h_rate;
+    h_rate_new_[index] = 0.0;
+    dist_[index]       = 0.0;
+    update_[index]     = 0;
+
+    // rotate bounding box center and half extents into global axis aligned box
+    double cos_h  = cos(h_[index]);
+    double sin_h  = sin(h_[index]);
+    double cx     = static_cast<double>(obj->boundingbox_.center_.x_);
+    double cy     = static_cast<double>(obj->boundingbox_.center_.y_);
+    double half_l = 0.5 * static_cast<double>(obj->boundingbox_.dimensions_.length_);
+    double half_w = 0.5 * static_cast<double>(obj->boundingbox_.dimensions_.width_);
+    double ex     = fabs(cos_h) * half_l + fabs(sin_h) * half_w + BROAD_PHASE_MARGIN;
+    double ey     = fabs(sin_h) * half_l + fabs(cos_h) * half_w + BROAD_PHASE_MARGIN;
+    double gx     = x_[index] + cos_h * cx - sin_h * cy;
+    double gy     = y_[index] + sin_h * cx + cos_h * cy;
+
+    bb_min_x_[index] = gx - ex;
+    bb_max_x_[index] = gx + ex;
+    bb_min_y_[index] = gy - ey;
+    bb_max_y_[index] = gy + ey;
+}
+
+void EntityStateBlock::UpdateKinematics(double dt, Kernel kernel)
+{
+    if (kernel != Kernel::SCALAR && dt > SMALL_NUMBER && IsAVX2Supported())
+    {
+        UpdateKinematicsAVX2(dt);
+        return;
+    }
+
+    for (size_t i = 0; i < Size(); i++)
+    {
+        if (update_[i])
+        {
+            UpdateKinematicsEntry(i, dt);
+        }
+    }
+}
+
+void EntityStateBlock::UpdateKinematicsEntry(size_t i, double dt)
+{
+    int dirty = dirty_[i];
+
+    if (dt > SMALL_NUMBER)
+    {
+        // If velocity has not been reported, calculate it based on movement
+        if (!(dirty & Object::DirtyBit::VELOCITY))
+        {
+            if (dirty & Object::DirtyBit::TELEPORT)
+            {
+                // if teleport occured, calculate approximated velocity vector based on current heading
+                vel_x_[i] = speed_[i] * cos(h_[i]);
+                vel_y_[i] = speed_[i] * sin(h_[i]);
+                vel_z_[i] = 0.0;
+            }
+            else
+            {
+                // calculate linear velocity
+                vel_x_[i] = (x_[i] - x_old_[i]) / dt;
+                vel_y_[i] = (y_[i] - y_old_[i]) / dt;
+                vel_z_[i] = (z_[i] - z_old_[i]) / dt;
+            }
+            dirty |= Object::DirtyBit::VELOCITY;
+        }
+
+        // If speed has not been reported or set by any controller, calculate it based on velocity
+        if (!(dirty & Object::DirtyBit::SPEED))
+        {
+            speed_[i] = GetLengthOfVector2D(vel_x_[i], vel_y_[i]);
+            dirty |= Object::DirtyBit::SPEED;
+        }
+
+        if (!(dirty & Object::DirtyBit::ACCELERATION))
+        {
+            // If not already reported, calculate linear acceleration
+            acc_x_[i] = (vel_x_[i] - vel_x_old_[i]) / dt;
+            acc_y_[i] = (vel_y_[i] - vel_y_old_[i]) / dt;
+            acc_z_[i] = (vel_z_[i] - vel_z_old_[i]) / dt;
+            dirty |= Object::DirtyBit::ACCELERATION;
+        }
+
+        h_rate_new_[i] = GetAngleDifference(h_[i], h_old_[i]) / dt;
+        if (!(dirty & Object::DirtyBit::ANGULAR_RATE))
+        {
+            // If not already reported, calculate angular velocity/rate
+            h_rate_[i] = h_rate_new_[i];
+            dirty |= Object::DirtyBit::ANGULAR_RATE;
+        }
+
+        if (!(dirty & Object::DirtyBit::ANGULAR_ACC))
+        {
+            // If not already reported, calculate angular acceleration
+            h_acc_[i] = GetAngleDifference(h_rate_new_[i], h_rate_old_[i]) / dt;
+            dirty |= Object::DirtyBit::ANGULAR_ACC;
+        }
+    }
+    else if (!(dirty & Object::DirtyBit::VELOCITY))
+    {
+        // If not already reported, calculate approximated velocity vector based on current heading
+        vel_x_[i] = speed_[i] * cos(h_[i]);
+        vel_y_[i] = speed_[i] * sin(h_[i]);
+        vel_z_[i] = 0.0;
+        dirty |= Object::DirtyBit::VELOCITY;
+    }
+
+    dirty_[i] = dirty;
+
+    // odometer always measure all movements as positive
+    dist_[i] = GetLengthOfVector2D(x_[i] - x_old_[i], y_[i] - y_old_[i]);
+
+    // store current values for next frame
+    x_old_[i]      = x_[i];
+    y_old_[i]      = y_[i];
+    z_old_[i]      = z_[i];
+    vel_x_old_[i]  = vel_x_[i];
+    vel_y_old_[i]  = vel_y_[i];
+    vel_z_old_[i]  = vel_z_[i];
+    h_old_[i]      = h_[i];
+    h_rate_old_[i] = h_rate_[i];
+}
+
+#ifdef SE_KINEMATICS_AVX2
+
+bool EntityStateBlock::IsAVX2Supported()
+{
+#ifdef _MSC_VER
+    static const bool supported = []()
+    {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);  // OSXSAVE, AVX, YMM state
+        __cpuidex(info, 7, 0);
+        return os_avx && (info[1] & (1 << 5));
+    }();
+#else
+    static const bool supported = __builtin_cpu_supports("avx2");
+#endif
+    return supported;
+}
+
+// Vector version of GetAngleDifference(), fmod replaced by truncated division
+SE_TARGET_AVX2 static inline __m256d AngleDifferenceAVX2(__m256d angle1, __m256d angle2)
+{
+    const __m256d two_pi = _mm256_set1_pd(2 * M_PI);
+    const __m256d pi     = _mm256_set1_pd(M_PI);
+    __m256d       diff   = _mm256_sub_pd(angle1, angle2);
+
+    diff = _mm256_sub_pd(diff, _mm256_mul_pd(_mm256_round_pd(_mm256_div_pd(diff, two_pi), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), two_pi));
+    diff = _mm256_add_pd(diff, _mm256_and_pd(_mm256_cmp_pd(diff, _mm256_sub_pd(_mm256_setzero_pd(), pi), _CMP_LT_OQ), two_pi));
+    diff = _mm256_sub_pd(diff, _mm256_and_pd(_mm256_cmp_pd(diff, pi, _CMP_GT_OQ), two_pi));
+
+    return diff;
+}
+
+// Lanes where given dirty bit is NOT set
+SE_TARGET_AVX2 static inline __m256d NotDirtyAVX2(__m256i dirty, int bit)
+{
+    return _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(dirty, _mm256_set1_epi64x(bit)), _mm256_setzero_si256()));
+}
+
+SE_TARGET_AVX2 void EntityStateBlock::UpdateKinematicsAVX2(double dt)
+{
+    const __m256d vdt        = _mm256_set1_pd(dt);
+    const int     calculated = Object::DirtyBit::VELOCITY | Object::DirtyBit::SPEED | Object::DirtyBit::ACCELERATION |
+                           Object::DirtyBit::ANGULAR_RATE | Object::DirtyBit::ANGULAR_ACC;
+    size_t i = 0;
+
+    for (; i + 4 <= Size(); i += 4)
+    {
+        bool any_update = false;
+        bool teleport   = false;
+        for (size_t j = i; j < i + 4; j++)
+        {
+            any_update |= update_[j] != 0;
+            teleport |= update_[j] && !(dirty_[j] & Object::DirtyBit::VELOCITY) && (dirty_[j] & Object::DirtyBit::TELEPORT);
+        }
+
+        if (!any_update)
+        {
+            continue;
+        }
+
+        if (teleport)
+        {
+            // velocity from heading needs trigonometric functions, rare case handled by scalar code
+            for (size_t j = i; j < i + 4; j++)
+            {
+                if (update_[j])
+                {
+                    UpdateKinematicsEntry(j, dt);
+                }
+            }
+            continue;
+        }
+
+        int update_bits = 0;
+        memcpy(&update_bits, &update_[i], 4);
+        const __m256i dirty  = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&dirty_[i])));
+        const __m256d update = _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(update_bits)), _mm256_setzero_si256()));
+
+        const __m256d x     = _mm256_loadu_pd(&x_[i]);
+        const __m256d y     = _mm256_loadu_pd(&y_[i]);
+        const __m256d z     = _mm256_loadu_pd(&z_[i]);
+        const __m256d h     = _mm256_loadu_pd(&h_[i]);
+        const __m256d x_old = _mm256_loadu_pd(&x_old_[i]);
+        const __m256d y_old = _mm256_loadu_pd(&y_old_[i]);
+        const __m256d z_old = _mm256_loadu_pd(&z_old_[i]);
+
+        // linear velocity
+        __m256d mask  = _mm256_and_pd(update, NotDirtyAVX2(dirty, Object::DirtyBit::VELOCITY));
+        __m256d vel_x = _mm256_blendv_pd(_mm256_loadu_pd(&vel_x_[i]), _mm256_div_pd(_mm256_sub_pd(x, x_old), vdt), mask);
+        __m256d vel_y = _mm256_blendv_pd(_mm256_loadu_pd(&vel_y_[i]), _mm256_div_pd(_mm256_sub_pd(y, y_old), vdt), mask);
+        __m256d vel_z = _mm256_blendv_pd(_mm256_loadu_pd(&vel_z_[i]), _mm256_div_pd(_mm256_sub_pd(z, z_old), vdt), mask);
+
+        // speed
+        mask = _mm256_and_pd(update, NotDirtyAVX2(dirty, Object::DirtyBit::SPEED));
+        _mm256_storeu_pd(
+            &speed_[i],
+            _mm256_blendv_pd(_mm256_loadu_pd(&speed_[i]), _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(vel_x, vel_x), _mm256_mul_pd(vel_y, vel_y))), mask));
+
+        // linear acceleration
+        mask = _mm256_and_pd(update, NotDirtyAVX2(dirty, Object::DirtyBit::ACCELERATION));
+        _mm256_storeu_pd(&acc_x_[i],
+                         _mm256_blendv_pd(_mm256_loadu_pd(&acc_x_[i]), _mm256_div_pd(_mm256_sub_pd(vel_x, _mm256_loadu_pd(&vel_x_old_[i])), vdt), mask));
+        _mm256_storeu_pd(&acc_y_[i],
+                         _mm256_blendv_pd(_mm256_loadu_pd(&acc_y_[i]), _mm256_div_pd(_mm256_sub_pd(vel_y, _mm256_loadu_pd(&vel_y_old_[i])), vdt), mask));
+        _mm256_storeu_pd(&acc_z_[i],
+                         _mm256_blendv_pd(_mm256_loadu_pd(&acc_z_[i]), _mm256_div_pd(_mm256_sub_pd(vel_z, _mm256_loadu_pd(&vel_z_old_[i])), vdt), mask));
+
+        // angular rate and acceleration
+        __m256d h_rate_new = _mm256_div_pd(AngleDifferenceAVX2(h, _mm256_loadu_pd(&h_old_[i])), vdt);
+        _mm256_storeu_pd(&h_rate_new_[i], _mm256_blendv_pd(_mm256_loadu_pd(&h_rate_new_[i]), h_rate_new, update));
+
+        mask           = _mm256_and_pd(update, NotDirtyAVX2(dirty, Object::DirtyBit::ANGULAR_RATE));
+        __m256d h_rate = _mm256_blendv_pd(_mm256_loadu_pd(&h_rate_[i]), h_rate_new, mask);
+        _mm256_storeu_pd(&h_rate_[i], h_rate);
+
+        mask = _mm256_and_pd(update, NotDirtyAVX2(dirty, Object::DirtyBit::ANGULAR_ACC));
+        _mm256_storeu_pd(
+            &h_acc_[i],
+            _mm256_blendv_pd(_mm256_loadu_pd(&h_acc_[i]), _mm256_div_pd(AngleDifferenceAVX2(h_rate_new, _mm256_loadu_pd(&h_rate_old_[i])), vdt), mask));
+
+        _mm256_storeu_pd(&vel_x_[i], vel_x);
+        _mm256_storeu_pd(&vel_y_[i], vel_y);
+        _mm256_storeu_pd(&vel_z_[i], vel_z);
+
+        // odometer
+        __m256d dx = _mm256_sub_pd(x, x_old);
+        __m256d dy = _mm256_sub_pd(y, y_old);
+        _mm256_storeu_pd(&dist_[i],
+                         _mm256_blendv_pd(_mm256_loadu_pd(&dist_[i]), _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))), update));
+
+        // store current values for next frame
+        _mm256_storeu_pd(&x_old_[i], _mm256_blendv_pd(x_old, x, update));
+        _mm256_storeu_pd(&y_old_[i], _mm256_blendv_pd(y_old, y, update));
+        _mm256_storeu_pd(&z_old_[i], _mm256_blendv_pd(z_old, z, update));
+        _mm256_storeu_pd(&vel_x_old_[i], _mm256_blendv_pd(_mm256_loadu_pd(&vel_x_old_[i]), vel_x, update));
+        _mm256_storeu_pd(&vel_y_old_[i], _mm256_blendv_pd(_mm256_loadu_pd(&vel_y_old_[i]), vel_y, update));
+        _mm256_storeu_pd(&vel_z_old_[i], _mm256_blendv_pd(_mm256_loadu_pd(&vel_z_old_[i]), vel_z, update));
+        _mm256_storeu_pd(&h_old_[i], _mm256_blendv_pd(_mm256_loadu_pd(&h_old_[i]), h, update));
+        _mm256_storeu_pd(&h_rate_old_[i], _mm256_blendv_pd(_mm256_loadu_pd(&h_rate_old_[i]), h_rate, update));
+
+        for (size_t j = i; j < i + 4; j++)
+        {
+            if (update_[j])
+            {
+                dirty_[j] |= calculated;
+            }
+        }
+    }
+
+    // remaining entries
+    for (; i < Size(); i++)
+    {
+        if (update_[i])
+        {
+            UpdateKinematicsEntry(i, dt);
+        }
+    }
+}
+
+#else
+
+bool EntityStateBlock::IsAVX2Supported()
+{
+    return false;
+}
+
+void EntityStateBlock::UpdateKinematicsAVX2(double dt)
+{
+    UpdateKinematics(dt, Kernel::SCALAR);
+}
+
+#endif  // SE_KINEMATICS_AVX2
+
+void EntityStateBlock::GetOverlapCandidates(size_t index, unsigned char* candidates) const
+{
+    const double min_x = bb_min_x_[index];
+    const double max_x = bb_max_x_[index];
+    const double min_y = bb_min_y_[index];
+    const double max_y = bb_max_y_[index];
+    const double z     = z_[index];
+
+    // branch free loop over contiguous arrays, to allow for auto vectorization
+    for (size_t j = index + 1; j < Size(); j++)
+    {
+        candidates[j] = static_cast<unsigned char>((bb_min_x_[j] <= max_x) & (bb_max_x_[j] >= min_x) & (bb_min_y_[j] <= max_y) &
+                                                   (bb_max_y_[j] >= min_y) & (fabs(z_[j] - z) <= ELEVATION_DIFF_THRESHOLD));
+    }
+}
+
 int Entities::addObject(Object* obj, bool activate, int call_index)
 {
     const int max_trailers = 100;
@@ -1440,6 +2228,7 @@ int Entities::addObject(Object* obj, bool activate, int call_index)
     if (activate)
     {
         object_.push_back(obj);
+        neighbor_index_.Invalidate();
     }
     else
     {
@@ -1491,6 +2280,7 @@ int Entities::activateObject(Object* obj, int call_index)
     {
         object_.push_back(obj);
         obj->SetActive(true);
+        neighbor_index_.Invalidate();
 
         int n_objs = static_cast<int>(std::count(object_pool_.begin(), object_pool_.end(), obj));
         if (n_objs == 1)
@@ -1536,6 +2326,7 @@ int Entities::deactivateObject(Object* obj, int call_index)
     {
         object_.erase(std::remove(object_.begin(), object_.end(), obj), object_.end());
         obj->SetActive(false);
+        neighbor_index_.Invalidate();
 
         int n_objs = static_cast<int>(std::count(object_pool_.begin(), object_pool_.end(), obj));
         if (n_objs == 0)
@@ -1613,11 +2404,61 @@ void Entities::removeObject(Object* object, bool recursive)
     }
 
     object_.erase(std::remove(object_.begin(), object_.end(), object), object_.end());
-    delete object;
+    object_pool_.erase(std::remove(object_pool_.begin(), object_pool_.end(), object), object_pool_.end());
+    neighbor_index_.Invalidate();
+
+    if (object->type_ == Object::Type::VEHICLE && recycled_.size() < max_recycled_)
+    {
+        // keep instance for reuse, see NewVehicle()
+        object->SetActive(false);
+        recycled_.push_back(object);
+    }
+    else
+    {
+        delete object;
+    }
 
     return;
 }
 
+void Entities::SetMaxRecycledObjects(size_t max_recycled)
+{
+    max_recycled_ = max_recycled;
+
+    while (recycled_.size() > max_recycled_)
+    {
+        delete recycled_.back();
+        recycled_.pop_back();
+    }
+}
+
+Vehicle* Entities::NewVehicle(const Vehicle* source)
+{
+    bool linked = source != nullptr && ((source->trailer_hitch_ && source->trailer_hitch_->trailer_vehicle_) ||
+                                        (source->trailer_coupler_ && source->trailer_coupler_->tow_vehicle_));
+
+    if (recycled_.empty() || linked)
+    {
+        // trailer connections are resolved by the copy constructor only
+        return source != nullptr ? new Vehicle(*source) : new Vehicle();
+    }
+
+    Vehicle* vehicle = static_cast<Vehicle*>(recycled_.back());
+    recycled_.pop_back();
+
+    // reset in place, assignment reuses allocated storage of members
+    if (source != nullptr)
+    {
+        *vehicle = *source;
+    }
+    else
+    {
+        *vehicle = Vehicle();
+    }
+
+    return vehicle;
+}
+
 bool Entities::nameExists(std::string name) const
 {
     for (size_t i = 0; i < object_.size(); i++)
@@ -15,6 +15,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include "RoadManager.hpp"
 #include "CommonMini.hpp"
 #include "OSCBoundingBox.hpp"
@@ -224,6 +225,9 @@ namespace scenarioengine
 
         std::vector<Object*> collisions_;
 
+        // Index of the object entry in the entity state block (Entities::state_block_), -1 if not registered
+        int state_index_ = -1;
+
         Object(Type type);
         Object(const Object& o) = default;
         virtual ~Object()
@@ -622,6 +626,20 @@ namespace scenarioengine
         static std::string Type2String(int type);
         static std::string Role2String(int role);
 
+        /**
+        Serialize dynamic state of the object, e.g. position, speed, odometer and ghost trail, into a binary stream
+        Static properties, like bounding box and performance, are not included. Neither are controllers and collisions.
+        @param stream Stream to append the state to
+        */
+        virtual void SaveState(SE_StateStream& stream) const;
+
+        /**
+        Restore dynamic state previously stored by SaveState()
+        @param stream Stream to read the state from
+        @return 0 on success, -1 on corrupt data
+        */
+        virtual int RestoreState(SE_StateStream& stream);
+
     private:
         int  dirty_;
         bool is_active_;
@@ -753,6 +771,8 @@ namespace scenarioengine
             return wheel_data;
         }
 
+        void                            SaveState(SE_StateStream& stream) const override;
+        int                             RestoreState(SE_StateStream& stream) override;
         int                             ConnectTrailer(Vehicle* trailer);
         int                             DisconnectTrailer();
         void                            AlignTrailers();
@@ -926,6 +946,169 @@ namespace scenarioengine
         static std::string Category2String(int category);
     };
 
+    /**
+    Structure of arrays holding frequently accessed state of all entities, one entry per object in Entities::object_
+    Passes running over all entities each frame, e.g. kinematics and collision detection, iterate these contiguous
+    arrays instead of dereferencing the large Object instances. The objects remain owners of the state, the block
+    is refreshed from them by Entities::UpdateStateBlock() and each object keeps the index of its entry.
+    */
+    class EntityStateBlock
+    {
+    public:
+        std::vector<Object*> object_;  // owner of each entry
+
+        // current state, global coordinate system
+        std::vector<double> x_;
+        std::vector<double> y_;
+        std::vector<double> z_;
+        std::vector<double> h_;
+        std::vector<double> speed_;
+        std::vector<double> vel_x_;
+        std::vector<double> vel_y_;
+        std::vector<double> vel_z_;
+        std::vector<double> acc_x_;
+        std::vector<double> acc_y_;
+        std::vector<double> acc_z_;
+        std::vector<double> h_rate_;
+        std::vector<double> h_acc_;
+        std::vector<int>    dirty_;
+
+        // state of previous frame, see Object::state_old
+        std::vector<double> x_old_;
+        std::vector<double> y_old_;
+        std::vector<double> z_old_;
+        std::vector<double> vel_x_old_;
+        std::vector<double> vel_y_old_;
+        std::vector<double> vel_z_old_;
+        std::vector<double> h_old_;
+        std::vector<double> h_rate_old_;
+
+        // axis aligned box enclosing the oriented bounding box
+        std::vector<double> bb_min_x_;
+        std::vector<double> bb_min_y_;
+        std::vector<double> bb_max_x_;
+        std::vector<double> bb_max_y_;
+
+        std::vector<double>        h_rate_new_;  // heading rate derived from movement, output of UpdateKinematics()
+        std::vector<double>        dist_;        // horizontal distance moved since previous frame, output of UpdateKinematics()
+        std::vector<unsigned char> update_;      // non zero for entries to be processed by UpdateKinematics()
+
+        enum class Kernel
+        {
+            AUTO,    // best available on current CPU
+            SCALAR,  // plain loop, any platform
+            AVX2     // four entries per iteration, falls back to SCALAR if not supported by compiler or CPU
+        };
+
+        size_t Size() const
+        {
+            return object_.size();
+        }
+
+        void Resize(size_t size);
+
+        /**
+        Copy state of given object into entry at index
+        @param index Entry index
+        @param obj Object to copy state from
+        */
+        void Set(size_t index, Object* obj);
+
+        /**
+        Derive velocity, speed, acceleration and angular rates from movement since previous frame, for entries with
+        update flag set. Only quantities not already reported, i.e. dirty bit not set, are calculated. Calculated
+        quantities are flagged in dirty_. Finally current state is copied into the previous frame state arrays.
+        @param dt Time step since previous frame
+        @param kernel Implementation to use, all give the same result within floating point tolerance
+        */
+        void UpdateKinematics(double dt, Kernel kernel = Kernel::AUTO);
+
+        /**
+        Check whether the AVX2 kernel is available, i.e. supported by both compiler and CPU
+        */
+        static bool IsAVX2Supported();
+
+        /**
+        Broad phase collision check of one entry against all subsequent ones, by means of enclosing boxes and elevation
+        @param index Entry to check
+        @param candidates Array of Size() elements. Element j > index is set to 1 if entries potentially overlap, else 0
+        */
+        void GetOverlapCandidates(size_t index, unsigned char* candidates) const;
+
+    private:
+        void UpdateKinematicsEntry(size_t index, double dt);
+        void UpdateKinematicsAVX2(double dt);
+    };
+
+    /**
+    Spatial index of entities for neighbor queries by controllers and sensors, rebuilt once per frame
+    Entities are bucketed by reference point in a uniform grid of global x, y. Cells are kept as one list sorted by
+    cell key, with the range of each occupied cell in a hash map. Positions are sampled when the index is built, so
+    callers should add a margin for any movement since then. Lane aware queries, see Entities::GetClosestInLane(),
+    use the grid for pre-selection and measure the candidates along the road network.
+    */
+    class NeighborIndex
+    {
+    public:
+        NeighborIndex(double cell_size = 50.0) : cell_size_(cell_size)
+        {
+        }
+
+        /**
+        Build index from current position of given objects
+        @param objects List of objects, typically Entities::object_
+        */
+        void Build(const std::vector<Object*>& objects);
+
+        void Invalidate()
+        {
+            valid_ = false;
+        }
+
+        bool IsValid() const
+        {
+            return valid_;
+        }
+
+        /**
+        Find all objects with reference point within given radius
+        @param x Global x coordinate of center point
+        @param y Global y coordinate of center point
+        @param radius Radius (m)
+        @param result Found objects, in same order as in the object list provided to Build()
+        @param scratch Working memory owned by the caller, keep between queries to avoid allocations
+        */
+        void GetObjectsInRadius(double x, double y, double radius, std::vector<Object*>& result, std::vector<size_t>& scratch) const;
+
+    private:
+        struct CellEntry
+        {
+            uint64_t key;    // grid cell
+            size_t   index;  // index in object list
+        };
+
+        uint64_t CellKey(double x, double y) const;
+        uint64_t CellKey(int64_t cx, int64_t cy) const;
+
+        double                                                  cell_size_;
+        bool                                                    valid_ = false;
+        std::vector<Object*>                                    objects_;
+        std::vector<double>                                     x_;
+        std::vector<double>                                     y_;
+        std::vector<CellEntry>                                  cell_entries_;  // sorted by cell key
+        std::unordered_map<uint64_t, std::pair<size_t, size_t>> cell_range_;    // first and end index in cell_entries_ per cell
+    };
+
+    /**
+    Result of a lane aware neighbor query, see Entities::GetClosestInLane()
+    */
+    struct LaneNeighbor
+    {
+        Object*                   object = nullptr;       // found object, nullptr if none
+        roadmanager::PositionDiff diff   = {};            // relative position, measured from the following to the leading object
+        double                    gap    = LARGE_NUMBER;  // longitudinal distance between bounding boxes along the road (m)
+    };
+
     class Entities
     {
     public:
@@ -943,6 +1126,11 @@ namespace scenarioengine
             {
                 delete entry;
             }
+
+            for (auto* entry : recycled_)
+            {
+                delete entry;
+            }
         }
 
         std::vector<Object*> object_;
@@ -955,14 +1143,100 @@ namespace scenarioengine
         void    removeObject(std::string name, bool recursive = true);
         void    removeObject(Object* object, bool recursive = true);
         int     getNewId();
+
+        /**
+        Create a vehicle, reusing the instance of a previously removed one when available. Storage kept by the reused
+        instance, e.g. trail and controller lists, is not reallocated.
+        @param source Optional vehicle to copy initial state from. Vehicles with trailers are always copied into new instances.
+        @return Vehicle in the state of a newly created one (or copy of source), not yet added to the entities
+        */
+        Vehicle* NewVehicle(const Vehicle* source = nullptr);
+
+        /**
+        @return Number of removed objects kept for reuse
+        */
+        size_t GetNumberOfRecycledObjects() const
+        {
+            return recycled_.size();
+        }
+
+        /**
+        Set max number of removed objects kept for reuse. Objects removed when the limit is reached are deleted.
+        @param max_recycled Max number of objects, 0 disables reuse
+        */
+        void SetMaxRecycledObjects(size_t max_recycled);
+
         bool    indexExists(int id) const;
         bool    nameExists(std::string name) const;
         Object* GetObjectByName(std::string name);
         Object* GetObjectById(int id);
         int     GetObjectIdxById(int id);
 
+        /**
+        Serialize state of all entities, active as well as inactive ones, into a binary stream
+        @param stream Stream to append the state to
+        */
+        void SaveState(SE_StateStream& stream) const;
+
+        /**
+        Restore state of entities previously stored by SaveState(). Objects are identified by ID.
+        Objects active in the snapshot are activated, others are moved to the pool of inactive objects.
+        @param stream Stream to read the state from
+        @return 0 on success, -1 on corrupt data or if any object of the snapshot does not exist anymore
+        */
+        int RestoreState(SE_StateStream& stream);
+
+        /**
+        Refresh the entity state block from current state of all active objects
+        */
+        void UpdateStateBlock();
+
+        /**
+        Rebuild the neighbor index from current state of all active objects
+        */
+        void UpdateNeighborIndex();
+
+        /**
+        Find all objects with reference point within given radius. Makes use of the neighbor index when valid.
+        @param x Global x coordinate of center point
+        @param y Global y coordinate of center point
+        @param radius Radius (m)
+        @param result Found objects, in order of the object list
+        @param scratch Working memory owned by the caller, keep between queries to avoid allocations
+        */
+        void GetObjectsInRadius(double x, double y, double radius, std::vector<Object*>& result, std::vector<size_t>& scratch) const;
+
+        /**
+        Find closest object ahead (lead) or behind (follow) in a lane relative to the lane of a reference object
+        Candidates are pre-selected by GetObjectsInRadius(), then measured along the road network by Position::Delta(),
+        hence following road links and junctions. A follow object is an object having the reference object as lead,
+        i.e. measured in its own driving direction. Objects not reachable without lane change are ignored.
+        @param ref Reference object, not included in the result
+        @param lane_offset Lane relative to the lane of ref, as PositionDiff::dLaneId, e.g. 0 for same lane
+        @param ahead true for closest lead object, false for closest follow object
+        @param max_dist Max distance along the road network between reference points (m)
+        @param max_lateral Lateral distance between reference points must be less than this (m)
+        @param result Closest object with its gap to ref, the one of lowest index in the object list on equal gap
+        @param candidates Pre-selected objects, owned by the caller. May be reused for further checks after the call.
+        @param scratch Working memory owned by the caller, keep between queries to avoid allocations
+        @return true if an object was found, else false
+        */
+        bool GetClosestInLane(Object*               ref,
+                              int                   lane_offset,
+                              bool                  ahead,
+                              double                max_dist,
+                              double                max_lateral,
+                              LaneNeighbor&         result,
+                              std::vector<Object*>& candidates,
+                              std::vector<size_t>&  scratch) const;
+
+        EntityStateBlock state_block_;
+        NeighborIndex    neighbor_index_;
+
     private:
-        int nextId_;  // Is incremented for each new object created
+        int                  nextId_;    // Is incremented for each new object created
+        std::vector<Object*> recycled_;             // removed objects, kept for reuse by NewVehicle()
+        size_t               max_recycled_ = 100;  // limit of recycled_, see SetMaxRecycledObjects()
     };
 
 }  // namespace scenarioengine
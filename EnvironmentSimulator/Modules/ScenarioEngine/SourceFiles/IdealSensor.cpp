@@ -11,6 +11,7 @@
  */
 
 #include "IdealSensor.hpp"
+#include <algorithm>
 
 using namespace scenarioengine;
 
@@ -28,6 +29,195 @@ BaseSensor::BaseSensor(BaseSensor::Type type, double pos_x, double pos_y, double
     pos_.z_global = 0;
 }
 
+// Check whether dot > c * len, with len_sq = len * len, without calculating the square root
+static bool DotAbove(double dot, double len_sq, double c)
+{
+    if (c < 0.0)
+    {
+        return dot >= 0.0 || dot * dot < c * c * len_sq;
+    }
+    return dot > 0.0 && dot * dot > c * c * len_sq;
+}
+
+// Check whether the segment p0 + t * d, t in [0, 1], overlaps the interval [min, max] along one axis.
+// Narrows [t0, t1] to the overlapping part, returns false if empty.
+static bool ClipSlab(double p0, double d, double min, double max, double &t0, double &t1)
+{
+    if (fabs(d) < SMALL_NUMBER)
+    {
+        return p0 >= min && p0 <= max;
+    }
+
+    double ta = (min - p0) / d;
+    double tb = (max - p0) / d;
+    if (ta > tb)
+    {
+        std::swap(ta, tb);
+    }
+    t0 = std::max(t0, ta);
+    t1 = std::min(t1, tb);
+
+    return t0 <= t1;
+}
+
+void FootprintBVH::Build(const std::vector<Object *> &objects)
+{
+    footprints_.clear();
+    nodes_.clear();
+
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        Object *obj = objects[i];
+        if (obj->IsGhost() || !(obj->visibilityMask_ & Object::Visibility::SENSORS))
+        {
+            continue;
+        }
+
+        Footprint fp;
+        GetFootprint(obj, fp);
+        footprints_.push_back(fp);
+    }
+
+    if (!footprints_.empty())
+    {
+        Build(0, static_cast<idx_t>(footprints_.size()));
+    }
+}
+
+idx_t FootprintBVH::Build(idx_t first, idx_t count)
+{
+    const idx_t max_leaf_size = 4;
+
+    idx_t node_idx = static_cast<idx_t>(nodes_.size());
+    nodes_.push_back(Node());
+
+    Node node;
+    node.first    = first;
+    node.count    = count;
+    node.child[0] = IDX_UNDEFINED;
+    node.child[1] = IDX_UNDEFINED;
+    node.min_x    = LARGE_NUMBER;
+    node.min_y    = LARGE_NUMBER;
+    node.max_x    = -LARGE_NUMBER;
+    node.max_y    = -LARGE_NUMBER;
+
+    double c_min_x = LARGE_NUMBER;
+    double c_min_y = LARGE_NUMBER;
+    double c_max_x = -LARGE_NUMBER;
+    double c_max_y = -LARGE_NUMBER;
+    for (idx_t i = first; i < first + count; i++)
+    {
+        const Footprint &fp = footprints_[i];
+        node.min_x          = std::min(node.min_x, fp.min_x);
+        node.min_y          = std::min(node.min_y, fp.min_y);
+        node.max_x          = std::max(node.max_x, fp.max_x);
+        node.max_y          = std::max(node.max_y, fp.max_y);
+        c_min_x             = std::min(c_min_x, fp.x);
+        c_min_y             = std::min(c_min_y, fp.y);
+        c_max_x             = std::max(c_max_x, fp.x);
+        c_max_y             = std::max(c_max_y, fp.y);
+    }
+
+    if (count > max_leaf_size)
+    {
+        // split at median of footprint centers along the longest axis
+        bool  split_x = c_max_x - c_min_x > c_max_y - c_min_y;
+        idx_t half    = count / 2;
+        std::nth_element(footprints_.begin() + first,
+                         footprints_.begin() + first + half,
+                         footprints_.begin() + first + count,
+                         [split_x](const Footprint &a, const Footprint &b) { return split_x ? a.x < b.x : a.y < b.y; });
+
+        node.count    = 0;
+        node.child[0] = Build(first, half);
+        node.child[1] = Build(first + half, count - half);
+    }
+
+    nodes_[node_idx] = node;
+
+    return node_idx;
+}
+
+bool FootprintBVH::IsBlocked(double x0, double y0, double x1, double y1, const Object *ignore0, const Object *ignore1) const
+{
+    if (nodes_.empty())
+    {
+        return false;
+    }
+
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+
+    // balanced tree, depth is limited by log2 of number of footprints
+    idx_t stack[64];
+    int   stack_size = 0;
+
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const Node &node = nodes_[stack[--stack_size]];
+
+        double t0 = 0.0;
+        double t1 = 1.0;
+        if (!ClipSlab(x0, dx, node.min_x, node.max_x, t0, t1) || !ClipSlab(y0, dy, node.min_y, node.max_y, t0, t1))
+        {
+            continue;
+        }
+
+        if (node.count == 0)
+        {
+            stack[stack_size++] = node.child[0];
+            stack[stack_size++] = node.child[1];
+            continue;
+        }
+
+        for (idx_t i = node.first; i < node.first + node.count; i++)
+        {
+            const Footprint &fp = footprints_[i];
+            if (fp.obj == ignore0 || fp.obj == ignore1)
+            {
+                continue;
+            }
+
+            // segment in box local coordinates
+            double lx  = (x0 - fp.x) * fp.cos_h + (y0 - fp.y) * fp.sin_h;
+            double ly  = -(x0 - fp.x) * fp.sin_h + (y0 - fp.y) * fp.cos_h;
+            double ldx = dx * fp.cos_h + dy * fp.sin_h;
+            double ldy = -dx * fp.sin_h + dy * fp.cos_h;
+
+            t0 = 0.0;
+            t1 = 1.0;
+            if (ClipSlab(lx, ldx, -fp.half_length, fp.half_length, t0, t1) && ClipSlab(ly, ldy, -fp.half_width, fp.half_width, t0, t1))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void FootprintBVH::GetFootprint(Object *obj, Footprint &fp)
+{
+    double center_x = static_cast<double>(obj->boundingbox_.center_.x_);
+    double center_y = static_cast<double>(obj->boundingbox_.center_.y_);
+
+    fp.obj         = obj;
+    fp.cos_h       = cos(obj->pos_.GetH());
+    fp.sin_h       = sin(obj->pos_.GetH());
+    fp.x           = obj->pos_.GetX() + fp.cos_h * center_x - fp.sin_h * center_y;
+    fp.y           = obj->pos_.GetY() + fp.sin_h * center_x + fp.cos_h * center_y;
+    fp.half_length = static_cast<double>(obj->boundingbox_.dimensions_.length_) / 2.0;
+    fp.half_width  = static_cast<double>(obj->boundingbox_.dimensions_.width_) / 2.0;
+
+    double ex = fabs(fp.cos_h) * fp.half_length + fabs(fp.sin_h) * fp.half_width;
+    double ey = fabs(fp.sin_h) * fp.half_length + fabs(fp.cos_h) * fp.half_width;
+    fp.min_x  = fp.x - ex;
+    fp.max_x  = fp.x + ex;
+    fp.min_y  = fp.y - ey;
+    fp.max_y  = fp.y + ey;
+}
+
 ObjectSensor::ObjectSensor(Entities *entities,
                            Object   *refobj,
                            double    pos_x,
@@ -40,16 +230,50 @@ ObjectSensor::ObjectSensor(Entities *entities,
                            int       maxObj)
     : BaseSensor(BaseSensor::Type::SENSOR_TYPE_OBJECT, pos_x, pos_y, pos_z, heading)
 {
-    entities_ = entities;
-    near_     = nearClip;
-    near_sq_  = near_ * near_;
-    far_      = farClip;
-    far_sq_   = far_ * far_;
-    fovH_     = fovH;
-    maxObj_   = maxObj;
-    host_     = refobj;
-    nObj_     = 0;
-    hitList_  = static_cast<ObjectHit *>(malloc(static_cast<unsigned int>(maxObj) * sizeof(ObjectHit)));
+    entities_  = entities;
+    near_      = nearClip;
+    near_sq_   = near_ * near_;
+    far_       = farClip;
+    far_sq_    = far_ * far_;
+    fovH_      = fovH;
+    maxObj_    = maxObj;
+    host_      = refobj;
+    nObj_      = 0;
+    occlusion_ = false;
+    hitList_   = static_cast<ObjectHit *>(malloc(static_cast<unsigned int>(maxObj) * sizeof(ObjectHit)));
+
+    // An object is within field of view when the (unsigned) angle between host heading and direction to the
+    // object differs less than half field of view from the sensor heading. That angle is in the range [0, pi],
+    // where cosine is decreasing, so convert the view into cosine intervals once instead of angles per object.
+    nFovCos_ = 0;
+    if (fovH_ / 2 >= M_PI)
+    {
+        fovCos_[0][0] = -2.0;
+        fovCos_[0][1] = 2.0;
+        nFovCos_      = 1;
+    }
+    else
+    {
+        double h = GetAngleInInterval2PI(pos_.h);
+        if (h >= M_PI)
+        {
+            h -= 2 * M_PI;  // [-pi, pi)
+        }
+
+        // view centered at h, or at h + 2pi, may overlap [0, pi]
+        for (int k = 0; k < 2; k++)
+        {
+            double min_angle = h + k * 2 * M_PI - fovH_ / 2;
+            double max_angle = h + k * 2 * M_PI + fovH_ / 2;
+            if (max_angle > 0.0 && min_angle < M_PI)
+            {
+                // bounds outside [0, pi] do not limit the view, set them outside the range of cosine
+                fovCos_[nFovCos_][0] = max_angle < M_PI ? cos(max_angle) : -2.0;
+                fovCos_[nFovCos_][1] = min_angle > 0.0 ? cos(min_angle) : 2.0;
+                nFovCos_++;
+            }
+        }
+    }
 }
 
 ObjectSensor::~ObjectSensor()
@@ -57,13 +281,58 @@ ObjectSensor::~ObjectSensor()
     free(hitList_);
 }
 
-void ObjectSensor::Update()
+bool ObjectSensor::IsOccluded(const FootprintBVH &occluders, Object *obj) const
+{
+    FootprintBVH::Footprint fp;
+    FootprintBVH::GetFootprint(obj, fp);
+
+    // Approximate the view of the object by rays to its center and the four corners of its footprint.
+    // The object is regarded visible if any of them is free from other objects.
+    static const double corners[5][2] = {{0.0, 0.0}, {1.0, 1.0}, {1.0, -1.0}, {-1.0, 1.0}, {-1.0, -1.0}};
+    for (int i = 0; i < 5; i++)
+    {
+        // pull corners slightly inwards, not to graze neighboring objects side by side
+        double lx = 0.99 * corners[i][0] * fp.half_length;
+        double ly = 0.99 * corners[i][1] * fp.half_width;
+        double x  = fp.x + lx * fp.cos_h - ly * fp.sin_h;
+        double y  = fp.y + lx * fp.sin_h + ly * fp.cos_h;
+        if (!occluders.IsBlocked(pos_.x_global, pos_.y_global, x, y, host_, obj))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ObjectSensor::Update(const FootprintBVH *occluders)
 {
     nObj_ = 0;
 
-    for (size_t i = 0; i < entities_->object_.size(); i++)
+    // Transforms of the sensor, shared by all objects
+    double host_h     = host_->pos_.GetH();
+    double host_cos_h = cos(host_h);
+    double host_sin_h = sin(host_h);
+    pos_.x_global     = host_->pos_.GetX() + (pos_.x * host_cos_h - pos_.y * host_sin_h);
+    pos_.y_global     = host_->pos_.GetY() + (pos_.x * host_sin_h + pos_.y * host_cos_h);
+    pos_.z_global     = host_->pos_.GetZ() + pos_.z;
+
+    double sensor_h    = GetAngleSum(host_h, pos_.h);
+    double local_cos_h = cos(-sensor_h);  // rotation from global into sensor local coordinates
+    double local_sin_h = sin(-sensor_h);
+    double host_vel_x  = host_->pos_.GetVelX();
+    double host_vel_y  = host_->pos_.GetVelY();
+    double host_acc_x  = host_->pos_.GetAccX();
+    double host_acc_y  = host_->pos_.GetAccY();
+    double host_h_rate = host_->pos_.GetHRate();
+    double host_h_acc  = host_->pos_.GetHAcc();
+
+    // Only consider objects within range
+    entities_->GetObjectsInRadius(pos_.x_global, pos_.y_global, far_, candidates_, candidate_scratch_);
+
+    for (size_t i = 0; i < candidates_.size() && nObj_ < maxObj_; i++)
     {
-        Object *obj = entities_->object_[i];
+        Object *obj = candidates_[i];
         if (obj == host_ || obj->IsGhost())
         {
             // skip own vehicle and any ghost vehicles
@@ -76,21 +345,7 @@ void ObjectSensor::Update()
             continue;
         }
 
-        // Check whether object is within field of view
-
-        // find out angle between heading vector and line to object
-        double hx = 1.0;
-        double hy = 0.0;
-        double hx2, hy2;
-        RotateVec2D(hx, hy, host_->pos_.GetH(), hx2, hy2);
-
-        double sensor_pos_x, sensor_pos_y;
-        RotateVec2D(pos_.x, pos_.y, host_->pos_.GetH(), sensor_pos_x, sensor_pos_y);
-        pos_.x_global = host_->pos_.GetX() + sensor_pos_x;
-        pos_.y_global = host_->pos_.GetY() + sensor_pos_y;
-        pos_.z_global = host_->pos_.GetZ() + pos_.z;
-
-        // Find vector from host to object
+        // Find vector from sensor to object
         double xo = obj->pos_.GetX() - pos_.x_global;
         double yo = obj->pos_.GetY() - pos_.y_global;
 
@@ -102,59 +357,64 @@ void ObjectSensor::Update()
             continue;
         }
 
-        double xon, yon;
-        NormalizeVec2D(xo, yo, xon, yon);
+        // Check whether object is within field of view, by the cosine of the angle between heading vector and line to object
+        double dot    = host_cos_h * xo + host_sin_h * yo;
+        bool   in_fov = false;
+        for (int j = 0; j < nFovCos_ && !in_fov; j++)
+        {
+            in_fov = DotAbove(dot, dist_sq, fovCos_[j][0]) && DotAbove(-dot, dist_sq, -fovCos_[j][1]);
+        }
+
+        if (in_fov && occlusion_ && occluders != nullptr && IsOccluded(*occluders, obj))
+        {
+            // Hidden behind other objects
+            in_fov = false;
+        }
 
-        // Find angle to object
-        double angle     = acos(GetDotProduct2D(hx2, hy2, xon, yon));
-        double rel_angle = GetAbsAngleDifference(angle, pos_.h);
-        if (rel_angle < fovH_ / 2)
+        if (in_fov)
         {
-            hitList_[nObj_].obj_ = obj;
+            ObjectHit &hit = hitList_[nObj_];
+            hit.obj_       = obj;
 
             // Calculate hit object position in sensor local coordinates
-            double xl, yl;
-            RotateVec2D(xo, yo, -GetAngleSum(host_->pos_.GetH(), pos_.h), xl, yl);
-
-            hitList_[nObj_].x_ = xl;
-            hitList_[nObj_].y_ = yl;
-            hitList_[nObj_].z_ = obj->pos_.GetZ() - pos_.z_global + 0.7;
+            hit.x_ = xo * local_cos_h - yo * local_sin_h;
+            hit.y_ = xo * local_sin_h + yo * local_cos_h;
+            hit.z_ = obj->pos_.GetZ() - pos_.z_global + 0.7;
 
             // Calculate hit object velocity in sensor local coordinates
-            double xVelTarget = obj->pos_.GetVelX();
-            double yVelTarget = obj->pos_.GetVelY();
-            double xVelHost   = host_->pos_.GetVelX();
-            double yVelHost   = host_->pos_.GetVelY();
-            double angleHost  = -GetAngleSum(host_->pos_.GetH(), pos_.h);
-            double targetVelXforHost, targetVelYforHost;
-            Global2LocalCoordinates(xVelTarget, yVelTarget, xVelHost, yVelHost, angleHost, targetVelXforHost, targetVelYforHost);
-            hitList_[nObj_].velX_ = targetVelXforHost;
-            hitList_[nObj_].velY_ = targetVelYforHost;
+            double vel_x = obj->pos_.GetVelX() - host_vel_x;
+            double vel_y = obj->pos_.GetVelY() - host_vel_y;
+            hit.velX_    = vel_x * local_cos_h - vel_y * local_sin_h;
+            hit.velY_    = vel_x * local_sin_h + vel_y * local_cos_h;
 
             // Calculate hit object acceleration in sensor local coordinates
-            double xAccTarget = obj->pos_.GetAccX();
-            double yAccTarget = obj->pos_.GetAccY();
-            double xAccHost   = host_->pos_.GetAccX();
-            double yAccHost   = host_->pos_.GetAccY();
-            double targetAccXforHost, targetAccYforHost;
-            Global2LocalCoordinates(xAccTarget, yAccTarget, xAccHost, yAccHost, angleHost, targetAccXforHost, targetAccYforHost);
-            hitList_[nObj_].accX_ = targetAccXforHost;
-            hitList_[nObj_].accY_ = targetAccYforHost;
+            double acc_x = obj->pos_.GetAccX() - host_acc_x;
+            double acc_y = obj->pos_.GetAccY() - host_acc_y;
+            hit.accX_    = acc_x * local_cos_h - acc_y * local_sin_h;
+            hit.accY_    = acc_x * local_sin_h + acc_y * local_cos_h;
 
             // Calculate hit object yaw, yaw rate and yaw acceleration in sensor local coordinates
-            double yawTarget     = obj->pos_.GetH();
-            double yawHost       = GetAngleSum(host_->pos_.GetH(), pos_.h);
-            hitList_[nObj_].yaw_ = GetAngleDifference(yawTarget, yawHost);
-
-            double yawRateTarget     = obj->pos_.GetHRate();
-            double yawRateHost       = host_->pos_.GetHRate();
-            hitList_[nObj_].yawRate_ = GetAngleDifference(yawRateTarget, yawRateHost);
-
-            double yawAccTarget     = obj->pos_.GetHAcc();
-            double yawAccHost       = host_->pos_.GetHAcc();
-            hitList_[nObj_].yawAcc_ = GetAngleDifference(yawAccTarget, yawAccHost);
+            hit.yaw_     = GetAngleDifference(obj->pos_.GetH(), sensor_h);
+            hit.yawRate_ = GetAngleDifference(obj->pos_.GetHRate(), host_h_rate);
+            hit.yawAcc_  = GetAngleDifference(obj->pos_.GetHAcc(), host_h_acc);
 
             nObj_++;
         }
     }
-}
\ No newline at end of file
+}
+
+void ObjectSensorManager::Update(Entities &entities, std::vector<ObjectSensor *> &sensors)
+{
+    const FootprintBVH *occluders = nullptr;
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        if (sensors[i]->occlusion_)
+        {
+            occluders_.Build(entities.object_);
+            occluders = &occluders_;
+            break;
+        }
+    }
+
+    pool_.Run(sensors.size(), [&sensors, occluders](size_t i) { sensors[i]->Update(occluders); });
+}
@@ -50,6 +50,78 @@ namespace scenarioengine
         };
     };
 
+    /**
+    Two dimensional bounding volume hierarchy of entity footprints, i.e. the oriented bounding boxes projected onto the
+    ground plane. Rebuilt once per frame and used for line of sight checks of object sensors.
+    Nodes and footprints are stored in arrays linked by index, kept between builds to avoid reallocation.
+    */
+    class FootprintBVH
+    {
+    public:
+        struct Footprint
+        {
+            Object *obj;
+            double  x;  // center of bounding box, global coordinates
+            double  y;
+            double  cos_h;
+            double  sin_h;
+            double  half_length;
+            double  half_width;
+            double  min_x;  // axis aligned box enclosing the footprint
+            double  min_y;
+            double  max_x;
+            double  max_y;
+        };
+
+        /**
+        Build the hierarchy from current position and bounding box of given objects
+        Ghosts and objects not visible for sensors are left out, since they do not block the view
+        @param objects Objects to include
+        */
+        void Build(const std::vector<Object *> &objects);
+
+        /**
+        Check whether the line segment between two points crosses any footprint
+        @param x0 X coordinate of start point
+        @param y0 Y coordinate of start point
+        @param x1 X coordinate of end point
+        @param y1 Y coordinate of end point
+        @param ignore0 Object to ignore, e.g. the sensor host. Can be nullptr.
+        @param ignore1 Additional object to ignore, e.g. the target. Can be nullptr.
+        @return true if blocked by any footprint, else false
+        */
+        bool IsBlocked(double x0, double y0, double x1, double y1, const Object *ignore0, const Object *ignore1) const;
+
+        const std::vector<Footprint> &GetFootprints() const
+        {
+            return footprints_;
+        }
+
+        /**
+        Calculate footprint of an object from its current position and bounding box
+        @param obj Object
+        @param fp Resulting footprint
+        */
+        static void GetFootprint(Object *obj, Footprint &fp);
+
+    private:
+        struct Node
+        {
+            double min_x;
+            double min_y;
+            double max_x;
+            double max_y;
+            idx_t  first;     // first footprint of leaf
+            idx_t  count;     // number of footprints of leaf, 0 for inner nodes
+            idx_t  child[2];  // children of inner nodes
+        };
+
+        std::vector<Footprint> footprints_;  // in leaf order after build
+        std::vector<Node>      nodes_;       // root at index 0
+
+        idx_t Build(idx_t first, idx_t count);
+    };
+
     class ObjectSensor : public BaseSensor
     {
     public:
@@ -77,9 +149,10 @@ namespace scenarioengine
         double     fovH_;     // Horizontal field of view, in degrees
         double     fovV_;     // Vertical field of view, in degrees
         int        maxObj_;   // Maximum length of object list
-        ObjectHit *hitList_;  // List of identified objects
-        Object    *host_;     // Entity to which the sensor is attached
-        int        nObj_;     // Size of object list, i.e. number of identified objects
+        ObjectHit *hitList_;    // List of identified objects
+        Object    *host_;       // Entity to which the sensor is attached
+        int        nObj_;       // Size of object list, i.e. number of identified objects
+        bool       occlusion_;  // Skip objects hidden behind other objects, see ObjectSensorManager
 
         ObjectSensor(Entities *entities,
                      Object   *refobj,
@@ -92,10 +165,69 @@ namespace scenarioengine
                      double    fovH,
                      int       maxObj);
         ~ObjectSensor();
-        void Update();
+
+        void Update()
+        {
+            Update(nullptr);
+        }
+
+        /**
+        Update list of identified objects
+        @param occluders Footprints of all entities, for occlusion check. Only used if occlusion_ is set.
+        */
+        void Update(const FootprintBVH *occluders);
+
+        /**
+        Check whether an object is hidden from the sensor by other objects
+        @param occluders Footprints of all entities
+        @param obj Object to check
+        @return true if no line of sight to the object, else false
+        */
+        bool IsOccluded(const FootprintBVH &occluders, Object *obj) const;
+
+    private:
+        Entities             *entities_;           // Reference to the global collection of objects within the scenario
+        std::vector<Object *> candidates_;         // Objects within range, reused between updates
+        std::vector<size_t>   candidate_scratch_;  // Working memory for the neighbor query
+
+        // Field of view expressed as intervals of the cosine of the angle between host heading and direction to object.
+        // Checked by dot products, since the angle itself is not needed. Up to two intervals, when view wraps around.
+        double fovCos_[2][2];  // (min, max) per interval, open bounds
+        int    nFovCos_;
+    };
+
+    /**
+    Updates all object sensors in one pass. Sensors only read entity state and write their own hit list, hence
+    they are independent and can optionally be updated in parallel. Result does not depend on number of threads.
+    For sensors with occlusion enabled, entity footprints are collected into a shared hierarchy once per update.
+    */
+    class ObjectSensorManager
+    {
+    public:
+        /**
+        Set number of threads for the sensor updates, including the calling one. 0 or 1 means serial update.
+        */
+        void SetNumberOfThreads(unsigned int n_threads)
+        {
+            pool_.SetNumberOfThreads(n_threads);
+        }
+
+        /**
+        Update given sensors. The neighbor index of the entities should reflect the current state, see
+        Entities::UpdateNeighborIndex(), else each sensor falls back to checking all entities.
+        @param entities Entities observed by the sensors
+        @param sensors Sensors to update
+        */
+        void Update(Entities &entities, std::vector<ObjectSensor *> &sensors);
+
+        const FootprintBVH &GetOccluders() const
+        {
+            return occluders_;
+        }
 
     private:
-        Entities *entities_;  // Reference to the global collection of objects within the scenario
+        SE_WorkerPool pool_;
+        FootprintBVH  occluders_;
     };
 
 }  // namespace scenarioengine
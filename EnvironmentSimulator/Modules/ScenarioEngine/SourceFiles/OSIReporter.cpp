@@ -17,6 +17,7 @@
 #include <string>
 #include <utility>
 #include <array>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -29,22 +30,14 @@
 #include <unistd.h> /* Needed for close() */
 #endif
 
-#define OSI_OUT_PORT          48198
-#define OSI_MAX_UDP_DATA_SIZE 8192
-
-// Large OSI messages needs to be split for UDP transmission
-// This struct must be mached on receiver side
-static struct
-{
-    int          counter;
-    unsigned int datasize;
-    char         data[OSI_MAX_UDP_DATA_SIZE];
-} osi_udp_buf;
+#define OSI_OUT_PORT             48198
+#define OSI_SENSOR_VIEW_OUT_PORT 48210  // port of first sensor view, following sensors on subsequent ports
 
 typedef struct
 {
     std::string  ground_truth;
     unsigned int size;
+    unsigned int static_size;  // size of leading static part of ground_truth, if any
 } OSIGroundTruth;
 
 typedef struct
@@ -96,6 +89,7 @@ static OSITrafficCommand   osiTrafficCommand;
 OSIReporter::OSIReporter(ScenarioEngine *scenarioengine)
 {
     udp_client_      = nullptr;
+    shm_writer_      = nullptr;
     scenario_engine_ = scenarioengine;
 
     obj_osi_internal.static_gt  = new osi3::GroundTruth();
@@ -123,6 +117,10 @@ OSIReporter::OSIReporter(ScenarioEngine *scenarioengine)
 
 OSIReporter::~OSIReporter()
 {
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    StopHighRateThread();
+#endif
+
     if (obj_osi_internal.static_gt)
     {
         obj_osi_internal.static_gt->Clear();
@@ -135,6 +133,8 @@ OSIReporter::~OSIReporter()
         delete obj_osi_internal.dynamic_gt;
     }
 
+    delete static_crop_gt_;
+
     if (obj_osi_external.gt)
     {
         obj_osi_external.gt->Clear();
@@ -166,23 +166,175 @@ OSIReporter::~OSIReporter()
     osiRoadLane.size       = 0;
     osiTrafficCommand.size = 0;
 
+    PrintUDPStatistics();
+    PrintDeltaStatistics();
     delete udp_client_;
+    delete shm_writer_;
 
-    if (osi_file.is_open())
-    {
-        osi_file.close();
-    }
+    CloseOSIFile();
 
     SE_Env::Inst().ResetOSITimeStamp();
 }
 
 SE_SOCKET OSIReporter::OpenSocket(std::string ipaddr)
 {
-    udp_client_ = new UDPClient(OSI_OUT_PORT, ipaddr);
+    udp_client_     = new UDPClient(OSI_OUT_PORT, ipaddr);
+    udp_ip_address_ = ipaddr;
+    udp_client_->SetRateLimit(udp_rate_limit_ * 1e6 / 8);
 
     return udp_client_->GetStatus();
 }
 
+int OSIReporter::SetUDPFragmentSize(unsigned int size)
+{
+    if (size < 1 || size > OSI_UDP_MAX_FRAGMENT_SIZE)
+    {
+        LOG_ERROR("OSI UDP package size {} out of range [1, {}]", size, OSI_UDP_MAX_FRAGMENT_SIZE);
+        return -1;
+    }
+
+    udp_fragment_size_ = size;
+
+    return 0;
+}
+
+void OSIReporter::SetUDPRateLimit(double mbit_per_second)
+{
+    udp_rate_limit_ = MAX(0.0, mbit_per_second);
+
+    if (udp_client_ != nullptr)
+    {
+        udp_client_->SetRateLimit(udp_rate_limit_ * 1e6 / 8);
+    }
+}
+
+void OSIReporter::PrintUDPStatistics() const
+{
+    if (udp_client_ == nullptr || udp_frame_id_ == 0)
+    {
+        return;
+    }
+
+    const UDPClient::Statistics& stats = udp_client_->GetStatistics();
+
+    LOG_INFO("OSI UDP: {} frames ({} incomplete), {} packages ({} failed) in {} send calls, {:.2f} MB",
+             udp_frame_id_,
+             udp_frames_failed_,
+             stats.n_datagrams,
+             stats.n_failed,
+             stats.n_calls,
+             static_cast<double>(stats.n_bytes) / 1e6);
+
+    if (stats.send_time > SMALL_NUMBER)
+    {
+        LOG_INFO("OSI UDP: send time avg {:.3f} ms per frame, throughput {:.1f} Mbit/s",
+                 1e3 * stats.send_time / udp_frame_id_,
+                 8e-6 * static_cast<double>(stats.n_bytes) / stats.send_time);
+    }
+}
+
+void OSIReporter::SendOSIUDP()
+{
+    if (osiGroundTruth.size == 0)
+    {
+        return;
+    }
+
+    udp_frame_id_++;
+    if (!SendOSIUDPMessage(udp_client_, osiGroundTruth.ground_truth.data(), osiGroundTruth.size, udp_frame_id_))
+    {
+        udp_frames_failed_++;
+    }
+}
+
+bool OSIReporter::SendOSIUDPMessage(UDPClient *client, const char *data, unsigned int size, unsigned int frame_id)
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    std::lock_guard<std::mutex> lock(udp_mutex_);
+#endif
+
+    // split large OSI messages in multiple packages, all sent in one go referring directly to the serialized data
+    unsigned int n = (size + udp_fragment_size_ - 1) / udp_fragment_size_;
+    udp_headers_.resize(n);
+    udp_datagrams_.resize(n);
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        unsigned int offset = i * udp_fragment_size_;
+
+        // Last package indicated by negative counter number
+        udp_headers_[i].counter  = i < n - 1 ? static_cast<int>(i + 1) : -static_cast<int>(i + 1);
+        udp_headers_[i].datasize = MIN(size - offset, udp_fragment_size_);
+        udp_headers_[i].frame_id = frame_id;
+
+        udp_datagrams_[i].header      = reinterpret_cast<const char *>(&udp_headers_[i]);
+        udp_datagrams_[i].header_size = sizeof(OSIUDPHeader);
+        udp_datagrams_[i].data        = &data[offset];
+        udp_datagrams_[i].data_size   = udp_headers_[i].datasize;
+    }
+
+    if (client->SendMultiple(udp_datagrams_.data(), n) != static_cast<int>(n))
+    {
+        LOG_ERROR("Failed send osi package over UDP");
+#ifdef _WIN32
+        wprintf(L"send failed with error: %d\n", WSAGetLastError());
+#endif
+        return false;
+    }
+
+    return true;
+}
+
+int OSIReporter::OpenSharedMemory(std::string name)
+{
+    delete shm_writer_;
+    shm_writer_ = new SharedMemoryWriter(name);
+
+    if (shm_writer_->GetStatus() != 0)
+    {
+        LOG_ERROR("Failed to create OSI shared memory {}", name);
+        return -1;
+    }
+
+    LOG_INFO("OSI ground truth published in shared memory {} ({} slots of {} MB)",
+             name,
+             shm_writer_->GetNumberOfSlots(),
+             shm_writer_->GetSlotSize() / (1024 * 1024));
+
+    return 0;
+}
+
+void OSIReporter::WriteOSISharedMemory(bool include_static)
+{
+    if (osiGroundTruth.size > 0 && osi_delta_tolerance_ < -SMALL_NUMBER)
+    {
+        // already serialized for file or UDP, one copy into the slot. Not in delta mode, shared memory gets all objects.
+        if (shm_writer_->Write(osiGroundTruth.ground_truth.data(), osiGroundTruth.size) != 0)
+        {
+            LOG_ERROR("OSI message of size {} does not fit into shared memory slot of size {}", osiGroundTruth.size, shm_writer_->GetSlotSize());
+        }
+        return;
+    }
+
+    // serialize directly into the slot, static part first just like SerializeDynamicAndStaticData()
+    size_t static_size  = include_static ? GetReportedStaticGroundTruth()->ByteSizeLong() : 0;
+    size_t dynamic_size = obj_osi_internal.dynamic_gt->ByteSizeLong();
+    char*  buf          = shm_writer_->BeginWrite(static_size + dynamic_size);
+
+    if (buf == nullptr)
+    {
+        LOG_ERROR("OSI message of size {} does not fit into shared memory slot of size {}", static_size + dynamic_size, shm_writer_->GetSlotSize());
+        return;
+    }
+
+    if (include_static)
+    {
+        GetReportedStaticGroundTruth()->SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t *>(buf));
+    }
+    obj_osi_internal.dynamic_gt->SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t *>(buf + static_size));
+    shm_writer_->EndWrite(static_size + dynamic_size);
+}
+
 void OSIReporter::ReportSensors(std::vector<ObjectSensor *> sensor)
 {
     if (sensor.size() == 0)
@@ -230,35 +382,97 @@ void OSIReporter::ReportSensors(std::vector<ObjectSensor *> sensor)
 
 bool OSIReporter::OpenOSIFile(const char *filename)
 {
-    osi_file.open(filename, std::ios_base::binary);
-    if (!osi_file.good())
+    osi_filename_ = filename;
+
+    if (osi_chunk_frames_ > 0)
+    {
+        if (osi_trace_.Open(filename, osi_chunk_frames_, SE_Env::Inst().GetWriteBufferSize()) != 0)
+        {
+            LOG_ERROR("Failed open OSI tracefile {}", filename);
+            return false;
+        }
+        LOG_INFO("OSI chunked tracefile {} opened ({} frames per chunk)", filename, osi_chunk_frames_);
+        return true;
+    }
+
+    if (osi_file.Open(filename, std::ios_base::binary, SE_Env::Inst().GetWriteBufferSize()) != 0)
     {
         LOG_ERROR("Failed open OSI tracefile {}", filename);
         return false;
     }
+    osi_file.SetDropWhenFull(SE_Env::Inst().GetWriteDropWhenFull());
     LOG_INFO("OSI tracefile {} opened", filename);
     return true;
 }
 
 void OSIReporter::CloseOSIFile()
 {
-    osi_file.close();
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    WaitForHighRateOutput();
+#endif
+
+    osi_file.Close();
+    sensor_view_files_.clear();
+
+    if (osi_trace_.IsOpen())
+    {
+        osi_trace_.Close();
+        LOG_INFO("OSI chunked tracefile: {} frames in {} chunks, {:.2f} MB compressed to {:.2f} MB",
+                 osi_trace_.GetNumberOfFrames(),
+                 osi_trace_.GetNumberOfChunks(),
+                 static_cast<double>(osi_trace_.GetRawSize()) / 1e6,
+                 static_cast<double>(osi_trace_.GetStoredSize()) / 1e6);
+    }
 }
 
 bool OSIReporter::WriteOSIFile()
 {
-    if (!osi_file.good())
+    const osi3::Timestamp &ts = obj_osi_internal.dynamic_gt->timestamp();
+
+    return WriteOSIFileMessage(osiGroundTruth.ground_truth.data(),
+                               osiGroundTruth.size,
+                               osiGroundTruth.static_size,
+                               static_crop_changed_,
+                               static_cast<unsigned long long>(ts.seconds()) * 1000000000ULL + static_cast<unsigned long long>(ts.nanos()),
+                               osi_frame_);
+}
+
+bool OSIReporter::WriteOSIFileMessage(const char        *data,
+                                      unsigned int       size,
+                                      unsigned int       static_size,
+                                      bool               static_changed,
+                                      unsigned long long timestamp,
+                                      std::string       &frame)
+{
+    if (osi_trace_.IsOpen())
+    {
+        // static part stored once, separately from the frames. Except updates of cropped static data, kept in their frame.
+        if (static_size > 0 && osi_trace_.SetStatic(data, static_size) != 0 && static_changed)
+        {
+            static_size = 0;
+        }
+
+        if (osi_trace_.AddFrame(timestamp, data + static_size, size - static_size) != 0)
+        {
+            LOG_ERROR("Failed write osi file");
+            return false;
+        }
+        return true;
+    }
+
+    if (!osi_file.IsOpen() || !osi_file.Good())
     {
         return false;
     }
 
-    // write to file, first size of message
-    osi_file.write(reinterpret_cast<char *>(&osiGroundTruth.size), sizeof(osiGroundTruth.size));
+    // compose frame, first size of message then actual message - the groundtruth object including timestamp and moving objects
+    frame.assign(reinterpret_cast<char *>(&size), sizeof(size));
+    frame.append(data, size);
 
-    // write to file, actual message - the groundtruth object including timestamp and moving objects
-    osi_file.write(osiGroundTruth.ground_truth.c_str(), osiGroundTruth.size);
+    // hand over complete frame to the file writer
+    osi_file.Write(frame);
 
-    if (!osi_file.good())
+    if (!osi_file.Good())
     {
         LOG_ERROR("Failed write osi file");
         return false;
@@ -268,9 +482,18 @@ bool OSIReporter::WriteOSIFile()
 
 void OSIReporter::FlushOSIFile()
 {
-    if (osi_file.good())
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    WaitForHighRateOutput();
+#endif
+
+    if (osi_file.IsOpen())
     {
-        osi_file.flush();
+        osi_file.Flush();
+    }
+
+    if (osi_trace_.IsOpen())
+    {
+        osi_trace_.Flush();
     }
 }
 void OSIReporter::SetOSIStaticReportMode(OSIStaticReportMode mode)
@@ -285,19 +508,21 @@ int OSIReporter::UpdateOSIGroundTruth(const std::vector<std::unique_ptr<ObjectSt
         return 0;
     }
     osiGroundTruth.ground_truth.clear();
-    osiGroundTruth.size = 0;
+    osiGroundTruth.size        = 0;
+    osiGroundTruth.static_size = 0;
+    bool include_static        = false;
+    dynamic_generation_++;
     if (!osi_initialized_)
     {
         UpdateOSIStaticGroundTruth(objectState);
         UpdateOSIDynamicGroundTruth(objectState);
+        UpdateOSIStaticCrop(objectState);
+        include_static = true;
+        static_generation_++;
 
-        if (IsFileOpen() || GetUDPClientStatus() == 0)
-        {
-            SerializeDynamicAndStaticData();
-        }
         // Merge for API
         obj_osi_external.gt->CopyFrom(*obj_osi_internal.dynamic_gt);
-        obj_osi_external.gt->MergeFrom(*obj_osi_internal.static_gt);
+        obj_osi_external.gt->MergeFrom(*GetReportedStaticGroundTruth());
 
         counter_offset_  = GetCounter();
         osi_initialized_ = true;
@@ -308,189 +533,677 @@ int OSIReporter::UpdateOSIGroundTruth(const std::vector<std::unique_ptr<ObjectSt
         UpdateOSIDynamicGroundTruth(objectState);
         obj_osi_external.gt->CopyFrom(*obj_osi_internal.dynamic_gt);
 
+        // Lanes entered or left the static crop radius, report the new set of lanes
+        include_static = UpdateOSIStaticCrop(objectState);
+        if (include_static)
+        {
+            static_generation_++;
+        }
+
         switch (static_update_mode_)
         {
             case OSIStaticReportMode::DEFAULT:  // Only log and transmit dynamic ground truth
-                if (IsFileOpen() || GetUDPClientStatus() == 0)
-                {
-                    SerializeDynamicData();
-                }
                 break;
             case OSIStaticReportMode::API:  // Log dynamic ground truth, serialize and transmit combined ground truth
-                if (IsFileOpen() || GetUDPClientStatus() == 0)
-                {
-                    SerializeDynamicData();
-                }
-
-                obj_osi_external.gt->MergeFrom(*obj_osi_internal.static_gt);  // Merge for API
+                obj_osi_external.gt->MergeFrom(*GetReportedStaticGroundTruth());  // Merge for API
                 break;
             case OSIStaticReportMode::API_AND_LOG:  // Log combined ground truth, serialze and transmit combined ground truth
-                if (IsFileOpen() || GetUDPClientStatus() == 0)
-                {
-                    SerializeDynamicAndStaticData();
-                }
-
-                obj_osi_external.gt->MergeFrom(*obj_osi_internal.static_gt);  // Merge for API
+                include_static = true;
+                obj_osi_external.gt->MergeFrom(*GetReportedStaticGroundTruth());  // Merge for API
                 break;
         }
     }
 
-    if (IsFileOpen())
+    // file and UDP output of each update, unless output at a rate of its own
+    bool output = high_rate_period_ == 0 && (IsFileOpen() || GetUDPClientStatus() == 0);
+
+    if (output)
+    {
+        if (include_static)
+        {
+            SerializeDynamicAndStaticData();
+        }
+        else
+        {
+            SerializeDynamicData();
+        }
+    }
+
+    if (GetSharedMemoryStatus() == 0)
+    {
+        WriteOSISharedMemory(include_static);
+    }
+
+    if (output && IsFileOpen())
     {
         WriteOSIFile();
     }
 
-    if (GetUDPClientStatus() == 0)
+    if (output && GetUDPClientStatus() == 0)
+    {
+        SendOSIUDP();
+    }
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (high_rate_period_ > 0 && (IsFileOpen() || GetUDPClientStatus() == 0))
     {
-        // send over udp - split large OSI messages in multiple transmissions
-        unsigned int sentDataBytes = 0;
+        QueueHighRateFrame(include_static);
+    }
+#endif
 
-        for (osi_udp_buf.counter = 1; sentDataBytes < osiGroundTruth.size; osi_udp_buf.counter++)
-        {
-            osi_udp_buf.datasize = MIN(osiGroundTruth.size - sentDataBytes, OSI_MAX_UDP_DATA_SIZE);
-            memcpy(osi_udp_buf.data, &osiGroundTruth.ground_truth.c_str()[sentDataBytes], osi_udp_buf.datasize);
-            int packSize = static_cast<int>(sizeof(osi_udp_buf)) - static_cast<int>((OSI_MAX_UDP_DATA_SIZE - osi_udp_buf.datasize));
+    if (sensor_views_enabled_)
+    {
+        UpdateOSISensorViews();
+    }
+
+    SetUpdated(true);
+
+    return 0;
+}
+
+void OSIReporter::SerializeDynamicData()
+{
+    bool delta = SwapInChangedMovingObjects();
+    obj_osi_internal.dynamic_gt->SerializeToString(&osiGroundTruth.ground_truth);
+    osiGroundTruth.size        = static_cast<unsigned int>(osiGroundTruth.ground_truth.size());
+    osiGroundTruth.static_size = 0;
+    if (delta)
+    {
+        obj_osi_internal.dynamic_gt->mutable_moving_object()->Swap(&delta_moving_objects_);
+    }
+}
+
+void OSIReporter::SerializeDynamicAndStaticData()
+{
+    bool delta = SwapInChangedMovingObjects();
+    GetReportedStaticGroundTruth()->SerializeToString(&osiGroundTruth.ground_truth);
+    osiGroundTruth.static_size = static_cast<unsigned int>(osiGroundTruth.ground_truth.size());
+    obj_osi_internal.dynamic_gt->AppendToString(&osiGroundTruth.ground_truth);
+    osiGroundTruth.size = static_cast<unsigned int>(osiGroundTruth.ground_truth.size());
+    if (delta)
+    {
+        obj_osi_internal.dynamic_gt->mutable_moving_object()->Swap(&delta_moving_objects_);
+    }
+}
 
-            if (sentDataBytes + osi_udp_buf.datasize >= osiGroundTruth.size)
+int OSIReporter::UpdateOSIStaticGroundTruth(const std::vector<std::unique_ptr<ObjectState>> &objectState)
+{
+    // First pick objects from the OpenDRIVE description
+    static roadmanager::OpenDrive *opendrive = roadmanager::Position::GetOpenDrive();
+    odr_objects_.clear();
+    for (unsigned i = 0; i < opendrive->GetNumOfRoads(); i++)
+    {
+        roadmanager::Road *road = opendrive->GetRoadByIdx(i);
+        if (road)
+        {
+            for (unsigned int j = 0; j < road->GetNumberOfObjects(); j++)
             {
-                // Last package indicated by negative counter number
-                osi_udp_buf.counter = -osi_udp_buf.counter;
+                roadmanager::RMObject *object = road->GetRoadObject(j);
+                if (object)
+                {
+                    odr_objects_.push_back(object);
+                }
             }
+        }
+    }
+
+    // Evaluate positions and outlines of the objects in parallel, then add them to the message in order
+    odr_object_data_.resize(odr_objects_.size());
+    object_pool_.Run(odr_objects_.size(), [this](size_t i) { GetStationaryObjectODRData(odr_objects_[i], odr_object_data_[i]); });
+
+    obj_osi_internal.static_gt->mutable_stationary_object()->Reserve(static_cast<int>(odr_objects_.size() + objectState.size()));
+    for (size_t i = 0; i < odr_objects_.size(); i++)
+    {
+        UpdateOSIStationaryObjectODR(odr_objects_[i], &odr_object_data_[i]);
+    }
+    odr_objects_.clear();
+    odr_object_data_.clear();
 
-            int sendResult = udp_client_->Send(reinterpret_cast<char *>(&osi_udp_buf), static_cast<unsigned int>(packSize));  // TODO: @Emil
+    // Then pick objects from the OpenSCENARIO description
+    for (size_t i = 0; i < objectState.size(); i++)
+    {
+        if (objectState[i]->state_.info.obj_type == static_cast<int>(Object::Type::VEHICLE) ||
+            objectState[i]->state_.info.obj_type == static_cast<int>(Object::Type::PEDESTRIAN))
+        {
+            // do nothing
+        }
+        else if (objectState[i]->state_.info.obj_type == static_cast<int>(Object::Type::MISC_OBJECT))
+        {
+            UpdateOSIStationaryObject(objectState[i].get());
+        }
+        else
+        {
+            LOG_WARN("Warning: Object type {} is not supported in OSIReporter, and hence no OSI update for this object",
+                     objectState[i]->state_.info.obj_type);
+        }
+    }
 
-            if (sendResult != packSize)
+    UpdateOSIRoadLane();
+    UpdateOSILaneBoundary();
+    UpdateOSIIntersection();
+    UpdateTrafficSignals();
+
+    // Set the original geo reference string as is
+    std::string proj_string_delimiter = "";
+    if (!opendrive->GetGeoReferenceOriginalString().empty() && !opendrive->GetGeoOffsetOriginalString().empty())
+    {
+        proj_string_delimiter = ";";
+    }
+    obj_osi_internal.static_gt->set_proj_string(
+        (opendrive->GetGeoReferenceOriginalString() + proj_string_delimiter + opendrive->GetGeoOffsetOriginalString()).c_str());
+    obj_osi_internal.static_gt->set_map_reference(opendrive->GetGeoReferenceAsString());
+    obj_osi_internal.static_gt->set_model_reference(stationary_model_reference);
+
+    return 0;
+}
+
+void OSIReporter::CropOSIDynamicGroundTruth(const int id, const double radius)
+{
+    if (osi_crop_.empty() && radius > SMALL_NUMBER)
+    {
+        osi_crop_.emplace_back(std::make_pair(id, radius));
+    }
+    else
+    {
+        for (size_t i = 0; i < osi_crop_.size(); i++)
+        {
+            if (osi_crop_[i].first == id)
             {
-                LOG_ERROR("Failed send osi package over UDP");
-#ifdef _WIN32
-                wprintf(L"send failed with error: %d\n", WSAGetLastError());
-#endif
-                // Give up
-                sentDataBytes = osiGroundTruth.size;
+                if (radius > SMALL_NUMBER)
+                {
+                    osi_crop_[i].second = radius;
+                }
+                else
+                {
+                    osi_crop_.erase(osi_crop_.begin() + static_cast<int>(i));
+                    LOG_INFO("CropGroundTruth: Removed crop for entity id {}", id);
+                }
+                return;
+            }
+        }
+        if (radius > SMALL_NUMBER)
+        {
+            osi_crop_.emplace_back(std::make_pair(id, radius));
+        }
+    }
+    LOG_INFO("CropGroundTruth: Added crop for entity id {} with radius {}", id, radius);
+}
+
+void OSIReporter::CropOSIStaticGroundTruth(const int id, const double radius)
+{
+    for (size_t i = 0; i < osi_static_crop_.size(); i++)
+    {
+        if (osi_static_crop_[i].first == id)
+        {
+            if (radius > SMALL_NUMBER)
+            {
+                osi_static_crop_[i].second = radius;
+                LOG_INFO("CropStaticGroundTruth: Changed crop for entity id {} to radius {}", id, radius);
             }
             else
             {
-                sentDataBytes += osi_udp_buf.datasize;
+                osi_static_crop_.erase(osi_static_crop_.begin() + static_cast<int>(i));
+                LOG_INFO("CropStaticGroundTruth: Removed crop for entity id {}", id);
             }
+            return;
         }
     }
 
-    SetUpdated(true);
+    if (radius > SMALL_NUMBER)
+    {
+        osi_static_crop_.emplace_back(std::make_pair(id, radius));
+        LOG_INFO("CropStaticGroundTruth: Added crop for entity id {} with radius {}", id, radius);
+    }
+}
 
-    return 0;
+osi3::GroundTruth *OSIReporter::GetReportedStaticGroundTruth() const
+{
+    return static_crop_gt_ != nullptr ? static_crop_gt_ : obj_osi_internal.static_gt;
 }
 
-void OSIReporter::SerializeDynamicData()
+static void GetLaneBoundaryPoints(const osi3::LaneBoundary &boundary, std::vector<double> &xy)
 {
-    obj_osi_internal.dynamic_gt->SerializeToString(&osiGroundTruth.ground_truth);
-    osiGroundTruth.size = static_cast<unsigned int>(osiGroundTruth.ground_truth.size());
+    xy.clear();
+    for (const auto &point : boundary.boundary_line())
+    {
+        xy.push_back(point.position().x());
+        xy.push_back(point.position().y());
+    }
+}
+
+void OSIReporter::BuildStaticCropIndex()
+{
+    const osi3::GroundTruth *gt = obj_osi_internal.static_gt;
+    std::vector<double>      xy;
+
+    if (static_crop_index_built_)
+    {
+        return;  // static ground truth does not change
+    }
+    static_crop_index_built_ = true;
+
+    static_crop_index_.Clear();
+    static_crop_boundary_idx_.clear();
+
+    for (int i = 0; i < gt->lane_boundary_size(); i++)
+    {
+        static_crop_boundary_idx_[static_cast<id_t>(gt->lane_boundary(i).id().value())] = i;
+    }
+
+    for (int i = 0; i < gt->lane_size(); i++)
+    {
+        const osi3::Lane_Classification &classification = gt->lane(i).classification();
+
+        xy.clear();
+        for (const auto &point : classification.centerline())
+        {
+            xy.push_back(point.x());
+            xy.push_back(point.y());
+        }
+
+        if (!xy.empty())
+        {
+            static_crop_index_.Add(i, xy);
+        }
+        else
+        {
+            // no center line, e.g. intersection lanes, locate by the free lane boundaries instead
+            for (const auto &boundary_id : classification.free_lane_boundary_id())
+            {
+                auto itr = static_crop_boundary_idx_.find(static_cast<id_t>(boundary_id.value()));
+                if (itr != static_crop_boundary_idx_.end())
+                {
+                    GetLaneBoundaryPoints(gt->lane_boundary(itr->second), xy);
+                    static_crop_index_.Add(i, xy);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < gt->lane_boundary_size(); i++)
+    {
+        GetLaneBoundaryPoints(gt->lane_boundary(i), xy);
+        static_crop_index_.Add(gt->lane_size() + i, xy);
+    }
+}
+
+template <class T>
+static void RemoveOSIElementsById(google::protobuf::RepeatedPtrField<T> *elements, std::vector<id_t> ids)
+{
+    // keep order of remaining elements
+    int n = 0;
+
+    std::sort(ids.begin(), ids.end());
+    for (int i = 0; i < elements->size(); i++)
+    {
+        if (std::binary_search(ids.begin(), ids.end(), static_cast<id_t>(elements->Get(i).id().value())))
+        {
+            continue;
+        }
+
+        if (i != n)
+        {
+            elements->SwapElements(i, n);
+        }
+        n++;
+    }
+
+    while (elements->size() > n)
+    {
+        elements->RemoveLast();
+    }
+}
+
+static void CompareSortedIndices(const std::vector<int> &current, const std::vector<int> &previous, std::vector<int> &entered, std::vector<int> &left)
+{
+    entered.clear();
+    left.clear();
+    std::set_difference(current.begin(), current.end(), previous.begin(), previous.end(), std::back_inserter(entered));
+    std::set_difference(previous.begin(), previous.end(), current.begin(), current.end(), std::back_inserter(left));
+}
+
+// Split items found in the static crop index into lanes and lane boundaries, adding all boundaries of the lanes
+void OSIReporter::GetOSILanesAndBoundaries(const std::vector<int> &found, std::vector<int> &lanes, std::vector<int> &boundaries) const
+{
+    const osi3::GroundTruth *gt = obj_osi_internal.static_gt;
+
+    for (int item : found)
+    {
+        if (item < gt->lane_size())
+        {
+            lanes.push_back(item);
+        }
+        else
+        {
+            boundaries.push_back(item - gt->lane_size());
+        }
+    }
+
+    // include all boundaries of the lanes, so that lanes are complete
+    for (int lane : lanes)
+    {
+        const osi3::Lane_Classification &classification = gt->lane(lane).classification();
+        for (const auto *boundary_ids :
+             {&classification.left_lane_boundary_id(), &classification.right_lane_boundary_id(), &classification.free_lane_boundary_id()})
+        {
+            for (const auto &boundary_id : *boundary_ids)
+            {
+                auto itr = static_crop_boundary_idx_.find(static_cast<id_t>(boundary_id.value()));
+                if (itr != static_crop_boundary_idx_.end())
+                {
+                    boundaries.push_back(itr->second);
+                }
+            }
+        }
+    }
+
+    std::sort(lanes.begin(), lanes.end());
+    lanes.erase(std::unique(lanes.begin(), lanes.end()), lanes.end());
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+}
+
+bool OSIReporter::UpdateOSIStaticCrop(const std::vector<std::unique_ptr<ObjectState>> &objectState)
+{
+    static_crop_changes_.lanes_entered.clear();
+    static_crop_changes_.lanes_left.clear();
+    static_crop_changes_.lane_boundaries_entered.clear();
+    static_crop_changes_.lane_boundaries_left.clear();
+    static_crop_changed_ = false;
+
+    if (osi_static_crop_.empty())
+    {
+        if (static_crop_gt_ != nullptr)
+        {
+            // cropping removed, back to complete static ground truth
+            delete static_crop_gt_;
+            static_crop_gt_ = nullptr;
+            static_crop_lanes_.clear();
+            static_crop_boundaries_.clear();
+            static_crop_changed_ = true;
+        }
+        return static_crop_changed_;
+    }
+
+    const osi3::GroundTruth *gt = obj_osi_internal.static_gt;
+
+    if (static_crop_gt_ == nullptr)
+    {
+        // copy everything but lanes and lane boundaries, which are added as they come within radius
+        google::protobuf::RepeatedPtrField<osi3::Lane>         lanes;
+        google::protobuf::RepeatedPtrField<osi3::LaneBoundary> boundaries;
+
+        lanes.Swap(obj_osi_internal.static_gt->mutable_lane());
+        boundaries.Swap(obj_osi_internal.static_gt->mutable_lane_boundary());
+        static_crop_gt_ = new osi3::GroundTruth(*obj_osi_internal.static_gt);
+        lanes.Swap(obj_osi_internal.static_gt->mutable_lane());
+        boundaries.Swap(obj_osi_internal.static_gt->mutable_lane_boundary());
+
+        BuildStaticCropIndex();
+        static_crop_changed_ = true;
+    }
+
+    // Find lanes and lane boundaries within radius of any of the crop objects
+    std::vector<int> found;
+    for (const auto &crop : osi_static_crop_)
+    {
+        std::vector<std::unique_ptr<ObjectState>>::const_iterator itr =
+            std::find_if(objectState.begin(),
+                         objectState.end(),
+                         [crop](const std::unique_ptr<ObjectState> &obj) { return obj->state_.info.id == crop.first; });
+        if (itr != objectState.end())
+        {
+            static_crop_index_.Find((*itr)->state_.pos.GetX(), (*itr)->state_.pos.GetY(), crop.second, found);
+        }
+    }
+
+    std::vector<int> lanes;
+    std::vector<int> boundaries;
+    GetOSILanesAndBoundaries(found, lanes, boundaries);
+
+    if (lanes == static_crop_lanes_ && boundaries == static_crop_boundaries_)
+    {
+        return static_crop_changed_;
+    }
+
+    // Apply the changes to the cropped ground truth, keeping the lanes and boundaries that stay within radius
+    std::vector<int> entered;
+    std::vector<int> left;
+
+    CompareSortedIndices(lanes, static_crop_lanes_, entered, left);
+    for (int i : left)
+    {
+        static_crop_changes_.lanes_left.push_back(static_cast<id_t>(gt->lane(i).id().value()));
+    }
+    RemoveOSIElementsById(static_crop_gt_->mutable_lane(), static_crop_changes_.lanes_left);
+    for (int i : entered)
+    {
+        *static_crop_gt_->add_lane() = gt->lane(i);
+        static_crop_changes_.lanes_entered.push_back(static_cast<id_t>(gt->lane(i).id().value()));
+    }
+
+    CompareSortedIndices(boundaries, static_crop_boundaries_, entered, left);
+    for (int i : left)
+    {
+        static_crop_changes_.lane_boundaries_left.push_back(static_cast<id_t>(gt->lane_boundary(i).id().value()));
+    }
+    RemoveOSIElementsById(static_crop_gt_->mutable_lane_boundary(), static_crop_changes_.lane_boundaries_left);
+    for (int i : entered)
+    {
+        *static_crop_gt_->add_lane_boundary() = gt->lane_boundary(i);
+        static_crop_changes_.lane_boundaries_entered.push_back(static_cast<id_t>(gt->lane_boundary(i).id().value()));
+    }
+
+    static_crop_lanes_      = lanes;
+    static_crop_boundaries_ = boundaries;
+    static_crop_changed_    = true;
+
+    return true;
+}
+
+void OSIReporter::SetOSISensorViews(bool enable, unsigned int n_threads)
+{
+    sensor_views_enabled_ = enable;
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    if (n_threads == 0)
+    {
+        n_threads = MAX(1, std::thread::hardware_concurrency());
+    }
+#endif
+    sensor_view_pool_.SetNumberOfThreads(n_threads);
+}
+
+void OSIReporter::UpdateOSISensorViews()
+{
+    if (sensors_ == nullptr || !osi_initialized_ || sensor_views_generation_ == dynamic_generation_)
+    {
+        return;
+    }
+    sensor_views_generation_ = dynamic_generation_;
+
+    // Prepare shared data once, then each sensor only reads it while building its own view
+    BuildStaticCropIndex();
+
+    sensor_view_objects_.clear();
+    for (int i = 0; i < obj_osi_internal.dynamic_gt->moving_object_size(); i++)
+    {
+        sensor_view_objects_[static_cast<int>(obj_osi_internal.dynamic_gt->moving_object(i).id().value())] = i;
+    }
+
+    sensor_views_.resize(sensors_->size());
+    sensor_view_buffers_.resize(sensors_->size());
+
+    sensor_view_pool_.Run(sensors_->size(), [this](size_t i) { BuildOSISensorView(i); });
+
+    if (!sensor_views_enabled_)
+    {
+        return;  // built on request via API only
+    }
+
+    if (IsFileOpen())
+    {
+        WriteOSISensorViewFiles();
+    }
+
+    if (GetUDPClientStatus() == 0)
+    {
+        SendOSISensorViewsUDP();
+    }
 }
 
-void OSIReporter::SerializeDynamicAndStaticData()
-{
-    obj_osi_internal.static_gt->SerializeToString(&osiGroundTruth.ground_truth);
-    obj_osi_internal.dynamic_gt->AppendToString(&osiGroundTruth.ground_truth);
-    osiGroundTruth.size = static_cast<unsigned int>(osiGroundTruth.ground_truth.size());
+void OSIReporter::BuildOSISensorView(size_t sensor_id)
+{
+    const ObjectSensor      *sensor     = (*sensors_)[sensor_id];
+    const osi3::GroundTruth *static_gt  = obj_osi_internal.static_gt;
+    const osi3::GroundTruth *dynamic_gt = obj_osi_internal.dynamic_gt;
+    osi3::SensorView        &sv         = sensor_views_[sensor_id];
+
+    sv.Clear();  // keeps allocated memory for next frame
+    osi3::GroundTruth *gt = sv.mutable_global_ground_truth();
+
+    *sv.mutable_version()   = static_gt->version();
+    *sv.mutable_timestamp() = dynamic_gt->timestamp();
+    sv.mutable_sensor_id()->set_value(sensor_id);
+    sv.mutable_host_vehicle_id()->set_value(static_cast<unsigned int>(sensor->host_->id_));
+    sv.mutable_mounting_position()->mutable_position()->set_x(sensor->pos_.x);
+    sv.mutable_mounting_position()->mutable_position()->set_y(sensor->pos_.y);
+    sv.mutable_mounting_position()->mutable_position()->set_z(sensor->pos_.z);
+    sv.mutable_mounting_position()->mutable_orientation()->set_yaw(sensor->pos_.h);
+
+    *gt->mutable_version()   = static_gt->version();
+    *gt->mutable_timestamp() = dynamic_gt->timestamp();
+    gt->mutable_host_vehicle_id()->set_value(static_cast<unsigned int>(sensor->host_->id_));
+
+    // host followed by the objects detected by the sensor
+    for (int i = -1; i < sensor->nObj_; i++)
+    {
+        auto itr = sensor_view_objects_.find(i < 0 ? sensor->host_->id_ : sensor->hitList_[i].obj_->id_);
+        if (itr != sensor_view_objects_.end())
+        {
+            *gt->add_moving_object() = dynamic_gt->moving_object(itr->second);
+        }
+    }
+
+    // lanes and lane boundaries within the horizontal field of view
+    std::vector<int> found;
+    std::vector<int> lanes;
+    std::vector<int> boundaries;
+
+    static_crop_index_.FindInSector(sensor->pos_.x_global,
+                                    sensor->pos_.y_global,
+                                    sensor->far_,
+                                    GetAngleSum(sensor->host_->pos_.GetH(), sensor->pos_.h),
+                                    sensor->fovH_,
+                                    found);
+    GetOSILanesAndBoundaries(found, lanes, boundaries);
+
+    for (int i : lanes)
+    {
+        *gt->add_lane() = static_gt->lane(i);
+    }
+    for (int i : boundaries)
+    {
+        *gt->add_lane_boundary() = static_gt->lane_boundary(i);
+    }
+
+    sv.SerializeToString(&sensor_view_buffers_[sensor_id]);
 }
 
-int OSIReporter::UpdateOSIStaticGroundTruth(const std::vector<std::unique_ptr<ObjectState>> &objectState)
+void OSIReporter::WriteOSISensorViewFiles()
 {
-    // First pick objects from the OpenSCENARIO description
-    static roadmanager::OpenDrive *opendrive = roadmanager::Position::GetOpenDrive();
-    for (unsigned i = 0; i < opendrive->GetNumOfRoads(); i++)
+    // one file per sensor, in the plain OSI trace format: size of message followed by the message
+    std::string stem = osi_filename_;
+    size_t      dot  = stem.find_last_of('.');
+    if (dot != std::string::npos && stem.find_first_of("/\\", dot) == std::string::npos)
     {
-        roadmanager::Road *road = opendrive->GetRoadByIdx(i);
-        if (road)
-        {
-            for (unsigned int j = 0; j < road->GetNumberOfObjects(); j++)
-            {
-                roadmanager::RMObject *object = road->GetRoadObject(j);
-                if (object)
-                {
-                    UpdateOSIStationaryObjectODR(object);
-                }
-            }
-        }
+        stem = stem.substr(0, dot);
     }
 
-    // Then pick objects from the OpenSCENARIO description
-    for (size_t i = 0; i < objectState.size(); i++)
+    while (sensor_view_files_.size() < sensor_view_buffers_.size())
     {
-        if (objectState[i]->state_.info.obj_type == static_cast<int>(Object::Type::VEHICLE) ||
-            objectState[i]->state_.info.obj_type == static_cast<int>(Object::Type::PEDESTRIAN))
-        {
-            // do nothing
-        }
-        else if (objectState[i]->state_.info.obj_type == static_cast<int>(Object::Type::MISC_OBJECT))
+        std::string filename = stem + "_sensor_view_" + std::to_string(sensor_view_files_.size()) + ".osi";
+        sensor_view_files_.push_back(std::make_unique<SE_AsyncFileWriter>());
+        if (sensor_view_files_.back()->Open(filename, std::ios_base::binary, SE_Env::Inst().GetWriteBufferSize()) != 0)
         {
-            UpdateOSIStationaryObject(objectState[i].get());
+            LOG_ERROR("Failed open OSI sensor view tracefile {}", filename);
         }
         else
         {
-            LOG_WARN("Warning: Object type {} is not supported in OSIReporter, and hence no OSI update for this object",
-                     objectState[i]->state_.info.obj_type);
+            sensor_view_files_.back()->SetDropWhenFull(SE_Env::Inst().GetWriteDropWhenFull());
+            LOG_INFO("OSI sensor view tracefile {} opened", filename);
         }
     }
 
-    UpdateOSIRoadLane();
-    UpdateOSILaneBoundary();
-    UpdateOSIIntersection();
-    UpdateTrafficSignals();
-
-    // Set the original geo reference string as is
-    std::string proj_string_delimiter = "";
-    if (!opendrive->GetGeoReferenceOriginalString().empty() && !opendrive->GetGeoOffsetOriginalString().empty())
+    for (size_t i = 0; i < sensor_view_buffers_.size(); i++)
     {
-        proj_string_delimiter = ";";
+        if (sensor_view_files_[i]->IsOpen() && sensor_view_files_[i]->Good())
+        {
+            unsigned int size = static_cast<unsigned int>(sensor_view_buffers_[i].size());
+            osi_frame_.assign(reinterpret_cast<char *>(&size), sizeof(size));
+            osi_frame_.append(sensor_view_buffers_[i]);
+            sensor_view_files_[i]->Write(osi_frame_);
+        }
     }
-    obj_osi_internal.static_gt->set_proj_string(
-        (opendrive->GetGeoReferenceOriginalString() + proj_string_delimiter + opendrive->GetGeoOffsetOriginalString()).c_str());
-    obj_osi_internal.static_gt->set_map_reference(opendrive->GetGeoReferenceAsString());
-    obj_osi_internal.static_gt->set_model_reference(stationary_model_reference);
-
-    return 0;
 }
 
-void OSIReporter::CropOSIDynamicGroundTruth(const int id, const double radius)
+void OSIReporter::SendOSISensorViewsUDP()
 {
-    if (osi_crop_.empty() && radius > SMALL_NUMBER)
+    while (sensor_view_udp_clients_.size() < sensor_view_buffers_.size())
     {
-        osi_crop_.emplace_back(std::make_pair(id, radius));
+        unsigned short port = static_cast<unsigned short>(OSI_SENSOR_VIEW_OUT_PORT + sensor_view_udp_clients_.size());
+        sensor_view_udp_clients_.push_back(std::make_unique<UDPClient>(port, udp_ip_address_));
+        sensor_view_udp_clients_.back()->SetRateLimit(udp_rate_limit_ * 1e6 / 8);
     }
-    else
+
+    // frame id of its own, since ground truth might be sent at another rate by the high rate thread
+    sensor_view_udp_frame_id_++;
+    for (size_t i = 0; i < sensor_view_buffers_.size(); i++)
     {
-        for (size_t i = 0; i < osi_crop_.size(); i++)
-        {
-            if (osi_crop_[i].first == id)
-            {
-                if (radius > SMALL_NUMBER)
-                {
-                    osi_crop_[i].second = radius;
-                }
-                else
-                {
-                    osi_crop_.erase(osi_crop_.begin() + static_cast<int>(i));
-                    LOG_INFO("CropGroundTruth: Removed crop for entity id {}", id);
-                }
-                return;
-            }
-        }
-        if (radius > SMALL_NUMBER)
+        if (sensor_view_udp_clients_[i]->GetStatus() == 0 && !sensor_view_buffers_[i].empty())
         {
-            osi_crop_.emplace_back(std::make_pair(id, radius));
+            SendOSIUDPMessage(sensor_view_udp_clients_[i].get(),
+                              sensor_view_buffers_[i].data(),
+                              static_cast<unsigned int>(sensor_view_buffers_[i].size()),
+                              sensor_view_udp_frame_id_);
         }
     }
-    LOG_INFO("CropGroundTruth: Added crop for entity id {} with radius {}", id, radius);
 }
 
-void OSIReporter::CheckDynamicTypeAndUpdate(const std::unique_ptr<ObjectState> &objectState)
+const char *OSIReporter::GetOSISensorView(int sensor_id, int *size)
+{
+    UpdateOSISensorViews();
+
+    if (sensor_id < 0 || sensor_id >= static_cast<int>(sensor_view_buffers_.size()))
+    {
+        *size = 0;
+        return nullptr;
+    }
+
+    *size = static_cast<int>(sensor_view_buffers_[static_cast<size_t>(sensor_id)].size());
+    return sensor_view_buffers_[static_cast<size_t>(sensor_id)].data();
+}
+
+const char *OSIReporter::GetOSISensorViewRaw(int sensor_id)
+{
+    UpdateOSISensorViews();
+
+    if (sensor_id < 0 || sensor_id >= static_cast<int>(sensor_views_.size()))
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<const char *>(&sensor_views_[static_cast<size_t>(sensor_id)]);
+}
+
+void OSIReporter::CheckDynamicTypeAndUpdate(const std::unique_ptr<ObjectState> &objectState, const MovingObjectData *data)
 {
     if (objectState->state_.info.obj_type == static_cast<int>(Object::Type::VEHICLE) ||
         objectState->state_.info.obj_type == static_cast<int>(Object::Type::PEDESTRIAN))
     {
         if (objectState->state_.info.ctrl_type != Controller::Type::GHOST_RESERVED_TYPE || report_ghost_)
         {
-            UpdateOSIMovingObject(objectState.get());
+            UpdateOSIMovingObject(objectState.get(), data);
             // All non-ghost objects are always updated. Ghosts only on request.
         }
     }
@@ -507,7 +1220,16 @@ void OSIReporter::CheckDynamicTypeAndUpdate(const std::unique_ptr<ObjectState> &
 
 int OSIReporter::UpdateOSIDynamicGroundTruth(const std::vector<std::unique_ptr<ObjectState>> &objectState)
 {
-    obj_osi_internal.dynamic_gt->clear_moving_object();
+    if (osi_in_place_)
+    {
+        moving_objects_update_++;
+        moving_objects_modified_ = false;
+        changed_moving_objects_.clear();
+    }
+    else
+    {
+        obj_osi_internal.dynamic_gt->clear_moving_object();
+    }
     obj_osi_internal.dynamic_gt->clear_timestamp();
 
     if (SE_Env::Inst().IsOSITimeStampSet())
@@ -534,18 +1256,28 @@ int OSIReporter::UpdateOSIDynamicGroundTruth(const std::vector<std::unique_ptr<O
     // As OSI defines the origin of the object coordinates in the center of the bounding box and esmini (as OpenSCENARIO)
     // at the center of the rear axle, the position needs to be transformed.
     // For the transformation the orientation of the object has to be taken into account.
-    for (const auto &obj : objectState)
+    // Objects are independent, so the transformation and the rest of the kinematic data is prepared in parallel.
+    moving_object_data_.resize(objectState.size());
+    object_pool_.Run(objectState.size(),
+                     [this, &objectState](size_t i)
+                     {
+                         ObjectState *obj = objectState[i].get();
+                         obj->state_.pos.SetOsiXYZ(obj->state_.info.boundingbox.center_.x_,
+                                                   obj->state_.info.boundingbox.center_.y_,
+                                                   obj->state_.info.boundingbox.center_.z_);
+                         GetMovingObjectData(obj, moving_object_data_[i]);
+                     });
+
+    if (!osi_in_place_)
     {
-        obj->state_.pos.SetOsiXYZ(obj->state_.info.boundingbox.center_.x_,
-                                  obj->state_.info.boundingbox.center_.y_,
-                                  obj->state_.info.boundingbox.center_.z_);
+        obj_osi_internal.dynamic_gt->mutable_moving_object()->Reserve(static_cast<int>(objectState.size()));
     }
 
     if (osi_crop_.empty())
     {
-        for (const auto &obj : objectState)
+        for (size_t i = 0; i < objectState.size(); i++)
         {
-            CheckDynamicTypeAndUpdate(obj);
+            CheckDynamicTypeAndUpdate(objectState[i], &moving_object_data_[i]);
         }
     }
     else
@@ -569,9 +1301,10 @@ int OSIReporter::UpdateOSIDynamicGroundTruth(const std::vector<std::unique_ptr<O
                 continue;
             }
 
-            for (const auto &obj : objectState)
+            for (size_t i = 0; i < objectState.size(); i++)
             {
-                bool update = false;
+                const std::unique_ptr<ObjectState> &obj    = objectState[i];
+                bool                                update = false;
                 if (crop_obj->state_.info.id == obj->state_.info.id)  // Update the crop object itself
                 {
                     update = true;
@@ -592,11 +1325,17 @@ int OSIReporter::UpdateOSIDynamicGroundTruth(const std::vector<std::unique_ptr<O
                 if (update && !ids_added.count(obj->state_.info.id))  // Update only once
                 {
                     ids_added.insert(obj->state_.info.id);
-                    CheckDynamicTypeAndUpdate(obj);
+                    CheckDynamicTypeAndUpdate(obj, &moving_object_data_[i]);
                 }
             }
         }
     }
+
+    if (osi_in_place_)
+    {
+        RemoveStaleMovingObjects();
+    }
+
     UpdateEnvironment(scenario_engine_->environment);
     return 0;
 }
@@ -623,8 +1362,46 @@ int OSIReporter::UpdateOSIHostVehicleData(ObjectState *objectState)
     return 0;
 }
 
-int OSIReporter::UpdateOSIStationaryObjectODR(roadmanager::RMObject *object)
+void OSIReporter::GetStationaryObjectODRData(roadmanager::RMObject *object, StationaryObjectODRData &data)
+{
+    data.position[0]    = object->GetX();
+    data.position[1]    = object->GetY();
+    data.position[2]    = object->GetZ() + object->GetZOffset() + object->GetHeight() / 2.0;
+    data.orientation[0] = GetAngleInIntervalMinusPIPlusPI(object->GetRoll());
+    data.orientation[1] = GetAngleInIntervalMinusPIPlusPI(object->GetPitch());
+    data.orientation[2] = GetAngleInIntervalMinusPIPlusPI(object->GetH() + object->GetHOffset());
+    data.height         = object->GetHeight();
+    data.base_polygon.clear();
+
+    for (unsigned int k = 0; k < object->GetNumberOfOutlines(); k++)
+    {
+        roadmanager::Outline *outline = object->GetOutline(k);
+        if (outline)
+        {
+            double height = 0;
+            for (size_t l = 0; l < outline->corner_.size(); l++)
+            {
+                double x, y, z;
+                outline->corner_[l]->GetPosLocal(x, y, z);
+                data.base_polygon.push_back(x);
+                data.base_polygon.push_back(y);
+                height += outline->corner_[l]->GetHeight() / static_cast<double>(outline->corner_.size());
+            }
+            // replace any previous height value with the average height of the outline corners
+            data.height = height;
+        }
+    }
+}
+
+int OSIReporter::UpdateOSIStationaryObjectODR(roadmanager::RMObject *object, const StationaryObjectODRData *data)
 {
+    StationaryObjectODRData local_data;
+    if (data == nullptr)
+    {
+        GetStationaryObjectODRData(object, local_data);
+        data = &local_data;
+    }
+
     // Create OSI Stationary Object
     obj_osi_internal.sobj = obj_osi_internal.static_gt->add_stationary_object();
 
@@ -690,42 +1467,30 @@ int OSIReporter::UpdateOSIStationaryObjectODR(roadmanager::RMObject *object)
         LOG_ERROR("OSIReporter::UpdateOSIStationaryObjectODR -> Unsupported stationary object category");
     }
 
+    osi3::BaseStationary *base = obj_osi_internal.sobj->mutable_base();
+
     // Set OSI Stationary Object Position
-    obj_osi_internal.sobj->mutable_base()->mutable_position()->set_x(object->GetX());
-    obj_osi_internal.sobj->mutable_base()->mutable_position()->set_y(object->GetY());
-    obj_osi_internal.sobj->mutable_base()->mutable_position()->set_z(object->GetZ() + object->GetZOffset() + object->GetHeight() / 2.0);
+    base->mutable_position()->set_x(data->position[0]);
+    base->mutable_position()->set_y(data->position[1]);
+    base->mutable_position()->set_z(data->position[2]);
 
     // Set OSI Stationary Object Boundingbox
-    obj_osi_internal.sobj->mutable_base()->mutable_dimension()->set_height(object->GetHeight());
-    obj_osi_internal.sobj->mutable_base()->mutable_dimension()->set_width(object->GetWidth());
-    obj_osi_internal.sobj->mutable_base()->mutable_dimension()->set_length(object->GetLength());
+    base->mutable_dimension()->set_height(data->height);
+    base->mutable_dimension()->set_width(object->GetWidth());
+    base->mutable_dimension()->set_length(object->GetLength());
 
     // Set OSI Stationary Object Orientation
-    obj_osi_internal.sobj->mutable_base()->mutable_orientation()->set_roll(GetAngleInIntervalMinusPIPlusPI(object->GetRoll()));
-    obj_osi_internal.sobj->mutable_base()->mutable_orientation()->set_pitch(GetAngleInIntervalMinusPIPlusPI(object->GetPitch()));
-    obj_osi_internal.sobj->mutable_base()->mutable_orientation()->set_yaw(GetAngleInIntervalMinusPIPlusPI(object->GetH() + object->GetHOffset()));
+    base->mutable_orientation()->set_roll(data->orientation[0]);
+    base->mutable_orientation()->set_pitch(data->orientation[1]);
+    base->mutable_orientation()->set_yaw(data->orientation[2]);
 
-    if (object->GetNumberOfOutlines() > 0)
+    // Set OSI Stationary Object outline
+    base->mutable_base_polygon()->Reserve(static_cast<int>(data->base_polygon.size() / 2));
+    for (size_t k = 0; k + 1 < data->base_polygon.size(); k += 2)
     {
-        for (unsigned int k = 0; k < object->GetNumberOfOutlines(); k++)
-        {
-            roadmanager::Outline *outline = object->GetOutline(k);
-            if (outline)
-            {
-                double height = 0;
-                for (size_t l = 0; l < outline->corner_.size(); l++)
-                {
-                    double x, y, z;
-                    outline->corner_[l]->GetPosLocal(x, y, z);
-                    osi3::Vector2d *vec = obj_osi_internal.sobj->mutable_base()->add_base_polygon();
-                    vec->set_x(x);
-                    vec->set_y(y);
-                    height += outline->corner_[l]->GetHeight() / static_cast<double>(outline->corner_.size());
-                }
-                // replace any previous height value with the average height of the outline corners
-                obj_osi_internal.sobj->mutable_base()->mutable_dimension()->set_height(height);
-            }
-        }
+        osi3::Vector2d *vec = base->add_base_polygon();
+        vec->set_x(data->base_polygon[k]);
+        vec->set_y(data->base_polygon[k + 1]);
     }
 
     return 0;
@@ -821,11 +1586,171 @@ int OSIReporter::UpdateOSIStationaryObject(ObjectState *objectState)
     return 0;
 }
 
-int OSIReporter::UpdateOSIMovingObject(ObjectState *objectState)
+static bool MovingObjectDescriptionChanged(const ObjectInfoStruct &a, const ObjectInfoStruct &b)
+{
+    return a.obj_type != b.obj_type || a.obj_category != b.obj_category || a.obj_role != b.obj_role || a.ctrl_type != b.ctrl_type ||
+           a.model3d != b.model3d || a.wheel_data.size() != b.wheel_data.size() ||
+           memcmp(&a.boundingbox, &b.boundingbox, sizeof(OSCBoundingBox)) != 0 || fabs(a.rear_axle_z_pos - b.rear_axle_z_pos) > SMALL_NUMBER ||
+           fabs(a.front_axle_x_pos - b.front_axle_x_pos) > SMALL_NUMBER || fabs(a.front_axle_z_pos - b.front_axle_z_pos) > SMALL_NUMBER;
+}
+
+void OSIReporter::GetMovingObjectData(const ObjectState *objectState, MovingObjectData &data)
+{
+    const roadmanager::Position &pos = objectState->state_.pos;
+
+    // OSI XYZ is center of BB, have been calculated in SetOsiXYZ
+    data.position[0]                 = pos.GetOsiX();
+    data.position[1]                 = pos.GetOsiY();
+    data.position[2]                 = pos.GetOsiZ();
+    data.orientation[0]              = GetAngleInIntervalMinusPIPlusPI(pos.GetR());
+    data.orientation[1]              = GetAngleInIntervalMinusPIPlusPI(pos.GetP());
+    data.orientation[2]              = GetAngleInIntervalMinusPIPlusPI(pos.GetH());
+    data.orientation_rate[0]         = pos.GetRRate();
+    data.orientation_rate[1]         = pos.GetPRate();
+    data.orientation_rate[2]         = pos.GetHRate();
+    data.orientation_acceleration[0] = pos.GetRAcc();
+    data.orientation_acceleration[1] = pos.GetPAcc();
+    data.orientation_acceleration[2] = pos.GetHAcc();
+    data.velocity[0]                 = pos.GetVelX();
+    data.velocity[1]                 = pos.GetVelY();
+    data.velocity[2]                 = pos.GetVelZ();
+    data.acceleration[0]             = pos.GetAccX();
+    data.acceleration[1]             = pos.GetAccY();
+    data.acceleration[2]             = pos.GetAccZ();
+    data.lane_id                     = pos.GetLaneGlobalId();
+}
+
+int OSIReporter::UpdateOSIMovingObject(ObjectState *objectState, const MovingObjectData *data)
 {
-    // Create OSI Moving object
-    obj_osi_internal.mobj = obj_osi_internal.dynamic_gt->add_moving_object();
+    MovingObjectData local_data;
+    if (data == nullptr)
+    {
+        GetMovingObjectData(objectState, local_data);
+        data = &local_data;
+    }
+
+    MovingObjectEntry *entry    = nullptr;
+    bool               describe = true;
+
+    if (osi_in_place_)
+    {
+        // Reuse the message of the object from previous update, if any
+        auto itr = moving_objects_.find(objectState->state_.info.id);
+        if (itr == moving_objects_.end())
+        {
+            MovingObjectEntry new_entry{};
+            new_entry.index          = obj_osi_internal.dynamic_gt->moving_object_size();
+            new_entry.info           = objectState->state_.info;
+            entry                    = &moving_objects_.emplace(objectState->state_.info.id, new_entry).first->second;
+            obj_osi_internal.mobj    = obj_osi_internal.dynamic_gt->add_moving_object();
+            moving_objects_modified_ = true;
+        }
+        else
+        {
+            entry                 = &itr->second;
+            obj_osi_internal.mobj = obj_osi_internal.dynamic_gt->mutable_moving_object(entry->index);
+            describe              = MovingObjectDescriptionChanged(entry->info, objectState->state_.info);
+            if (describe)
+            {
+                // start over, not to keep any fields from previous description, e.g. vehicle classification of a pedestrian
+                obj_osi_internal.mobj->Clear();
+                entry->info = objectState->state_.info;
+            }
+        }
+        entry->update = moving_objects_update_;
+    }
+    else
+    {
+        // Create OSI Moving object
+        obj_osi_internal.mobj = obj_osi_internal.dynamic_gt->add_moving_object();
+    }
+
+    if (describe)
+    {
+        UpdateOSIMovingObjectDescription(objectState);
+    }
+
+    osi3::BaseMoving *base = obj_osi_internal.mobj->mutable_base();
+
+    // Set OSI Moving Object Position
+    base->mutable_position()->set_x(data->position[0]);
+    base->mutable_position()->set_y(data->position[1]);
+    base->mutable_position()->set_z(data->position[2]);
+
+    // Set OSI Moving Object Orientation
+    base->mutable_orientation()->set_roll(data->orientation[0]);
+    base->mutable_orientation()->set_pitch(data->orientation[1]);
+    base->mutable_orientation()->set_yaw(data->orientation[2]);
+    base->mutable_orientation_rate()->set_yaw(data->orientation_rate[2]);
+    base->mutable_orientation_rate()->set_pitch(data->orientation_rate[1]);
+    base->mutable_orientation_rate()->set_roll(data->orientation_rate[0]);
+    base->mutable_orientation_acceleration()->set_yaw(data->orientation_acceleration[2]);
+    base->mutable_orientation_acceleration()->set_pitch(data->orientation_acceleration[1]);
+    base->mutable_orientation_acceleration()->set_roll(data->orientation_acceleration[0]);
+
+    // Set OSI Moving Object Velocity
+    base->mutable_velocity()->set_x(data->velocity[0]);
+    base->mutable_velocity()->set_y(data->velocity[1]);
+    base->mutable_velocity()->set_z(data->velocity[2]);
+
+    // Set OSI Moving Object Acceleration
+    base->mutable_acceleration()->set_x(data->acceleration[0]);
+    base->mutable_acceleration()->set_y(data->acceleration[1]);
+    base->mutable_acceleration()->set_z(data->acceleration[2]);
+
+    // Set ego lane
+    if (obj_osi_internal.mobj->assigned_lane_id_size() != 1)
+    {
+        obj_osi_internal.mobj->clear_assigned_lane_id();
+        obj_osi_internal.mobj->add_assigned_lane_id();
+    }
+    obj_osi_internal.mobj->mutable_assigned_lane_id(0)->set_value(data->lane_id);
+
+    // simplified wheel info, set nr wheels based on object type
+    // can be improved by considering axels and actual wheel configuration
+
+    if (objectState->state_.info.obj_type == static_cast<int>(Object::Type::VEHICLE))
+    {
+        osi3::MovingObject_VehicleAttributes *attributes = obj_osi_internal.mobj->mutable_vehicle_attributes();
+
+        // Set some data for each wheel
+        for (int i = 0; i < static_cast<int>(objectState->state_.info.wheel_data.size()); i++)
+        {
+            const WheelData &wheel_data = objectState->state_.info.wheel_data[static_cast<unsigned int>(i)];
+            if (wheel_data.axle > -1)
+            {
+                // create wheel data message, unless there is one from previous update
+                if (i >= attributes->wheel_data_size())
+                {
+                    attributes->add_wheel_data();
+                }
+                osi3::MovingObject_VehicleAttributes_WheelData *wheel = attributes->mutable_wheel_data(i);
+                wheel->mutable_position()->set_x(wheel_data.x - static_cast<double>(objectState->state_.info.boundingbox.center_.x_));
+                wheel->mutable_position()->set_y(wheel_data.y - static_cast<double>(objectState->state_.info.boundingbox.center_.y_));
+                wheel->mutable_position()->set_z(wheel_data.z - static_cast<double>(objectState->state_.info.boundingbox.center_.z_));
+
+                wheel->mutable_orientation()->set_yaw(wheel_data.h);
+                wheel->mutable_orientation()->set_pitch(wheel_data.p);
+                wheel->set_friction_coefficient(wheel_data.friction_coefficient);
+                wheel->set_axle(static_cast<unsigned int>(wheel_data.axle));
+                wheel->set_index(static_cast<unsigned int>(wheel_data.index));  // Index along axis
+                wheel->set_wheel_radius(wheel_data.wheel_radius);
+                wheel->set_rotation_rate(wheel_data.rotation_rate);
+                attributes->set_number_wheels(static_cast<unsigned int>(objectState->state_.info.wheel_data.size()));
+            }
+        }
+    }
+
+    if (entry != nullptr && osi_delta_tolerance_ > -SMALL_NUMBER)
+    {
+        CheckMovingObjectChange(*entry, describe);
+    }
+
+    return 0;
+}
 
+void OSIReporter::UpdateOSIMovingObjectDescription(ObjectState *objectState)
+{
     // Set OSI Moving Object Mutable ID
     obj_osi_internal.mobj->mutable_id()->set_value(static_cast<unsigned int>(objectState->state_.info.id));
 
@@ -972,81 +1897,130 @@ int OSIReporter::UpdateOSIMovingObject(ObjectState *objectState)
     obj_osi_internal.mobj->mutable_base()->mutable_dimension()->set_width(objectState->state_.info.boundingbox.dimensions_.width_);
     obj_osi_internal.mobj->mutable_base()->mutable_dimension()->set_length(objectState->state_.info.boundingbox.dimensions_.length_);
 
-    // OSI XYZ is center of BB, have been calculated in SetOsiXYZ
-    obj_osi_internal.mobj->mutable_base()->mutable_position()->set_x(objectState->state_.pos.GetOsiX());
-    obj_osi_internal.mobj->mutable_base()->mutable_position()->set_y(objectState->state_.pos.GetOsiY());
-    obj_osi_internal.mobj->mutable_base()->mutable_position()->set_z(objectState->state_.pos.GetOsiZ());
 
-    // Set OSI Moving Object Orientation
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation()->set_roll(GetAngleInIntervalMinusPIPlusPI(objectState->state_.pos.GetR()));
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation()->set_pitch(GetAngleInIntervalMinusPIPlusPI(objectState->state_.pos.GetP()));
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation()->set_yaw(GetAngleInIntervalMinusPIPlusPI(objectState->state_.pos.GetH()));
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation_rate()->set_yaw(objectState->state_.pos.GetHRate());
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation_rate()->set_pitch(objectState->state_.pos.GetPRate());
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation_rate()->set_roll(objectState->state_.pos.GetRRate());
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation_acceleration()->set_yaw(objectState->state_.pos.GetHAcc());
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation_acceleration()->set_pitch(objectState->state_.pos.GetPAcc());
-    obj_osi_internal.mobj->mutable_base()->mutable_orientation_acceleration()->set_roll(objectState->state_.pos.GetRAcc());
+    // Set 3D model file as OSI model reference
+    obj_osi_internal.mobj->set_model_reference(objectState->state_.info.model3d);
+}
 
-    // Set OSI Moving Object Velocity
-    obj_osi_internal.mobj->mutable_base()->mutable_velocity()->set_x(objectState->state_.pos.GetVelX());
-    obj_osi_internal.mobj->mutable_base()->mutable_velocity()->set_y(objectState->state_.pos.GetVelY());
-    obj_osi_internal.mobj->mutable_base()->mutable_velocity()->set_z(objectState->state_.pos.GetVelZ());
+void OSIReporter::CheckMovingObjectChange(MovingObjectEntry &entry, bool force)
+{
+    const osi3::BaseMoving &base      = obj_osi_internal.mobj->base();
+    double                  state[12] = {base.position().x(),
+                                         base.position().y(),
+                                         base.position().z(),
+                                         base.velocity().x(),
+                                         base.velocity().y(),
+                                         base.velocity().z(),
+                                         base.acceleration().x(),
+                                         base.acceleration().y(),
+                                         base.acceleration().z(),
+                                         base.orientation().yaw(),
+                                         base.orientation().pitch(),
+                                         base.orientation().roll()};
+    bool                    changed   = force;
+
+    // compare to state at latest output, not previous update, so that also slow changes are eventually output
+    for (int i = 0; i < 9 && !changed; i++)
+    {
+        changed = fabs(state[i] - entry.output[i]) > osi_delta_tolerance_;
+    }
 
-    // Set OSI Moving Object Acceleration
-    obj_osi_internal.mobj->mutable_base()->mutable_acceleration()->set_x(objectState->state_.pos.GetAccX());
-    obj_osi_internal.mobj->mutable_base()->mutable_acceleration()->set_y(objectState->state_.pos.GetAccY());
-    obj_osi_internal.mobj->mutable_base()->mutable_acceleration()->set_z(objectState->state_.pos.GetAccZ());
+    for (int i = 9; i < 12 && !changed; i++)
+    {
+        changed = GetAbsAngleDifference(state[i], entry.output[i]) > osi_delta_tolerance_;
+    }
 
-    // Set ego lane
-    obj_osi_internal.mobj->add_assigned_lane_id()->set_value(objectState->state_.pos.GetLaneGlobalId());
+    if (changed)
+    {
+        memcpy(entry.output, state, sizeof(state));
+        changed_moving_objects_.push_back(&entry);
+    }
+}
 
-    // simplified wheel info, set nr wheels based on object type
-    // can be improved by considering axels and actual wheel configuration
+void OSIReporter::RemoveStaleMovingObjects()
+{
+    // Drop objects not included in latest update, e.g. deleted or cropped out, keeping order of the remaining ones
+    google::protobuf::RepeatedPtrField<osi3::MovingObject> *mobjs = obj_osi_internal.dynamic_gt->mutable_moving_object();
+    int                                                     n     = 0;
 
-    if (objectState->state_.info.obj_type == static_cast<int>(Object::Type::VEHICLE))
+    for (int i = 0; i < mobjs->size(); i++)
     {
-        // Set some data for each wheel
-        for (int i = 0; i < static_cast<int>(objectState->state_.info.wheel_data.size()); i++)
+        auto itr = moving_objects_.find(static_cast<int>(mobjs->Get(i).id().value()));
+        if (itr == moving_objects_.end() || itr->second.update != moving_objects_update_)
         {
-            if (objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].axle > -1)
+            if (itr != moving_objects_.end())
             {
-                // create wheel data message
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->add_wheel_data();
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->mutable_position()->set_x(
-                    objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].x -
-                    static_cast<double>(objectState->state_.info.boundingbox.center_.x_));
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->mutable_position()->set_y(
-                    objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].y -
-                    static_cast<double>(objectState->state_.info.boundingbox.center_.y_));
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->mutable_position()->set_z(
-                    objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].z -
-                    static_cast<double>(objectState->state_.info.boundingbox.center_.z_));
-
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->mutable_orientation()->set_yaw(
-                    objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].h);
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->mutable_orientation()->set_pitch(
-                    objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].p);
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->set_friction_coefficient(
-                    objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].friction_coefficient);
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->set_axle(
-                    static_cast<unsigned int>(objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].axle));
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->set_index(
-                    static_cast<unsigned int>(objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].index));  // Index along axis
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->set_wheel_radius(
-                    objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].wheel_radius);
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->mutable_wheel_data(i)->set_rotation_rate(
-                    objectState->state_.info.wheel_data[static_cast<unsigned int>(i)].rotation_rate);
-                obj_osi_internal.mobj->mutable_vehicle_attributes()->set_number_wheels(
-                    static_cast<unsigned int>(objectState->state_.info.wheel_data.size()));
+                moving_objects_.erase(itr);
             }
+            continue;
+        }
+
+        if (i != n)
+        {
+            mobjs->SwapElements(i, n);
+            itr->second.index = n;
         }
+        n++;
     }
 
-    // Set 3D model file as OSI model reference
-    obj_osi_internal.mobj->set_model_reference(objectState->state_.info.model3d);
+    if (n < mobjs->size())
+    {
+        moving_objects_modified_ = true;
+        while (mobjs->size() > n)
+        {
+            mobjs->RemoveLast();
+        }
+    }
+}
 
-    return 0;
+void OSIReporter::SetOSIDeltaOutput(double tolerance)
+{
+    osi_delta_tolerance_ = tolerance;
+    if (tolerance > -SMALL_NUMBER)
+    {
+        osi_in_place_ = true;
+        LOG_INFO("OSI delta output, tolerance {:.4f}", tolerance);
+    }
+}
+
+bool OSIReporter::SwapInChangedMovingObjects()
+{
+    // In delta output mode, temporarily replace the moving objects of dynamic ground truth by the changed ones.
+    // Swap back by swapping delta_moving_objects_ once more.
+    if (osi_delta_tolerance_ < -SMALL_NUMBER)
+    {
+        return false;
+    }
+
+    delta_n_objects_ += static_cast<unsigned long long>(obj_osi_internal.dynamic_gt->moving_object_size());
+
+    if (moving_objects_modified_)
+    {
+        // objects added or removed, output all of them
+        delta_n_output_ += static_cast<unsigned long long>(obj_osi_internal.dynamic_gt->moving_object_size());
+        return false;
+    }
+
+    delta_moving_objects_.Clear();
+    for (auto entry : changed_moving_objects_)
+    {
+        *delta_moving_objects_.Add() = obj_osi_internal.dynamic_gt->moving_object(entry->index);
+    }
+    delta_n_output_ += changed_moving_objects_.size();
+    obj_osi_internal.dynamic_gt->mutable_moving_object()->Swap(&delta_moving_objects_);
+
+    return true;
+}
+
+void OSIReporter::PrintDeltaStatistics() const
+{
+    if (delta_n_objects_ > 0)
+    {
+        LOG_INFO("OSI delta output: {} of {} moving object states output ({:.1f}%)",
+                 delta_n_output_,
+                 delta_n_objects_,
+                 100.0 * static_cast<double>(delta_n_output_) / static_cast<double>(delta_n_objects_));
+    }
 }
 
 int OSIReporter::UpdateOSIIntersection()
@@ -2758,16 +3732,60 @@ void OSIReporter::CreateLaneBoundaryFromSensordata(const osi3::SensorData &sd, i
     }
 }
 
-const char *OSIReporter::GetOSIGroundTruth(int *size)
+const char *OSIReporter::GetOSIGroundTruth(int *size)
+{
+    if (!(GetUDPClientStatus() == 0 || IsFileOpen()))
+    {
+        // Data has not been serialized
+        obj_osi_external.gt->SerializeToString(&osiGroundTruth.ground_truth);
+        osiGroundTruth.size = static_cast<unsigned int>(obj_osi_external.gt->ByteSizeLong());
+    }
+    *size = static_cast<int>(osiGroundTruth.size);
+    return osiGroundTruth.ground_truth.data();
+}
+
+OSIReporter::OSIBuffer OSIReporter::SerializeToBuffer(const osi3::GroundTruth &gt, std::shared_ptr<std::string> &buffer)
+{
+    // Never touch a buffer someone else is holding, it might be read in another thread
+    if (buffer == nullptr || buffer.use_count() > 1)
+    {
+        buffer = std::make_shared<std::string>();
+    }
+    gt.SerializeToString(buffer.get());
+
+    return buffer;
+}
+
+OSIReporter::OSIBuffer OSIReporter::GetOSIStaticGroundTruthBuffer(unsigned long long &generation)
+{
+    if (static_buffer_generation_ != static_generation_)
+    {
+        SerializeToBuffer(*GetReportedStaticGroundTruth(), static_buffer_);
+        static_buffer_generation_ = static_generation_;
+    }
+    else if (static_buffer_ == nullptr)
+    {
+        static_buffer_ = std::make_shared<std::string>();
+    }
+
+    generation = static_generation_;
+    return static_buffer_;
+}
+
+OSIReporter::OSIBuffer OSIReporter::GetOSIDynamicGroundTruthBuffer(unsigned long long &generation)
 {
-    if (!(GetUDPClientStatus() == 0 || IsFileOpen()))
+    if (dynamic_buffer_generation_ != dynamic_generation_)
     {
-        // Data has not been serialized
-        obj_osi_external.gt->SerializeToString(&osiGroundTruth.ground_truth);
-        osiGroundTruth.size = static_cast<unsigned int>(obj_osi_external.gt->ByteSizeLong());
+        SerializeToBuffer(*obj_osi_internal.dynamic_gt, dynamic_buffer_);
+        dynamic_buffer_generation_ = dynamic_generation_;
     }
-    *size = static_cast<int>(osiGroundTruth.size);
-    return osiGroundTruth.ground_truth.data();
+    else if (dynamic_buffer_ == nullptr)
+    {
+        dynamic_buffer_ = std::make_shared<std::string>();
+    }
+
+    generation = dynamic_generation_;
+    return dynamic_buffer_;
 }
 
 const char *OSIReporter::GetOSIGroundTruthRaw()
@@ -2819,10 +3837,14 @@ const char *OSIReporter::GetOSIRoadLane(const std::vector<std::unique_ptr<Object
         LOG_ERROR("Failed to locate vehicle lane id!");
         return 0;
     }
-    // serialize to string the single lane
-    obj_osi_internal.ln[idx]->SerializeToString(&osiRoadLane.osi_lane_info);
-    osiRoadLane.size = static_cast<unsigned int>(obj_osi_internal.ln[idx]->ByteSizeLong());
-    *size            = static_cast<int>(osiRoadLane.size);
+    // serialize to string the single lane, unless done already since lanes are static
+    if (idx != road_lane_idx_)
+    {
+        obj_osi_internal.ln[idx]->SerializeToString(&osiRoadLane.osi_lane_info);
+        osiRoadLane.size = static_cast<unsigned int>(osiRoadLane.osi_lane_info.size());
+        road_lane_idx_   = idx;
+    }
+    *size = static_cast<int>(osiRoadLane.size);
     return osiRoadLane.osi_lane_info.data();
 }
 
@@ -2846,10 +3868,14 @@ const char *OSIReporter::GetOSIRoadLaneBoundary(int *size, int global_id)
         return 0;
     }
 
-    // serialize to string the single lane
-    obj_osi_internal.lnb[static_cast<unsigned int>(idx)]->SerializeToString(&osiRoadLaneBoundary.osi_lane_boundary_info);
-    osiRoadLaneBoundary.size = static_cast<unsigned int>(obj_osi_internal.lnb[static_cast<unsigned int>(idx)]->ByteSizeLong());
-    *size                    = static_cast<int>(osiRoadLaneBoundary.size);
+    // serialize to string the single lane boundary, unless done already
+    if (idx != road_lane_boundary_idx_)
+    {
+        obj_osi_internal.lnb[static_cast<unsigned int>(idx)]->SerializeToString(&osiRoadLaneBoundary.osi_lane_boundary_info);
+        osiRoadLaneBoundary.size = static_cast<unsigned int>(osiRoadLaneBoundary.osi_lane_boundary_info.size());
+        road_lane_boundary_idx_  = idx;
+    }
+    *size = static_cast<int>(osiRoadLaneBoundary.size);
     return osiRoadLaneBoundary.osi_lane_boundary_info.data();
 }
 
@@ -3026,6 +4052,340 @@ int OSIReporter::SetOSITimeStampExplicit(unsigned long long nanoseconds)
     return 0;
 }
 
+int OSIReporter::SetOSIOutputRate(double rate)
+{
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    StopHighRateThread();
+
+    high_rate_period_ = rate > SMALL_NUMBER ? static_cast<unsigned long long>(llround(1e9 / rate)) : 0;
+    if (high_rate_period_ > 0)
+    {
+        high_rate_quit_   = false;
+        high_rate_thread_ = std::thread(&OSIReporter::HighRateLoop, this);
+    }
+    return 0;
+#else
+    if (rate > SMALL_NUMBER)
+    {
+        LOG_ERROR("OSI output rate not supported on this platform");
+        return -1;
+    }
+    return 0;
+#endif
+}
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+static unsigned long long GetTimestampNanoseconds(const osi3::Timestamp &ts)
+{
+    return static_cast<unsigned long long>(ts.seconds()) * 1000000000ULL + static_cast<unsigned long long>(ts.nanos());
+}
+
+static void ExtrapolateBaseMoving(const osi3::BaseMoving &src, double dt, osi3::BaseMoving *dst)
+{
+    // constant acceleration, also for heading
+    double dt2 = 0.5 * dt * dt;
+
+    dst->mutable_position()->set_x(src.position().x() + src.velocity().x() * dt + src.acceleration().x() * dt2);
+    dst->mutable_position()->set_y(src.position().y() + src.velocity().y() * dt + src.acceleration().y() * dt2);
+    dst->mutable_position()->set_z(src.position().z() + src.velocity().z() * dt + src.acceleration().z() * dt2);
+    dst->mutable_velocity()->set_x(src.velocity().x() + src.acceleration().x() * dt);
+    dst->mutable_velocity()->set_y(src.velocity().y() + src.acceleration().y() * dt);
+    dst->mutable_velocity()->set_z(src.velocity().z() + src.acceleration().z() * dt);
+    dst->mutable_orientation()->set_yaw(
+        GetAngleInIntervalMinusPIPlusPI(src.orientation().yaw() + src.orientation_rate().yaw() * dt + src.orientation_acceleration().yaw() * dt2));
+    dst->mutable_orientation_rate()->set_yaw(src.orientation_rate().yaw() + src.orientation_acceleration().yaw() * dt);
+}
+
+// Cubic Hermite interpolation of value and its derivative, given value and derivative at both ends of an interval of duration T
+static void InterpolateHermite(double p0, double v0, double p1, double v1, double T, double s, double &p, double &v)
+{
+    double s2 = s * s;
+    double s3 = s2 * s;
+
+    p = (2 * s3 - 3 * s2 + 1) * p0 + (s3 - 2 * s2 + s) * T * v0 + (-2 * s3 + 3 * s2) * p1 + (s3 - s2) * T * v1;
+    v = (6 * s2 - 6 * s) / T * p0 + (3 * s2 - 4 * s + 1) * v0 + (-6 * s2 + 6 * s) / T * p1 + (3 * s2 - 2 * s) * v1;
+}
+
+// Check whether rate of change at both ends of an interval explains the change of value, by the trapezoidal rule which is
+// exact for constant acceleration. If not, e.g. at a step change of speed or a teleport, cubic interpolation would overshoot.
+static bool RatesConsistent(double dp, double v0, double v1, double T)
+{
+    return fabs(dp - 0.5 * T * (v0 + v1)) < 0.1 * fabs(dp) + 1e-3;
+}
+
+static void InterpolateBaseMoving(const osi3::BaseMoving &src, const osi3::BaseMoving &next, double T, double dt, osi3::BaseMoving *dst)
+{
+    // position and heading following both reported state and its rate of change at start and end, accelerations blended linearly
+    // if the rates don't match the movement, interpolate linearly at constant rate instead, as the entity was actually moved
+    double s = dt / T;
+    double p, v;
+
+    const osi3::Vector3d &p0 = src.position();
+    const osi3::Vector3d &p1 = next.position();
+    const osi3::Vector3d &v0 = src.velocity();
+    const osi3::Vector3d &v1 = next.velocity();
+    double                dx = p1.x() - p0.x();
+    double                dy = p1.y() - p0.y();
+    double                dz = p1.z() - p0.z();
+
+    if (RatesConsistent(sqrt(dx * dx + dy * dy + dz * dz),
+                        sqrt(v0.x() * v0.x() + v0.y() * v0.y() + v0.z() * v0.z()),
+                        sqrt(v1.x() * v1.x() + v1.y() * v1.y() + v1.z() * v1.z()),
+                        T) &&
+        RatesConsistent(dx, v0.x(), v1.x(), T) && RatesConsistent(dy, v0.y(), v1.y(), T) && RatesConsistent(dz, v0.z(), v1.z(), T))
+    {
+        InterpolateHermite(p0.x(), v0.x(), p1.x(), v1.x(), T, s, p, v);
+        dst->mutable_position()->set_x(p);
+        dst->mutable_velocity()->set_x(v);
+        InterpolateHermite(p0.y(), v0.y(), p1.y(), v1.y(), T, s, p, v);
+        dst->mutable_position()->set_y(p);
+        dst->mutable_velocity()->set_y(v);
+        InterpolateHermite(p0.z(), v0.z(), p1.z(), v1.z(), T, s, p, v);
+        dst->mutable_position()->set_z(p);
+        dst->mutable_velocity()->set_z(v);
+    }
+    else
+    {
+        dst->mutable_position()->set_x(p0.x() + s * dx);
+        dst->mutable_position()->set_y(p0.y() + s * dy);
+        dst->mutable_position()->set_z(p0.z() + s * dz);
+        dst->mutable_velocity()->set_x(dx / T);
+        dst->mutable_velocity()->set_y(dy / T);
+        dst->mutable_velocity()->set_z(dz / T);
+    }
+
+    dst->mutable_acceleration()->set_x((1 - s) * src.acceleration().x() + s * next.acceleration().x());
+    dst->mutable_acceleration()->set_y((1 - s) * src.acceleration().y() + s * next.acceleration().y());
+    dst->mutable_acceleration()->set_z((1 - s) * src.acceleration().z() + s * next.acceleration().z());
+
+    // interpolate over the shortest way around
+    double yaw0 = src.orientation().yaw();
+    double dyaw = GetAngleInIntervalMinusPIPlusPI(next.orientation().yaw() - yaw0);
+    if (RatesConsistent(dyaw, src.orientation_rate().yaw(), next.orientation_rate().yaw(), T))
+    {
+        InterpolateHermite(yaw0, src.orientation_rate().yaw(), yaw0 + dyaw, next.orientation_rate().yaw(), T, s, p, v);
+    }
+    else
+    {
+        p = yaw0 + s * dyaw;
+        v = dyaw / T;
+    }
+    dst->mutable_orientation()->set_yaw(GetAngleInIntervalMinusPIPlusPI(p));
+    dst->mutable_orientation_rate()->set_yaw(v);
+    dst->mutable_orientation_acceleration()->set_yaw((1 - s) * src.orientation_acceleration().yaw() + s * next.orientation_acceleration().yaw());
+}
+
+void OSIReporter::QueueHighRateFrame(bool include_static)
+{
+    std::unique_ptr<HighRateFrame> frame;
+    {
+        std::lock_guard<std::mutex> lock(high_rate_mutex_);
+        if (!high_rate_free_.empty())
+        {
+            frame = std::move(high_rate_free_.back());
+            high_rate_free_.pop_back();
+        }
+    }
+
+    if (frame == nullptr)
+    {
+        frame = std::make_unique<HighRateFrame>();
+    }
+
+    frame->dynamic_gt.CopyFrom(*obj_osi_internal.dynamic_gt);
+    frame->static_data.clear();
+    if (include_static)
+    {
+        GetReportedStaticGroundTruth()->SerializeToString(&frame->static_data);
+    }
+    frame->static_changed = static_crop_changed_;
+    frame->timestamp      = GetTimestampNanoseconds(obj_osi_internal.dynamic_gt->timestamp());
+    frame->arrival        = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(high_rate_mutex_);
+        high_rate_queue_.push_back(std::move(frame));
+    }
+    high_rate_cv_.notify_all();
+}
+
+void OSIReporter::HighRateLoop()
+{
+    std::unique_ptr<HighRateFrame> frame;  // latest frame, its samples are output when the next frame arrives
+
+    while (true)
+    {
+        std::unique_ptr<HighRateFrame> next;
+        {
+            std::unique_lock<std::mutex> lock(high_rate_mutex_);
+            high_rate_cv_.wait(lock, [this] { return high_rate_quit_ || !high_rate_queue_.empty(); });
+            if (high_rate_queue_.empty())
+            {
+                return;  // quit, all reported frames taken care of
+            }
+            next = std::move(high_rate_queue_.front());
+            high_rate_queue_.pop_front();
+            high_rate_busy_ = true;
+        }
+
+        if (frame != nullptr)
+        {
+            OutputHighRateSamples(*frame, *next);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(high_rate_mutex_);
+            if (frame != nullptr)
+            {
+                high_rate_free_.push_back(std::move(frame));
+            }
+            high_rate_busy_ = false;
+        }
+        high_rate_cv_.notify_all();
+
+        frame = std::move(next);
+    }
+}
+
+void OSIReporter::OutputHighRateSamples(const HighRateFrame &frame, const HighRateFrame &next)
+{
+    if (!frame.static_data.empty())
+    {
+        // kept until output, also if no sample falls within this frame
+        high_rate_static_         = frame.static_data;
+        high_rate_static_changed_ = frame.static_changed;
+    }
+
+    if (next.timestamp <= frame.timestamp)
+    {
+        return;
+    }
+
+    // samples on the grid of the output period, from the frame up to next frame
+    double wall_time = std::chrono::duration<double>(next.arrival - frame.arrival).count();
+    double duration  = 1e-9 * static_cast<double>(next.timestamp - frame.timestamp);
+    bool   copied    = false;
+
+    // look up each moving object in the next frame, typically at the same index
+    high_rate_next_index_.resize(static_cast<size_t>(frame.dynamic_gt.moving_object_size()));
+    for (int i = 0; i < frame.dynamic_gt.moving_object_size(); i++)
+    {
+        uint64_t id = frame.dynamic_gt.moving_object(i).id().value();
+        int      j  = i;
+        if (j >= next.dynamic_gt.moving_object_size() || next.dynamic_gt.moving_object(j).id().value() != id)
+        {
+            j = 0;
+            while (j < next.dynamic_gt.moving_object_size() && next.dynamic_gt.moving_object(j).id().value() != id)
+            {
+                j++;
+            }
+        }
+        high_rate_next_index_[static_cast<size_t>(i)] = j < next.dynamic_gt.moving_object_size() ? j : -1;
+    }
+
+    for (unsigned long long t = (frame.timestamp + high_rate_period_ - 1) / high_rate_period_ * high_rate_period_; t < next.timestamp;
+         t += high_rate_period_)
+    {
+        if (!copied)
+        {
+            high_rate_gt_.CopyFrom(frame.dynamic_gt);
+            copied = true;
+        }
+
+        double dt = 1e-9 * static_cast<double>(t - frame.timestamp);
+        for (int i = 0; i < frame.dynamic_gt.moving_object_size(); i++)
+        {
+            int j = high_rate_next_index_[static_cast<size_t>(i)];
+            if (j >= 0)
+            {
+                InterpolateBaseMoving(frame.dynamic_gt.moving_object(i).base(),
+                                      next.dynamic_gt.moving_object(j).base(),
+                                      duration,
+                                      dt,
+                                      high_rate_gt_.mutable_moving_object(i)->mutable_base());
+            }
+            else
+            {
+                // object removed before next frame, nothing to interpolate towards
+                ExtrapolateBaseMoving(frame.dynamic_gt.moving_object(i).base(), dt, high_rate_gt_.mutable_moving_object(i)->mutable_base());
+            }
+        }
+        high_rate_gt_.mutable_timestamp()->set_seconds(static_cast<int64_t>(t / 1000000000ULL));
+        high_rate_gt_.mutable_timestamp()->set_nanos(static_cast<uint32_t>(t % 1000000000ULL));
+
+        // pace samples over the wall clock time the simulation took for the frame, unless behind
+        bool behind;
+        {
+            std::lock_guard<std::mutex> lock(high_rate_mutex_);
+            behind = high_rate_quit_ || !high_rate_queue_.empty();
+        }
+        if (!behind)
+        {
+            double fraction = static_cast<double>(t - frame.timestamp) / static_cast<double>(next.timestamp - frame.timestamp);
+            std::this_thread::sleep_until(next.arrival +
+                                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                              std::chrono::duration<double>(fraction * wall_time)));
+        }
+
+        OutputHighRateSample();
+    }
+}
+
+void OSIReporter::OutputHighRateSample()
+{
+    high_rate_message_       = high_rate_static_;
+    unsigned int static_size = static_cast<unsigned int>(high_rate_message_.size());
+    high_rate_static_.clear();
+    high_rate_gt_.AppendToString(&high_rate_message_);
+
+    if (IsFileOpen())
+    {
+        WriteOSIFileMessage(high_rate_message_.data(),
+                            static_cast<unsigned int>(high_rate_message_.size()),
+                            static_size,
+                            high_rate_static_changed_,
+                            GetTimestampNanoseconds(high_rate_gt_.timestamp()),
+                            high_rate_frame_);
+    }
+
+    if (GetUDPClientStatus() == 0)
+    {
+        udp_frame_id_++;  // not touched by the engine thread while the high rate thread is running
+        if (!SendOSIUDPMessage(udp_client_, high_rate_message_.data(), static_cast<unsigned int>(high_rate_message_.size()), udp_frame_id_))
+        {
+            udp_frames_failed_++;
+        }
+    }
+
+    high_rate_n_samples_++;
+}
+
+void OSIReporter::WaitForHighRateOutput()
+{
+    std::unique_lock<std::mutex> lock(high_rate_mutex_);
+    high_rate_cv_.wait(lock, [this] { return high_rate_queue_.empty() && !high_rate_busy_; });
+}
+
+void OSIReporter::StopHighRateThread()
+{
+    if (high_rate_thread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(high_rate_mutex_);
+            high_rate_quit_ = true;
+        }
+        high_rate_cv_.notify_all();
+        high_rate_thread_.join();
+
+        LOG_INFO("OSI output at {:.1f} Hz: {} samples", 1e9 / static_cast<double>(high_rate_period_), high_rate_n_samples_);
+    }
+
+    high_rate_queue_.clear();
+    high_rate_free_.clear();
+    high_rate_n_samples_ = 0;
+}
+#endif
+
 void OSIReporter::SetStationaryModelReference(std::string model_reference)
 {
     // Check registered paths for model3d
@@ -3320,4 +4680,210 @@ void OSIReporter::UpdateEnvironmentPrecipitation(const double precipitation_inte
         obj_osi_internal.dynamic_gt->mutable_environmental_conditions()->set_precipitation(
             osi3::EnvironmentalConditions_Precipitation_PRECIPITATION_OTHER);
     }
-}
\ No newline at end of file
+}
+
+void OSIPolylineIndex::Clear()
+{
+    xy_.clear();
+    polylines_.clear();
+    cells_.clear();
+}
+
+uint64_t OSIPolylineIndex::CellKey(int64_t cx, int64_t cy) const
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+void OSIPolylineIndex::Add(int item, const std::vector<double> &xy)
+{
+    size_t n_points = xy.size() / 2;
+    if (n_points == 0)
+    {
+        return;
+    }
+
+    int index = static_cast<int>(polylines_.size());
+    polylines_.push_back({item, xy_.size() / 2, n_points});
+    xy_.insert(xy_.end(), xy.begin(), xy.begin() + static_cast<long>(2 * n_points));
+
+    // Register the cells of points sampled along each segment at half the cell size. Any point of the polyline is then
+    // within a quarter cell size from a registered point, which is the margin applied by Find().
+    double step = 0.5 * cell_size_;
+    for (size_t i = 0; i < n_points; i++)
+    {
+        double x0      = xy[2 * i];
+        double y0      = xy[2 * i + 1];
+        double dx      = i + 1 < n_points ? xy[2 * i + 2] - x0 : 0.0;
+        double dy      = i + 1 < n_points ? xy[2 * i + 3] - y0 : 0.0;
+        double len     = sqrt(dx * dx + dy * dy);
+        int    n_steps = static_cast<int>(len / step);
+
+        for (int j = 0; j <= n_steps; j++)
+        {
+            double            f    = n_steps > 0 ? j * step / len : 0.0;
+            std::vector<int> &cell = cells_[CellKey(Cell(x0 + f * dx), Cell(y0 + f * dy))];
+            if (cell.empty() || cell.back() != index)
+            {
+                cell.push_back(index);
+            }
+        }
+    }
+}
+
+bool OSIPolylineIndex::InRadius(const Polyline &polyline, double x, double y, double radius) const
+{
+    const double *p = &xy_[2 * polyline.first];
+
+    for (size_t i = 0; i < polyline.n; i++)
+    {
+        double dx = p[2 * i] - x;
+        double dy = p[2 * i + 1] - y;
+
+        if (dx * dx + dy * dy <= radius * radius)
+        {
+            return true;
+        }
+
+        if (i + 1 < polyline.n)
+        {
+            // closest point of the segment, if between its end points
+            double sx  = p[2 * i + 2] - p[2 * i];
+            double sy  = p[2 * i + 3] - p[2 * i + 1];
+            double len = sx * sx + sy * sy;
+            double t   = len > SMALL_NUMBER ? -(dx * sx + dy * sy) / len : 0.0;
+
+            if (t > 0.0 && t < 1.0 && pow(dx + t * sx, 2) + pow(dy + t * sy, 2) <= radius * radius)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void OSIPolylineIndex::GetCandidates(double x, double y, double radius, std::vector<int> &candidates) const
+{
+    double margin = 0.25 * cell_size_;
+
+    for (int64_t cx = Cell(x - radius - margin); cx <= Cell(x + radius + margin); cx++)
+    {
+        for (int64_t cy = Cell(y - radius - margin); cy <= Cell(y + radius + margin); cy++)
+        {
+            auto itr = cells_.find(CellKey(cx, cy));
+            if (itr != cells_.end())
+            {
+                candidates.insert(candidates.end(), itr->second.begin(), itr->second.end());
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+void OSIPolylineIndex::Find(double x, double y, double radius, std::vector<int> &result) const
+{
+    std::vector<int> candidates;
+
+    GetCandidates(x, y, radius, candidates);
+
+    for (int index : candidates)
+    {
+        if (InRadius(polylines_[static_cast<size_t>(index)], x, y, radius))
+        {
+            result.push_back(polylines_[static_cast<size_t>(index)].item);
+        }
+    }
+}
+
+static bool SegmentsIntersect(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+    // signed areas of each segment end point relative the other segment, touching counts as intersection
+    double d1 = (dx - cx) * (ay - cy) - (dy - cy) * (ax - cx);
+    double d2 = (dx - cx) * (by - cy) - (dy - cy) * (bx - cx);
+    double d3 = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    double d4 = (bx - ax) * (dy - ay) - (by - ay) * (dx - ax);
+
+    return ((d1 <= 0.0 && d2 >= 0.0) || (d1 >= 0.0 && d2 <= 0.0)) && ((d3 <= 0.0 && d4 >= 0.0) || (d3 >= 0.0 && d4 <= 0.0)) &&
+           !(d1 == 0.0 && d2 == 0.0);  // collinear segments not considered, covered by the end point checks
+}
+
+bool OSIPolylineIndex::InSector(const Polyline &polyline, double x, double y, double radius, double heading, double half_fov) const
+{
+    const double *p = &xy_[2 * polyline.first];
+
+    auto in_angle = [x, y, heading, half_fov](double px, double py)
+    {
+        double dx = px - x;
+        double dy = py - y;
+        return (fabs(dx) < SMALL_NUMBER && fabs(dy) < SMALL_NUMBER) || fabs(GetAngleDifference(atan2(dy, dx), heading)) <= half_fov;
+    };
+
+    // end points of the sector edges
+    double edge_x[2] = {x + radius * cos(heading - half_fov), x + radius * cos(heading + half_fov)};
+    double edge_y[2] = {y + radius * sin(heading - half_fov), y + radius * sin(heading + half_fov)};
+
+    // A segment passes through the sector if any end point is inside it, or if it crosses any of the edges or the arc
+    for (size_t i = 0; i < polyline.n; i++)
+    {
+        double px = p[2 * i];
+        double py = p[2 * i + 1];
+
+        if (pow(px - x, 2) + pow(py - y, 2) <= radius * radius && in_angle(px, py))
+        {
+            return true;
+        }
+
+        if (i + 1 < polyline.n)
+        {
+            double qx = p[2 * i + 2];
+            double qy = p[2 * i + 3];
+
+            for (int k = 0; k < 2; k++)
+            {
+                if (SegmentsIntersect(px, py, qx, qy, x, y, edge_x[k], edge_y[k]))
+                {
+                    return true;
+                }
+            }
+
+            // intersections with the circle, solving |p + t * (q - p) - center| = radius
+            double sx   = qx - px;
+            double sy   = qy - py;
+            double a    = sx * sx + sy * sy;
+            double b    = 2 * ((px - x) * sx + (py - y) * sy);
+            double c    = pow(px - x, 2) + pow(py - y, 2) - radius * radius;
+            double disc = b * b - 4 * a * c;
+
+            if (a > SMALL_NUMBER && disc >= 0.0)
+            {
+                for (double t : {(-b - sqrt(disc)) / (2 * a), (-b + sqrt(disc)) / (2 * a)})
+                {
+                    if (t >= 0.0 && t <= 1.0 && in_angle(px + t * sx, py + t * sy))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void OSIPolylineIndex::FindInSector(double x, double y, double radius, double heading, double fov, std::vector<int> &result) const
+{
+    std::vector<int> candidates;
+
+    GetCandidates(x, y, radius, candidates);
+
+    for (int index : candidates)
+    {
+        const Polyline &polyline = polylines_[static_cast<size_t>(index)];
+        if (fov >= 2 * M_PI ? InRadius(polyline, x, y, radius) : InSector(polyline, x, y, radius, heading, fov / 2))
+        {
+            result.push_back(polyline.item);
+        }
+    }
+}
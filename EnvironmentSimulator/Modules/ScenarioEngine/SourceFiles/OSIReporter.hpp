@@ -13,6 +13,8 @@
 #pragma once
 
 #include "UDP.hpp"
+#include "SharedMemory.hpp"
+#include "ChunkedTrace.hpp"
 #include "IdealSensor.hpp"
 #include "ScenarioGateway.hpp"
 #include "ScenarioEngine.hpp"
@@ -30,12 +32,96 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <deque>
+#include <chrono>
 #include <math.h>
 
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
 #define DEFAULT_OSI_TRACE_FILENAME "ground_truth.osi"
+#define OSI_UDP_FRAGMENT_SIZE      8192                            // default max payload of each UDP package
+#define OSI_UDP_MAX_FRAGMENT_SIZE  (65507 - sizeof(OSIUDPHeader))  // max UDP payload minus header
 
 using namespace scenarioengine;
 
+// Large OSI messages needs to be split for UDP transmission
+// Each package starts with this header, which must be matched on receiver side
+typedef struct
+{
+    int          counter;   // package number within the frame, starting at 1, negative for last package
+    unsigned int datasize;  // payload size of this package
+    unsigned int frame_id;  // incremented for each frame, used by receivers to detect incomplete frames
+} OSIUDPHeader;
+
+/**
+Uniform grid of polylines, e.g. center lines of OSI lanes and lane boundaries, for finding the ones passing within a
+radius of a point. Each polyline is registered in all grid cells it passes through.
+*/
+class OSIPolylineIndex
+{
+public:
+    OSIPolylineIndex(double cell_size = 100.0) : cell_size_(cell_size)
+    {
+    }
+
+    void Clear();
+
+    /**
+    Add a polyline. An item may consist of several polylines, e.g. the boundaries of a lane.
+    @param item Id of the item the polyline belongs to, e.g. index of a lane
+    @param xy Points of the polyline, as x and y coordinates in sequence
+    */
+    void Add(int item, const std::vector<double>& xy);
+
+    /**
+    Find items passing within given radius of a point
+    @param x Global x coordinate of center point
+    @param y Global y coordinate of center point
+    @param radius Radius (m)
+    @param result Found items, appended. An item may occur more than once.
+    */
+    void Find(double x, double y, double radius, std::vector<int>& result) const;
+
+    /**
+    Find items passing through a circular sector, e.g. the horizontal field of view of a sensor
+    @param x Global x coordinate of sector origin
+    @param y Global y coordinate of sector origin
+    @param radius Radius (m)
+    @param heading Global direction of sector center line (rad)
+    @param fov Opening angle of the sector (rad). Values of 2 * PI and above means full circle.
+    @param result Found items, appended. An item may occur more than once.
+    */
+    void FindInSector(double x, double y, double radius, double heading, double fov, std::vector<int>& result) const;
+
+private:
+    struct Polyline
+    {
+        int    item;
+        size_t first;  // index of first point in xy_
+        size_t n;      // number of points
+    };
+
+    uint64_t CellKey(int64_t cx, int64_t cy) const;
+    int64_t  Cell(double value) const
+    {
+        return static_cast<int64_t>(floor(value / cell_size_));
+    }
+    bool InRadius(const Polyline& polyline, double x, double y, double radius) const;
+    bool InSector(const Polyline& polyline, double x, double y, double radius, double heading, double half_fov) const;
+    void GetCandidates(double x, double y, double radius, std::vector<int>& candidates) const;
+
+    double                                         cell_size_;
+    std::vector<double>                            xy_;
+    std::vector<Polyline>                          polylines_;
+    std::unordered_map<uint64_t, std::vector<int>> cells_;  // polyline indices per cell
+};
+
 class OSIReporter
 {
 public:
@@ -62,6 +148,15 @@ public:
     */
     bool OpenOSIFile(const char* filename);
     /**
+    Write following OSI files as chunked trace files instead of plain sequence of messages. Frames are compressed in
+    chunks and indexed for random access, static ground truth is stored only once. Read with ChunkedTraceReader.
+    @param chunk_frames Number of frames per chunk, 0 for plain OSI trace file
+    */
+    void SetOSIFileChunked(unsigned int chunk_frames)
+    {
+        osi_chunk_frames_ = chunk_frames;
+    }
+    /**
     Closes any open osi file
     */
     void CloseOSIFile();
@@ -77,6 +172,25 @@ public:
     Decide how the static data should be handled during each frame
     */
     void SetOSIStaticReportMode(OSIStaticReportMode mode);
+
+    /**
+    Update moving objects of the dynamic ground truth in place, matched by id, instead of rebuilding all of them each
+    frame. Type, classification, dimensions and other descriptive fields are only set when the object first appears or
+    its description changes. Objects no longer reported, e.g. deleted or cropped out, are removed.
+    */
+    void SetOSIUpdateInPlace(bool value)
+    {
+        osi_in_place_ = value;
+    }
+
+    /**
+    Limit moving objects of file and UDP output to the ones that changed beyond given tolerance since they were last
+    output. All objects are output in the first frame and whenever objects are added or removed, so a receiver can keep
+    the latest state of each object. API and shared memory still provide complete ground truth. Implies in place update.
+    @param tolerance Max change of position (m), orientation (rad), velocity (m/s) and acceleration (m/s2) of an object
+    not being output, 0 to output any change. Negative value disables delta output.
+    */
+    void SetOSIDeltaOutput(double tolerance);
     /**
     Calls UpdateOSIStaticGroundTruth and UpdateOSIDynamicGroundTruth
     */
@@ -89,10 +203,28 @@ public:
     Fills up the osi message with dynamic GroundTruth
     */
     int UpdateOSIDynamicGroundTruth(const std::vector<std::unique_ptr<ObjectState>>& objectState);
+    /**
+    Position, orientation and outline of a stationary object from the OpenDRIVE description, prepared for the OSI message
+    */
+    typedef struct
+    {
+        double              position[3];
+        double              orientation[3];  // roll, pitch, yaw
+        double              height;          // of object, or average of outline corners
+        std::vector<double> base_polygon;    // outline corners, as local x and y in sequence
+    } StationaryObjectODRData;
+
     /**
     Fills up the osi message with Stationary Object from the OpenDRIVE description
+    @param object OpenDRIVE object
+    @param data Prepared data, see GetStationaryObjectODRData(). Set to nullptr to prepare it here.
     */
-    int UpdateOSIStationaryObjectODR(roadmanager::RMObject* object);
+    int UpdateOSIStationaryObjectODR(roadmanager::RMObject* object, const StationaryObjectODRData* data = nullptr);
+
+    /**
+    Prepare data of an OpenDRIVE object for the OSI message. Only reads the object, may be called from multiple threads.
+    */
+    static void GetStationaryObjectODRData(roadmanager::RMObject* object, StationaryObjectODRData& data);
     /**
     Fills up the osi message with Stationary Object
     */
@@ -101,10 +233,40 @@ public:
     Fills up the osi message with Host Vehicle data
     */
     int UpdateOSIHostVehicleData(ObjectState* objectState);
+    /**
+    Kinematic state of a moving object, prepared for the OSI message
+    */
+    typedef struct
+    {
+        double position[3];                  // center of bounding box, see SetOsiXYZ
+        double orientation[3];               // roll, pitch, yaw
+        double orientation_rate[3];          // roll, pitch, yaw
+        double orientation_acceleration[3];  // roll, pitch, yaw
+        double velocity[3];
+        double acceleration[3];
+        id_t   lane_id;  // global id of assigned lane
+    } MovingObjectData;
+
     /**
     Fills up the osi message with Moving Object
+    @param objectState State of the object
+    @param data Prepared data, see GetMovingObjectData(). Set to nullptr to prepare it here.
     */
-    int UpdateOSIMovingObject(ObjectState* objectState);
+    int UpdateOSIMovingObject(ObjectState* objectState, const MovingObjectData* data = nullptr);
+
+    /**
+    Prepare kinematic state of an object for the OSI message. Only reads the object state, may be called from multiple threads.
+    */
+    static void GetMovingObjectData(const ObjectState* objectState, MovingObjectData& data);
+
+    /**
+    Set number of threads preparing moving and stationary objects, including the calling one. 0 or 1 means serial.
+    The OSI messages are then filled in by the calling thread. Result does not depend on number of threads.
+    */
+    void SetNumberOfThreads(unsigned int n_threads)
+    {
+        object_pool_.SetNumberOfThreads(n_threads);
+    }
     /**
     Fills up the osi message with Lane Boundary
     */
@@ -130,6 +292,75 @@ public:
     */
     void CropOSIDynamicGroundTruth(const int id, const double radius);
 
+    /**
+    Crops lanes and lane boundaries of the static groundtruth to a circle around an object. Using the method repeatedly with
+    different object ids will crop around all objects specified. Setting the radius to 0 will remove the cropping for the object.
+    Lanes and boundaries entering or leaving the circles are tracked each update. Whenever the set changes, the static
+    groundtruth, holding the lanes and boundaries currently within radius, is again included in file and UDP output.
+    */
+    void CropOSIStaticGroundTruth(const int id, const double radius);
+
+    typedef struct
+    {
+        std::vector<id_t> lanes_entered;
+        std::vector<id_t> lanes_left;
+        std::vector<id_t> lane_boundaries_entered;
+        std::vector<id_t> lane_boundaries_left;
+    } StaticCropChanges;
+
+    /**
+    Get lanes and lane boundaries that entered or left the static crop circles in latest update
+    */
+    const StaticCropChanges& GetOSIStaticCropChanges() const
+    {
+        return static_crop_changes_;
+    }
+
+    /**
+    Set object sensors to generate OSI sensor views for, see SetOSISensorViews()
+    */
+    void SetSensors(std::vector<ObjectSensor*>* sensors)
+    {
+        sensors_ = sensors;
+    }
+
+    /**
+    Generate one osi3::SensorView per object sensor with each ground truth update. A view holds the host and the objects
+    detected by the sensor, plus the lanes and lane boundaries passing through the horizontal field of view of the sensor.
+    Views are independent and built in parallel. While an OSI file is open, each view is saved into a file of its own,
+    named as the OSI file with "_sensor_view_<sensor id>" added, and while OSI UDP output is active each view is sent to
+    a port of its own, OSI_SENSOR_VIEW_OUT_PORT + sensor id.
+    @param enable Generate sensor views or not
+    @param n_threads Number of threads, including the calling one. 0 means number of hardware threads.
+    */
+    void SetOSISensorViews(bool enable, unsigned int n_threads = 0);
+
+    /**
+    Build sensor views from current ground truth, unless already done. Called by UpdateOSIGroundTruth() when enabled,
+    else by the getters on request. Views are saved and sent only when enabled.
+    */
+    void UpdateOSISensorViews();
+
+    int GetNumberOfOSISensorViews() const
+    {
+        return static_cast<int>(sensor_views_.size());
+    }
+
+    /**
+    Get sensor view of a sensor, serialized
+    @param sensor_id Index of the sensor
+    @param size Set to the size of the serialized osi3::SensorView, 0 if not available
+    @return Pointer to serialized osi3::SensorView, nullptr if not available
+    */
+    const char* GetOSISensorView(int sensor_id, int* size);
+
+    /**
+    Get sensor view of a sensor
+    @param sensor_id Index of the sensor
+    @return Pointer to osi3::SensorView, nullptr if not available
+    */
+    const char* GetOSISensorViewRaw(int sensor_id);
+
     void ExcludeGhost()
     {
         report_ghost_ = false;
@@ -188,6 +419,27 @@ public:
     */
     int CreateSensorViewFromSensorData(const osi3::SensorData& sd);
 
+    /**
+    Serialized message, read-only and reference counted. Holders, e.g. API users in other threads, keep it intact
+    as long as they need, while subsequent updates produce new buffers.
+    */
+    typedef std::shared_ptr<const std::string> OSIBuffer;
+
+    /**
+    Get static part of the latest ground truth, cropped if enabled, serialized. Only serialized again when changed.
+    @param generation Set to the generation of the static part, increased each time it changes
+    @return Serialized osi3::GroundTruth, empty if ground truth not yet updated
+    */
+    OSIBuffer GetOSIStaticGroundTruthBuffer(unsigned long long& generation);
+
+    /**
+    Get dynamic part of the latest ground truth, serialized. Concatenated to the static part it makes the
+    complete ground truth message.
+    @param generation Set to the generation of the dynamic part, increased each update
+    @return Serialized osi3::GroundTruth, empty if ground truth not yet updated
+    */
+    OSIBuffer GetOSIDynamicGroundTruthBuffer(unsigned long long& generation);
+
     const char*       GetOSIGroundTruth(int* size);
     const char*       GetOSIGroundTruthRaw();
     const char*       GetOSITrafficCommandRaw();
@@ -196,20 +448,50 @@ public:
     void              GetOSILaneBoundaryIds(const std::vector<std::unique_ptr<ObjectState>>& objectState, std::vector<id_t>& ids, int object_id);
     const char*       GetOSISensorDataRaw();
     osi3::SensorView* GetSensorView();
-    void              CheckDynamicTypeAndUpdate(const std::unique_ptr<ObjectState>& objectState);
+    void              CheckDynamicTypeAndUpdate(const std::unique_ptr<ObjectState>& objectState, const MovingObjectData* data = nullptr);
     bool              IsCentralOSILane(int lane_idx);
     idx_t             GetLaneIdxfromIdOSI(id_t lane_id);
     osi3::Lane*       GetOSILaneFromGlobalId(id_t lane_global_id);
     SE_SOCKET         OpenSocket(std::string ipaddr);
+
+    /**
+    Publish ground truth in named shared memory, for consumers on the same host. Each message is serialized
+    directly into a slot of the shared memory ring, no fragmentation. See SharedMemoryReader for the receiving end.
+    @param name Name of the shared memory
+    @return 0 if successful, -1 if not
+    */
+    int OpenSharedMemory(std::string name);
     void              SerializeDynamicData();
     void              SerializeDynamicAndStaticData();
     int               GetUDPClientStatus()
     {
         return (udp_client_ ? udp_client_->GetStatus() : -1);
     }
+    /**
+    Set max payload size of each UDP package. Larger frames are split in multiple packages.
+    @param size Size in bytes, up to OSI_UDP_MAX_FRAGMENT_SIZE. Must be supported by the receiver, and preferably fit the network MTU.
+    @return 0 if successful, -1 if size out of range
+    */
+    int SetUDPFragmentSize(unsigned int size);
+
+    /**
+    Pace UDP packages to avoid bursts overflowing the receiver socket buffer
+    @param mbit_per_second Max average rate, in Mbit/s. 0 means no limit.
+    */
+    void SetUDPRateLimit(double mbit_per_second);
+
+    /**
+    Log number of frames and packages sent over UDP, amount of data and throughput
+    */
+    void PrintUDPStatistics() const;
+
+    int GetSharedMemoryStatus()
+    {
+        return (shm_writer_ ? shm_writer_->GetStatus() : -1);
+    }
     bool IsFileOpen() const
     {
-        return osi_file.is_open();
+        return osi_file.IsOpen() || osi_trace_.IsOpen();
     }
     void ReportSensors(std::vector<ObjectSensor*> sensor);
 
@@ -256,16 +538,157 @@ public:
     */
     int SetOSITimeStampExplicit(unsigned long long nanoseconds);
 
+    /**
+    Output ground truth to file and UDP at given rate, independent of the simulation step, e.g. 1000 Hz while the scenario
+    runs at 100 Hz. Samples are timestamped on a grid of the output period, relative the ground truth timestamp (see
+    SetOSITimeStampExplicit()), with moving objects interpolated between frames by their position and velocity.
+    Samples are output by a separate thread, paced to the progress of the simulation. Samples following a frame are output
+    when the next frame is reported, i.e. with one frame delay. Delta output does not apply. API and shared memory still
+    provide the ground truth of each frame.
+    @param rate Output rate (Hz), period rounded to whole nanoseconds. 0 outputs each OSI update, as by default.
+    @return 0 if successful, -1 if not supported
+    */
+    int SetOSIOutputRate(double rate);
+
 private:
     UDPClient*                          udp_client_;
+    std::string                         udp_ip_address_;
+    unsigned int                        udp_fragment_size_ = OSI_UDP_FRAGMENT_SIZE;
+    double                              udp_rate_limit_    = 0.0;  // Mbit/s
+    unsigned int                        udp_frame_id_      = 0;    // ground truth frames, by engine or high rate thread, never both
+    unsigned long long                  udp_frames_failed_ = 0;
+    std::vector<OSIUDPHeader>           udp_headers_;
+    std::vector<UDPClient::Datagram>    udp_datagrams_;
+    SharedMemoryWriter*                 shm_writer_;
     ScenarioEngine*                     scenario_engine_;
-    std::ofstream                       osi_file;
+    SE_AsyncFileWriter                  osi_file;
+    std::string                         osi_frame_;  // size and message of current frame, handed over to osi_file
+    std::string                         osi_filename_;
+    ChunkedTraceWriter                  osi_trace_;
+    unsigned int                        osi_chunk_frames_ = 0;
     int*                                osi_update_counter_ = nullptr;
     int                                 counter_offset_     = 0;
     int                                 osi_freq_           = 0;
     std::string                         stationary_model_reference;
+    void                                WriteOSISharedMemory(bool include_static);
+    void                                SendOSIUDP();
+    bool                                SendOSIUDPMessage(UDPClient* client, const char* data, unsigned int size, unsigned int frame_id);
     void                                CreateMovingObjectFromSensorData(const osi3::SensorData& sd, int obj_nr);
     void                                CreateLaneBoundaryFromSensordata(const osi3::SensorData& sd, int lane_boundary_nr);
+
+    struct MovingObjectEntry
+    {
+        int              index;       // position in the moving object list of dynamic ground truth
+        unsigned int     update;      // latest dynamic update including the object
+        ObjectInfoStruct info;        // description the descriptive fields were set from
+        double           output[12];  // position, velocity, acceleration and orientation at latest output
+    };
+
+    void UpdateOSIMovingObjectDescription(ObjectState* objectState);
+    void CheckMovingObjectChange(MovingObjectEntry& entry, bool force);
+    void RemoveStaleMovingObjects();
+    bool SwapInChangedMovingObjects();
+    void PrintDeltaStatistics() const;
+
+    bool                                                   osi_in_place_            = false;
+    double                                                 osi_delta_tolerance_     = -1.0;
+    unsigned int                                           moving_objects_update_   = 0;
+    bool                                                   moving_objects_modified_ = false;  // objects added or removed in latest update
+    std::unordered_map<int, MovingObjectEntry>             moving_objects_;                   // in place entries, by object id
+    std::vector<MovingObjectEntry*>                        changed_moving_objects_;           // beyond tolerance in latest update
+    google::protobuf::RepeatedPtrField<osi3::MovingObject> delta_moving_objects_;
+    unsigned long long                                     delta_n_objects_ = 0;  // moving object states in delta output mode
+    unsigned long long                                     delta_n_output_  = 0;  // of which output
+
+    osi3::GroundTruth* GetReportedStaticGroundTruth() const;
+    void               BuildStaticCropIndex();
+    bool               UpdateOSIStaticCrop(const std::vector<std::unique_ptr<ObjectState>>& objectState);
+
+    std::vector<std::pair<int, double>> osi_static_crop_;                // id, radius
+    osi3::GroundTruth*                  static_crop_gt_      = nullptr;  // static ground truth limited to lanes within radius
+    bool                                static_crop_changed_ = false;    // in latest update
+    OSIPolylineIndex                    static_crop_index_;              // lanes followed by lane boundaries, also used by sensor views
+    bool                                static_crop_index_built_ = false;
+    std::unordered_map<id_t, int>       static_crop_boundary_idx_;       // index of lane boundaries in static ground truth, by id
+    std::vector<int>                    static_crop_lanes_;              // sorted index of lanes currently within radius
+    std::vector<int>                    static_crop_boundaries_;         // sorted index of lane boundaries currently within radius
+    StaticCropChanges                   static_crop_changes_;
+
+    void BuildOSISensorView(size_t sensor_id);
+    void WriteOSISensorViewFiles();
+    void SendOSISensorViewsUDP();
+    void GetOSILanesAndBoundaries(const std::vector<int>& found, std::vector<int>& lanes, std::vector<int>& boundaries) const;
+
+    SE_WorkerPool                        object_pool_;
+    std::vector<MovingObjectData>        moving_object_data_;  // per object state, prepared in parallel
+    std::vector<roadmanager::RMObject*>  odr_objects_;
+    std::vector<StationaryObjectODRData> odr_object_data_;     // per OpenDRIVE object, prepared in parallel
+
+    std::vector<ObjectSensor*>*                      sensors_                 = nullptr;
+    bool                                             sensor_views_enabled_    = false;
+    unsigned long long                               sensor_views_generation_ = 0;  // dynamic generation the views were built from
+    std::vector<osi3::SensorView>                    sensor_views_;
+    std::vector<std::string>                         sensor_view_buffers_;  // serialized sensor views
+    std::unordered_map<int, int>                     sensor_view_objects_;  // index of moving objects in dynamic ground truth, by id
+    SE_WorkerPool                                    sensor_view_pool_;
+    std::vector<std::unique_ptr<SE_AsyncFileWriter>> sensor_view_files_;
+    std::vector<std::unique_ptr<UDPClient>>          sensor_view_udp_clients_;
+    unsigned int                                     sensor_view_udp_frame_id_ = 0;  // frame id of sensor view streams
+
+    OSIBuffer SerializeToBuffer(const osi3::GroundTruth& gt, std::shared_ptr<std::string>& buffer);
+
+    std::shared_ptr<std::string> static_buffer_;                              // reused unless held by someone else
+    std::shared_ptr<std::string> dynamic_buffer_;                             // reused unless held by someone else
+    unsigned long long           static_generation_         = 0;              // of static ground truth
+    unsigned long long           static_buffer_generation_  = 0;              // serialized into static_buffer_
+    unsigned long long           dynamic_generation_        = 0;              // of dynamic ground truth
+    unsigned long long           dynamic_buffer_generation_ = 0;              // serialized into dynamic_buffer_
+    idx_t                        road_lane_idx_             = IDX_UNDEFINED;  // lane serialized by GetOSIRoadLane
+    int                          road_lane_boundary_idx_    = -1;             // lane boundary serialized by GetOSIRoadLaneBoundary
+
+    bool WriteOSIFileMessage(const char*        data,
+                             unsigned int       size,
+                             unsigned int       static_size,
+                             bool               static_changed,
+                             unsigned long long timestamp,
+                             std::string&       frame);
+
+    unsigned long long high_rate_period_ = 0;  // ns, 0 = output each OSI update
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+    struct HighRateFrame
+    {
+        osi3::GroundTruth                     dynamic_gt;
+        std::string                           static_data;     // serialized static ground truth to include, empty if none
+        bool                                  static_changed;  // static data included due to changed crop
+        unsigned long long                    timestamp;       // of dynamic ground truth (ns)
+        std::chrono::steady_clock::time_point arrival;         // wall clock time the frame was reported
+    };
+
+    void QueueHighRateFrame(bool include_static);
+    void HighRateLoop();
+    void OutputHighRateSamples(const HighRateFrame& frame, const HighRateFrame& next);
+    void OutputHighRateSample();
+    void WaitForHighRateOutput();
+    void StopHighRateThread();
+
+    std::thread                                 high_rate_thread_;
+    std::mutex                                  high_rate_mutex_;
+    std::condition_variable                     high_rate_cv_;
+    std::deque<std::unique_ptr<HighRateFrame>>  high_rate_queue_;  // reported frames not yet taken by the thread
+    std::vector<std::unique_ptr<HighRateFrame>> high_rate_free_;   // output frames, reused to keep allocated memory
+    osi3::GroundTruth                           high_rate_gt_;          // current sample
+    std::string                                 high_rate_static_;      // static data not yet output
+    std::string                                 high_rate_message_;     // serialized sample
+    std::string                                 high_rate_frame_;       // size and message, handed over to osi_file
+    std::vector<int>                            high_rate_next_index_;  // index of each moving object in next frame, -1 if none
+    bool                                        high_rate_busy_           = false;
+    bool                                        high_rate_quit_           = false;
+    bool                                        high_rate_static_changed_ = false;
+    unsigned long long                          high_rate_n_samples_      = 0;
+    std::mutex                                  udp_mutex_;  // UDP sends by high rate thread and sensor views
+#endif
+
     bool                                osi_updated_        = false;
     bool                                osi_initialized_    = false;
     bool                                report_ghost_       = true;
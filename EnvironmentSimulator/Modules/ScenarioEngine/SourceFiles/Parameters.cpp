@@ -70,20 +70,33 @@ int Parameters::setParameter(std::string name, std::string value)
     return -1;
 }
 
-std::string Parameters::getParameter(std::string name)
+// Find value of named parameter, the name may or may not include the prefix. Returns nullptr if not found.
+static const std::string* FindParameterValue(const std::string& name)
 {
-    // If string already present in parameterDeclaration
+    const char* bare_name = (!name.empty() && name[0] == PARAMETER_PREFIX) ? name.c_str() + 1 : nullptr;
+
     const std::vector<OSCParameterDeclarations::ParameterStruct>& parameters = ScenarioReader::parameters.parameterDeclarations_.Parameter;
     for (size_t i = 0; i < parameters.size(); i++)
     {
-        if (PARAMETER_PREFIX + parameters[i].name == name ||  // parameter names should not include prefix
-            parameters[i].name == name)                       // But support also parameter name including prefix
+        if ((bare_name != nullptr && parameters[i].name == bare_name) ||  // parameter names should not include prefix
+            parameters[i].name == name)                                   // But support also parameter name including prefix
         {
-            return parameters[i].value._string;
+            return &parameters[i].value._string;
         }
     }
-    LOG_ERROR("Failed to resolve parameter {}", name);
-    throw std::runtime_error("Failed to resolve parameter");
+
+    return nullptr;
+}
+
+std::string Parameters::getParameter(std::string name)
+{
+    const std::string* value = FindParameterValue(name);
+    if (value == nullptr)
+    {
+        LOG_ERROR("Failed to resolve parameter {}", name);
+        throw std::runtime_error("Failed to resolve parameter");
+    }
+    return *value;
 }
 
 OSCParameterDeclarations::ParameterStruct* Parameters::getParameterEntry(std::string name)
@@ -377,7 +390,7 @@ int Parameters::setParameterValue(std::string name, bool value)
     return 0;
 }
 
-std::string Parameters::ResolveParametersInString(std::string str)
+std::string Parameters::ResolveParametersInStringRecursive(std::string str)
 {
     size_t found;
     while ((found = str.find("$")) != std::string::npos)
@@ -406,6 +419,141 @@ static void ReplaceStringInPlace(std::string& subject, const std::string& search
     }
 }
 
+void Parameters::CompileTemplate(const std::string& str, ParameterTemplate& tmpl)
+{
+    size_t start = 0;
+    size_t found;
+
+    tmpl.source_ = str;
+    tmpl.literal_.clear();
+    tmpl.param_.clear();
+
+    while ((found = str.find("$", start)) != std::string::npos)
+    {
+        size_t found_space = str.find_first_of(" ({)}-+*/%^!|&<>=,", found);
+        tmpl.literal_.push_back(str.substr(start, found - start));
+        tmpl.param_.push_back(str.substr(found, found_space == std::string::npos ? std::string::npos : found_space - found));
+        start = found_space == std::string::npos ? str.length() : found_space;
+    }
+    tmpl.literal_.push_back(str.substr(start));
+}
+
+std::string Parameters::ResolveTemplate(const ParameterTemplate& tmpl, const std::vector<const std::string*>& values)
+{
+    std::string str = tmpl.literal_[0];
+
+    for (size_t i = 0; i < tmpl.param_.size(); i++)
+    {
+        if (values[i]->find('$') != std::string::npos)
+        {
+            // parameter value referring other parameters, resolve step by step
+            return ResolveParametersInStringRecursive(tmpl.source_);
+        }
+        str += *values[i];
+        str += tmpl.literal_[i + 1];
+    }
+
+    return str;
+}
+
+std::string Parameters::ResolveParametersInString(std::string str)
+{
+    if (str.find('$') == std::string::npos)
+    {
+        return str;
+    }
+
+    auto it = template_cache_.find(str);
+    if (it == template_cache_.end())
+    {
+        it = template_cache_.emplace(str, ParameterTemplate()).first;
+        CompileTemplate(str, it->second);
+    }
+
+    std::vector<const std::string*> values(it->second.param_.size());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if ((values[i] = FindParameterValue(it->second.param_[i])) == nullptr)
+        {
+            getParameter(it->second.param_[i]);  // report and throw
+        }
+    }
+
+    return ResolveTemplate(it->second, values);
+}
+
+std::string Parameters::EvaluateExpression(const char* attr_value, const std::string& expr_str)
+{
+    auto it = expression_cache_.find(expr_str);
+    if (it == expression_cache_.end())
+    {
+        it = expression_cache_.emplace(expr_str, CompiledExpression()).first;
+        CompileTemplate(expr_str, it->second.template_);
+    }
+    CompiledExpression& compiled = it->second;
+
+    // look up current value of input parameters, re-evaluate only on any change
+    // values referring other parameters depend on more than the direct inputs, always re-evaluate those
+    bool                            changed = !compiled.evaluated_;
+    std::vector<const std::string*> values(compiled.template_.param_.size());
+    compiled.input_.resize(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if ((values[i] = FindParameterValue(compiled.template_.param_[i])) == nullptr)
+        {
+            compiled.evaluated_ = false;
+            getParameter(compiled.template_.param_[i]);  // report and throw
+        }
+        if (values[i]->find('$') != std::string::npos)
+        {
+            changed = true;
+        }
+        if (*values[i] != compiled.input_[i])
+        {
+            compiled.input_[i] = *values[i];
+            changed            = true;
+        }
+    }
+
+    if (!changed)
+    {
+        return compiled.result_;
+    }
+
+    std::string expr = ResolveTemplate(compiled.template_, values);  // replace parameters by their values
+
+    // Convert from OpenSCENARIO 1.1 operator names to expr op names
+    ReplaceStringInPlace(expr, "not ", "!");
+    ReplaceStringInPlace(expr, "not(", "!(");
+    ReplaceStringInPlace(expr, "and ", "&& ");
+    ReplaceStringInPlace(expr, "or ", "|| ");
+    ReplaceStringInPlace(expr, "true ", "1 ");
+    ReplaceStringInPlace(expr, "false ", "0 ");
+
+    ExprReturnStruct rs = eval_expr(expr.c_str());
+    if (rs.type == EXPR_RETURN_UNDEFINED && isnan(rs._double))
+    {
+        compiled.evaluated_ = false;
+        LOG_ERROR_AND_QUIT("Failed to evaluate the expression : {}\n", attr_value);
+    }
+
+    compiled.result_.clear();
+    if (rs.type == EXPR_RETURN_DOUBLE)
+    {
+        LOG_INFO("Expr {} = {} = {:.10f}", attr_value, expr, rs._double);
+        compiled.result_ = std::to_string(rs._double);
+    }
+    else if (rs.type == EXPR_RETURN_STRING)
+    {
+        LOG_INFO("Expr {} = {} = {}", attr_value, expr, rs._string.string);
+        compiled.result_ = rs._string.string;
+    }
+    clear_expr_result(&rs);
+    compiled.evaluated_ = true;
+
+    return compiled.result_;
+}
+
 // std::string ReadAttributeFrom
 
 std::string Parameters::ReadAttribute(pugi::xml_node node, std::string attribute_name, bool required)
@@ -434,34 +582,8 @@ std::string Parameters::ReadAttribute(pugi::xml_node node, std::string attribute
                 std::size_t found = expr.find('}', 2);
                 if (found != std::string::npos)
                 {
-                    expr = expr.substr(2, found - 2);        // trim to bare expression, exclude '{' and '}'
-                    expr = ResolveParametersInString(expr);  // replace parameters by their values
-
-                    // Convert from OpenSCENARIO 1.1 operator names to expr op names
-                    ReplaceStringInPlace(expr, "not ", "!");
-                    ReplaceStringInPlace(expr, "not(", "!(");
-                    ReplaceStringInPlace(expr, "and ", "&& ");
-                    ReplaceStringInPlace(expr, "or ", "|| ");
-                    ReplaceStringInPlace(expr, "true ", "1 ");
-                    ReplaceStringInPlace(expr, "false ", "0 ");
-
-                    ExprReturnStruct rs = eval_expr(expr.c_str());
-                    if (rs.type == EXPR_RETURN_UNDEFINED && isnan(rs._double))
-                    {
-                        LOG_ERROR_AND_QUIT("Failed to evaluate the expression : {}\n", attr.value());
-                    }
-
-                    if (rs.type == EXPR_RETURN_DOUBLE)
-                    {
-                        LOG_INFO("Expr {} = {} = {:.10f}", attr.value(), expr, rs._double);
-                        return_value = std::to_string(rs._double);
-                    }
-                    else if (rs.type == EXPR_RETURN_STRING)
-                    {
-                        LOG_INFO("Expr {} = {} = {}", attr.value(), expr, rs._string.string);
-                        return_value = rs._string.string;
-                    }
-                    clear_expr_result(&rs);
+                    // trim to bare expression, exclude '{' and '}'
+                    return_value = EvaluateExpression(attr.value(), expr.substr(2, found - 2));
                 }
                 else
                 {
@@ -582,8 +704,15 @@ void Parameters::parseParameterDeclarations(pugi::xml_node declarationsNode, OSC
     }
 }
 
+void Parameters::ClearCache()
+{
+    template_cache_.clear();
+    expression_cache_.clear();
+}
+
 void Parameters::Clear()
 {
+    ClearCache();
     parameterDeclarations_.Parameter.clear();
     while (!paramDeclarationsSize_.empty())
     {
@@ -602,6 +731,48 @@ void Parameters::Print(std::string typestr)
     }
 }
 
+void Parameters::SaveState(SE_StateStream& stream)
+{
+    stream.Write(static_cast<uint32_t>(parameterDeclarations_.Parameter.size()));
+    for (auto& p : parameterDeclarations_.Parameter)
+    {
+        stream.WriteString(p.name);
+        stream.Write(p.value._int);
+        stream.Write(p.value._double);
+        stream.WriteString(p.value._string);
+        stream.Write(p.value._bool);
+        stream.Write(p.dirty);
+    }
+}
+
+int Parameters::RestoreState(SE_StateStream& stream)
+{
+    uint32_t n_params = 0;
+    stream.Read(n_params);
+
+    for (uint32_t i = 0; i < n_params && stream.Good(); i++)
+    {
+        OSCParameterDeclarations::ParameterStruct tmp;
+        stream.ReadString(tmp.name);
+        stream.Read(tmp.value._int);
+        stream.Read(tmp.value._double);
+        stream.ReadString(tmp.value._string);
+        stream.Read(tmp.value._bool);
+        stream.Read(tmp.dirty);
+
+        OSCParameterDeclarations::ParameterStruct* p = getParameterEntry(tmp.name);
+        if (p == nullptr)
+        {
+            LOG_ERROR("Restore state: Parameter {} not declared", tmp.name);
+            return -1;
+        }
+        p->value = tmp.value;
+        p->dirty = tmp.dirty;
+    }
+
+    return stream.Good() ? 0 : -1;
+}
+
 // bool Parameters::CheckAttribute(pugi::xml_node node, std::string attribute_name)
 // {
 // 	bool check = ReadAttribute(node, attribute_name);
@@ -15,8 +15,10 @@
 #include <string.h>
 #include "pugixml.hpp"
 #include "OSCParameterDeclarations.hpp"
+#include "CommonMini.hpp"
 #include <vector>
 #include <stack>
+#include <unordered_map>
 
 namespace scenarioengine
 {
@@ -70,5 +72,40 @@ namespace scenarioengine
 
         // Log current set of parameter names and values
         void Print(std::string typestr);
+
+        // Drop cached templates and expression results, e.g. on new scenario
+        void ClearCache();
+
+        // Serialize current values of all declared parameters, identified by name
+        void SaveState(SE_StateStream& stream);
+
+        // Restore values previously stored by SaveState(). Returns 0 on success, -1 on error (e.g. unknown parameter)
+        int RestoreState(SE_StateStream& stream);
+
+    private:
+        // String with parameter references split into literal text and parameter names, e.g. "$a + 1" -> {"", " + 1"}, {"$a"}
+        struct ParameterTemplate
+        {
+            std::string              source_;
+            std::vector<std::string> literal_;  // text preceding each parameter reference, last entry is trailing text
+            std::vector<std::string> param_;    // referenced parameter names, including prefix
+        };
+
+        // Expression is evaluated again only when any of its input parameter values has changed
+        struct CompiledExpression
+        {
+            ParameterTemplate        template_;
+            std::vector<std::string> input_;  // parameter values at latest evaluation
+            std::string              result_;
+            bool                     evaluated_ = false;
+        };
+
+        std::unordered_map<std::string, ParameterTemplate>  template_cache_;
+        std::unordered_map<std::string, CompiledExpression> expression_cache_;
+
+        static void CompileTemplate(const std::string& str, ParameterTemplate& tmpl);
+        std::string ResolveTemplate(const ParameterTemplate& tmpl, const std::vector<const std::string*>& values);
+        std::string ResolveParametersInStringRecursive(std::string str);
+        std::string EvaluateExpression(const char* attr_value, const std::string& expr);
     };
 }  // namespace scenarioengine
\ No newline at end of file
@@ -18,6 +18,7 @@
 #include "ControllerFollowRoute.hpp"
 #include "Entities.hpp"
 #include "OSCParameterDistribution.hpp"
+#include <sstream>
 
 #define WHEEL_RADIUS          0.35
 #define STAND_STILL_THRESHOLD 1e-3  // meter per second
@@ -58,6 +59,13 @@ void ScenarioEngine::InitScenarioCommon(bool disable_controllers)
     txtLogger.SetLoggerTime(GetSimulationTimePtr());
     SE_Env::Inst().SetGhostMode(GhostMode::NORMAL);
     SE_Env::Inst().SetGhostHeadstart(0.0);
+
+    controller_threads_ = 0;
+    if (SE_Env::Inst().GetOptions().GetOptionSet("controller_threads"))
+    {
+        controller_threads_ = static_cast<unsigned int>(MAX(0, strtoi(SE_Env::Inst().GetOptions().GetOptionArg("controller_threads"))));
+    }
+    controller_pool_.SetNumberOfThreads(MAX(1U, controller_threads_));
 }
 
 int ScenarioEngine::InitScenario(std::string oscFilename, bool disable_controllers)
@@ -424,31 +432,27 @@ int ScenarioEngine::step(double deltaSimTime)
         else
         {
             // Object not reported yet, do that
-            scenarioGateway.reportObject(obj->id_,
-                                         obj->name_,
-                                         static_cast<int>(obj->type_),
-                                         obj->category_,
-                                         obj->role_,
-                                         obj->model_id_,
-                                         obj->model3d_,
-                                         obj->GetControllerTypeActiveOnDomain(ControlDomains::DOMAIN_LONG),
-                                         obj->boundingbox_,
-                                         static_cast<int>(obj->scaleMode_),
-                                         obj->visibilityMask_,
-                                         simulationTime_,
-                                         obj->speed_,
-                                         obj->wheel_angle_,
-                                         obj->wheel_rot_,
-                                         obj->rear_axle_.positionZ,
-                                         obj->front_axle_.positionX,
-                                         obj->front_axle_.positionZ,
-                                         &obj->pos_);
-
-            if (obj->type_ == Object::Type::VEHICLE)
+            ReportObjectToGateway(obj);
+        }
+    }
+
+    // Index entities once for neighbor queries by controllers, instead of each controller checking all others
+    entities_.UpdateNeighborIndex();
+
+    if (SE_Env::Inst().GetGhostMode() != GhostMode::RESTARTING)
+    {
+        // Perception phase of all active controllers, in parallel if controller threads are specified. No entity state
+        // is modified during this phase, so all controllers see the same state of previous frame regardless of number
+        // of threads and order. The phase is always completed before any controller is stepped.
+        active_controllers_.clear();
+        for (size_t i = 0; i < scenarioReader->controller_.size(); i++)
+        {
+            if (scenarioReader->controller_[i]->Active())
             {
-                scenarioGateway.updateObjectWheelData(obj->id_, static_cast<Vehicle*>(obj)->GetWheelData());
+                active_controllers_.push_back(scenarioReader->controller_[i]);
             }
         }
+        controller_pool_.Run(active_controllers_.size(), [this, deltaSimTime](size_t i) { active_controllers_[i]->Prepare(deltaSimTime); });
     }
 
     for (size_t i = 0; i < scenarioReader->controller_.size(); i++)
@@ -762,12 +766,18 @@ int ScenarioEngine::defaultController(Object* obj, double dt)
 
 void ScenarioEngine::prepareGroundTruth(double dt)
 {
+    EntityStateBlock& state = entities_.state_block_;
+    state.Resize(entities_.object_.size());
+    gateway_states_.resize(entities_.object_.size());
+
     for (size_t i = 0; i < entities_.object_.size(); i++)
     {
         // Fetch external states from gateway
         Object*      obj = entities_.object_[i];
         ObjectState* o   = scenarioGateway.getObjectStatePtrById(obj->id_);
 
+        gateway_states_[i] = o;
+
         if (o == nullptr)
         {
             LOG_WARN("Gateway did not provide state for external car {}", obj->id_);
@@ -806,58 +816,47 @@ void ScenarioEngine::prepareGroundTruth(double dt)
             }
         }
 
-        // Calculate resulting updated velocity, acceleration and heading rate (rad/s) NOTE: in global coordinate sys
-        double dx = obj->pos_.GetX() - obj->state_old.pos_x;
-        double dy = obj->pos_.GetY() - obj->state_old.pos_y;
-        double dz = obj->pos_.GetZ() - obj->state_old.pos_z;
-
-        if (frame_nr_ == 1 || (obj->IsGhost() && SE_Env::Inst().GetGhostMode() != GhostMode::RESTART) ||
-            (!obj->IsGhost() && SE_Env::Inst().GetGhostMode() != GhostMode::RESTARTING))
-        {
-            if (dt > SMALL_NUMBER)
-            {
-                // If velocity has not been reported, calculate it based on movement
-                if (!obj->CheckDirtyBits(Object::DirtyBit::VELOCITY))
-                {
-                    if (obj->CheckDirtyBits(Object::DirtyBit::TELEPORT))
-                    {
-                        // if teleport occured, calculate approximated velocity vector based on current heading
-                        obj->SetVel(obj->speed_ * cos(obj->pos_.GetH()), obj->speed_ * sin(obj->pos_.GetH()), 0.0);
-                    }
-                    else
-                    {
-                        // calculate linear velocity
-                        obj->SetVel(dx / dt, dy / dt, dz / dt);
-                    }
-                }
+        state.Set(i, obj);
+        state.update_[i] = (frame_nr_ == 1 || (obj->IsGhost() && SE_Env::Inst().GetGhostMode() != GhostMode::RESTART) ||
+                            (!obj->IsGhost() && SE_Env::Inst().GetGhostMode() != GhostMode::RESTARTING));
+    }
 
-                // If speed has not been reported or set by any controller, calculate it based on velocity
-                if (!obj->CheckDirtyBits(Object::DirtyBit::SPEED))
-                {
-                    obj->SetSpeed(GetLengthOfVector2D(obj->pos_.GetVelX(), obj->pos_.GetVelY()));
-                }
+    // Calculate resulting updated velocity, acceleration and heading rate (rad/s) NOTE: in global coordinate sys
+    state.UpdateKinematics(dt);
 
-                if (!obj->CheckDirtyBits(Object::DirtyBit::ACCELERATION))
-                {
-                    // If not already reported, calculate linear acceleration
-                    obj->SetAcc((obj->pos_.GetVelX() - obj->state_old.vel_x) / dt,
-                                (obj->pos_.GetVelY() - obj->state_old.vel_y) / dt,
-                                (obj->pos_.GetVelZ() - obj->state_old.vel_z) / dt);
-                }
+    for (size_t i = 0; i < entities_.object_.size(); i++)
+    {
+        Object*      obj = entities_.object_[i];
+        ObjectState* o   = gateway_states_[i];
 
-                double heading_diff     = GetAngleDifference(obj->pos_.GetH(), obj->state_old.h);
-                double heading_rate_new = heading_diff / dt;
-                if (!obj->CheckDirtyBits(Object::DirtyBit::ANGULAR_RATE))
-                {
-                    // If not already reported, calculate angular velocity/rate
-                    obj->SetAngularVel(heading_rate_new, 0.0, 0.0);
-                }
+        if (state.update_[i])
+        {
+            // Apply calculated values, i.e. the ones not reported
+            int calculated = state.dirty_[i] & ~obj->GetDirtyBitMask();
+            if (calculated & Object::DirtyBit::VELOCITY)
+            {
+                obj->SetVel(state.vel_x_[i], state.vel_y_[i], state.vel_z_[i]);
+            }
+            if (calculated & Object::DirtyBit::SPEED)
+            {
+                obj->SetSpeed(state.speed_[i]);
+            }
+            if (calculated & Object::DirtyBit::ACCELERATION)
+            {
+                obj->SetAcc(state.acc_x_[i], state.acc_y_[i], state.acc_z_[i]);
+            }
+            if (calculated & Object::DirtyBit::ANGULAR_RATE)
+            {
+                obj->SetAngularVel(state.h_rate_[i], 0.0, 0.0);
+            }
+            if (calculated & Object::DirtyBit::ANGULAR_ACC)
+            {
+                obj->SetAngularAcc(state.h_acc_[i], 0.0, 0.0);
+            }
 
-                if (!obj->CheckDirtyBits(Object::DirtyBit::ANGULAR_ACC))
-                {
-                    // If not already reported, calculate angular acceleration
-                    obj->SetAngularAcc(GetAngleDifference(heading_rate_new, obj->state_old.h_rate) / dt, 0.0, 0.0);
-                }
+            if (dt > SMALL_NUMBER)
+            {
+                double heading_rate_new = state.h_rate_new_[i];
 
                 // Update wheel rotations of internal scenario objects
                 if (!obj->CheckDirtyBits(Object::DirtyBit::WHEEL_ANGLE))
@@ -879,29 +878,20 @@ void ScenarioEngine::prepareGroundTruth(double dt)
                     obj->SetDirtyBits(Object::DirtyBit::WHEEL_ROTATION);
                 }
             }
-            else
-            {
-                // calculate approximated velocity vector based on current heading
-                if (!obj->CheckDirtyBits(Object::DirtyBit::VELOCITY))
-                {
-                    // If not already reported, calculate approximated velocity vector based on current heading
-                    obj->SetVel(obj->speed_ * cos(obj->pos_.GetH()), obj->speed_ * sin(obj->pos_.GetH()), 0.0);
-                }
-            }
 
             // store current values for next loop
-            obj->state_old.pos_x  = obj->pos_.GetX();
-            obj->state_old.pos_y  = obj->pos_.GetY();
-            obj->state_old.pos_z  = obj->pos_.GetZ();
-            obj->state_old.vel_x  = obj->pos_.GetVelX();
-            obj->state_old.vel_y  = obj->pos_.GetVelY();
-            obj->state_old.vel_z  = obj->pos_.GetVelZ();
-            obj->state_old.h      = obj->pos_.GetH();
-            obj->state_old.h_rate = obj->pos_.GetHRate();
+            obj->state_old.pos_x  = state.x_old_[i];
+            obj->state_old.pos_y  = state.y_old_[i];
+            obj->state_old.pos_z  = state.z_old_[i];
+            obj->state_old.vel_x  = state.vel_x_old_[i];
+            obj->state_old.vel_y  = state.vel_y_old_[i];
+            obj->state_old.vel_z  = state.vel_z_old_[i];
+            obj->state_old.h      = state.h_old_[i];
+            obj->state_old.h_rate = state.h_rate_old_[i];
 
             if (!obj->reset_)
             {
-                obj->odometer_ += abs(sqrt(dx * dx + dy * dy));  // odometer always measure all movements as positive, I guess...
+                obj->odometer_ += state.dist_[i];
             }
 
             if (!(obj->IsGhost() && SE_Env::Inst().GetGhostMode() == GhostMode::RESTART))  // skip ghost sample during restart
@@ -933,6 +923,13 @@ void ScenarioEngine::prepareGroundTruth(double dt)
                                                0.0,
                                                roadmanager::Position::PosMode::H_REL,
                                                0.0});
+
+                        if (SE_Env::Inst().GetTrailHorizon() > 0.0)
+                        {
+                            // keep what ghost followers might look for, i.e. the headstart time in addition to the horizon
+                            obj->trail_.DiscardVerticesBefore(simulationTime_ - SE_Env::Inst().GetTrailHorizon() -
+                                                              SE_Env::Inst().GetGhostHeadstart());
+                        }
                     }
                 }
             }
@@ -1217,6 +1214,317 @@ void ScenarioEngine::SetupGhost(Object* object)
         }
     }
 }
+
+void ScenarioEngine::ReportObjectToGateway(Object* obj)
+{
+    scenarioGateway.reportObject(obj->id_,
+                                 obj->name_,
+                                 static_cast<int>(obj->type_),
+                                 obj->category_,
+                                 obj->role_,
+                                 obj->model_id_,
+                                 obj->model3d_,
+                                 obj->GetControllerTypeActiveOnDomain(ControlDomains::DOMAIN_LONG),
+                                 obj->boundingbox_,
+                                 static_cast<int>(obj->scaleMode_),
+                                 obj->visibilityMask_,
+                                 simulationTime_,
+                                 obj->speed_,
+                                 obj->wheel_angle_,
+                                 obj->wheel_rot_,
+                                 obj->rear_axle_.positionZ,
+                                 obj->front_axle_.positionX,
+                                 obj->front_axle_.positionZ,
+                                 &obj->pos_);
+
+    if (obj->type_ == Object::Type::VEHICLE)
+    {
+        scenarioGateway.updateObjectWheelData(obj->id_, static_cast<Vehicle*>(obj)->GetWheelData());
+    }
+}
+
+#define STATE_STREAM_MAGIC   0x45534D53  // "SMSE"
+#define STATE_STREAM_VERSION 3           // increase on any change of the stream format, e.g. 3 added trail start time
+
+void ScenarioEngine::SaveState(SE_StateStream& stream)
+{
+    stream.Write(static_cast<uint32_t>(STATE_STREAM_MAGIC));
+    stream.Write(static_cast<uint32_t>(STATE_STREAM_VERSION));
+    stream.WriteString(getScenarioFilename());
+
+    // time and global settings
+    stream.Write(simulationTime_);
+    stream.Write(trueTime_);
+    stream.Write(frame_nr_);
+    stream.Write(SE_Env::Inst().GetGhostMode());
+    stream.Write(SE_Env::Inst().GetGhostHeadstart());
+
+    // random number generator, mt19937 state is portable via its stream representation
+    std::ostringstream rand_state;
+    rand_state << SE_Env::Inst().GetRand().GetGenerator();
+    stream.Write(SE_Env::Inst().GetRand().GetSeed());
+    stream.WriteString(rand_state.str());
+
+    // parameters and variables
+    scenarioReader->parameters.SaveState(stream);
+    scenarioReader->variables.SaveState(stream);
+
+    // entities
+    entities_.SaveState(stream);
+
+    // controllers, including object assignments by index
+    stream.Write(static_cast<uint32_t>(scenarioReader->controller_.size()));
+    for (auto ctrl : scenarioReader->controller_)
+    {
+        stream.Write(ctrl->GetLinkedObject() ? ctrl->GetLinkedObject()->GetId() : -1);
+        ctrl->SaveState(stream);
+    }
+
+    for (auto obj_list : {&entities_.object_, &entities_.object_pool_})
+    {
+        for (auto obj : *obj_list)
+        {
+            stream.Write(static_cast<uint32_t>(obj->controllers_.size()));
+            for (auto ctrl : obj->controllers_)
+            {
+                auto it = std::find(scenarioReader->controller_.begin(), scenarioReader->controller_.end(), ctrl);
+                stream.Write(static_cast<int>(it == scenarioReader->controller_.end() ? -1 : it - scenarioReader->controller_.begin()));
+            }
+        }
+    }
+
+    // distance cache
+    stream.Write(static_cast<uint32_t>(object_distance_map_.size()));
+    for (auto& entry : object_distance_map_)
+    {
+        stream.Write(entry.first);
+        stream.Write(entry.second);
+    }
+
+    // storyboard, starting with init actions
+    for (auto action : storyBoard.init_.private_action_)
+    {
+        action->SaveState(stream);
+    }
+    for (auto action : storyBoard.init_.global_action_)
+    {
+        action->SaveState(stream);
+    }
+    for (auto action : storyBoard.init_.user_defined_action_)
+    {
+        action->SaveState(stream);
+    }
+    storyBoard.SaveState(stream);
+}
+
+int ScenarioEngine::ReadStateHeader(SE_StateStream& stream)
+{
+    uint32_t    magic   = 0;
+    uint32_t    version = 0;
+    std::string filename;
+
+    stream.Read(magic);
+    stream.Read(version);
+    stream.ReadString(filename);
+
+    if (!stream.Good() || magic != STATE_STREAM_MAGIC || version != STATE_STREAM_VERSION)
+    {
+        LOG_ERROR("Restore state: Unknown or unsupported state format");
+        return -1;
+    }
+
+    if (filename != getScenarioFilename())
+    {
+        LOG_ERROR("Restore state: State of scenario {} can't be applied to {}", filename, getScenarioFilename());
+        return -1;
+    }
+
+    return 0;
+}
+
+int ScenarioEngine::RestoreState(SE_StateStream& stream)
+{
+    if (ReadStateHeader(stream) != 0)
+    {
+        return -1;
+    }
+
+    // register currently active objects, to find out which ones needs to be removed from the gateway
+    std::vector<Object*> active_before = entities_.object_;
+
+    // State is restored in place. Save current state first, to roll back to in case the stream turns out to be
+    // corrupt or incompatible half way through. So either all of the state is restored or none of it.
+    SE_StateStream backup;
+    SaveState(backup);
+    ReadStateHeader(backup);
+
+    int retval = RestoreStateData(stream);
+    if (retval != 0)
+    {
+        LOG_ERROR("Restore state: Failed, rolling back to state before restore");
+        if (RestoreStateData(backup) != 0)
+        {
+            LOG_ERROR("Restore state: Failed to roll back");
+        }
+    }
+
+    SyncGatewayWithObjects(active_before);
+
+    return retval;
+}
+
+int ScenarioEngine::RestoreStateData(SE_StateStream& stream)
+{
+    stream.Read(simulationTime_);
+    stream.Read(trueTime_);
+    stream.Read(frame_nr_);
+
+    GhostMode ghost_mode      = GhostMode::NORMAL;
+    double    ghost_headstart = 0.0;
+    stream.Read(ghost_mode);
+    stream.Read(ghost_headstart);
+    SE_Env::Inst().SetGhostMode(ghost_mode);
+    SE_Env::Inst().SetGhostHeadstart(ghost_headstart);
+
+    unsigned int seed = 0;
+    std::string  rand_str;
+    stream.Read(seed);
+    stream.ReadString(rand_str);
+    SE_Env::Inst().GetRand().SetSeed(seed);
+    std::istringstream rand_state(rand_str);
+    rand_state >> SE_Env::Inst().GetRand().GetGenerator();
+
+    if (scenarioReader->parameters.RestoreState(stream) != 0 || scenarioReader->variables.RestoreState(stream) != 0)
+    {
+        LOG_ERROR("Restore state: Failed to restore parameters or variables");
+        return -1;
+    }
+
+    if (entities_.RestoreState(stream) != 0)
+    {
+        return -1;
+    }
+
+    uint32_t n_controllers = 0;
+    stream.Read(n_controllers);
+    if (n_controllers != scenarioReader->controller_.size())
+    {
+        LOG_ERROR("Restore state: Controller count mismatch ({} vs {})", n_controllers, scenarioReader->controller_.size());
+        return -1;
+    }
+
+    for (auto ctrl : scenarioReader->controller_)
+    {
+        int obj_id = -1;
+        stream.Read(obj_id);
+        if (obj_id < 0)
+        {
+            ctrl->UnlinkObject();
+        }
+        else
+        {
+            ctrl->LinkObject(entities_.GetObjectById(obj_id));
+        }
+
+        if (ctrl->RestoreState(stream) != 0)
+        {
+            LOG_ERROR("Restore state: Failed to restore controller {}", ctrl->GetName());
+            return -1;
+        }
+    }
+
+    for (auto obj_list : {&entities_.object_, &entities_.object_pool_})
+    {
+        for (auto obj : *obj_list)
+        {
+            uint32_t n_obj_controllers = 0;
+            stream.Read(n_obj_controllers);
+            obj->controllers_.clear();
+            for (uint32_t i = 0; i < n_obj_controllers && stream.Good(); i++)
+            {
+                int ctrl_idx = -1;
+                stream.Read(ctrl_idx);
+                if (ctrl_idx >= 0 && ctrl_idx < static_cast<int>(scenarioReader->controller_.size()))
+                {
+                    obj->controllers_.push_back(scenarioReader->controller_[static_cast<unsigned int>(ctrl_idx)]);
+                }
+            }
+        }
+    }
+
+    uint32_t n_distances = 0;
+    stream.Read(n_distances);
+    object_distance_map_.clear();
+    for (uint32_t i = 0; i < n_distances && stream.Good(); i++)
+    {
+        uint64_t      key = 0;
+        DistanceEntry entry;
+        stream.Read(key);
+        stream.Read(entry);
+        object_distance_map_[key] = entry;
+    }
+
+    for (auto action : storyBoard.init_.private_action_)
+    {
+        if (action->RestoreState(stream) != 0)
+        {
+            return -1;
+        }
+    }
+    for (auto action : storyBoard.init_.global_action_)
+    {
+        if (action->RestoreState(stream) != 0)
+        {
+            return -1;
+        }
+    }
+    for (auto action : storyBoard.init_.user_defined_action_)
+    {
+        if (action->RestoreState(stream) != 0)
+        {
+            return -1;
+        }
+    }
+
+    if (storyBoard.RestoreState(stream) != 0)
+    {
+        LOG_ERROR("Restore state: Failed to restore storyboard");
+        return -1;
+    }
+
+    return stream.Good() ? 0 : -1;
+}
+
+void ScenarioEngine::SyncGatewayWithObjects(const std::vector<Object*>& active_before)
+{
+    for (auto obj : active_before)
+    {
+        if (!obj->IsActive())
+        {
+            scenarioGateway.removeObject(obj->name_);
+        }
+    }
+
+    for (auto obj : entities_.object_)
+    {
+        if (scenarioGateway.isObjectReported(obj->id_))
+        {
+            scenarioGateway.updateObjectPos(obj->id_, simulationTime_, &obj->pos_);
+            scenarioGateway.updateObjectSpeed(obj->id_, simulationTime_, obj->speed_);
+            scenarioGateway.updateObjectWheelAngle(obj->id_, simulationTime_, obj->wheel_angle_);
+            scenarioGateway.updateObjectWheelRotation(obj->id_, simulationTime_, obj->wheel_rot_);
+            scenarioGateway.updateObjectVisibilityMask(obj->id_, obj->visibilityMask_);
+            scenarioGateway.updateObjectControllerType(obj->id_, obj->GetControllerTypeActiveOnDomain(ControlDomains::DOMAIN_LONG));
+        }
+        else
+        {
+            // e.g. object activated again by the restore
+            ReportObjectToGateway(obj);
+        }
+    }
+    scenarioGateway.clearDirtyBits();
+}
+
 // Reset events ongoing or finished by ghost
 void ScenarioEngine::ResetEvents() const
 {
@@ -1291,13 +1599,25 @@ void ScenarioEngine::ResetEvents() const
 int ScenarioEngine::DetectCollisions()
 {
     collision_pair_.clear();
+
+    // Broad phase over the contiguous entity state block, narrow phase (SAT) only for overlapping enclosing boxes
+    entities_.UpdateStateBlock();
+    collision_candidates_.resize(entities_.object_.size());
+
     for (size_t i = 0; i < entities_.object_.size(); i++)
     {
         Object* obj0 = entities_.object_[i];
+        entities_.state_block_.GetOverlapCandidates(i, collision_candidates_.data());
+
         for (size_t j = i + 1; j < entities_.object_.size(); j++)
         {
+            if (!collision_candidates_[j] && obj0->collisions_.empty())
+            {
+                continue;  // no overlap, and no previous collision to dissolve
+            }
+
             Object* obj1 = entities_.object_[j];
-            if (obj0->Collision(obj1))
+            if (collision_candidates_[j] && obj0->Collision(obj1))
             {
                 collision_pair_.push_back({obj0, obj1});
                 if (std::find(obj0->collisions_.begin(), obj0->collisions_.end(), obj1) == obj0->collisions_.end())
@@ -1427,10 +1747,14 @@ int ScenarioEngine::GetDistance(Object*                           object_1,
     uint64_t key     = GenerateKey(object_1->GetId(), object_2->GetId());
     uint64_t rev_key = GenerateKey(object_2->GetId(), object_1->GetId());
 
+    // might be called by controllers during the parallel perception phase
+    distance_mutex_.Lock();
+
     if (!object_1->IsActive() || !object_2->IsActive())
     {
         object_distance_map_.erase(key);
         object_distance_map_.erase(rev_key);
+        distance_mutex_.Unlock();
         return -1;
     }
 
@@ -1445,12 +1769,14 @@ int ScenarioEngine::GetDistance(Object*                           object_1,
 
     if (it == object_distance_map_.end())
     {
+        distance_mutex_.Unlock();
         return -1;
     }
 
     auto& measurement = it->second.measurement_[static_cast<size_t>(dist_type)];
     *distance         = measurement.distance_;
     *timestamp        = measurement.timestamp_;
+    distance_mutex_.Unlock();
 
     return dist_updated;
 }
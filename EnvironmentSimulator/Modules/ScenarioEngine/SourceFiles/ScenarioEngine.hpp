@@ -158,6 +158,21 @@ namespace scenarioengine
             return init_status_;
         }
 
+        /**
+        Serialize complete simulation state into a binary stream, e.g. for later rewind or branching of a simulation
+        Includes time, entities, controllers, storyboard element and condition states, parameters, variables and random generator
+        @param stream Stream to append the state to
+        */
+        void SaveState(SE_StateStream &stream);
+
+        /**
+        Restore simulation state previously stored by SaveState() of the same scenario. On failure, e.g. corrupt data,
+        the state from before the call is kept.
+        @param stream Stream to read the state from
+        @return 0 on success, -1 on error, e.g. corrupt data or state from another scenario
+        */
+        int RestoreState(SE_StateStream &stream);
+
 #ifdef _USE_OSI
         void SetOSIReporter(OSIReporter *osi_reporter)
         {
@@ -203,12 +218,25 @@ namespace scenarioengine
         }
 
         std::unordered_map<uint64_t, DistanceEntry> object_distance_map_;
+        SE_Mutex                                    distance_mutex_;  // guards the distance map
+
+        std::vector<ObjectState *> gateway_states_;        // gateway state per entity, cached during prepareGroundTruth
+        std::vector<unsigned char> collision_candidates_;  // broad phase result, see DetectCollisions
+
+        // Optional parallel controller perception phase
+        unsigned int              controller_threads_ = 0;  // 0 and 1 means serial perception phase
+        SE_WorkerPool             controller_pool_;
+        std::vector<Controller *> active_controllers_;
 
         // execution control flags
         unsigned int frame_nr_;
         int          init_status_;
 
-        int parseScenario();
+        int  parseScenario();
+        void ReportObjectToGateway(Object *obj);
+        int  ReadStateHeader(SE_StateStream &stream);
+        int  RestoreStateData(SE_StateStream &stream);
+        void SyncGatewayWithObjects(const std::vector<Object *> &active_before);
     };
 
 }  // namespace scenarioengine
@@ -261,8 +261,7 @@ ScenarioGateway::~ScenarioGateway()
 {
     objectState_.clear();
 
-    data_file_.flush();
-    data_file_.close();
+    data_file_.Close();
 }
 
 ObjectState* ScenarioGateway::getObjectStatePtrById(int id)
@@ -360,28 +359,25 @@ int ScenarioGateway::reportObject(int                    id,
         }
 
         // Create state and set permanent information
-        obj_state = new ObjectState(id,
-                                    name,
-                                    obj_type,
-                                    obj_category,
-                                    obj_role,
-                                    model_id,
-                                    model3d_abs_path,
-                                    ctrl_type,
-                                    boundingbox,
-                                    scaleMode,
-                                    visibilityMask,
-                                    timestamp,
-                                    speed,
-                                    wheel_angle,
-                                    wheel_rot,
-                                    rear_axle_z_pos,
-                                    front_axle_x_pos,
-                                    front_axle_z_pos,
-                                    pos);
-
-        // Add object to collection
-        objectState_.push_back(std::unique_ptr<ObjectState>{obj_state});
+        obj_state = addObjectState(ObjectState(id,
+                                               name,
+                                               obj_type,
+                                               obj_category,
+                                               obj_role,
+                                               model_id,
+                                               model3d_abs_path,
+                                               ctrl_type,
+                                               boundingbox,
+                                               scaleMode,
+                                               visibilityMask,
+                                               timestamp,
+                                               speed,
+                                               wheel_angle,
+                                               wheel_rot,
+                                               rear_axle_z_pos,
+                                               front_axle_x_pos,
+                                               front_axle_z_pos,
+                                               pos));
     }
     else
     {
@@ -423,30 +419,27 @@ int ScenarioGateway::reportObject(int            id,
     {
         // Create state and set permanent information
         LOG_INFO("Creating new object \"{}\" (id {}, timestamp {:.2f})", name, id, timestamp);
-        obj_state = new ObjectState(id,
-                                    name,
-                                    obj_type,
-                                    obj_category,
-                                    obj_role,
-                                    model_id,
-                                    ctrl_type,
-                                    boundingbox,
-                                    scaleMode,
-                                    visibilityMask,
-                                    timestamp,
-                                    speed,
-                                    wheel_angle,
-                                    wheel_rot,
-                                    rear_axle_z_pos,
-                                    x,
-                                    y,
-                                    z,
-                                    h,
-                                    p,
-                                    r);
-
-        // Add object to collection
-        objectState_.push_back(std::unique_ptr<ObjectState>{obj_state});
+        obj_state = addObjectState(ObjectState(id,
+                                               name,
+                                               obj_type,
+                                               obj_category,
+                                               obj_role,
+                                               model_id,
+                                               ctrl_type,
+                                               boundingbox,
+                                               scaleMode,
+                                               visibilityMask,
+                                               timestamp,
+                                               speed,
+                                               wheel_angle,
+                                               wheel_rot,
+                                               rear_axle_z_pos,
+                                               x,
+                                               y,
+                                               z,
+                                               h,
+                                               p,
+                                               r));
     }
     else
     {
@@ -485,30 +478,27 @@ int ScenarioGateway::reportObject(int            id,
     {
         // Create state and set permanent information
         LOG_INFO("Creating new object \"{}\" (id {}, timestamp {:.2f})", name, id, timestamp);
-        obj_state = new ObjectState(id,
-                                    name,
-                                    obj_type,
-                                    obj_category,
-                                    obj_role,
-                                    model_id,
-                                    ctrl_type,
-                                    boundingbox,
-                                    scaleMode,
-                                    visibilityMask,
-                                    timestamp,
-                                    speed,
-                                    wheel_angle,
-                                    wheel_rot,
-                                    rear_axle_z_pos,
-                                    x,
-                                    y,
-                                    0,
-                                    h,
-                                    0,
-                                    0);
-
-        // Add object to collection
-        objectState_.push_back(std::unique_ptr<ObjectState>{obj_state});
+        obj_state = addObjectState(ObjectState(id,
+                                               name,
+                                               obj_type,
+                                               obj_category,
+                                               obj_role,
+                                               model_id,
+                                               ctrl_type,
+                                               boundingbox,
+                                               scaleMode,
+                                               visibilityMask,
+                                               timestamp,
+                                               speed,
+                                               wheel_angle,
+                                               wheel_rot,
+                                               rear_axle_z_pos,
+                                               x,
+                                               y,
+                                               0,
+                                               h,
+                                               0,
+                                               0));
     }
     else
     {
@@ -548,28 +538,25 @@ int ScenarioGateway::reportObject(int            id,
     {
         // Create state and set permanent information
         LOG_INFO("Creating new object \"{}\" (id {}, timestamp {:.2f})", name, id, timestamp);
-        obj_state = new ObjectState(id,
-                                    name,
-                                    obj_type,
-                                    obj_category,
-                                    obj_role,
-                                    model_id,
-                                    ctrl_type,
-                                    boundingbox,
-                                    scaleMode,
-                                    visibilityMask,
-                                    timestamp,
-                                    speed,
-                                    wheel_angle,
-                                    wheel_rot,
-                                    rear_axle_z_pos,
-                                    roadId,
-                                    laneId,
-                                    laneOffset,
-                                    s);
-
-        // Add object to collection
-        objectState_.push_back(std::unique_ptr<ObjectState>{obj_state});
+        obj_state = addObjectState(ObjectState(id,
+                                               name,
+                                               obj_type,
+                                               obj_category,
+                                               obj_role,
+                                               model_id,
+                                               ctrl_type,
+                                               boundingbox,
+                                               scaleMode,
+                                               visibilityMask,
+                                               timestamp,
+                                               speed,
+                                               wheel_angle,
+                                               wheel_rot,
+                                               rear_axle_z_pos,
+                                               roadId,
+                                               laneId,
+                                               laneOffset,
+                                               s));
     }
     else
     {
@@ -608,27 +595,24 @@ int ScenarioGateway::reportObject(int            id,
     {
         // Create state and set permanent information
         LOG_INFO("Creating new object \"{}\" (id {}, timestamp {:.2f})", name, id, timestamp);
-        obj_state = new ObjectState(id,
-                                    name,
-                                    obj_type,
-                                    obj_category,
-                                    obj_role,
-                                    model_id,
-                                    ctrl_type,
-                                    boundingbox,
-                                    scaleMode,
-                                    visibilityMask,
-                                    timestamp,
-                                    speed,
-                                    wheel_angle,
-                                    wheel_rot,
-                                    rear_axle_z_pos,
-                                    roadId,
-                                    lateralOffset,
-                                    s);
-
-        // Add object to collection
-        objectState_.push_back(std::unique_ptr<ObjectState>{obj_state});
+        obj_state = addObjectState(ObjectState(id,
+                                               name,
+                                               obj_type,
+                                               obj_category,
+                                               obj_role,
+                                               model_id,
+                                               ctrl_type,
+                                               boundingbox,
+                                               scaleMode,
+                                               visibilityMask,
+                                               timestamp,
+                                               speed,
+                                               wheel_angle,
+                                               wheel_rot,
+                                               rear_axle_z_pos,
+                                               roadId,
+                                               lateralOffset,
+                                               s));
     }
     else
     {
@@ -1059,12 +1043,30 @@ void ScenarioGateway::clearDirtyBits()
     }
 }
 
+ObjectState* ScenarioGateway::addObjectState(const ObjectState& state)
+{
+    if (objectStatePool_.empty())
+    {
+        objectState_.push_back(std::unique_ptr<ObjectState>{new ObjectState(state)});
+    }
+    else
+    {
+        // reset in place, assignment reuses allocated storage of members
+        *objectStatePool_.back() = state;
+        objectState_.push_back(std::move(objectStatePool_.back()));
+        objectStatePool_.pop_back();
+    }
+
+    return objectState_.back().get();
+}
+
 void ScenarioGateway::removeObject(int id)
 {
     for (auto objectIt = std::begin(objectState_); objectIt != std::end(objectState_);)
     {
         if ((*objectIt)->state_.info.id == id)
         {
+            objectStatePool_.push_back(std::move(*objectIt));
             objectIt = objectState_.erase(objectIt);
         }
         else
@@ -1080,6 +1082,7 @@ void ScenarioGateway::removeObject(std::string name)
     {
         if ((*objectIt)->state_.info.name == name)
         {
+            objectStatePool_.push_back(std::move(*objectIt));
             objectIt = objectState_.erase(objectIt);
         }
         else
@@ -1091,44 +1094,59 @@ void ScenarioGateway::removeObject(std::string name)
 
 void ScenarioGateway::WriteStatesToFile()
 {
-    if (data_file_.is_open())
+    if (data_file_.IsOpen())
     {
-        // Write status to file - for later replay
-        for (size_t i = 0; i < objectState_.size(); i++)
-        {
-            struct ObjectStateStructDat datState;
-
-            datState.info.boundingbox = objectState_[i]->state_.info.boundingbox;
-            datState.info.ctrl_type   = objectState_[i]->state_.info.ctrl_type;
-            datState.info.id          = objectState_[i]->state_.info.id;
-            datState.info.model_id    = objectState_[i]->state_.info.model_id;
-            memcpy(datState.info.name, objectState_[i]->state_.info.name, sizeof(datState.info.name));
-            datState.info.obj_category   = objectState_[i]->state_.info.obj_category;
-            datState.info.obj_type       = objectState_[i]->state_.info.ctrl_type;
-            datState.info.scaleMode      = objectState_[i]->state_.info.scaleMode;
-            datState.info.speed          = static_cast<float>(objectState_[i]->state_.info.speed);
-            datState.info.timeStamp      = static_cast<float>(objectState_[i]->state_.info.timeStamp);
-            datState.info.visibilityMask = objectState_[i]->state_.info.visibilityMask;
-
-            // assume first wheel is on front axle and steering
-            datState.info.wheel_angle =
-                objectState_[i]->state_.info.wheel_data.size() > 0 ? static_cast<float>(objectState_[i]->state_.info.wheel_data[0].h) : 0.0f;
-            datState.info.wheel_rot =
-                objectState_[i]->state_.info.wheel_data.size() > 0 ? static_cast<float>(objectState_[i]->state_.info.wheel_data[0].p) : 0.0f;
-
-            datState.pos.x      = static_cast<float>(objectState_[i]->state_.pos.GetX());
-            datState.pos.y      = static_cast<float>(objectState_[i]->state_.pos.GetY());
-            datState.pos.z      = static_cast<float>(objectState_[i]->state_.pos.GetZ());
-            datState.pos.h      = static_cast<float>(objectState_[i]->state_.pos.GetH());
-            datState.pos.p      = static_cast<float>(objectState_[i]->state_.pos.GetP());
-            datState.pos.r      = static_cast<float>(objectState_[i]->state_.pos.GetR());
-            datState.pos.roadId = objectState_[i]->state_.pos.GetTrackId();
-            datState.pos.laneId = objectState_[i]->state_.pos.GetLaneId();
-            datState.pos.offset = static_cast<float>(objectState_[i]->state_.pos.GetOffset());
-            datState.pos.t      = static_cast<float>(objectState_[i]->state_.pos.GetT());
-            datState.pos.s      = static_cast<float>(objectState_[i]->state_.pos.GetS());
-            data_file_.write(reinterpret_cast<char*>(&datState), sizeof(datState));
-        }
+        GetStatesForFile(datStates_);
+        WriteStatesToFile(datStates_);
+    }
+}
+
+void ScenarioGateway::GetStatesForFile(std::vector<ObjectStateStructDat>& states) const
+{
+    states.resize(objectState_.size());
+
+    for (size_t i = 0; i < objectState_.size(); i++)
+    {
+        struct ObjectStateStructDat& datState = states[i];
+
+        datState.info.boundingbox = objectState_[i]->state_.info.boundingbox;
+        datState.info.ctrl_type   = objectState_[i]->state_.info.ctrl_type;
+        datState.info.id          = objectState_[i]->state_.info.id;
+        datState.info.model_id    = objectState_[i]->state_.info.model_id;
+        memcpy(datState.info.name, objectState_[i]->state_.info.name, sizeof(datState.info.name));
+        datState.info.obj_category   = objectState_[i]->state_.info.obj_category;
+        datState.info.obj_type       = objectState_[i]->state_.info.ctrl_type;
+        datState.info.scaleMode      = objectState_[i]->state_.info.scaleMode;
+        datState.info.speed          = static_cast<float>(objectState_[i]->state_.info.speed);
+        datState.info.timeStamp      = static_cast<float>(objectState_[i]->state_.info.timeStamp);
+        datState.info.visibilityMask = objectState_[i]->state_.info.visibilityMask;
+
+        // assume first wheel is on front axle and steering
+        datState.info.wheel_angle =
+            objectState_[i]->state_.info.wheel_data.size() > 0 ? static_cast<float>(objectState_[i]->state_.info.wheel_data[0].h) : 0.0f;
+        datState.info.wheel_rot =
+            objectState_[i]->state_.info.wheel_data.size() > 0 ? static_cast<float>(objectState_[i]->state_.info.wheel_data[0].p) : 0.0f;
+
+        datState.pos.x      = static_cast<float>(objectState_[i]->state_.pos.GetX());
+        datState.pos.y      = static_cast<float>(objectState_[i]->state_.pos.GetY());
+        datState.pos.z      = static_cast<float>(objectState_[i]->state_.pos.GetZ());
+        datState.pos.h      = static_cast<float>(objectState_[i]->state_.pos.GetH());
+        datState.pos.p      = static_cast<float>(objectState_[i]->state_.pos.GetP());
+        datState.pos.r      = static_cast<float>(objectState_[i]->state_.pos.GetR());
+        datState.pos.roadId = objectState_[i]->state_.pos.GetTrackId();
+        datState.pos.laneId = objectState_[i]->state_.pos.GetLaneId();
+        datState.pos.offset = static_cast<float>(objectState_[i]->state_.pos.GetOffset());
+        datState.pos.t      = static_cast<float>(objectState_[i]->state_.pos.GetT());
+        datState.pos.s      = static_cast<float>(objectState_[i]->state_.pos.GetS());
+    }
+}
+
+void ScenarioGateway::WriteStatesToFile(const std::vector<ObjectStateStructDat>& states)
+{
+    if (data_file_.IsOpen() && !states.empty())
+    {
+        // Hand over status of all objects as one frame to the file writer - for later replay
+        data_file_.Write(states.data(), states.size() * sizeof(ObjectStateStructDat));
     }
 }
 
@@ -1136,8 +1154,7 @@ int ScenarioGateway::RecordToFile(std::string filename, std::string odr_filename
 {
     if (!filename.empty())
     {
-        data_file_.open(filename, std::ofstream::binary);
-        if (data_file_.fail())
+        if (data_file_.Open(filename, std::ofstream::binary, SE_Env::Inst().GetWriteBufferSize()) != 0)
         {
             LOG_ERROR("Cannot open file: {}", filename);
             return -1;
@@ -1147,7 +1164,10 @@ int ScenarioGateway::RecordToFile(std::string filename, std::string odr_filename
         StrCopy(header.odr_filename, odr_filename.c_str(), MIN(odr_filename.length() + 1, DAT_FILENAME_SIZE));
         StrCopy(header.model_filename, model_filename.c_str(), MIN(model_filename.length() + 1, DAT_FILENAME_SIZE));
 
-        data_file_.write(reinterpret_cast<char*>(&header), sizeof(header));
+        data_file_.Write(&header, sizeof(header));
+
+        // header is always written, optionally drop frames of the recording rather than waiting for the writer
+        data_file_.SetDropWhenFull(SE_Env::Inst().GetWriteDropWhenFull());
     }
 
     return 0;
@@ -365,12 +365,40 @@ namespace scenarioengine
         int          getObjectStateById(int id, ObjectState &objectState) const;
         void         WriteStatesToFile();
         int          RecordToFile(std::string filename, std::string odr_filename, std::string model_filename);
+        bool         IsRecording() const
+        {
+            return data_file_.IsOpen();
+        }
+
+        /**
+        Convert current states into the format of the recording (.dat) file
+        @param states Buffer to fill, any previous content is replaced
+        */
+        void GetStatesForFile(std::vector<ObjectStateStructDat> &states) const;
+
+        /**
+        Write states, as collected by GetStatesForFile(), to the recording file. Does not access any other
+        data of the gateway, hence it can be called from another thread while the simulation proceeds.
+        Actual file output is made by a separate writer thread, see SE_AsyncFileWriter.
+        @param states States to write
+        */
+        void WriteStatesToFile(const std::vector<ObjectStateStructDat> &states);
 
         std::vector<std::unique_ptr<ObjectState>> objectState_;
 
     private:
+        std::vector<std::unique_ptr<ObjectState>> objectStatePool_;  // states of removed objects, kept for reuse
+
+        /**
+        Add state of a new object, reusing the instance of a removed one when available
+        @param state Initial state of the object
+        @return Pointer to the added state
+        */
+        ObjectState *addObjectState(const ObjectState &state);
+
         int updateObjectInfo(ObjectState *obj_state, double timestamp, int visibilityMask, double speed, double wheel_angle, double wheel_rot);
-        std::ofstream data_file_;
+        SE_AsyncFileWriter                data_file_;
+        std::vector<ObjectStateStructDat> datStates_;  // reused buffer for synchronous recording
     };
 
 }  // namespace scenarioengine
@@ -75,6 +75,11 @@ ScenarioReader::~ScenarioReader()
         delete controller_[i];
     }
     controller_.clear();
+    for (size_t i = 0; i < released_controllers_.size(); i++)
+    {
+        delete released_controllers_[i];
+    }
+    released_controllers_.clear();
     parameters.Clear();
     variables.Clear();
 }
@@ -122,6 +127,47 @@ int ScenarioReader::RemoveController(Controller *controller)
     return -1;
 }
 
+int ScenarioReader::ReleaseController(Controller *controller)
+{
+    for (size_t i = 0; i < controller_.size(); i++)
+    {
+        if (controller_[i] == controller)
+        {
+            controller->Deactivate();
+            controller_.erase(controller_.begin() + static_cast<int>(i));
+            released_controllers_.push_back(controller);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+Controller *ScenarioReader::ReuseController(Controller::InitArgs *args)
+{
+    for (size_t i = released_controllers_.size(); i-- > 0;)
+    {
+        Controller *controller = released_controllers_[i];
+        if (args->type != controller->GetTypeName())
+        {
+            continue;
+        }
+
+        released_controllers_.erase(released_controllers_.begin() + static_cast<int>(i));
+        if (controller->ResetInstance(args) != 0)
+        {
+            // controller type does not support reuse
+            delete controller;
+            continue;
+        }
+
+        controller_.push_back(controller);
+        return controller;
+    }
+
+    return nullptr;
+}
+
 int ScenarioReader::loadOSCFile(const char *path)
 {
     pugi::xml_parse_result result = doc_.load_file(path);
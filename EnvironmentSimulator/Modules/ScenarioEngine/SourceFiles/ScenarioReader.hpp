@@ -181,12 +181,28 @@ namespace scenarioengine
         {
             controller_.push_back(controller);
         }
+
+        /**
+        Remove controller from the scenario but keep the instance for reuse, instead of deleting it.
+        The controller should be unlinked from any object before released.
+        @param controller Controller to release
+        @return 0 on success, -1 if controller not found
+        */
+        int ReleaseController(Controller* controller);
+
+        /**
+        Pick a released controller of given type, reset it to the state of a newly created one and add it to the scenario
+        @param args Arguments as for instantiating a new controller, type decides which controllers qualify
+        @return Reset controller, or nullptr if no reusable controller of the type is available
+        */
+        Controller* ReuseController(Controller::InitArgs* args);
         pugi::xml_document* GetDXMLDocument()
         {
             return &doc_;
         }
 
         std::vector<Controller*> controller_;
+        std::vector<Controller*> released_controllers_;  // removed from scenario, kept for reuse
 
         static Parameters parameters;  // static to enable set via callback during creation of object
         static Parameters variables;
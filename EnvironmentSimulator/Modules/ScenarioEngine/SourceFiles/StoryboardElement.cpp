@@ -378,6 +378,71 @@ void StoryBoardElement::Reset(State state)
     }
 }
 
+void StoryBoardElement::SaveState(SE_StateStream& stream)
+{
+    stream.Write(state_);
+    stream.Write(transition_);
+    stream.Write(num_executions_);
+
+    stream.Write(start_trigger_ != nullptr);
+    if (start_trigger_ != nullptr)
+    {
+        start_trigger_->SaveState(stream);
+    }
+
+    stream.Write(stop_trigger_ != nullptr);
+    if (stop_trigger_ != nullptr)
+    {
+        stop_trigger_->SaveState(stream);
+    }
+
+    stream.Write(static_cast<uint32_t>(GetChildren()->size()));
+    for (auto child : *GetChildren())
+    {
+        child->SaveState(stream);
+    }
+}
+
+int StoryBoardElement::RestoreState(SE_StateStream& stream)
+{
+    stream.Read(state_);
+    stream.Read(transition_);
+    stream.Read(num_executions_);
+
+    bool has_trigger = false;
+    stream.Read(has_trigger);
+    if (has_trigger != (start_trigger_ != nullptr) || (has_trigger && start_trigger_->RestoreState(stream) != 0))
+    {
+        LOG_ERROR("Failed to restore start trigger state of {}", GetFullPath());
+        return -1;
+    }
+
+    stream.Read(has_trigger);
+    if (has_trigger != (stop_trigger_ != nullptr) || (has_trigger && stop_trigger_->RestoreState(stream) != 0))
+    {
+        LOG_ERROR("Failed to restore stop trigger state of {}", GetFullPath());
+        return -1;
+    }
+
+    uint32_t n_children = 0;
+    stream.Read(n_children);
+    if (n_children != GetChildren()->size())
+    {
+        LOG_ERROR("Storyboard element {} child count mismatch ({} vs {})", GetFullPath(), n_children, GetChildren()->size());
+        return -1;
+    }
+
+    for (auto child : *GetChildren())
+    {
+        if (child->RestoreState(stream) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return stream.Good() ? 0 : -1;
+}
+
 void StoryBoardElement::SetName(std::string name)
 {
     name_ = name;
@@ -181,6 +181,20 @@ namespace scenarioengine
 
         virtual void Reset(State state = State::INIT);
 
+        /**
+        Serialize runtime state of the element, including its triggers and all child elements, into a binary stream
+        Derived elements, e.g. actions, may extend with internal progress but should call base class first
+        @param stream Stream to append the state to
+        */
+        virtual void SaveState(SE_StateStream& stream);
+
+        /**
+        Restore runtime state previously stored by SaveState(). The storyboard structure must be identical.
+        @param stream Stream to read the state from
+        @return 0 on success, -1 on corrupt data or mismatching storyboard structure
+        */
+        virtual int RestoreState(SE_StateStream& stream);
+
         void SetName(std::string name);
 
         const std::string GetName() const
@@ -361,10 +361,29 @@ void PolyLine::AddPoint(double x, double y, double z)
     Update();
 }
 
+void PolyLine::DiscardPoints(unsigned int n)
+{
+    n = MIN(n, static_cast<unsigned int>(pline_vertex_data_->size()));
+    if (n == 0)
+    {
+        return;
+    }
+
+    pline_vertex_data_->erase(pline_vertex_data_->begin(), pline_vertex_data_->begin() + n);
+    if (dots3D_group_ != nullptr)
+    {
+        dots3D_group_->removeChildren(0, MIN(n, dots3D_group_->getNumChildren()));
+    }
+    n_discarded_ += n;
+
+    Update();
+}
+
 void PolyLine::Reset()
 {
     pline_vertex_data_->clear();
     dots3D_group_->removeChildren(0, dots3D_group_->getNumChildren());
+    n_discarded_ = 0;
 
     Update();
 }
@@ -600,12 +619,10 @@ SensorViewFrustum::~SensorViewFrustum()
 
 void SensorViewFrustum::Update()
 {
-    // Visualize hits by a "line of sight"
+    std::vector<double> hits;
+
     for (size_t i = 0; i < static_cast<unsigned int>(sensor_->nObj_); i++)
     {
-        (*plines_[i]->pline_vertex_data_)[1][0] = static_cast<float>(sensor_->hitList_[i].x_);
-        (*plines_[i]->pline_vertex_data_)[1][1] = static_cast<float>(sensor_->hitList_[i].y_);
-
         // compensate z for vehicle pitch angle
         double z_add = GetLengthOfLine2D(sensor_->hitList_[i].obj_->pos_.GetX(),
                                          sensor_->hitList_[i].obj_->pos_.GetY(),
@@ -613,13 +630,30 @@ void SensorViewFrustum::Update()
                                          sensor_->host_->pos_.GetY()) *
                        tan(sensor_->host_->pos_.GetP());
 
-        (*plines_[i]->pline_vertex_data_)[1][2] = static_cast<float>(sensor_->hitList_[i].z_ + z_add);
+        hits.push_back(sensor_->hitList_[i].x_);
+        hits.push_back(sensor_->hitList_[i].y_);
+        hits.push_back(sensor_->hitList_[i].z_ + z_add);
+    }
+
+    Update(hits);
+}
+
+void SensorViewFrustum::Update(const std::vector<double>& hits)
+{
+    size_t n_hits = MIN(hits.size() / 3, plines_.size());
+
+    // Visualize hits by a "line of sight"
+    for (size_t i = 0; i < n_hits; i++)
+    {
+        (*plines_[i]->pline_vertex_data_)[1][0] = static_cast<float>(hits[3 * i + 0]);
+        (*plines_[i]->pline_vertex_data_)[1][1] = static_cast<float>(hits[3 * i + 1]);
+        (*plines_[i]->pline_vertex_data_)[1][2] = static_cast<float>(hits[3 * i + 2]);
 
         plines_[i]->Redraw();
     }
 
     // Reset additional lines possibly previously in use
-    for (size_t i = static_cast<unsigned int>(sensor_->nObj_); i < static_cast<unsigned int>(sensor_->maxObj_); i++)
+    for (size_t i = n_hits; i < plines_.size(); i++)
     {
         (*plines_[i]->pline_vertex_data_)[1][0] = 0;
         (*plines_[i]->pline_vertex_data_)[1][1] = 0;
@@ -3478,6 +3512,28 @@ PointSensor* Viewer::CreateSensor(const float (&color)[3], bool create_ball, boo
 }
 
 void Viewer::UpdateRoadSensors(PointSensor* road_sensor, PointSensor* route_sensor, PointSensor* lane_sensor, roadmanager::Position* pos)
+{
+    roadmanager::Route* r     = pos->GetRoute();
+    bool                valid = r && r->IsValid();
+
+    UpdateRoadSensors(road_sensor,
+                      route_sensor,
+                      lane_sensor,
+                      pos,
+                      valid,
+                      valid ? r->GetTrackId() : ID_UNDEFINED,
+                      valid ? r->GetLaneId() : 0,
+                      valid ? r->GetTrackS() : 0.0);
+}
+
+void Viewer::UpdateRoadSensors(PointSensor*           road_sensor,
+                               PointSensor*           route_sensor,
+                               PointSensor*           lane_sensor,
+                               roadmanager::Position* pos,
+                               bool                   route_valid,
+                               id_t                   route_track_id,
+                               int                    route_lane_id,
+                               double                 route_s)
 {
     if (road_sensor == 0 || route_sensor == 0 || lane_sensor == 0)
     {
@@ -3492,10 +3548,9 @@ void Viewer::UpdateRoadSensors(PointSensor* road_sensor, PointSensor* route_sens
     UpdateSensor(road_sensor);
 
     roadmanager::Position route_pos(track_pos);
-    roadmanager::Route*   r = pos->GetRoute();
-    if (r && r->IsValid())
+    if (route_valid)
     {
-        route_pos.SetLanePos(r->GetTrackId(), r->GetLaneId(), r->GetTrackS(), 0.0);
+        route_pos.SetLanePos(route_track_id, route_lane_id, route_s, 0.0);
     }
 
     SensorSetPivotPos(route_sensor, pos->GetX(), pos->GetY(), pos->GetZ());
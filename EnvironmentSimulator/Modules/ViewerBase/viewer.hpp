@@ -76,6 +76,7 @@ namespace viewer
         osg::ref_ptr<osg::ShapeDrawable> dot3D_shape_;
         osg::ref_ptr<osg::Geode>         dot3D_geode_;
         osg::ref_ptr<osg::Group>         dots3D_group_;
+        unsigned int                     n_discarded_ = 0;  // points removed from the start since last reset, see DiscardPoints()
 
         /**
          * Create and visualize a set of connected line segments defined by an array of points.
@@ -118,6 +119,13 @@ namespace viewer
 
         void SetPoints(osg::ref_ptr<osg::Vec3Array> points);
         void AddPoint(double x, double y, double z);
+
+        /**
+         * Remove points from the start of the polyline, e.g. to follow a trail of limited time span
+         * @param n Number of points to remove
+         */
+        void DiscardPoints(unsigned int n);
+
         void Reset();
         void Update();
         void Redraw();
@@ -143,6 +151,12 @@ namespace viewer
         SensorViewFrustum(Viewer* viewer, ObjectSensor* sensor, osg::Group* parent);
         ~SensorViewFrustum();
         void Update();
+
+        /**
+        Update lines of sight from captured detections instead of reading the sensor
+        @param hits x, y, z of each detected object
+        */
+        void Update(const std::vector<double>& hits);
     };
 
     class Trajectory
@@ -507,6 +521,14 @@ namespace viewer
         void                     SensorSetPivotPos(PointSensor* sensor, double x, double y, double z);
         void                     SensorSetTargetPos(PointSensor* sensor, double x, double y, double z);
         void UpdateRoadSensors(PointSensor* road_sensor, PointSensor* route_sensor, PointSensor* lane_sensor, roadmanager::Position* pos);
+        void UpdateRoadSensors(PointSensor*           road_sensor,
+                               PointSensor*           route_sensor,
+                               PointSensor*           lane_sensor,
+                               roadmanager::Position* pos,
+                               bool                   route_valid,
+                               id_t                   route_track_id,
+                               int                    route_lane_id,
+                               double                 route_s);
         void setKeyUp(bool pressed)
         {
             keyUp_ = pressed;
@@ -3,6 +3,9 @@
 #include "CommonMini.hpp"
 #include "esminiLib.hpp"
 #include "Config.hpp"
+#include "ChunkedTrace.hpp"
+#include "SharedMemory.hpp"
+#include "UDP.hpp"
 
 struct Coordinate2D
 {
@@ -320,6 +323,473 @@ TEST(MathFunctions, TestGetIntersectionsOfLineAndCircle)
     EXPECT_EQ(GetIntersectionsOfLineAndCircle({-1.0, 0.0}, {-1.0, 5.0}, {1.0, 1.0}, 2.01, i0, i1), 2);  // two intersection points
 }
 
+TEST(AsyncFileWriter, TestWriteOrderAndDrop)
+{
+    const char* filename = "async_file_writer_test.txt";
+    std::string expected;
+
+    // tiny buffer forcing the writer to wrap around and the producer to wait for space
+    SE_AsyncFileWriter writer;
+    ASSERT_EQ(writer.Open(filename, std::ios_base::out, 16), 0);
+    for (int i = 0; i < 1000; i++)
+    {
+        std::string frame = "frame " + std::to_string(i) + "\n";
+        EXPECT_TRUE(writer.Write(frame));
+        expected += frame;
+    }
+
+    // frame larger than the buffer is handed over in pieces
+    std::string large(100, 'x');
+    EXPECT_TRUE(writer.Write(large));
+    expected += large;
+
+    // in drop mode, a frame which can't fit is rejected
+    writer.SetDropWhenFull(true);
+    EXPECT_FALSE(writer.Write(large));
+    EXPECT_EQ(writer.GetNumberOfDroppedFrames(), 1);
+    writer.SetDropWhenFull(false);
+
+    writer.Write("end\n");
+    expected += "end\n";
+    writer.Close();
+    EXPECT_TRUE(writer.Good());
+    EXPECT_FALSE(writer.IsOpen());
+
+    std::ifstream     file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), expected);
+    file.close();
+
+    // synchronous mode
+    ASSERT_EQ(writer.Open(filename, std::ios_base::out, 0), 0);
+    writer.Write("sync\n");
+    writer.Flush();
+    file.open(filename);
+    std::string line;
+    std::getline(file, line);
+    EXPECT_EQ(line, "sync");
+    file.close();
+    writer.Close();
+
+    std::remove(filename);
+}
+
+#if !(defined WINVER && WINVER == _WIN32_WINNT_WIN7 || __MINGW32__)
+TEST(TripleBuffer, TestConsistentAndLatestData)
+{
+    struct Data
+    {
+        int              counter = 0;
+        std::vector<int> values;  // all equal to counter
+    };
+
+    SE_TripleBuffer<Data> buffer;
+    const int             n_frames = 20000;
+
+    EXPECT_FALSE(buffer.Consume());
+
+    std::thread producer(
+        [&buffer]()
+        {
+            for (int i = 1; i <= n_frames; i++)
+            {
+                Data& data   = buffer.GetWriteBuffer();
+                data.counter = i;
+                data.values.assign(16, i);
+                buffer.Publish();
+            }
+        });
+
+    int last = 0;
+    while (last < n_frames)
+    {
+        if (buffer.Consume())
+        {
+            Data& data = buffer.GetReadBuffer();
+
+            // never older data, and never a mix of two frames
+            EXPECT_GT(data.counter, last);
+            EXPECT_EQ(data.values.size(), 16);
+            for (size_t i = 0; i < data.values.size(); i++)
+            {
+                EXPECT_EQ(data.values[i], data.counter);
+            }
+            last = data.counter;
+        }
+    }
+    producer.join();
+
+    // latest data already picked up
+    EXPECT_FALSE(buffer.Consume());
+    EXPECT_EQ(buffer.GetReadBuffer().counter, n_frames);
+}
+#endif
+
+TEST(ChunkedTrace, TestLZ4RoundTrip)
+{
+    std::string src;
+    for (int i = 0; i < 2000; i++)
+    {
+        src += "frame " + std::to_string(i % 17) + " x=" + std::to_string(i * 0.1) + ";";
+    }
+    src += std::string(300, 'a');  // long match overlapping itself
+
+    std::string compressed;
+    EXPECT_LT(LZ4CompressBlock(src.data(), src.size(), compressed), src.size() / 2);
+
+    std::string decompressed(src.size(), '\0');
+    EXPECT_EQ(LZ4DecompressBlock(compressed.data(), compressed.size(), &decompressed[0], decompressed.size()), static_cast<long long>(src.size()));
+    EXPECT_EQ(decompressed, src);
+
+    // too small destination and corrupt data are rejected
+    EXPECT_EQ(LZ4DecompressBlock(compressed.data(), compressed.size(), &decompressed[0], decompressed.size() - 1), -1);
+    compressed[compressed.size() / 2] = static_cast<char>(0xff);
+    compressed.resize(compressed.size() / 2 + 1);
+    EXPECT_LE(LZ4DecompressBlock(compressed.data(), compressed.size(), &decompressed[0], decompressed.size()), static_cast<long long>(src.size()));
+
+    // short and empty input
+    for (std::string s : {std::string(""), std::string("abc"), std::string("abcdabcdabcdabcd")})
+    {
+        LZ4CompressBlock(s.data(), s.size(), compressed);
+        std::string out(s.size(), '\0');
+        EXPECT_EQ(LZ4DecompressBlock(compressed.data(), compressed.size(), &out[0], out.size()), static_cast<long long>(s.size()));
+        EXPECT_EQ(out, s);
+    }
+}
+
+TEST(ChunkedTrace, TestWriteAndRandomAccess)
+{
+    const char*        filename = "chunked_trace_test.osi";
+    ChunkedTraceWriter writer;
+    ASSERT_EQ(writer.Open(filename, 10, 1024), 0);
+    EXPECT_EQ(writer.SetStatic("static data", 11), 0);
+    EXPECT_EQ(writer.SetStatic("again", 5), -1);
+
+    // 95 frames at 50 ms, i.e. 10 chunks, the last one partial
+    for (unsigned int i = 0; i < 95; i++)
+    {
+        std::string msg = "frame " + std::to_string(i) + std::string(i, 'x');
+        EXPECT_EQ(writer.AddFrame(i * 50000000ULL, msg.data(), msg.size()), 0);
+    }
+    writer.Close();
+
+    ChunkedTraceReader reader;
+    ASSERT_EQ(reader.Open(filename), 0);
+    EXPECT_EQ(reader.GetNumberOfFrames(), 95);
+    EXPECT_EQ(reader.GetNumberOfChunks(), 10);
+    EXPECT_EQ(reader.GetChunkInfo(9).n_frames, 5);
+
+    std::string static_data;
+    EXPECT_EQ(reader.ReadStatic(static_data), 0);
+    EXPECT_EQ(static_data, "static data");
+
+    ChunkedTraceReader::Frame frame;
+    EXPECT_EQ(reader.ReadFrame(42, frame), 0);
+    EXPECT_EQ(frame.timestamp, 42 * 50000000ULL);
+    EXPECT_EQ(frame.data, "frame 42" + std::string(42, 'x'));
+    EXPECT_EQ(reader.ReadFrame(95, frame), -1);
+
+    // latest frame at or before given time
+    EXPECT_EQ(reader.ReadFrameAtTime(2120000000ULL, frame), 42);
+    EXPECT_EQ(reader.ReadFrameAtTime(0, frame), 0);
+    EXPECT_EQ(reader.ReadFrameAtTime(100000000000ULL, frame), 94);
+    EXPECT_EQ(frame.data, "frame 94" + std::string(94, 'x'));
+
+    // all chunks in parallel
+    std::vector<std::vector<ChunkedTraceReader::Frame>> chunks;
+    EXPECT_EQ(reader.ReadChunks(0, reader.GetNumberOfChunks(), chunks, 4), 0);
+    ASSERT_EQ(chunks.size(), 10);
+    unsigned int n = 0;
+    for (auto& chunk : chunks)
+    {
+        for (auto& f : chunk)
+        {
+            EXPECT_EQ(f.data, "frame " + std::to_string(n) + std::string(n, 'x'));
+            n++;
+        }
+    }
+    EXPECT_EQ(n, 95);
+    reader.Close();
+
+    // a file missing its index, e.g. after a crash, is scanned instead
+    {
+        std::ifstream in(filename, std::ios_base::binary);
+        in.seekg(0, std::ios_base::end);
+        std::string content(static_cast<size_t>(in.tellg()), '\0');
+        in.seekg(0);
+        in.read(&content[0], static_cast<std::streamsize>(content.size()));
+        ASSERT_TRUE(in.good());
+        in.close();
+        std::ofstream out(filename, std::ios_base::binary | std::ios_base::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size() - 10 * 32 - 32));
+    }
+    ASSERT_EQ(reader.Open(filename), 0);
+    EXPECT_EQ(reader.GetNumberOfFrames(), 95);
+    EXPECT_EQ(reader.GetNumberOfChunks(), 10);
+    EXPECT_TRUE(reader.HasStatic());
+    EXPECT_EQ(reader.ReadFrameAtTime(2120000000ULL, frame), 42);
+    reader.Close();
+
+    std::remove(filename);
+}
+
+TEST(UDP, TestSendMultipleDatagrams)
+{
+    const unsigned short port = 48297;
+    UDPServer            server(port, 1000);
+    UDPClient            client(port, "127.0.0.1");
+    ASSERT_EQ(server.GetStatus(), 0);
+    ASSERT_EQ(client.GetStatus(), 0);
+
+    // header and payload kept apart, received as one package each
+    const int                        n_datagrams = 10;
+    int                              headers[n_datagrams];
+    std::string                      payload(n_datagrams * 100, ' ');
+    std::vector<UDPClient::Datagram> datagrams(n_datagrams);
+    for (int i = 0; i < n_datagrams; i++)
+    {
+        headers[i] = i;
+        for (int j = 0; j < 100; j++)
+        {
+            payload[static_cast<size_t>(i * 100 + j)] = static_cast<char>('a' + i);
+        }
+        datagrams[static_cast<size_t>(i)] = {reinterpret_cast<char*>(&headers[i]), sizeof(int), &payload[static_cast<size_t>(i * 100)], 100};
+    }
+
+    // paced to 10 kB/s, second batch has to wait for the first one, 520 bytes, to be paid for (52 ms)
+    client.SetRateLimit(1e4);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    EXPECT_EQ(client.SendMultiple(datagrams.data(), 5), 5);
+    EXPECT_EQ(client.SendMultiple(&datagrams[5], 5), 5);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_GT(elapsed, 0.04);
+
+    char buf[256];
+    for (int i = 0; i < n_datagrams; i++)
+    {
+        ASSERT_EQ(server.Receive(buf, sizeof(buf)), static_cast<int>(sizeof(int) + 100));
+        int header = 0;
+        memcpy(&header, buf, sizeof(int));
+        EXPECT_EQ(header, i);
+        EXPECT_EQ(buf[sizeof(int)], 'a' + i);
+        EXPECT_EQ(buf[sizeof(int) + 99], 'a' + i);
+    }
+
+    EXPECT_EQ(client.GetStatistics().n_datagrams, n_datagrams);
+    EXPECT_EQ(client.GetStatistics().n_bytes, n_datagrams * (sizeof(int) + 100));
+    EXPECT_EQ(client.GetStatistics().n_failed, 0);
+}
+
+TEST(UDP, TestFrameAssembly)
+{
+    const unsigned short port = 48298;
+    UDPServer            server(port, 1000);
+    UDPClient            client(port, "127.0.0.1");
+    ASSERT_EQ(server.GetStatus(), 0);
+    ASSERT_EQ(client.GetStatus(), 0);
+
+    // frames 1 and 4 fit in one single package, 2 and 3 are split in two packages where one of frame 2 gets lost
+    const std::string                payload[] = {"single", "lo", "st", "spl", "it", "again"};
+    UDPFrameAssembler::Header        headers[] = {{-1, 6, 1}, {1, 2, 2}, {-3, 2, 2}, {1, 3, 3}, {-2, 2, 3}, {-1, 5, 4}};
+    std::vector<UDPClient::Datagram> datagrams;
+    for (size_t i = 0; i < 6; i++)
+    {
+        datagrams.push_back({reinterpret_cast<char*>(&headers[i]), sizeof(UDPFrameAssembler::Header), payload[i].c_str(), headers[i].datasize});
+    }
+    EXPECT_EQ(client.SendMultiple(datagrams.data(), static_cast<unsigned int>(datagrams.size())), 6);
+
+    UDPFrameAssembler        assembler(1024);
+    std::vector<std::string> frames;
+    char                     buf[256];
+    for (size_t i = 0; i < datagrams.size(); i++)
+    {
+        int size = server.Receive(buf, sizeof(buf));
+        ASSERT_GT(size, 0);
+        if (assembler.Add(buf, size))
+        {
+            frames.push_back(std::string(assembler.GetFrame(), assembler.GetFrameSize()));
+        }
+    }
+
+    ASSERT_EQ(frames.size(), 3);
+    EXPECT_EQ(frames[0], "single");
+    EXPECT_EQ(frames[1], "split");
+    EXPECT_EQ(frames[2], "again");
+    EXPECT_EQ(assembler.GetNumberOfFrames(), 3);
+    EXPECT_EQ(assembler.GetNumberOfIncompleteFrames(), 1);
+    EXPECT_EQ(assembler.GetNumberOfMissedFrames(), 0);
+
+    // frame 5 is lost altogether
+    UDPFrameAssembler::Header header = {-1, 4, 6};
+    char                      package[sizeof(header) + 4];
+    memcpy(package, &header, sizeof(header));
+    memcpy(package + sizeof(header), "last", 4);
+    EXPECT_TRUE(assembler.Add(package, static_cast<int>(sizeof(package))));
+    EXPECT_EQ(std::string(assembler.GetFrame(), assembler.GetFrameSize()), "last");
+    EXPECT_EQ(assembler.GetNumberOfMissedFrames(), 1);
+}
+
+TEST(UDP, TestInputMultiplexer)
+{
+    UDPInputMultiplexer multiplexer;
+
+    const unsigned short          port0    = 48298;
+    const unsigned short          port1    = 48299;
+    UDPInputMultiplexer::Mailbox* mailbox0 = multiplexer.Open(port0);
+    UDPInputMultiplexer::Mailbox* mailbox1 = multiplexer.Open(port1);
+    ASSERT_NE(mailbox0, nullptr);
+    ASSERT_NE(mailbox1, nullptr);
+    EXPECT_EQ(multiplexer.GetNumberOfMailboxes(), 2);
+    EXPECT_EQ(mailbox1->GetPort(), port1);
+
+    UDPClient client0(port0, "127.0.0.1");
+    UDPClient client1(port1, "127.0.0.1");
+
+    char buf[64];
+    EXPECT_FALSE(mailbox0->HasMessage());
+    EXPECT_EQ(mailbox0->Take(buf, sizeof(buf)), 0);
+
+    // barrier times out while only one of the senders has reported
+    std::vector<UDPInputMultiplexer::Mailbox*> mailboxes = {mailbox0, mailbox1};
+    int                                        value     = 1;
+    client0.Send(reinterpret_cast<char*>(&value), sizeof(value));
+    EXPECT_FALSE(multiplexer.WaitForMessages(mailboxes, 50));
+    EXPECT_TRUE(mailbox0->HasMessage());
+
+    // messages are queued per port, in order
+    value = 2;
+    client0.Send(reinterpret_cast<char*>(&value), sizeof(value));
+    value = 3;
+    client0.Send(reinterpret_cast<char*>(&value), sizeof(value));
+    client1.Send(reinterpret_cast<char*>(&value), sizeof(value));
+    EXPECT_TRUE(multiplexer.WaitForMessages(mailboxes, 1000));
+    multiplexer.Refresh(mailbox0);
+    EXPECT_EQ(mailbox0->GetNumberOfMessages(), 3);
+
+    EXPECT_EQ(mailbox0->Take(buf, sizeof(buf)), static_cast<int>(sizeof(int)));
+    memcpy(&value, buf, sizeof(int));
+    EXPECT_EQ(value, 1);
+
+    // or just the latest one
+    EXPECT_EQ(mailbox0->TakeLatest(buf, sizeof(buf)), static_cast<int>(sizeof(int)));
+    memcpy(&value, buf, sizeof(int));
+    EXPECT_EQ(value, 3);
+    EXPECT_EQ(mailbox0->GetNumberOfDropped(), 1);
+    EXPECT_FALSE(mailbox0->HasMessage());
+
+    EXPECT_EQ(mailbox1->Take(buf, sizeof(buf)), static_cast<int>(sizeof(int)));
+    memcpy(&value, buf, sizeof(int));
+    EXPECT_EQ(value, 3);
+    EXPECT_EQ(mailbox1->Take(buf, sizeof(buf)), 0);
+
+    // waiting for many senders takes the time of the slowest one, not the sum
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::thread                           sender(
+        [&]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            int v = 4;
+            client1.Send(reinterpret_cast<char*>(&v), sizeof(v));
+            client0.Send(reinterpret_cast<char*>(&v), sizeof(v));
+        });
+    EXPECT_TRUE(multiplexer.WaitForMessages(mailboxes, 1000));
+    sender.join();
+    EXPECT_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 0.5);
+
+    multiplexer.Close(mailbox0);
+    multiplexer.Close(mailbox1);
+    EXPECT_EQ(multiplexer.GetNumberOfMailboxes(), 0);
+}
+
+#ifndef _WIN32
+TEST(SharedMemory, TestWriteAndReadMessages)
+{
+    const char* name = "esmini_unittest_shm";
+
+    // no writer yet
+    SharedMemoryReader no_reader(name);
+    EXPECT_EQ(no_reader.GetStatus(), -1);
+
+    SharedMemoryWriter writer(name, 3, 64);
+    ASSERT_EQ(writer.GetStatus(), 0);
+    SharedMemoryReader reader(name);
+    ASSERT_EQ(reader.GetStatus(), 0);
+    EXPECT_EQ(reader.GetNumberOfSlots(), 3);
+    EXPECT_EQ(reader.GetSlotSize(), 64);
+
+    std::string msg;
+    EXPECT_EQ(reader.Receive(msg, 0), 0);
+
+    // too large for a slot
+    EXPECT_EQ(writer.BeginWrite(65), nullptr);
+
+    // write directly into the slot
+    char* buf = writer.BeginWrite(5);
+    ASSERT_NE(buf, nullptr);
+    memcpy(buf, "first", 5);
+    EXPECT_EQ(writer.EndWrite(5), 0);
+    EXPECT_EQ(writer.Write("second", 6), 0);
+
+    size_t      size = 0;
+    const char* data = reader.Acquire(size, 0);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(std::string(data, size), "first");
+    EXPECT_TRUE(reader.Release());
+    EXPECT_EQ(reader.GetSequenceNumber(), 1);
+    EXPECT_EQ(reader.Receive(msg, 0), 6);
+    EXPECT_EQ(msg, "second");
+    EXPECT_EQ(reader.Receive(msg, 10), 0);
+
+    // message overwritten while in use
+    EXPECT_EQ(writer.Write("third", 5), 0);
+    data = reader.Acquire(size, 0);
+    ASSERT_NE(data, nullptr);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(writer.Write("next", 4), 0);
+    }
+    EXPECT_FALSE(reader.Release());
+
+    // reader fell behind, continue from the latest message
+    EXPECT_EQ(writer.Write("latest", 6), 0);
+    EXPECT_EQ(reader.Receive(msg, 0), 6);
+    EXPECT_EQ(msg, "latest");
+    EXPECT_EQ(reader.GetSequenceNumber(), 7);
+    EXPECT_GT(reader.GetNumberOfSkippedMessages(), 0);
+
+    // wake up waiting reader
+    std::thread producer(
+        [&writer]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            writer.Write("woken", 5);
+        });
+    EXPECT_EQ(reader.Receive(msg, 5000), 5);
+    EXPECT_EQ(msg, "woken");
+    producer.join();
+    EXPECT_FALSE(reader.IsWriterClosed());
+
+    // new writer with same name, e.g. after a crash, replaces the memory and tells old readers
+    SharedMemoryWriter writer2(name, 3, 64);
+    ASSERT_EQ(writer2.GetStatus(), 0);
+    EXPECT_TRUE(reader.IsWriterClosed());
+    EXPECT_EQ(reader.Receive(msg, 10), -1);
+    SharedMemoryReader reader2(name);
+    ASSERT_EQ(reader2.GetStatus(), 0);
+    EXPECT_EQ(writer2.Write("again", 5), 0);
+    EXPECT_EQ(reader2.Receive(msg, 0), 5);
+    EXPECT_EQ(msg, "again");
+
+    // replaced writer going away does not remove the memory of the new one
+    SharedMemoryWriter* replaced = new SharedMemoryWriter(name, 3, 64);
+    SharedMemoryWriter  writer3(name, 3, 64);
+    delete replaced;
+    SharedMemoryReader reader3(name);
+    EXPECT_EQ(reader3.GetStatus(), 0);
+}
+#endif
+
 int main(int argc, char** argv)
 {
     // testing::GTEST_FLAG(filter) = "*TestIsPointWithinSectorBetweenTwoLines*";
@@ -1615,6 +1615,126 @@ TEST(TrajectoryTest, PolyLineBase_YawInterpolation)
     EXPECT_NEAR(v.h, 0.958407, 1e-5);
 }
 
+TEST(TrajectoryTest, PolyLineBase_DiscardOldVertices)
+{
+    PolyLineBase pline;
+    TrajVertex   v;
+    idx_t        index = 0;
+    double       s     = 0.0;
+
+    // trail along x axis, 1 m/s, one vertex per second
+    for (int i = 0; i < 100; i++)
+    {
+        double t = static_cast<double>(i);
+        pline.AddVertex({std::nan(""), t, 0.0, 0.0, 0.0, 0.0, 0.0, ID_UNDEFINED, t, 1.0, 0.0, 0.0, Position::PosMode::H_ABS});
+    }
+
+    EXPECT_EQ(pline.FindPointAtTime(70.5, v, index), 0);
+    EXPECT_EQ(index, 70);
+    EXPECT_NEAR(v.x, 70.5, 1e-5);
+
+    // fewer than half obsolete, nothing discarded yet
+    pline.DiscardVerticesBefore(40.0);
+    EXPECT_EQ(pline.GetNumberOfVertices(), 100);
+    EXPECT_EQ(pline.GetNumberOfDiscardedVertices(), 0);
+
+    // vertex at time 59 is kept for interpolation
+    pline.DiscardVerticesBefore(59.5);
+    EXPECT_EQ(pline.GetNumberOfVertices(), 41);
+    EXPECT_EQ(pline.GetNumberOfDiscardedVertices(), 59);
+    EXPECT_NEAR(pline.vertex_[0].time, 59.0, 1e-5);
+
+    // indices and s values refer to the complete trail
+    EXPECT_EQ(pline.FindPointAtTime(70.5, v, index), 0);
+    EXPECT_EQ(index, 70);
+    EXPECT_NEAR(v.x, 70.5, 1e-5);
+    EXPECT_NEAR(v.s, 70.5, 1e-5);
+
+    EXPECT_EQ(pline.Evaluate(80.25, v, index), 80);
+    EXPECT_NEAR(v.x, 80.25, 1e-5);
+
+    EXPECT_EQ(pline.FindClosestPoint(90.5, 1.0, v, index, index), 0);
+    EXPECT_EQ(index, 90);
+    EXPECT_NEAR(v.x, 90.5, 1e-5);
+
+    // start index among discarded vertices is accepted
+    index = 10;
+    EXPECT_EQ(pline.Time2S(60.5, s, index), PolyLineBase::GhostTrailReturnCode::GHOST_TRAIL_OK);
+    EXPECT_EQ(index, 60);
+    EXPECT_NEAR(s, 60.5, 1e-5);
+
+    // discarded time range
+    EXPECT_EQ(pline.Time2S(30.0, s, index), PolyLineBase::GhostTrailReturnCode::GHOST_TRAIL_TIME_PRIOR);
+    EXPECT_EQ(index, 59);
+
+    // at least two vertices are kept
+    pline.DiscardVerticesBefore(1000.0);
+    EXPECT_EQ(pline.GetNumberOfVertices(), 2);
+    EXPECT_EQ(pline.GetNumberOfDiscardedVertices(), 98);
+
+    pline.Reset(true);
+    EXPECT_EQ(pline.GetNumberOfDiscardedVertices(), 0);
+}
+
+TEST(TrajectoryTest, PolyLineBase_DiscardKeepsRelativeTime)
+{
+    PolyLineBase pline;
+    TrajVertex   v;
+    idx_t        index = IDX_UNDEFINED;
+
+    // trail along x axis starting at time 10, 1 m/s, one vertex per second
+    for (int i = 0; i < 100; i++)
+    {
+        double t = static_cast<double>(i);
+        pline.AddVertex({std::nan(""), t, 0.0, 0.0, 0.0, 0.0, 0.0, ID_UNDEFINED, 10.0 + t, 1.0, 0.0, 0.0, Position::PosMode::H_ABS});
+    }
+    EXPECT_NEAR(pline.GetStartTime(), 10.0, 1e-5);
+
+    EXPECT_EQ(pline.FindPointAtTimeRelative(70.5, v, index), 0);
+    EXPECT_EQ(index, 70);
+    EXPECT_NEAR(v.x, 70.5, 1e-5);
+
+    // relative time still refers to the first vertex ever added, and indices to the complete trail
+    pline.DiscardVerticesBefore(69.5);
+    EXPECT_EQ(pline.GetNumberOfDiscardedVertices(), 59);
+    EXPECT_NEAR(pline.GetStartTime(), 10.0, 1e-5);
+
+    index = IDX_UNDEFINED;
+    EXPECT_EQ(pline.FindPointAtTimeRelative(70.5, v, index), 0);
+    EXPECT_EQ(index, 70);
+    EXPECT_NEAR(v.x, 70.5, 1e-5);
+    EXPECT_NEAR(v.time, 80.5, 1e-5);
+
+    // start at given index
+    index = 80;
+    EXPECT_EQ(pline.FindPointAtTimeRelative(80.25, v, index), 0);
+    EXPECT_EQ(index, 80);
+    EXPECT_NEAR(v.x, 80.25, 1e-5);
+
+    // discarded time range snaps to the oldest vertex kept
+    EXPECT_EQ(pline.FindPointAtTimeRelative(30.0, v, index), static_cast<int>(PolyLineBase::GhostTrailReturnCode::GHOST_TRAIL_TIME_PRIOR));
+    EXPECT_EQ(index, 59);
+    EXPECT_NEAR(v.x, 59.0, 1e-5);
+
+    // further discarding keeps the start time
+    pline.DiscardVerticesBefore(100.0);
+    EXPECT_EQ(pline.GetNumberOfDiscardedVertices(), 90);
+    index = IDX_UNDEFINED;
+    EXPECT_EQ(pline.FindPointAtTimeRelative(95.5, v, index), 0);
+    EXPECT_EQ(index, 95);
+    EXPECT_NEAR(v.x, 95.5, 1e-5);
+
+    // new trail after reset
+    pline.Reset(true);
+    pline.AddVertex({std::nan(""), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, ID_UNDEFINED, 200.0, 1.0, 0.0, 0.0, Position::PosMode::H_ABS});
+    pline.AddVertex({std::nan(""), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, ID_UNDEFINED, 201.0, 1.0, 0.0, 0.0, Position::PosMode::H_ABS});
+    EXPECT_NEAR(pline.GetStartTime(), 200.0, 1e-5);
+    index = IDX_UNDEFINED;
+    EXPECT_EQ(pline.FindPointAtTimeRelative(0.5, v, index), 0);
+    EXPECT_EQ(index, 0);
+    EXPECT_NEAR(v.x, 0.5, 1e-5);
+}
+
 TEST(TrajectoryTest, PolyLineShape_Filter)
 {
     PolyLineShape shape;
@@ -1862,6 +1862,268 @@ TEST(GroundTruthTests, osi_ground_truth_crop_multiple_objects)
     SE_Close();
 }
 
+TEST(GroundTruthTests, osi_ground_truth_crop_static)
+{
+    const osi3::GroundTruth* osi_gt_ptr;
+
+    ASSERT_EQ(SE_Init("../../../resources/xosc/ltap-od.xosc", 0, 0, 0, 0), 0);
+    SE_SetOSIStaticReportMode(SE_OSIStaticReportMode::API);
+
+    osi_gt_ptr = reinterpret_cast<const osi3::GroundTruth*>(SE_GetOSIGroundTruthRaw());
+
+    int n_lanes      = osi_gt_ptr->lane_size();
+    int n_boundaries = osi_gt_ptr->lane_boundary_size();
+    EXPECT_GT(n_lanes, 0);
+
+    SE_CropOSIStaticGroundTruth(0, 10.0);
+    SE_StepDT(0.01f);
+
+    EXPECT_GT(osi_gt_ptr->lane_size(), 0);
+    EXPECT_LT(osi_gt_ptr->lane_size(), n_lanes);
+    EXPECT_LT(osi_gt_ptr->lane_boundary_size(), n_boundaries);
+
+    SE_CropOSIStaticGroundTruth(0, 0.0);
+    SE_StepDT(0.01f);
+
+    EXPECT_EQ(osi_gt_ptr->lane_size(), n_lanes);
+    EXPECT_EQ(osi_gt_ptr->lane_boundary_size(), n_boundaries);
+
+    SE_Close();
+}
+
+TEST(GroundTruthTests, osi_ground_truth_buffers)
+{
+    SE_OSIBuffer static_gt;
+    SE_OSIBuffer dynamic_gt;
+
+    ASSERT_EQ(SE_Init("../../../resources/xosc/cut-in.xosc", 0, 0, 0, 0), 0);
+    ASSERT_EQ(SE_GetOSIGroundTruthBuffers(&static_gt, &dynamic_gt), 0);
+    EXPECT_GT(static_gt.size, 0);
+    EXPECT_GT(dynamic_gt.size, 0);
+
+    // static and dynamic parts together make the complete ground truth
+    std::string message(static_gt.data, static_cast<size_t>(static_gt.size));
+    message.append(dynamic_gt.data, static_cast<size_t>(dynamic_gt.size));
+    osi3::GroundTruth osi_gt;
+    ASSERT_TRUE(osi_gt.ParseFromString(message));
+    EXPECT_GT(osi_gt.lane_size(), 0);
+    EXPECT_EQ(osi_gt.moving_object_size(), 2);
+
+    // a held frame stays intact while the simulation keeps stepping
+    std::string        dynamic_copy(dynamic_gt.data, static_cast<size_t>(dynamic_gt.size));
+    unsigned long long static_generation = static_gt.generation;
+    SE_OSIBuffer       static_gt2;
+    SE_OSIBuffer       dynamic_gt2;
+    SE_StepDT(0.1f);
+    ASSERT_EQ(SE_GetOSIGroundTruthBuffers(&static_gt2, &dynamic_gt2), 0);
+    EXPECT_EQ(std::string(dynamic_gt.data, static_cast<size_t>(dynamic_gt.size)), dynamic_copy);
+    EXPECT_NE(dynamic_gt2.data, dynamic_gt.data);
+    EXPECT_GT(dynamic_gt2.generation, dynamic_gt.generation);
+
+    // unchanged static part, same buffer and generation
+    EXPECT_EQ(static_gt2.generation, static_generation);
+    EXPECT_EQ(static_gt2.data, static_gt.data);
+
+    SE_ReleaseOSIBuffer(&static_gt);
+    SE_ReleaseOSIBuffer(&dynamic_gt);
+    EXPECT_EQ(dynamic_gt.data, nullptr);
+
+    SE_Close();
+
+    // released after the simulation is closed
+    EXPECT_GT(dynamic_gt2.size, 0);
+    SE_ReleaseOSIBuffer(&static_gt2);
+    SE_ReleaseOSIBuffer(&dynamic_gt2);
+}
+
+TEST(GroundTruthTests, osi_sensor_view)
+{
+    int sv_size = 0;
+    int list[10];
+
+    ASSERT_EQ(SE_Init("../../../resources/xosc/cut-in.xosc", 0, 0, 0, 0), 0);
+    ASSERT_EQ(SE_AddObjectSensor(0, 2.0f, 0.0f, 0.5f, 0.0f, 1.0f, 100.0f, 1.0f, 10), 0);
+    ASSERT_EQ(SE_AddObjectSensor(0, -1.0f, 0.0f, 0.5f, static_cast<float>(M_PI), 1.0f, 100.0f, 1.0f, 10), 1);
+    SE_StepDT(0.1f);
+
+    for (int i = 0; i < 2; i++)
+    {
+        const char*      data = SE_GetOSISensorView(i, &sv_size);
+        osi3::SensorView sv;
+        ASSERT_NE(data, nullptr);
+        ASSERT_TRUE(sv.ParseFromArray(data, sv_size));
+        EXPECT_EQ(sv.sensor_id().value(), static_cast<uint64_t>(i));
+        EXPECT_EQ(sv.host_vehicle_id().value(), 0u);
+
+        // host followed by the objects detected by the sensor
+        int n_hits = SE_FetchSensorObjectList(i, list);
+        ASSERT_EQ(sv.global_ground_truth().moving_object_size(), n_hits + 1);
+        EXPECT_EQ(sv.global_ground_truth().moving_object(0).id().value(), 0u);
+        for (int j = 0; j < n_hits; j++)
+        {
+            EXPECT_EQ(sv.global_ground_truth().moving_object(j + 1).id().value(), static_cast<uint64_t>(list[j]));
+        }
+        EXPECT_GT(sv.global_ground_truth().lane_size(), 0);
+        EXPECT_GT(sv.global_ground_truth().lane_boundary_size(), 0);
+    }
+
+    // target vehicle starts behind Ego, seen by the rear sensor only
+    EXPECT_EQ(SE_FetchSensorObjectList(0, list), 0);
+    EXPECT_EQ(SE_FetchSensorObjectList(1, list), 1);
+
+    const osi3::SensorView* sv_raw = reinterpret_cast<const osi3::SensorView*>(SE_GetOSISensorViewRaw(1));
+    ASSERT_NE(sv_raw, nullptr);
+    EXPECT_EQ(sv_raw->global_ground_truth().moving_object_size(), 2);
+
+    EXPECT_EQ(SE_GetOSISensorView(2, &sv_size), nullptr);
+    EXPECT_EQ(sv_size, 0);
+
+    SE_Close();
+}
+
+TEST(GroundTruthTests, osi_output_rate)
+{
+    ASSERT_EQ(SE_Init("../../../resources/xosc/cut-in.xosc", 0, 0, 0, 0), 0);
+    ASSERT_EQ(SE_SetOSIOutputRate(1000.0), 0);
+    SE_EnableOSIFile("gt_output_rate.osi");
+
+    for (int i = 0; i < 10; i++)
+    {
+        SE_StepDT(0.01f);
+    }
+    SE_Close();  // pending samples are output before the file is closed
+
+    std::ifstream                  file("gt_output_rate.osi", std::ios::binary);
+    std::vector<osi3::GroundTruth> samples;
+    std::string                    buf;
+    unsigned int                   size = 0;
+
+    ASSERT_TRUE(file.good());
+    while (file.read(reinterpret_cast<char*>(&size), sizeof(size)))
+    {
+        buf.resize(size);
+        ASSERT_TRUE(file.read(&buf[0], size));
+        samples.emplace_back();
+        ASSERT_TRUE(samples.back().ParseFromString(buf));
+    }
+
+    // samples every ms up to the latest frame, which awaits the next one
+    ASSERT_GE(samples.size(), 99u);
+    ASSERT_LE(samples.size(), 101u);
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        EXPECT_EQ(samples[i].timestamp().seconds(), 0);
+        EXPECT_EQ(samples[i].timestamp().nanos(), static_cast<uint32_t>(i * 1000000));
+    }
+
+    // static data in first sample only
+    EXPECT_GT(samples[0].lane_size(), 0);
+    EXPECT_EQ(samples[1].lane_size(), 0);
+
+    // same objects in the same order in all samples
+    ASSERT_EQ(samples[0].moving_object_size(), 2);
+    for (size_t i = 1; i < samples.size(); i++)
+    {
+        ASSERT_EQ(samples[i].moving_object_size(), samples[0].moving_object_size());
+        for (int j = 0; j < samples[i].moving_object_size(); j++)
+        {
+            ASSERT_EQ(samples[i].moving_object(j).id().value(), samples[0].moving_object(j).id().value());
+        }
+    }
+
+    // look up objects by id, not by position in the list
+    auto find = [](const osi3::GroundTruth& gt, uint64_t id) -> const osi3::MovingObject*
+    {
+        for (int k = 0; k < gt.moving_object_size(); k++)
+        {
+            if (gt.moving_object(k).id().value() == id)
+            {
+                return &gt.moving_object(k);
+            }
+        }
+        return nullptr;
+    };
+
+    // distance moved by object of given id between two samples
+    auto distance = [&samples, &find](size_t i, size_t j, uint64_t id)
+    {
+        const osi3::MovingObject* o0 = find(samples[i], id);
+        const osi3::MovingObject* o1 = find(samples[j], id);
+        if (o0 == nullptr || o1 == nullptr)
+        {
+            return LARGE_NUMBER;
+        }
+        const osi3::Vector3d& p0 = o0->base().position();
+        const osi3::Vector3d& p1 = o1->base().position();
+        return sqrt(pow(p1.x() - p0.x(), 2) + pow(p1.y() - p0.y(), 2));
+    };
+
+    // Ego interpolated between frames, driving at 108 km/h
+    EXPECT_NEAR(distance(0, 5, 0), 0.15, 0.02);
+    EXPECT_NEAR(distance(10, 15, 0), 0.15, 0.02);
+
+    // speed of object of given id in a sample
+    auto speed = [&samples, &find](size_t i, uint64_t id)
+    {
+        const osi3::MovingObject* o = find(samples[i], id);
+        if (o == nullptr)
+        {
+            return 0.0;
+        }
+        const osi3::Vector3d& vel = o->base().velocity();
+        return sqrt(pow(vel.x(), 2) + pow(vel.y(), 2));
+    };
+
+    // no jumps, neither within frames nor at frame boundaries (every 10th sample). OverTaker starts by a step change of
+    // speed, hence step lengths are compared only at constant speed, otherwise limited by the speed of enclosing frames.
+    for (size_t i = 2; i < samples.size(); i++)
+    {
+        size_t frame0 = (i - 1) / 10 * 10;
+        size_t frame1 = MIN(frame0 + 10, samples.size() - 1);
+        for (int j = 0; j < samples[i].moving_object_size(); j++)
+        {
+            uint64_t                  id = samples[i].moving_object(j).id().value();
+            const osi3::MovingObject* o0 = find(samples[i - 1], id);
+            const osi3::MovingObject* o1 = find(samples[i], id);
+            ASSERT_NE(o0, nullptr);
+            ASSERT_NE(o1, nullptr);
+            EXPECT_LE(distance(i - 1, i, id), 1e-3 * MAX(speed(frame0, id), speed(frame1, id)) + 1e-4);
+            if (fabs(speed(i, id) - speed(i - 2, id)) < 1e-3)
+            {
+                EXPECT_NEAR(distance(i - 1, i, id), distance(i - 2, i - 1, id), 1e-3);
+            }
+            EXPECT_NEAR(o1->base().orientation().yaw(), o0->base().orientation().yaw(), 1e-3);
+        }
+    }
+}
+
+TEST(GroundTruthTests, osi_threads)
+{
+    std::string gt[2];
+
+    for (int i = 0; i < 2; i++)
+    {
+        SE_SetOptionValue("osi_threads", i == 0 ? "1" : "4");
+        ASSERT_EQ(SE_Init("../../../resources/xosc/cut-in.xosc", 0, 0, 0, 0), 0);
+        for (int j = 0; j < 20; j++)
+        {
+            SE_StepDT(0.1f);
+        }
+
+        int         size = 0;
+        const char* data = SE_GetOSIGroundTruth(&size);
+        ASSERT_NE(data, nullptr);
+        gt[i].assign(data, static_cast<size_t>(size));
+        SE_Close();
+    }
+
+    // objects prepared in parallel, same result
+    osi3::GroundTruth osi_gt;
+    ASSERT_TRUE(osi_gt.ParseFromString(gt[1]));
+    EXPECT_EQ(osi_gt.moving_object_size(), 2);
+    EXPECT_EQ(gt[0], gt[1]);
+}
+
 TEST(GetMiscObjFromGroundTruth, receive_miscobj)
 {
     int               sv_size = 0;
@@ -4399,6 +4661,152 @@ TEST(TestGetAndSet, SeedTest)
     SE_Close();
 }
 
+TEST(StateTest, TestSaveAndRestoreState)
+{
+    std::string scenario_file = "../../../EnvironmentSimulator/Unittest/xosc/highway_exit.xosc";
+
+    ASSERT_EQ(SE_Init(scenario_file.c_str(), 0, 0, 0, 0), 0);
+    ASSERT_EQ(SE_GetNumberOfObjects(), 2);
+
+    // run into the slowdown event, with the lane change event still in standby
+    for (int i = 0; i < 40; i++)
+    {
+        SE_StepDT(0.1f);
+    }
+    EXPECT_NEAR(SE_GetSimulationTimeDouble(), 4.0, 1e-5);
+
+    int         size = 0;
+    const char* data = SE_SaveState(&size);
+    ASSERT_NE(data, nullptr);
+    ASSERT_GT(size, 0);
+    std::vector<char> snapshot(data, data + size);
+
+    // run past the lane change, register states
+    std::vector<SE_ScenarioObjectState> states;
+    for (int i = 0; i < 60; i++)
+    {
+        SE_StepDT(0.1f);
+        for (int j = 0; j < SE_GetNumberOfObjects(); j++)
+        {
+            SE_ScenarioObjectState state;
+            SE_GetObjectState(SE_GetId(j), &state);
+            states.push_back(state);
+        }
+    }
+
+    // rewind and check that the same outcome is reproduced
+    ASSERT_EQ(SE_RestoreState(snapshot.data(), static_cast<int>(snapshot.size())), 0);
+    EXPECT_NEAR(SE_GetSimulationTimeDouble(), 4.0, 1e-5);
+
+    size_t k = 0;
+    for (int i = 0; i < 60; i++)
+    {
+        SE_StepDT(0.1f);
+        for (int j = 0; j < SE_GetNumberOfObjects(); j++)
+        {
+            SE_ScenarioObjectState state;
+            SE_GetObjectState(SE_GetId(j), &state);
+            ASSERT_LT(k, states.size());
+            EXPECT_NEAR(state.x, states[k].x, 1e-5);
+            EXPECT_NEAR(state.y, states[k].y, 1e-5);
+            EXPECT_NEAR(state.h, states[k].h, 1e-5);
+            EXPECT_NEAR(state.speed, states[k].speed, 1e-5);
+            EXPECT_EQ(state.laneId, states[k].laneId);
+            k++;
+        }
+    }
+
+    // truncated state is rejected, without any effect on current state
+    SE_ScenarioObjectState before;
+    SE_ScenarioObjectState after;
+    double                 time_before = SE_GetSimulationTimeDouble();
+    SE_GetObjectState(SE_GetId(0), &before);
+    EXPECT_EQ(SE_RestoreState(snapshot.data(), static_cast<int>(snapshot.size() / 2)), -1);
+    EXPECT_NEAR(SE_GetSimulationTimeDouble(), time_before, 1e-5);
+    SE_GetObjectState(SE_GetId(0), &after);
+    EXPECT_NEAR(after.x, before.x, 1e-5);
+    EXPECT_NEAR(after.y, before.y, 1e-5);
+    EXPECT_NEAR(after.speed, before.speed, 1e-5);
+
+    // state of previous format version is rejected
+    std::vector<char> old_version = snapshot;
+    uint32_t          version     = 1;
+    memcpy(old_version.data() + sizeof(uint32_t), &version, sizeof(version));  // version follows magic number
+    EXPECT_EQ(SE_RestoreState(old_version.data(), static_cast<int>(old_version.size())), -1);
+    EXPECT_NEAR(SE_GetSimulationTimeDouble(), time_before, 1e-5);
+
+    // state of other scenario is rejected
+    SE_Close();
+    ASSERT_EQ(SE_Init("../../../resources/xosc/cut-in.xosc", 0, 0, 0, 0), 0);
+    EXPECT_EQ(SE_RestoreState(snapshot.data(), static_cast<int>(snapshot.size())), -1);
+
+    SE_Close();
+}
+
+static std::vector<SE_ScenarioObjectState> RunWithControllerThreads(const char* osc_file, const char* threads, int n_steps, int& max_n_objects)
+{
+    std::vector<SE_ScenarioObjectState> states;
+    const char* args[] = {"--osc", osc_file, "--seed", "5", "--controller_threads", threads, "--headless"};
+
+    max_n_objects = 0;
+    if (SE_InitWithArgs(sizeof(args) / sizeof(char*), args) != 0)
+    {
+        return states;
+    }
+
+    for (int i = 0; i < n_steps; i++)
+    {
+        SE_StepDT(0.05f);
+        max_n_objects = MAX(max_n_objects, SE_GetNumberOfObjects());
+        for (int j = 0; j < SE_GetNumberOfObjects(); j++)
+        {
+            SE_ScenarioObjectState state;
+            SE_GetObjectState(SE_GetId(j), &state);
+            states.push_back(state);
+        }
+    }
+    SE_Close();
+
+    return states;
+}
+
+static void CheckSameResultForControllerThreads(const char* osc_file, int n_steps, int min_n_objects)
+{
+    int                                 max_n_objects = 0;
+    std::vector<SE_ScenarioObjectState> ref           = RunWithControllerThreads(osc_file, "1", n_steps, max_n_objects);
+    ASSERT_GT(ref.size(), 0);
+    ASSERT_GE(max_n_objects, min_n_objects);
+
+    // outcome should be identical regardless of number of threads, including serial stepping (0)
+    for (const char* threads : {"0", "2", "4"})
+    {
+        int                                 n_objects = 0;
+        std::vector<SE_ScenarioObjectState> states    = RunWithControllerThreads(osc_file, threads, n_steps, n_objects);
+        ASSERT_EQ(n_objects, max_n_objects);
+        ASSERT_EQ(states.size(), ref.size());
+        for (size_t i = 0; i < ref.size(); i++)
+        {
+            ASSERT_EQ(states[i].id, ref[i].id);
+            ASSERT_DOUBLE_EQ(states[i].x, ref[i].x);
+            ASSERT_DOUBLE_EQ(states[i].y, ref[i].y);
+            ASSERT_DOUBLE_EQ(states[i].speed, ref[i].speed);
+        }
+    }
+}
+
+TEST(ControllerTest, TestParallelControllerPerception)
+{
+    // swarm vehicles are driven by ACC controllers, i.e. many controllers perceiving each other
+    CheckSameResultForControllerThreads("../../../resources/xosc/swarm.xosc", 200, 11);
+}
+
+TEST(ControllerTest, TestControllerPerceptionBeforeStep)
+{
+    // ACC controllers in override mode move their entity when stepped, each one following the entity of previous controller
+    // all controllers should perceive the state prior to any controller step, also when stepped serially
+    CheckSameResultForControllerThreads("../../../EnvironmentSimulator/Unittest/xosc/acc_queue.xosc", 300, 4);
+}
+
 TEST(SimpleVehicleTest, TestControl)
 {
     float dt = 0.01f;
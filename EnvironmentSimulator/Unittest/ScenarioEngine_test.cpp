@@ -4,6 +4,7 @@
 #include <vector>
 #include <stdexcept>
 #include <array>
+#include <random>
 
 #include "CommonMini.hpp"
 #include "ScenarioEngine.hpp"
@@ -13,6 +14,7 @@
 #include "ControllerALKS_R157SM.hpp"
 #include "ControllerInteractive.hpp"
 #include "OSCParameterDistribution.hpp"
+#include "OSCAABBTree.hpp"
 #include "pugixml.hpp"
 #include "simple_expr.h"
 
@@ -1308,6 +1310,36 @@ TEST(ParameterTest, ParseParameterTest)
     ASSERT_EQ(params.ReadAttribute(someNode0, "attr9", false), "2.000000");
 }
 
+// Verify that cached expressions and parameter strings are re-evaluated on changed input values
+TEST(ParameterTest, CachedExpressionTest)
+{
+    Parameters& params = ScenarioReader::parameters;
+    params.Clear();
+
+    params.parameterDeclarations_.Parameter.push_back({"dist", OSCParameterDeclarations::ParameterType::PARAM_TYPE_DOUBLE, {0, 10.0, "10.0", false}});
+
+    pugi::xml_document xml_doc;
+    pugi::xml_node     someNode        = xml_doc.append_child("someNode");
+    someNode.append_attribute("attr0") = "${$dist * 2}";
+
+    ASSERT_EQ(params.ReadAttribute(someNode, "attr0", false), "20.000000");
+    ASSERT_EQ(params.ReadAttribute(someNode, "attr0", false), "20.000000");
+    ASSERT_EQ(params.ResolveParametersInString("$dist m"), "10.0 m");
+
+    ASSERT_EQ(params.setParameterValue("dist", 4.0), 0);
+    ASSERT_EQ(params.ReadAttribute(someNode, "attr0", false), "8.000000");
+    ASSERT_EQ(params.ResolveParametersInString("$dist m"), "4.000000 m");
+
+    // parameter referring another one, change of the nested parameter only
+    params.parameterDeclarations_.Parameter.push_back({"ref", OSCParameterDeclarations::ParameterType::PARAM_TYPE_STRING, {0, 0.0, "$dist", false}});
+    someNode.append_attribute("attr1") = "${$ref + 1}";
+    ASSERT_EQ(params.ReadAttribute(someNode, "attr1", false), "5.000000");
+    ASSERT_EQ(params.setParameterValue("dist", 6.0), 0);
+    ASSERT_EQ(params.ReadAttribute(someNode, "attr1", false), "7.000000");
+
+    params.Clear();
+}
+
 // Verify additional declarations of the same parameter will overwrite the previous one
 TEST(ParameterTest, KeepLastParameterValueTest)
 {
@@ -5775,6 +5807,340 @@ TEST(LatDistAction, EntityCoordinates)
     EXPECT_NEAR(pos_4.GetH(), 6.2821, 1e-3);
 }
 
+TEST(EntityStateBlockTest, KinematicsKernels)
+{
+    // Compare available kernels with the scalar one, for random states and all combinations of dirty bits
+    std::mt19937                           gen(1234);
+    std::uniform_real_distribution<double> pos_dist(-100.0, 100.0);
+    std::uniform_real_distribution<double> vel_dist(-30.0, 30.0);
+    std::uniform_real_distribution<double> angle_dist(-7.0, 7.0);
+    std::uniform_int_distribution<int>     bits_dist(0, 0xffff);
+
+    const int bits = Object::DirtyBit::VELOCITY | Object::DirtyBit::SPEED | Object::DirtyBit::ACCELERATION | Object::DirtyBit::ANGULAR_RATE |
+                     Object::DirtyBit::ANGULAR_ACC | Object::DirtyBit::TELEPORT;
+
+    EntityStateBlock block;
+    block.Resize(103);  // not a multiple of vector width
+    for (size_t i = 0; i < block.Size(); i++)
+    {
+        for (auto* v : {&block.x_, &block.y_, &block.z_, &block.x_old_, &block.y_old_, &block.z_old_})
+        {
+            (*v)[i] = pos_dist(gen);
+        }
+        for (auto* v : {&block.speed_,
+                        &block.vel_x_,
+                        &block.vel_y_,
+                        &block.vel_z_,
+                        &block.vel_x_old_,
+                        &block.vel_y_old_,
+                        &block.vel_z_old_,
+                        &block.acc_x_,
+                        &block.acc_y_,
+                        &block.acc_z_,
+                        &block.h_acc_})
+        {
+            (*v)[i] = vel_dist(gen);
+        }
+        for (auto* v : {&block.h_, &block.h_old_, &block.h_rate_, &block.h_rate_old_})
+        {
+            (*v)[i] = angle_dist(gen);
+        }
+        block.dirty_[i]  = bits_dist(gen) & bits;
+        block.update_[i] = (i % 7 != 3) ? 1 : 0;
+    }
+    // no teleport in first entries, to make sure vector path is used for some of them
+    for (size_t i = 0; i < 16; i++)
+    {
+        block.dirty_[i] &= ~Object::DirtyBit::TELEPORT;
+    }
+
+    for (double dt : {0.05, 0.0})
+    {
+        EntityStateBlock ref = block;
+        ref.UpdateKinematics(dt, EntityStateBlock::Kernel::SCALAR);
+
+        for (EntityStateBlock::Kernel kernel : {EntityStateBlock::Kernel::AUTO, EntityStateBlock::Kernel::AVX2})
+        {
+            EntityStateBlock res = block;
+            res.UpdateKinematics(dt, kernel);
+
+            for (size_t i = 0; i < block.Size(); i++)
+            {
+                EXPECT_EQ(res.dirty_[i], ref.dirty_[i]);
+                EXPECT_NEAR(res.speed_[i], ref.speed_[i], 1e-9);
+                EXPECT_NEAR(res.vel_x_[i], ref.vel_x_[i], 1e-9);
+                EXPECT_NEAR(res.vel_y_[i], ref.vel_y_[i], 1e-9);
+                EXPECT_NEAR(res.vel_z_[i], ref.vel_z_[i], 1e-9);
+                EXPECT_NEAR(res.acc_x_[i], ref.acc_x_[i], 1e-9);
+                EXPECT_NEAR(res.acc_y_[i], ref.acc_y_[i], 1e-9);
+                EXPECT_NEAR(res.acc_z_[i], ref.acc_z_[i], 1e-9);
+                EXPECT_NEAR(res.h_rate_[i], ref.h_rate_[i], 1e-9);
+                EXPECT_NEAR(res.h_rate_new_[i], ref.h_rate_new_[i], 1e-9);
+                EXPECT_NEAR(res.h_acc_[i], ref.h_acc_[i], 1e-9);
+                EXPECT_NEAR(res.dist_[i], ref.dist_[i], 1e-9);
+                EXPECT_NEAR(res.x_old_[i], ref.x_old_[i], 1e-9);
+                EXPECT_NEAR(res.vel_y_old_[i], ref.vel_y_old_[i], 1e-9);
+                EXPECT_NEAR(res.h_old_[i], ref.h_old_[i], 1e-9);
+                EXPECT_NEAR(res.h_rate_old_[i], ref.h_rate_old_[i], 1e-9);
+            }
+        }
+    }
+}
+
+TEST(NeighborIndexTest, QueriesMatchLinearSearch)
+{
+    ASSERT_EQ(Position::GetOpenDrive()->LoadOpenDriveFile("../../../resources/xodr/straight_500m.xodr"), true);
+
+    Entities entities;
+    for (int i = 0; i < 60; i++)
+    {
+        Vehicle* v = new Vehicle();
+        v->pos_.SetLanePos(1, (i % 3) - 2 + (i % 3 == 2 ? 1 : 0), 7.0 * i + (i % 3), 0.0);  // lanes -2, -1 and 1
+        entities.addObject(v, true);
+    }
+    EXPECT_FALSE(entities.neighbor_index_.IsValid());
+
+    std::vector<std::vector<Object*>> linear;
+    std::vector<Object*>              result;
+    std::vector<size_t>               scratch;
+    const double                      queries[][2] = {{0.0, 0.0}, {100.0, -3.0}, {250.0, 5.0}, {499.0, 0.0}, {700.0, 0.0}};
+
+    // reference results by linear search, index not built
+    for (auto& q : queries)
+    {
+        entities.GetObjectsInRadius(q[0], q[1], 35.0, result, scratch);
+        linear.push_back(result);
+    }
+
+    entities.UpdateNeighborIndex();
+    EXPECT_TRUE(entities.neighbor_index_.IsValid());
+
+    size_t k = 0;
+    for (auto& q : queries)
+    {
+        entities.GetObjectsInRadius(q[0], q[1], 35.0, result, scratch);
+        EXPECT_EQ(result, linear[k++]);
+    }
+
+    // check a few explicit results
+    entities.GetObjectsInRadius(0.0, 0.0, 10.0, result, scratch);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0], entities.object_[0]);
+    EXPECT_EQ(result[1], entities.object_[1]);
+
+    // index is invalidated when entities are added or removed
+    entities.removeObject(entities.object_[0]);
+    EXPECT_FALSE(entities.neighbor_index_.IsValid());
+}
+
+TEST(NeighborIndexTest, ClosestInLane)
+{
+    ASSERT_EQ(Position::GetOpenDrive()->LoadOpenDriveFile("../../../resources/xodr/straight_500m.xodr"), true);
+
+    // ego in lane -1 at s=100, leads at 130 and 160, follower at 60 and a vehicle in adjacent lane -2 at 120
+    Entities     entities;
+    const double lane_s[][2] = {{-1, 100.0}, {-1, 160.0}, {-1, 130.0}, {-1, 60.0}, {-2, 120.0}};
+    for (auto& ls : lane_s)
+    {
+        Vehicle* v                          = new Vehicle();
+        v->boundingbox_.dimensions_.length_ = 4.0f;
+        v->boundingbox_.center_.x_          = 1.0f;
+        v->pos_.SetLanePos(1, static_cast<int>(ls[0]), ls[1], 0.0);
+        entities.addObject(v, true);
+    }
+    Object* ego = entities.object_[0];
+
+    std::vector<Object*> candidates;
+    std::vector<size_t>  scratch;
+    LaneNeighbor         result;
+
+    // same results by linear search and by the index
+    for (int i = 0; i < 2; i++)
+    {
+        // closest ahead in same lane, gap from front of ego to rear of lead
+        EXPECT_TRUE(entities.GetClosestInLane(ego, 0, true, 100.0, 1.0, result, candidates, scratch));
+        EXPECT_EQ(result.object, entities.object_[2]);
+        EXPECT_NEAR(result.gap, 26.0, 1e-5);
+        EXPECT_NEAR(result.diff.ds, 30.0, 1e-5);
+
+        // closest behind, gap from front of follower to rear of ego
+        EXPECT_TRUE(entities.GetClosestInLane(ego, 0, false, 100.0, 1.0, result, candidates, scratch));
+        EXPECT_EQ(result.object, entities.object_[3]);
+        EXPECT_NEAR(result.gap, 36.0, 1e-5);
+
+        // adjacent lane to the right, lateral distance between lane centers is 2.375 m
+        EXPECT_TRUE(entities.GetClosestInLane(ego, -1, true, 100.0, 3.0, result, candidates, scratch));
+        EXPECT_EQ(result.object, entities.object_[4]);
+        EXPECT_NEAR(result.gap, 16.0, 1e-5);
+        EXPECT_FALSE(entities.GetClosestInLane(ego, -1, true, 100.0, 2.0, result, candidates, scratch));
+        EXPECT_EQ(result.object, nullptr);
+        EXPECT_FALSE(entities.GetClosestInLane(ego, -1, false, 100.0, 3.0, result, candidates, scratch));
+
+        // nothing within max distance
+        EXPECT_FALSE(entities.GetClosestInLane(ego, 0, true, 20.0, 1.0, result, candidates, scratch));
+        EXPECT_EQ(result.object, nullptr);
+
+        entities.UpdateNeighborIndex();
+        EXPECT_TRUE(entities.neighbor_index_.IsValid());
+    }
+}
+
+TEST(AABBTreeTest, IntersectMatchesBruteForce)
+{
+    std::mt19937                           gen(4321);
+    std::uniform_real_distribution<double> pos_dist(-200.0, 200.0);
+    std::uniform_real_distribution<double> size_dist(-5.0, 5.0);
+
+    aabbTree::Tree tree1;
+    aabbTree::Tree tree2;
+
+    auto fill = [&](aabbTree::Tree& tree, int n)
+    {
+        tree.clear();
+        for (int i = 0; i < n; i++)
+        {
+            double x = pos_dist(gen);
+            double y = pos_dist(gen);
+            tree.Triangles().push_back(
+                aabbTree::makeTriangle(x, y, x + size_dist(gen), y + size_dist(gen), x + size_dist(gen), y + size_dist(gen)));
+        }
+        tree.build();
+    };
+
+    // rebuild a few times to exercise reuse of tree storage
+    for (int round = 0; round < 3; round++)
+    {
+        fill(tree1, 500 - 100 * round);
+        fill(tree2, 200 + 100 * round);
+        EXPECT_EQ(tree1.leafCount(), tree1.Triangles().size());
+        EXPECT_EQ(tree1.nodeCount(), 2 * tree1.Triangles().size() - 1);
+
+        aabbTree::Candidates candidates;
+        tree1.intersect(tree2, candidates);
+
+        std::vector<std::pair<unsigned int, unsigned int>> found;
+        for (auto const& c : candidates)
+        {
+            if (tree1.GetTriangle(c.triangle1).collide(tree2.GetTriangle(c.triangle2)))
+            {
+                found.push_back({c.triangle1, c.triangle2});
+            }
+        }
+        std::sort(found.begin(), found.end());
+
+        std::vector<std::pair<unsigned int, unsigned int>> expected;
+        for (unsigned int i = 0; i < tree1.Triangles().size(); i++)
+        {
+            for (unsigned int j = 0; j < tree2.Triangles().size(); j++)
+            {
+                if (tree1.GetTriangle(i).collide(tree2.GetTriangle(j)))
+                {
+                    expected.push_back({i, j});
+                }
+            }
+        }
+
+        EXPECT_GT(expected.size(), 0);
+        EXPECT_EQ(found, expected);
+    }
+
+    tree1.clear();
+    EXPECT_TRUE(tree1.empty());
+    aabbTree::Candidates candidates;
+    tree1.intersect(tree2, candidates);
+    EXPECT_EQ(candidates.size(), 0);
+}
+
+TEST(SwarmTest, RecyclesDespawnedVehicles)
+{
+    SE_Env::Inst().GetRand().SetSeed(0);
+
+    ScenarioEngine* se = new ScenarioEngine("../../../resources/xosc/swarm.xosc");
+    ASSERT_NE(se, nullptr);
+
+    // swarm vehicles, excluding any trailers
+    auto isSwarm = [](Object* obj) { return obj->GetName().rfind("swarm_", 0) == 0 && obj->TowVehicle() == nullptr; };
+
+    size_t max_active = 0;
+    while (se->getSimulationTime() < 15.0 - SMALL_NUMBER)
+    {
+        se->step(0.05);
+        se->prepareGroundTruth(0.05);
+        max_active = MAX(max_active, static_cast<size_t>(std::count_if(se->entities_.object_.begin(), se->entities_.object_.end(), isSwarm)));
+    }
+    EXPECT_GT(max_active, 0);
+    EXPECT_LE(max_active, 75);
+
+    auto isACC = [](scenarioengine::Controller* ctrl) { return ctrl->GetType() == scenarioengine::Controller::Type::CONTROLLER_TYPE_ACC; };
+
+    size_t n_active = static_cast<size_t>(std::count_if(se->entities_.object_.begin(), se->entities_.object_.end(), isSwarm));
+    size_t n_controllers =
+        static_cast<size_t>(std::count_if(se->scenarioReader->controller_.begin(), se->scenarioReader->controller_.end(), isACC));
+    size_t n_released = static_cast<size_t>(
+        std::count_if(se->scenarioReader->released_controllers_.begin(), se->scenarioReader->released_controllers_.end(), isACC));
+
+    // despawned vehicles and their controllers are kept for reuse, instead of deleted
+    EXPECT_GT(se->entities_.GetNumberOfRecycledObjects(), 0);
+    EXPECT_EQ(n_controllers, n_active);
+    EXPECT_LE(n_controllers + n_released, max_active);
+
+    int n_spawned = 0;
+    for (auto* obj : se->entities_.object_)
+    {
+        if (isSwarm(obj))
+        {
+            n_spawned = MAX(n_spawned, std::stoi(obj->GetName().substr(6)) + 1);
+        }
+    }
+    EXPECT_GT(static_cast<size_t>(n_spawned), max_active);
+
+    delete se;
+}
+
+TEST(EntitiesTest, ReusesRemovedVehicles)
+{
+    Entities entities;
+
+    Vehicle* vehicle = entities.NewVehicle();
+    vehicle->name_   = "Car";
+    vehicle->SetSpeed(10.0);
+    entities.addObject(vehicle, true);
+    EXPECT_EQ(entities.object_.size(), 1);
+
+    entities.removeObject(vehicle);
+    EXPECT_EQ(entities.object_.size(), 0);
+    EXPECT_EQ(entities.GetNumberOfRecycledObjects(), 1);
+
+    // same instance handed out again, reset to initial state
+    Vehicle* reused = entities.NewVehicle();
+    EXPECT_EQ(reused, vehicle);
+    EXPECT_EQ(entities.GetNumberOfRecycledObjects(), 0);
+    EXPECT_EQ(reused->name_, "");
+    EXPECT_NEAR(reused->GetSpeed(), 0.0, 1e-10);
+
+    // or to a copy of given source
+    Vehicle source;
+    source.name_ = "Source";
+    source.SetSpeed(5.0);
+    entities.addObject(reused, true);
+    entities.removeObject(reused);
+    reused = entities.NewVehicle(&source);
+    EXPECT_EQ(reused, vehicle);
+    EXPECT_EQ(reused->name_, "Source");
+    EXPECT_NEAR(reused->GetSpeed(), 5.0, 1e-10);
+
+    // number of kept instances is limited, others are deleted
+    entities.SetMaxRecycledObjects(1);
+    entities.addObject(reused, true);
+    entities.addObject(entities.NewVehicle(), true);
+    entities.removeObject(entities.object_[1]);
+    entities.removeObject(entities.object_[0]);
+    EXPECT_EQ(entities.GetNumberOfRecycledObjects(), 1);
+
+    entities.SetMaxRecycledObjects(0);
+    EXPECT_EQ(entities.GetNumberOfRecycledObjects(), 0);
+}
+
 int main(int argc, char** argv)
 {
 #if 0  // set to 1 and modify filter to run one single test
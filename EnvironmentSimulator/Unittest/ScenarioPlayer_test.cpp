@@ -224,6 +224,197 @@ TEST(SensorTest, TestSensorFunctionsReturnValuesAndCounters)
     delete player;
 }
 
+TEST(SensorTest, TestFieldOfViewMatchesAngleCheck)
+{
+    Entities entities;
+
+    Vehicle* host = new Vehicle();
+    entities.addObject(host, true);
+    host->pos_.SetInertiaPos(10.0, 20.0, 0.4, false);
+
+    // objects in rings around the host
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = 0; j < 50; j++)
+        {
+            double   dist  = 0.5 + 14.0 * i;
+            double   angle = j * 2 * M_PI / 50 + 0.01 * i;
+            Vehicle* obj   = new Vehicle();
+            entities.addObject(obj, true);
+            obj->pos_.SetInertiaPos(10.0 + dist * cos(angle), 20.0 + dist * sin(angle), 0.1 * j, false);
+        }
+    }
+
+    std::vector<ObjectSensor*> sensors;
+    for (double heading : {0.0, 1.57, -1.57, 3.14, -3.0, 7.0})
+    {
+        for (double fov : {0.5, 1.57, 3.5, 6.0, 7.0})
+        {
+            sensors.push_back(new ObjectSensor(&entities, host, 2.0, 0.5, 0.5, heading, 1.0, 60.0, fov, 400));
+        }
+    }
+
+    // reference: angle based check, as before the sensor was converted to dot products
+    auto inView = [host](ObjectSensor* sensor, Object* obj)
+    {
+        double xo      = obj->pos_.GetX() - sensor->pos_.x_global;
+        double yo      = obj->pos_.GetY() - sensor->pos_.y_global;
+        double dist_sq = xo * xo + yo * yo;
+        if (dist_sq < sensor->near_sq_ || dist_sq > sensor->far_sq_)
+        {
+            return false;
+        }
+        double hx, hy, xon, yon;
+        RotateVec2D(1.0, 0.0, host->pos_.GetH(), hx, hy);
+        NormalizeVec2D(xo, yo, xon, yon);
+        double angle = acos(CLAMP(GetDotProduct2D(hx, hy, xon, yon), -1.0, 1.0));
+        return GetAbsAngleDifference(angle, sensor->pos_.h) < sensor->fovH_ / 2;
+    };
+
+    ObjectSensorManager manager;
+    for (unsigned int n_threads : {1U, 4U})
+    {
+        manager.SetNumberOfThreads(n_threads);
+        manager.Update(entities, sensors);
+
+        for (auto* sensor : sensors)
+        {
+            std::vector<Object*> expected;
+            for (size_t i = 1; i < entities.object_.size(); i++)
+            {
+                if (inView(sensor, entities.object_[i]))
+                {
+                    expected.push_back(entities.object_[i]);
+                }
+            }
+
+            ASSERT_EQ(sensor->nObj_, static_cast<int>(expected.size()));
+            for (size_t i = 0; i < expected.size(); i++)
+            {
+                EXPECT_EQ(sensor->hitList_[i].obj_, expected[i]);
+            }
+        }
+    }
+
+    EXPECT_EQ(sensors[0]->nObj_, 14);
+
+    for (auto* sensor : sensors)
+    {
+        delete sensor;
+    }
+}
+
+TEST(SensorTest, TestOcclusion)
+{
+    Entities entities;
+
+    auto addVehicle = [&entities](double x, double y, double h, double length, double width)
+    {
+        Vehicle* v = new Vehicle();
+        entities.addObject(v, true);
+        v->pos_.SetInertiaPos(x, y, h, false);
+        v->boundingbox_.center_     = {0.0f, 0.0f, 0.0f};
+        v->boundingbox_.dimensions_ = {static_cast<float>(width), static_cast<float>(length), 2.0f};
+        return v;
+    };
+
+    Vehicle* host   = addVehicle(0.0, 0.0, 0.0, 4.5, 1.8);
+    Vehicle* truck  = addVehicle(15.0, 0.0, 0.0, 10.0, 2.5);
+    Vehicle* hidden = addVehicle(40.0, 0.3, 0.1, 4.5, 1.8);
+    Vehicle* beside = addVehicle(40.0, 9.0, 0.0, 4.5, 1.8);
+    Vehicle* corner = addVehicle(40.0, 5.6, 0.0, 4.5, 1.8);  // center hidden, near corner visible past the truck
+
+    ObjectSensor        sensor(&entities, host, 2.0, 0.0, 0.5, 0.0, 1.0, 100.0, 1.0, 10);
+    ObjectSensorManager manager;
+    std::vector<ObjectSensor*> sensors = {&sensor};
+
+    auto detected = [&sensor](Object* obj)
+    {
+        for (int i = 0; i < sensor.nObj_; i++)
+        {
+            if (sensor.hitList_[i].obj_ == obj)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    manager.Update(entities, sensors);
+    EXPECT_EQ(sensor.nObj_, 4);
+
+    sensor.occlusion_ = true;
+    manager.Update(entities, sensors);
+    EXPECT_EQ(sensor.nObj_, 3);
+    EXPECT_TRUE(detected(truck));
+    EXPECT_FALSE(detected(hidden));
+    EXPECT_TRUE(detected(beside));
+    EXPECT_TRUE(detected(corner));
+
+    // ghosts do not block the view
+    truck->isGhost_ = true;
+    manager.Update(entities, sensors);
+    EXPECT_TRUE(detected(hidden));
+}
+
+TEST(FrameSchedulerTest, TestDeferredOutputKeepsOrder)
+{
+    FrameScheduler   scheduler;
+    std::vector<int> output;
+
+    // no budget, everything run in order in the calling thread
+    scheduler.BeginFrame();
+    scheduler.RunOutput(FrameScheduler::Stage::CSV_LOG, [&output]() { output.push_back(0); });
+    scheduler.EndFrame();
+    EXPECT_FALSE(scheduler.IsBackground(FrameScheduler::Stage::CSV_LOG));
+    EXPECT_EQ(scheduler.GetNumberOfDeadlineMisses(), 0u);
+
+    // tiny budget, expensive output stage is moved to background thread
+    scheduler.SetBudget(1e-9);
+    for (int i = 1; i < 50; i++)
+    {
+        scheduler.BeginFrame();
+        scheduler.Run(FrameScheduler::Stage::SCENARIO, []() { SE_sleep(1); });
+        scheduler.RunOutput(FrameScheduler::Stage::CSV_LOG,
+                            [&output, i]()
+                            {
+                                SE_sleep(1);
+                                output.push_back(i);
+                            });
+        scheduler.EndFrame();
+    }
+    scheduler.Flush();
+
+    EXPECT_TRUE(scheduler.IsBackground(FrameScheduler::Stage::CSV_LOG));
+    EXPECT_EQ(scheduler.GetNumberOfDeadlineMisses(), 49u);
+    EXPECT_EQ(scheduler.GetStats(FrameScheduler::Stage::CSV_LOG).n_runs, 50u);
+    EXPECT_EQ(scheduler.GetStats(FrameScheduler::Stage::CSV_LOG).n_deferred, 48u);
+    ASSERT_EQ(output.size(), 50u);
+    for (int i = 0; i < 50; i++)
+    {
+        EXPECT_EQ(output[static_cast<unsigned int>(i)], i);
+    }
+
+    // presentation stages are slowed down
+    int n_plot = 0;
+    for (int i = 0; i < 20; i++)
+    {
+        scheduler.BeginFrame();
+        if (scheduler.ShouldRun(FrameScheduler::Stage::PLOT))
+        {
+            scheduler.Run(FrameScheduler::Stage::PLOT, [&n_plot]() { n_plot++; });
+        }
+        scheduler.EndFrame();
+    }
+    EXPECT_GT(scheduler.GetStats(FrameScheduler::Stage::PLOT).rate_divisor, 1u);
+    EXPECT_LT(n_plot, 20);
+
+    // budget removed, back to normal
+    scheduler.SetBudget(0.0);
+    EXPECT_FALSE(scheduler.IsBackground(FrameScheduler::Stage::CSV_LOG));
+    EXPECT_EQ(scheduler.GetStats(FrameScheduler::Stage::PLOT).rate_divisor, 1u);
+}
+
 TEST(AlignmentTest, TestPosMode)
 {
     const char* args[] = {"esmini", "--headless", "--osc", "../../../EnvironmentSimulator/Unittest/xosc/curve_slope_simple.xosc", "--disable_stdout"};
@@ -42,7 +42,7 @@ class UdpSender():
 
 class UdpReceiver():
     def __init__(self, ip='127.0.0.1', port=base_port, timeout=-1):
-        self.buffersize = 8208  # MAX OSI data size (contract with esmini) + header (two ints)
+        self.buffersize = 65536  # Max UDP package size, fits any OSI package size configured in esmini
         # Create a UDP socket
         self.sock = socket(AF_INET, SOCK_DGRAM)
         if timeout >= 0:
@@ -66,36 +66,39 @@ class OSIReceiver():
     def receive(self):
         done = False
         next_index = 1
+        frame_id = None
         complete_msg = b''
 
         # Large nessages might be split in multiple parts
-        # esmini will add a counter to indicate sequence number 0, 1, 2...
+        # esmini will add a counter to indicate sequence number 1, 2, 3...
         # negative counter means last part and message is now complete
+        # all parts of a message share the same frame id
         while not done:
             # receive header
             msg = self.udp_receiver.receive()
 
             # extract message parts
-            header_size = 4 + 4  # counter(int) + size(unsigned int)
-            counter, size, frame = struct.unpack('iI{}s'.format(len(msg)-header_size), msg)
-            # print('counter {} size {}'.format(counter, size))
+            header_size = 4 + 4 + 4  # counter(int) + size(unsigned int) + frame id(unsigned int)
+            counter, size, frame_id_part, frame = struct.unpack('iII{}s'.format(len(msg)-header_size), msg)
+            # print('counter {} size {} frame id {}'.format(counter, size, frame_id_part))
 
-            if not (len(frame) == size == len(msg)-8):
+            if not (len(frame) == size == len(msg)-header_size):
                 print('Error: Unexpected invalid lengths')
                 return
 
-            if counter == 1:  # new message
+            if abs(counter) == 1:  # new message, -1 means it fits in one single part
                 complete_msg = b''
                 next_index = 1
+                frame_id = frame_id_part
 
             # Compose complete message
-            if counter == 1 or abs(counter) == next_index:
+            if abs(counter) == next_index and frame_id_part == frame_id:
                 complete_msg += frame
                 next_index += 1
                 if counter < 0:  # negative counter number indicates end of message
                     done = True
             else:
-                next_index = 1   # out of sync, reset
+                next_index = 1   # part missing, wait for first part of next message
 
         # Parse and return message
         self.osi_msg.ParseFromString(complete_msg)